@@ -390,6 +390,18 @@ namespace QBluezConst {
         OcfLeClearWhiteList = 0x10,
         OcfLeAddToWhiteList = 0x11,
         OcfLeConnectionUpdate = 0x13,
+        OcfLeSetAdvSetRandomAddress = 0x35,
+        OcfLeSetExtAdvParams = 0x36,
+        OcfLeSetExtAdvData = 0x37,
+        OcfLeSetExtScanResponseData = 0x38,
+        OcfLeSetExtAdvEnable = 0x39,
+        OcfLeReadMaxAdvDataLength = 0x3a,
+        OcfLeReadNumberOfSupportedAdvSets = 0x3b,
+        OcfLeRemoveAdvSet = 0x3c,
+        OcfLeClearAdvSets = 0x3d,
+        OcfLeSetPeriodicAdvParams = 0x3e,
+        OcfLeSetPeriodicAdvData = 0x3f,
+        OcfLeSetPeriodicAdvEnable = 0x40,
     };
     Q_ENUM_NS(OpCodeCommandField)
 
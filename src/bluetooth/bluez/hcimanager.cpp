@@ -92,6 +92,15 @@ HciManager::HciManager(const QBluetoothAddress& deviceAdapter, QObject *parent)
 
 }
 
+#ifdef QT_BUILD_INTERNAL
+HciManager::HciManager(int socketDescriptor, int deviceId, QObject *parent)
+    : QObject(parent), hciSocket(socketDescriptor), hciDev(deviceId), simulatedController(true)
+{
+    notifier = new QSocketNotifier(hciSocket, QSocketNotifier::Read, this);
+    connect(notifier, SIGNAL(activated(QSocketDescriptor)), this, SLOT(_q_readNotify()));
+}
+#endif
+
 HciManager::~HciManager()
 {
     if (hciSocket >= 0)
@@ -160,6 +169,12 @@ bool HciManager::monitorEvent(HciManager::HciEvent event)
     if (runningEvents.contains(event))
         return true;
 
+#ifdef QT_BUILD_INTERNAL
+    // there is no kernel event filter in front of a simulated controller
+    if (simulatedController)
+        return true;
+#endif
+
     hci_filter filter;
     socklen_t length = sizeof(hci_filter);
     if (getsockopt(hciSocket, SOL_HCI, HCI_FILTER, &filter, &length) < 0) {
@@ -62,7 +62,7 @@ QT_BEGIN_NAMESPACE
 
 class QLowEnergyConnectionParameters;
 
-class HciManager : public QObject
+class Q_AUTOTEST_EXPORT HciManager : public QObject
 {
     Q_OBJECT
 public:
@@ -193,9 +193,15 @@ public:
     Q_ENUM(HciError);
 
     explicit HciManager(const QBluetoothAddress &deviceAdapter, QObject *parent = nullptr);
+#ifdef QT_BUILD_INTERNAL
+    // for tests: exchanges HCI packets with a simulated controller over socketDescriptor,
+    // which it takes ownership of
+    HciManager(int socketDescriptor, int deviceId, QObject *parent = nullptr);
+#endif
     ~HciManager();
 
     bool isValid() const;
+    int deviceId() const { return hciDev; }
     bool monitorEvent(HciManager::HciEvent event);
     bool monitorAclPackets();
     bool sendCommand(QBluezConst::OpCodeGroupField ogf, QBluezConst::OpCodeCommandField ocf, const QByteArray &parameters);
@@ -231,6 +237,9 @@ private:
     quint8 sigPacketIdentifier = 0;
     QSocketNotifier *notifier = nullptr;
     QSet<HciManager::HciEvent> runningEvents;
+#ifdef QT_BUILD_INTERNAL
+    bool simulatedController = false;
+#endif
 };
 
 QT_END_NAMESPACE
@@ -666,7 +666,7 @@ using DiscoveryMode = QLowEnergyService::DiscoveryMode;
     NSArray *const cs = service.characteristics;
     // Now map chars/descriptors and handles.
     if (cs && cs.count) {
-        QHash<QLowEnergyHandle, QLowEnergyServicePrivate::CharData> charList;
+        CharacteristicDataMap charList;
 
         for (CBCharacteristic *c in cs) {
             ++lastValidHandle;
@@ -683,7 +683,7 @@ using DiscoveryMode = QLowEnergyService::DiscoveryMode;
 
             NSArray *const ds = c.descriptors;
             if (ds && ds.count) {
-                QHash<QLowEnergyHandle, QLowEnergyServicePrivate::DescData> descList;
+                DescriptorDataMap descList;
                 for (CBDescriptor *d in ds) {
                     // Register this descriptor:
                     ++lastValidHandle;
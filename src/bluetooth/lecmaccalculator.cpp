@@ -43,7 +43,9 @@
 #include <QtCore/qbytearray.h>
 #include <QtCore/qloggingcategory.h>
 #include <QtCore/private/qcore_unix_p.h>
+#include <QtCore/private/qsimd_p.h>
 
+#include <algorithm>
 #include <cstring>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -53,17 +55,227 @@
 #include <linux/if_alg.h>
 #endif
 
+#if defined(Q_PROCESSOR_X86) && QT_COMPILER_SUPPORTS_HERE(AES)
+#  define QT_BLUETOOTH_AESNI
+#endif
+
 QT_BEGIN_NAMESPACE
 
 Q_DECLARE_LOGGING_CATEGORY(QT_BT_BLUEZ)
 
-LeCmacCalculator::LeCmacCalculator()
+// AES-128 as specified in FIPS-197, AES-CMAC as specified in RFC 4493.
+
+// The software AES avoids lookup tables and branches on secret data, so that its timing does
+// not depend on the key. Each S-box value is computed as the inverse in GF(2^8) followed by
+// the affine transformation of FIPS-197, 5.1.1.
+
+static inline quint8 xtime(quint8 x)
+{
+    return quint8((x << 1) ^ (0x1b & -(x >> 7)));
+}
+
+static inline quint8 gfMultiply(quint8 a, quint8 b)
+{
+    quint8 product = 0;
+    for (int i = 0; i < 8; ++i) {
+        product ^= a & -((b >> i) & 1);
+        a = xtime(a);
+    }
+    return product;
+}
+
+static inline quint8 rotateLeft(quint8 x, int n)
+{
+    return quint8((x << n) | (x >> (8 - n)));
+}
+
+static quint8 subByte(quint8 x)
+{
+    // x^254 is the multiplicative inverse, with 0 mapping to 0
+    const quint8 x2 = gfMultiply(x, x);
+    const quint8 x3 = gfMultiply(x2, x);
+    const quint8 x6 = gfMultiply(x3, x3);
+    const quint8 x12 = gfMultiply(x6, x6);
+    const quint8 x15 = gfMultiply(x12, x3);
+    const quint8 x30 = gfMultiply(x15, x15);
+    const quint8 x60 = gfMultiply(x30, x30);
+    const quint8 x120 = gfMultiply(x60, x60);
+    const quint8 x127 = gfMultiply(gfMultiply(x120, x6), x);
+    const quint8 inverse = gfMultiply(x127, x127);
+    return quint8(inverse ^ rotateLeft(inverse, 1) ^ rotateLeft(inverse, 2)
+                  ^ rotateLeft(inverse, 3) ^ rotateLeft(inverse, 4) ^ 0x63);
+}
+
+// memset() through a volatile pointer, which the compiler cannot drop as a dead store
+static void *(*const volatile wipeMemory)(void *, int, size_t) = std::memset;
+
+void LeCmacCalculator::wipe(void *data, size_t size)
+{
+    wipeMemory(data, 0, size);
+}
+
+LeCmacCalculator::KeySchedule::~KeySchedule()
+{
+    wipe(this, sizeof *this);
+}
+
+static void expandAesKey(const quint8 key[16], quint8 roundKeys[176])
+{
+    static const quint8 rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+    std::memcpy(roundKeys, key, 16);
+    for (int i = 4; i < 44; ++i) {
+        quint8 temp[4];
+        std::memcpy(temp, roundKeys + 4 * (i - 1), sizeof temp);
+        if (i % 4 == 0) {
+            const quint8 first = temp[0];
+            temp[0] = subByte(temp[1]) ^ rcon[i / 4 - 1];
+            temp[1] = subByte(temp[2]);
+            temp[2] = subByte(temp[3]);
+            temp[3] = subByte(first);
+        }
+        for (int j = 0; j < 4; ++j)
+            roundKeys[4 * i + j] = roundKeys[4 * (i - 4) + j] ^ temp[j];
+        LeCmacCalculator::wipe(temp, sizeof temp);
+    }
+}
+
+static inline void addRoundKey(quint8 state[16], const quint8 *roundKey)
+{
+    for (int i = 0; i < 16; ++i)
+        state[i] ^= roundKey[i];
+}
+
+static inline void subBytesAndShiftRows(quint8 state[16])
+{
+    // The state is stored column by column; row r is rotated left by r.
+    quint8 tmp[16];
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r)
+            tmp[r + 4 * c] = subByte(state[r + 4 * ((c + r) % 4)]);
+    }
+    std::memcpy(state, tmp, sizeof tmp);
+}
+
+static inline void mixColumns(quint8 state[16])
+{
+    for (int c = 0; c < 4; ++c) {
+        quint8 * const col = state + 4 * c;
+        const quint8 a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+        const quint8 all = a0 ^ a1 ^ a2 ^ a3;
+        col[0] = a0 ^ all ^ xtime(a0 ^ a1);
+        col[1] = a1 ^ all ^ xtime(a1 ^ a2);
+        col[2] = a2 ^ all ^ xtime(a2 ^ a3);
+        col[3] = a3 ^ all ^ xtime(a3 ^ a0);
+    }
+}
+
+static void encryptBlockSoftware(const quint8 *roundKeys, quint8 block[16])
+{
+    addRoundKey(block, roundKeys);
+    for (int round = 1; round < 10; ++round) {
+        subBytesAndShiftRows(block);
+        mixColumns(block);
+        addRoundKey(block, roundKeys + 16 * round);
+    }
+    subBytesAndShiftRows(block);
+    addRoundKey(block, roundKeys + 16 * 10);
+}
+
+#ifdef QT_BLUETOOTH_AESNI
+QT_FUNCTION_TARGET(AES)
+static void encryptBlockAesNi(const quint8 *roundKeys, quint8 block[16])
+{
+    const auto roundKey = [roundKeys](int round) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(roundKeys + 16 * round));
+    };
+    __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+    state = _mm_xor_si128(state, roundKey(0));
+    for (int round = 1; round < 10; ++round)
+        state = _mm_aesenc_si128(state, roundKey(round));
+    state = _mm_aesenclast_si128(state, roundKey(10));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(block), state);
+}
+#endif
+
+using BlockEncrypter = void (*)(const quint8 *roundKeys, quint8 block[16]);
+
+static BlockEncrypter blockEncrypter()
 {
+#ifdef QT_BLUETOOTH_AESNI
+    if (qCpuHasFeature(AES))
+        return encryptBlockAesNi;
+#endif
+    return encryptBlockSoftware;
+}
+
+static void deriveSubkey(const quint8 in[16], quint8 out[16])
+{
+    // RFC 4493, 2.3
+    for (int i = 0; i < 15; ++i)
+        out[i] = quint8((in[i] << 1) | (in[i + 1] >> 7));
+    out[15] = quint8(in[15] << 1);
+    if (in[0] & 0x80)
+        out[15] ^= 0x87;
+}
+
+static quint64 calculateMacInProcess(const QByteArray &message,
+                                     const LeCmacCalculator::KeySchedule &key)
+{
+    // RFC 4493, 2.4
+    // Bluetooth messages are little-endian, while CMAC processes the most significant byte
+    // first. Rather than reversing the whole message, each block is gathered from its end.
+    static const BlockEncrypter encrypt = blockEncrypter();
+    const quint8 * const data = reinterpret_cast<const quint8 *>(message.constData());
+    const int length = message.count();
+    const int blockCount = qMax(1, (length + 15) / 16);
+    const bool lastBlockComplete = length > 0 && length % 16 == 0;
+
+    quint8 mac[16] = {};
+    quint8 block[16];
+    const auto loadBlock = [&](int blockIndex, int blockLength) {
+        const quint8 *src = data + length - 1 - 16 * blockIndex;
+        for (int i = 0; i < blockLength; ++i)
+            block[i] = *src--;
+    };
+
+    for (int i = 0; i < blockCount - 1; ++i) {
+        loadBlock(i, 16);
+        for (int j = 0; j < 16; ++j)
+            mac[j] ^= block[j];
+        encrypt(key.roundKeys, mac);
+    }
+
+    const int lastLength = length - 16 * (blockCount - 1);
+    loadBlock(blockCount - 1, lastLength);
+    const quint8 *subkey = key.k1;
+    if (!lastBlockComplete) {
+        block[lastLength] = 0x80;
+        std::memset(block + lastLength + 1, 0, 16 - lastLength - 1);
+        subkey = key.k2;
+    }
+    for (int j = 0; j < 16; ++j)
+        mac[j] ^= block[j] ^ subkey[j];
+    encrypt(key.roundKeys, mac);
+
+    // The signature consists of the 64 most significant bits.
+    const quint64 signature = qFromBigEndian<quint64>(mac);
+    LeCmacCalculator::wipe(mac, sizeof mac);
+    LeCmacCalculator::wipe(block, sizeof block);
+    return signature;
+}
+
+LeCmacCalculator::LeCmacCalculator(Implementation implementation)
+    : m_implementation(implementation)
+{
+    if (m_implementation != Implementation::LinuxCryptoApi)
+        return;
+
 #ifdef CONFIG_LINUX_CRYPTO_API
     m_baseSocket = socket(AF_ALG, SOCK_SEQPACKET, 0);
     if (m_baseSocket == -1) {
         qCWarning(QT_BT_BLUEZ) << "failed to create first level crypto socket:"
-                               << strerror(errno);
+                               << strerror(errno) << "; using in-process CMAC";
+        m_implementation = Implementation::InProcess;
         return;
     }
     sockaddr_alg sa;
@@ -73,11 +285,16 @@ LeCmacCalculator::LeCmacCalculator()
     strcpy(reinterpret_cast<char *>(sa.salg_type), "hash");
     strcpy(reinterpret_cast<char *>(sa.salg_name), "cmac(aes)");
     if (::bind(m_baseSocket, reinterpret_cast<sockaddr *>(&sa), sizeof sa) == -1) {
-        qCWarning(QT_BT_BLUEZ) << "bind() failed for crypto socket:" << strerror(errno);
+        qCWarning(QT_BT_BLUEZ) << "bind() failed for crypto socket:" << strerror(errno)
+                               << "; using in-process CMAC";
+        close(m_baseSocket);
+        m_baseSocket = -1;
+        m_implementation = Implementation::InProcess;
         return;
     }
 #else // CONFIG_LINUX_CRYPTO_API
-    qCWarning(QT_BT_BLUEZ) << "Linux crypto API not present, CMAC verification will fail.";
+    qCWarning(QT_BT_BLUEZ) << "Linux crypto API not present, using in-process CMAC.";
+    m_implementation = Implementation::InProcess;
 #endif
 }
 
@@ -87,6 +304,22 @@ LeCmacCalculator::~LeCmacCalculator()
         close(m_baseSocket);
 }
 
+LeCmacCalculator::Implementation LeCmacCalculator::defaultImplementation()
+{
+    // The kernel implementation is kept for comparison and as a fallback.
+    static const bool useCryptoApi = qEnvironmentVariableIntValue("QT_BLUETOOTH_KERNEL_CMAC");
+    return useCryptoApi ? Implementation::LinuxCryptoApi : Implementation::InProcess;
+}
+
+bool LeCmacCalculator::hasHardwareAes()
+{
+#ifdef QT_BLUETOOTH_AESNI
+    return qCpuHasFeature(AES);
+#else
+    return false;
+#endif
+}
+
 QByteArray LeCmacCalculator::createFullMessage(const QByteArray &message, quint32 signCounter)
 {
     // Spec v4.2, Vol 3, Part H, 2.4.5
@@ -96,16 +329,42 @@ QByteArray LeCmacCalculator::createFullMessage(const QByteArray &message, quint3
     return fullMessage;
 }
 
+LeCmacCalculator::KeySchedule LeCmacCalculator::expandKey(const quint128 &csrk)
+{
+    KeySchedule schedule;
+    std::reverse_copy(std::begin(csrk.data), std::end(csrk.data), std::begin(schedule.key));
+    expandAesKey(schedule.key, schedule.roundKeys);
+
+    // RFC 4493, 2.3
+    quint8 l[16] = {};
+    encryptBlockSoftware(schedule.roundKeys, l);
+    deriveSubkey(l, schedule.k1);
+    deriveSubkey(schedule.k1, schedule.k2);
+    wipe(l, sizeof l);
+    return schedule;
+}
+
 quint64 LeCmacCalculator::calculateMac(const QByteArray &message, const quint128 &csrk) const
+{
+    return calculateMac(message, expandKey(csrk));
+}
+
+quint64 LeCmacCalculator::calculateMac(const QByteArray &message, const KeySchedule &key) const
+{
+    if (m_implementation == Implementation::LinuxCryptoApi)
+        return calculateMacWithCryptoApi(message, key);
+    return calculateMacInProcess(message, key);
+}
+
+quint64 LeCmacCalculator::calculateMacWithCryptoApi(const QByteArray &message,
+                                                    const KeySchedule &key) const
 {
 #ifdef CONFIG_LINUX_CRYPTO_API
     if (m_baseSocket == -1)
-        return false;
-    quint128 csrkMsb;
-    std::reverse_copy(std::begin(csrk.data), std::end(csrk.data), std::begin(csrkMsb.data));
-    qCDebug(QT_BT_BLUEZ) << "CSRK (MSB):" << QByteArray(reinterpret_cast<char *>(csrkMsb.data),
-                                                        sizeof csrkMsb).toHex();
-    if (setsockopt(m_baseSocket, 279 /* SOL_ALG */, ALG_SET_KEY, csrkMsb.data, sizeof csrkMsb) == -1) {
+        return 0;
+    qCDebug(QT_BT_BLUEZ) << "CSRK (MSB):" << QByteArray(reinterpret_cast<const char *>(key.key),
+                                                        sizeof key.key).toHex();
+    if (setsockopt(m_baseSocket, 279 /* SOL_ALG */, ALG_SET_KEY, key.key, sizeof key.key) == -1) {
         qCWarning(QT_BT_BLUEZ) << "setsockopt() failed for crypto socket:" << strerror(errno);
         return 0;
     }
@@ -157,7 +416,7 @@ quint64 LeCmacCalculator::calculateMac(const QByteArray &message, const quint128
     return qFromBigEndian(mac);
 #else // CONFIG_LINUX_CRYPTO_API
     Q_UNUSED(message);
-    Q_UNUSED(csrk);
+    Q_UNUSED(key);
     qCWarning(QT_BT_BLUEZ) << "CMAC calculation failed due to missing Linux crypto API.";
     return 0;
 #endif
@@ -166,21 +425,19 @@ quint64 LeCmacCalculator::calculateMac(const QByteArray &message, const quint128
 bool LeCmacCalculator::verify(const QByteArray &message, const quint128 &csrk,
                            quint64 expectedMac) const
 {
-#ifdef CONFIG_LINUX_CRYPTO_API
-    const quint64 actualMac = calculateMac(message, csrk);
+    return verify(message, expandKey(csrk), expectedMac);
+}
+
+bool LeCmacCalculator::verify(const QByteArray &message, const KeySchedule &key,
+                              quint64 expectedMac) const
+{
+    const quint64 actualMac = calculateMac(message, key);
     if (actualMac != expectedMac) {
         qCWarning(QT_BT_BLUEZ) << Qt::hex << "signature verification failed: calculated mac:"
                                << actualMac << "expected mac:" << expectedMac;
         return false;
     }
     return true;
-#else // CONFIG_LINUX_CRYPTO_API
-    Q_UNUSED(message);
-    Q_UNUSED(csrk);
-    Q_UNUSED(expectedMac);
-    qCWarning(QT_BT_BLUEZ) << "CMAC verification failed due to missing Linux crypto API.";
-    return false;
-#endif
 }
 
 QT_END_NAMESPACE
@@ -59,17 +59,50 @@ struct quint128;
 class Q_AUTOTEST_EXPORT LeCmacCalculator
 {
 public:
-    LeCmacCalculator();
+    enum class Implementation {
+        InProcess,      // AES-CMAC in user space, using AES-NI or constant-time software AES
+        LinuxCryptoApi  // "cmac(aes)" via an AF_ALG socket
+    };
+
+    // Expanded AES-128 key schedule and CMAC subkeys derived from one CSRK.
+    // Computing this is the expensive part of the MAC calculation, so it
+    // should be cached for as long as the key stays the same. Every copy is
+    // wiped when it is destroyed.
+    struct KeySchedule {
+        KeySchedule() = default;
+        KeySchedule(const KeySchedule &) = default;
+        KeySchedule &operator=(const KeySchedule &) = default;
+        ~KeySchedule();
+
+        quint8 key[16]; // CSRK, most significant byte first
+        quint8 roundKeys[176];
+        quint8 k1[16];
+        quint8 k2[16];
+    };
+
+    explicit LeCmacCalculator(Implementation implementation = defaultImplementation());
     ~LeCmacCalculator();
 
+    static Implementation defaultImplementation();
+    static bool hasHardwareAes();
+    Implementation implementation() const { return m_implementation; }
+
     static QByteArray createFullMessage(const QByteArray &message, quint32 signCounter);
+    static KeySchedule expandKey(const quint128 &csrk);
+    // Overwrites key material in a way the compiler does not optimize away.
+    static void wipe(void *data, size_t size);
 
     quint64 calculateMac(const QByteArray &message, const quint128 &csrk) const;
+    quint64 calculateMac(const QByteArray &message, const KeySchedule &key) const;
 
-    // Convenience function.
+    // Convenience functions.
     bool verify(const QByteArray &message, const quint128 &csrk, quint64 expectedMac) const;
+    bool verify(const QByteArray &message, const KeySchedule &key, quint64 expectedMac) const;
 
 private:
+    quint64 calculateMacWithCryptoApi(const QByteArray &message, const KeySchedule &key) const;
+
+    Implementation m_implementation;
     int m_baseSocket = -1;
 };
 
@@ -53,6 +53,8 @@
 #include <errno.h>
 #include <unistd.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <time.h>
 
 #include <QtCore/QSocketNotifier>
 
@@ -368,12 +370,68 @@ void QBluetoothSocketPrivateBluez::_q_writeNotify()
     }
 }
 
+// Reads like ::read() but also extracts the kernel receive timestamp
+// enabled via SO_TIMESTAMPING (software RX stamp) or SO_TIMESTAMPNS.
+static int readWithTimestamp(int socket, char *buffer, int size, qint64 *timestamp)
+{
+    iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = size_t(size);
+
+    union {
+        cmsghdr header;
+        char buffer[CMSG_SPACE(3 * sizeof(timespec))];
+    } control;
+
+    msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    *timestamp = 0;
+    const int result = int(::recvmsg(socket, &message, 0));
+    if (result <= 0)
+        return result;
+
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET)
+            continue;
+
+        timespec stamp = {};
+#ifdef SCM_TIMESTAMPING
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            // ts[0] is the software stamp, hardware stamps do not use the system clock
+            memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+        } else
+#endif
+        if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+        } else {
+            continue;
+        }
+
+        if (stamp.tv_sec || stamp.tv_nsec) {
+            *timestamp = qint64(stamp.tv_sec) * 1000000000 + stamp.tv_nsec;
+            break;
+        }
+    }
+    return result;
+}
+
 void QBluetoothSocketPrivateBluez::_q_readNotify()
 {
     Q_Q(QBluetoothSocket);
     char *writePointer = rxBuffer.reserve(QPRIVATELINEARBUFFER_BUFFERSIZE);
 //    qint64 readFromDevice = q->readData(writePointer, QPRIVATELINEARBUFFER_BUFFERSIZE);
-    int readFromDevice = ::read(socket, writePointer, QPRIVATELINEARBUFFER_BUFFERSIZE);
+    int readFromDevice;
+    if (receiveTimestamps) {
+        readFromDevice = readWithTimestamp(socket, writePointer, QPRIVATELINEARBUFFER_BUFFERSIZE,
+                                           &lastReceiveTimestamp);
+    } else {
+        readFromDevice = ::read(socket, writePointer, QPRIVATELINEARBUFFER_BUFFERSIZE);
+    }
     rxBuffer.chop(QPRIVATELINEARBUFFER_BUFFERSIZE - (readFromDevice < 0 ? 0 : readFromDevice));
     if(readFromDevice <= 0){
         int errsv = errno;
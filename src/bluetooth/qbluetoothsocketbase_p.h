@@ -171,6 +171,10 @@ protected:
 #if QT_CONFIG(bluez)
 public:
     quint8 lowEnergySocketType = 0;
+    // set when SO_TIMESTAMPING or SO_TIMESTAMPNS is enabled on the socket
+    bool receiveTimestamps = false;
+    // kernel receive time of the last read packet (ns since epoch), 0 if unknown
+    qint64 lastReceiveTimestamp = 0;
 #endif
 };
 
@@ -38,22 +38,85 @@
 ****************************************************************************/
 
 #include "qbluetoothuuid.h"
-#include "qbluetoothservicediscoveryagent.h"
+#include "qbluetoothuuid_p.h"
 
+#include <QtCore/QCoreApplication>
+#include <QtCore/QMutex>
+#include <QtCore/QPointer>
+#include <QtCore/QThread>
 #include <QStringList>
 #include <QtEndian>
 
+#include <algorithm>
+
 #include <string.h>
 
 QT_BEGIN_NAMESPACE
 
-// Bluetooth base UUID 00000000-0000-1000-8000-00805F9B34FB
-// these defines represent the above UUID
-// static inline constexpr const uint data1Reference   = 0x00000000;
-static inline constexpr const ushort data2Reference = 0x0000;
-static inline constexpr const ushort data3Reference = 0x1000;
-static inline constexpr const unsigned char data4Reference[] { 0x80, 0x00, 0x00, 0x80,
-                                                               0x5f, 0x9b, 0x34, 0xfb };
+using QtBluetoothPrivate::hasBluetoothBaseUuid;
+
+// Value of each ASCII hex digit, -1 for anything else
+static constexpr qint8 hexDigitValues[128] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+// Decodes Digits hex digits starting at src. Instead of bailing out at the first
+// invalid character, the sign bits of all table lookups are accumulated in error so
+// that the loop has no data dependent branches and can be unrolled or vectorized.
+template <int Digits, typename T>
+static inline T parseHexDigits(const char16_t *src, int &error) noexcept
+{
+    T value = 0;
+    for (int i = 0; i < Digits; ++i) {
+        const char16_t c = src[i];
+        const int digit = hexDigitValues[c & 0x7f] | -int(c > 0x7f);
+        error |= digit;
+        value = T(value << 4) | T(digit & 0xf);
+    }
+    return value;
+}
+
+// Parses "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" and the same wrapped in curly braces.
+// Returns false for anything else so that the caller can fall back to QUuid's parser.
+static bool parseUuidString(QStringView str, QUuid &uuid) noexcept
+{
+    if (str.size() == 38) {
+        if (str.front() != u'{' || str.back() != u'}')
+            return false;
+        str = str.sliced(1, 36);
+    } else if (str.size() != 36) {
+        return false;
+    }
+
+    const char16_t *s = str.utf16();
+    if (s[8] != u'-' || s[13] != u'-' || s[18] != u'-' || s[23] != u'-')
+        return false;
+
+    int error = 0;
+    const quint32 data1 = parseHexDigits<8, quint32>(s, error);
+    const quint16 data2 = parseHexDigits<4, quint16>(s + 9, error);
+    const quint16 data3 = parseHexDigits<4, quint16>(s + 14, error);
+    uchar data4[8];
+    data4[0] = parseHexDigits<2, uchar>(s + 19, error);
+    data4[1] = parseHexDigits<2, uchar>(s + 21, error);
+    for (int i = 2; i < 8; ++i)
+        data4[i] = parseHexDigits<2, uchar>(s + 24 + (i - 2) * 2, error);
+    if (error < 0)
+        return false;
+
+    uuid.data1 = data1;
+    uuid.data2 = data2;
+    uuid.data3 = data3;
+    memcpy(uuid.data4, data4, sizeof(data4));
+    return true;
+}
 
 void registerQBluetoothUuid()
 {
@@ -584,8 +647,11 @@ QT_WARNING_POP
     explanation of how the five hex fields map to the public data members in QUuid.
 */
 QBluetoothUuid::QBluetoothUuid(const QString &uuid)
-:   QUuid(uuid)
 {
+    // The canonical forms are by far the most common ones, everything
+    // else is left to QUuid, which also takes care of invalid input
+    if (!parseUuidString(uuid, *this))
+        static_cast<QUuid &>(*this) = QUuid(uuid);
 }
 
 /*!
@@ -604,8 +670,7 @@ QBluetoothUuid::QBluetoothUuid(const QUuid &uuid)
 */
 int QBluetoothUuid::minimumSize() const
 {
-    if (data2 == data2Reference && data3 == data3Reference
-        && memcmp(data4, data4Reference, 8) == 0) {
+    if (hasBluetoothBaseUuid(*this)) {
         // 16 or 32 bit Bluetooth UUID
         if (data1 & 0xFFFF0000)
             return 4;
@@ -626,8 +691,7 @@ int QBluetoothUuid::minimumSize() const
 */
 quint16 QBluetoothUuid::toUInt16(bool *ok) const
 {
-    if (data1 & 0xFFFF0000 || data2 != data2Reference || data3 != data3Reference
-        || memcmp(data4, data4Reference, 8) != 0) {
+    if (data1 & 0xFFFF0000 || !hasBluetoothBaseUuid(*this)) {
         // not convertable to 16 bit Bluetooth UUID.
         if (ok)
             *ok = false;
@@ -647,8 +711,7 @@ quint16 QBluetoothUuid::toUInt16(bool *ok) const
 */
 quint32 QBluetoothUuid::toUInt32(bool *ok) const
 {
-    if (data2 != data2Reference || data3 != data3Reference
-        || memcmp(data4, data4Reference, 8) != 0) {
+    if (!hasBluetoothBaseUuid(*this)) {
         // not convertable to 32 bit Bluetooth UUID.
         if (ok)
             *ok = false;
@@ -682,6 +745,804 @@ quint128 QBluetoothUuid::toUInt128() const
     return uuid;
 }
 
+// Assigned numbers and their untranslated names, sorted by number so that lookups can
+// use a binary search. The names are translated in the context of the former
+// QBluetoothServiceDiscoveryAgent::tr() calls, so existing translations still apply.
+struct AssignedNumber
+{
+    quint16 value;
+    const char *name;
+};
+
+static constexpr char assignedNumberContext[] = "QBluetoothServiceDiscoveryAgent";
+
+static constexpr AssignedNumber serviceClassNames[] = {
+    { quint16(QBluetoothUuid::ServiceClassUuid::ServiceDiscoveryServer),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Service Discovery") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::BrowseGroupDescriptor),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Browse Group Descriptor") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::PublicBrowseGroup),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Public Browse Group") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::SerialPort),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Serial Port Profile") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::LANAccessUsingPPP),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "LAN Access Profile") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::DialupNetworking),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Dial-Up Networking") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::IrMCSync),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Synchronization") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ObexObjectPush),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Object Push") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::OBEXFileTransfer),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "File Transfer") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::IrMCSyncCommand),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Synchronization Command") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::Headset),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Headset") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::AudioSource),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Audio Source") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::AudioSink),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Audio Sink") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::AV_RemoteControlTarget),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Audio/Video Remote Control Target") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::AdvancedAudioDistribution),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Advanced Audio Distribution") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::AV_RemoteControl),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Audio/Video Remote Control") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::AV_RemoteControlController),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Audio/Video Remote Control Controller") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HeadsetAG),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Headset AG") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::PANU),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Personal Area Networking (PANU)") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::NAP),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Personal Area Networking (NAP)") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::GN),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Personal Area Networking (GN)") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::DirectPrinting),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Direct Printing (BPP)") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ReferencePrinting),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Reference Printing (BPP)") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::BasicImage),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Imaging Profile") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ImagingResponder),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Imaging Responder") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ImagingAutomaticArchive),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Imaging Archive") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ImagingReferenceObjects),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Imaging Ref Objects") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::Handsfree),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hands-Free") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HandsfreeAudioGateway),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hands-Free AG") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::DirectPrintingReferenceObjectsService),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Printing RefObject Service") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ReflectedUI),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Printing Reflected UI") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::BasicPrinting),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Printing") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::PrintingStatus),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Basic Printing Status") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HumanInterfaceDeviceService),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Human Interface Device") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HardcopyCableReplacement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hardcopy Cable Replacement") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HCRPrint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hardcopy Cable Replacement Print") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HCRScan),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hardcopy Cable Replacement Scan") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::SIMAccess),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "SIM Access Server") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::PhonebookAccessPCE),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Phonebook Access PCE") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::PhonebookAccessPSE),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Phonebook Access PSE") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::PhonebookAccess),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Phonebook Access") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HeadsetHS),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Headset HS") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::MessageAccessServer),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Message Access Server") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::MessageNotificationServer),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Message Notification Server") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::MessageAccessProfile),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Message Access") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::GNSS),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Global Navigation Satellite System") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::GNSSServer),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Global Navigation Satellite System Server") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::Display3D),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "3D Synchronization Display") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::Glasses3D),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "3D Synchronization Glasses") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::Synchronization3D),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "3D Synchronization") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::MPSProfile),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Multi-Profile Specification (Profile)") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::MPSService),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Multi-Profile Specification") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::PnPInformation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Device Identification") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::GenericNetworking),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Generic Networking") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::GenericFileTransfer),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Generic File Transfer") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::GenericAudio),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Generic Audio") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::GenericTelephony),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Generic Telephony") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::VideoSource),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Video Source") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::VideoSink),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Video Sink") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::VideoDistribution),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Video Distribution") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HDP),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Health Device") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HDPSource),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Health Device Source") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HDPSink),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Health Device Sink") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::GenericAccess),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Generic Access") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::GenericAttribute),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Generic Attribute") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ImmediateAlert),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Immediate Alert") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::LinkLoss),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Link Loss") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::TxPower),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Tx Power") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::CurrentTimeService),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Current Time Service") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ReferenceTimeUpdateService),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Reference Time Update Service") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::NextDSTChangeService),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Next DST Change Service") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::Glucose),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Glucose") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HealthThermometer),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Health Thermometer") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::DeviceInformation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Device Information") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HeartRate),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Heart Rate") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::PhoneAlertStatusService),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Phone Alert Status Service") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::BatteryService),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Battery Service") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::BloodPressure),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Blood Pressure") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::AlertNotificationService),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Alert Notification Service") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::HumanInterfaceDevice),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Human Interface Device") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ScanParameters),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Scan Parameters") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::RunningSpeedAndCadence),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Running Speed and Cadence") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::CyclingSpeedAndCadence),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Cycling Speed and Cadence") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::CyclingPower),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Cycling Power") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::LocationAndNavigation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Location and Navigation") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::EnvironmentalSensing),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Environmental Sensing") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::BodyComposition),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Body Composition") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::UserData),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "User Data") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::WeightScale),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Weight Scale") },
+    //: Connection management (Bluetooth)
+    { quint16(QBluetoothUuid::ServiceClassUuid::BondManagement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Bond Management") },
+    { quint16(QBluetoothUuid::ServiceClassUuid::ContinuousGlucoseMonitoring),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Continuous Glucose Monitoring") },
+};
+
+static constexpr AssignedNumber protocolNames[] = {
+    { quint16(QBluetoothUuid::ProtocolUuid::Sdp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Service Discovery Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Udp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "User Datagram Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Rfcomm),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Radio Frequency Communication") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Tcp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Transmission Control Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::TcsBin),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Telephony Control Specification - Binary") },
+    { quint16(QBluetoothUuid::ProtocolUuid::TcsAt),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Telephony Control Specification - AT") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Att),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Attribute Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Obex),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Object Exchange Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Ip),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Internet Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Ftp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "File Transfer Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Http),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hypertext Transfer Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Wsp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Wireless Short Packet Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Bnep),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Bluetooth Network Encapsulation Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Upnp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Extended Service Discovery Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Hidp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Human Interface Device Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::HardcopyControlChannel),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hardcopy Control Channel") },
+    { quint16(QBluetoothUuid::ProtocolUuid::HardcopyDataChannel),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hardcopy Data Channel") },
+    { quint16(QBluetoothUuid::ProtocolUuid::HardcopyNotification),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hardcopy Notification") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Avctp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Audio/Video Control Transport Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Avdtp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Audio/Video Distribution Transport Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::Cmtp),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Common ISDN Access Protocol") },
+    { quint16(QBluetoothUuid::ProtocolUuid::UdiCPlain),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "UdiCPlain") },
+    { quint16(QBluetoothUuid::ProtocolUuid::McapControlChannel),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Multi-Channel Adaptation Protocol - Control") },
+    { quint16(QBluetoothUuid::ProtocolUuid::McapDataChannel),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Multi-Channel Adaptation Protocol - Data") },
+    { quint16(QBluetoothUuid::ProtocolUuid::L2cap),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Layer 2 Control Protocol") },
+};
+
+static constexpr AssignedNumber characteristicNames[] = {
+    //: GAP:  Generic Access Profile (Bluetooth)
+    { quint16(QBluetoothUuid::CharacteristicType::DeviceName),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "GAP Device Name") },
+    //: GAP:  Generic Access Profile (Bluetooth)
+    { quint16(QBluetoothUuid::CharacteristicType::Appearance),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "GAP Appearance") },
+    //: GAP:  Generic Access Profile (Bluetooth)
+    { quint16(QBluetoothUuid::CharacteristicType::PeripheralPrivacyFlag),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "GAP Peripheral Privacy Flag") },
+    //: GAP:  Generic Access Profile (Bluetooth)
+    { quint16(QBluetoothUuid::CharacteristicType::ReconnectionAddress),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "GAP Reconnection Address") },
+    { quint16(QBluetoothUuid::CharacteristicType::PeripheralPreferredConnectionParameters),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "GAP Peripheral Preferred Connection Parameters") },
+    //: GATT: _G_eneric _Att_ribute Profile (Bluetooth)
+    { quint16(QBluetoothUuid::CharacteristicType::ServiceChanged),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "GATT Service Changed") },
+    { quint16(QBluetoothUuid::CharacteristicType::AlertLevel),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Alert Level") },
+    { quint16(QBluetoothUuid::CharacteristicType::TxPowerLevel),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "TX Power") },
+    { quint16(QBluetoothUuid::CharacteristicType::DateTime),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Date Time") },
+    { quint16(QBluetoothUuid::CharacteristicType::DayOfWeek),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Day Of Week") },
+    { quint16(QBluetoothUuid::CharacteristicType::DayDateTime),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Day Date Time") },
+    { quint16(QBluetoothUuid::CharacteristicType::ExactTime256),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Exact Time 256") },
+    { quint16(QBluetoothUuid::CharacteristicType::DSTOffset),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "DST Offset") },
+    { quint16(QBluetoothUuid::CharacteristicType::TimeZone),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Time Zone") },
+    { quint16(QBluetoothUuid::CharacteristicType::LocalTimeInformation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Local Time Information") },
+    { quint16(QBluetoothUuid::CharacteristicType::TimeWithDST),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Time With DST") },
+    { quint16(QBluetoothUuid::CharacteristicType::TimeAccuracy),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Time Accuracy") },
+    { quint16(QBluetoothUuid::CharacteristicType::TimeSource),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Time Source") },
+    { quint16(QBluetoothUuid::CharacteristicType::ReferenceTimeInformation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Reference Time Information") },
+    { quint16(QBluetoothUuid::CharacteristicType::TimeUpdateControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Time Update Control Point") },
+    { quint16(QBluetoothUuid::CharacteristicType::TimeUpdateState),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Time Update State") },
+    { quint16(QBluetoothUuid::CharacteristicType::GlucoseMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Glucose Measurement") },
+    { quint16(QBluetoothUuid::CharacteristicType::BatteryLevel),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Battery Level") },
+    { quint16(QBluetoothUuid::CharacteristicType::TemperatureMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Temperature Measurement") },
+    { quint16(QBluetoothUuid::CharacteristicType::TemperatureType),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Temperature Type") },
+    { quint16(QBluetoothUuid::CharacteristicType::IntermediateTemperature),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Intermediate Temperature") },
+    { quint16(QBluetoothUuid::CharacteristicType::MeasurementInterval),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Measurement Interval") },
+    { quint16(QBluetoothUuid::CharacteristicType::BootKeyboardInputReport),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Boot Keyboard Input Report") },
+    { quint16(QBluetoothUuid::CharacteristicType::SystemID),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "System ID") },
+    { quint16(QBluetoothUuid::CharacteristicType::ModelNumberString),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Model Number String") },
+    { quint16(QBluetoothUuid::CharacteristicType::SerialNumberString),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Serial Number String") },
+    { quint16(QBluetoothUuid::CharacteristicType::FirmwareRevisionString),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Firmware Revision String") },
+    { quint16(QBluetoothUuid::CharacteristicType::HardwareRevisionString),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hardware Revision String") },
+    { quint16(QBluetoothUuid::CharacteristicType::SoftwareRevisionString),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Software Revision String") },
+    { quint16(QBluetoothUuid::CharacteristicType::ManufacturerNameString),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Manufacturer Name String") },
+    { quint16(QBluetoothUuid::CharacteristicType::IEEE1107320601RegulatoryCertificationDataList),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "IEEE 11073 20601 Regulatory Certification Data List") },
+    { quint16(QBluetoothUuid::CharacteristicType::CurrentTime),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Current Time") },
+    //: Angle between geographic and magnetic north
+    { quint16(QBluetoothUuid::CharacteristicType::MagneticDeclination),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Magnetic Declination") },
+    { quint16(QBluetoothUuid::CharacteristicType::ScanRefresh),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Scan Refresh") },
+    { quint16(QBluetoothUuid::CharacteristicType::BootKeyboardOutputReport),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Boot Keyboard Output Report") },
+    { quint16(QBluetoothUuid::CharacteristicType::BootMouseInputReport),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Boot Mouse Input Report") },
+    { quint16(QBluetoothUuid::CharacteristicType::GlucoseMeasurementContext),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Glucose Measurement Context") },
+    { quint16(QBluetoothUuid::CharacteristicType::BloodPressureMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Blood Pressure Measurement") },
+    { quint16(QBluetoothUuid::CharacteristicType::IntermediateCuffPressure),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Intermediate Cuff Pressure") },
+    { quint16(QBluetoothUuid::CharacteristicType::HeartRateMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Heart Rate Measurement") },
+    { quint16(QBluetoothUuid::CharacteristicType::BodySensorLocation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Body Sensor Location") },
+    { quint16(QBluetoothUuid::CharacteristicType::HeartRateControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Heart Rate Control Point") },
+    { quint16(QBluetoothUuid::CharacteristicType::AlertStatus),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Alert Status") },
+    { quint16(QBluetoothUuid::CharacteristicType::RingerControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Ringer Control Point") },
+    { quint16(QBluetoothUuid::CharacteristicType::RingerSetting),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Ringer Setting") },
+    { quint16(QBluetoothUuid::CharacteristicType::AlertCategoryIDBitMask),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Alert Category ID Bit Mask") },
+    { quint16(QBluetoothUuid::CharacteristicType::AlertCategoryID),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Alert Category ID") },
+    { quint16(QBluetoothUuid::CharacteristicType::AlertNotificationControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Alert Notification Control Point") },
+    { quint16(QBluetoothUuid::CharacteristicType::UnreadAlertStatus),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Unread Alert Status") },
+    { quint16(QBluetoothUuid::CharacteristicType::NewAlert),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "New Alert") },
+    { quint16(QBluetoothUuid::CharacteristicType::SupportedNewAlertCategory),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Supported New Alert Category") },
+    { quint16(QBluetoothUuid::CharacteristicType::SupportedUnreadAlertCategory),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Supported Unread Alert Category") },
+    { quint16(QBluetoothUuid::CharacteristicType::BloodPressureFeature),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Blood Pressure Feature") },
+    //: HID: Human Interface Device Profile (Bluetooth)
+    { quint16(QBluetoothUuid::CharacteristicType::HIDInformation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "HID Information") },
+    { quint16(QBluetoothUuid::CharacteristicType::ReportMap),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Report Map") },
+    //: HID: Human Interface Device Profile (Bluetooth)
+    { quint16(QBluetoothUuid::CharacteristicType::HIDControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "HID Control Point") },
+    { quint16(QBluetoothUuid::CharacteristicType::Report),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Report") },
+    { quint16(QBluetoothUuid::CharacteristicType::ProtocolMode),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Protocol Mode") },
+    { quint16(QBluetoothUuid::CharacteristicType::ScanIntervalWindow),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Scan Interval Window") },
+    { quint16(QBluetoothUuid::CharacteristicType::PnPID),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "PnP ID") },
+    { quint16(QBluetoothUuid::CharacteristicType::GlucoseFeature),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Glucose Feature") },
+    //: Glucose Sensor patient record database.
+    { quint16(QBluetoothUuid::CharacteristicType::RecordAccessControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Record Access Control Point") },
+    //: RSC: Running Speed and Cadence
+    { quint16(QBluetoothUuid::CharacteristicType::RSCMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "RSC Measurement") },
+    //: RSC: Running Speed and Cadence
+    { quint16(QBluetoothUuid::CharacteristicType::RSCFeature),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "RSC Feature") },
+    { quint16(QBluetoothUuid::CharacteristicType::SCControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "SC Control Point") },
+    //: CSC: Cycling Speed and Cadence
+    { quint16(QBluetoothUuid::CharacteristicType::CSCMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "CSC Measurement") },
+    //: CSC: Cycling Speed and Cadence
+    { quint16(QBluetoothUuid::CharacteristicType::CSCFeature),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "CSC Feature") },
+    { quint16(QBluetoothUuid::CharacteristicType::SensorLocation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Sensor Location") },
+    { quint16(QBluetoothUuid::CharacteristicType::CyclingPowerMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Cycling Power Measurement") },
+    { quint16(QBluetoothUuid::CharacteristicType::CyclingPowerVector),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Cycling Power Vector") },
+    { quint16(QBluetoothUuid::CharacteristicType::CyclingPowerFeature),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Cycling Power Feature") },
+    { quint16(QBluetoothUuid::CharacteristicType::CyclingPowerControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Cycling Power Control Point") },
+    { quint16(QBluetoothUuid::CharacteristicType::LocationAndSpeed),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Location And Speed") },
+    { quint16(QBluetoothUuid::CharacteristicType::Navigation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Navigation") },
+    { quint16(QBluetoothUuid::CharacteristicType::PositionQuality),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Position Quality") },
+    { quint16(QBluetoothUuid::CharacteristicType::LNFeature),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "LN Feature") },
+    { quint16(QBluetoothUuid::CharacteristicType::LNControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "LN Control Point") },
+    //: Above/below sea level
+    { quint16(QBluetoothUuid::CharacteristicType::Elevation),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Elevation") },
+    { quint16(QBluetoothUuid::CharacteristicType::Pressure),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Pressure") },
+    { quint16(QBluetoothUuid::CharacteristicType::Temperature),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Temperature") },
+    { quint16(QBluetoothUuid::CharacteristicType::Humidity),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Humidity") },
+    //: Wind speed while standing
+    { quint16(QBluetoothUuid::CharacteristicType::TrueWindSpeed),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "True Wind Speed") },
+    { quint16(QBluetoothUuid::CharacteristicType::TrueWindDirection),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "True Wind Direction") },
+    //: Wind speed while observer is moving
+    { quint16(QBluetoothUuid::CharacteristicType::ApparentWindSpeed),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Apparent Wind Speed") },
+    { quint16(QBluetoothUuid::CharacteristicType::ApparentWindDirection),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Apparent Wind Direction") },
+    //: Factor by which wind gust is stronger than average wind
+    { quint16(QBluetoothUuid::CharacteristicType::GustFactor),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Gust Factor") },
+    { quint16(QBluetoothUuid::CharacteristicType::PollenConcentration),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Pollen Concentration") },
+    { quint16(QBluetoothUuid::CharacteristicType::UVIndex),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "UV Index") },
+    { quint16(QBluetoothUuid::CharacteristicType::Irradiance),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Irradiance") },
+    { quint16(QBluetoothUuid::CharacteristicType::Rainfall),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Rainfall") },
+    { quint16(QBluetoothUuid::CharacteristicType::WindChill),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Wind Chill") },
+    { quint16(QBluetoothUuid::CharacteristicType::HeatIndex),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Heat Index") },
+    { quint16(QBluetoothUuid::CharacteristicType::DewPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Dew Point") },
+    //: Environmental sensing related
+    { quint16(QBluetoothUuid::CharacteristicType::DescriptorValueChanged),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Descriptor Value Changed") },
+    { quint16(QBluetoothUuid::CharacteristicType::AerobicHeartRateLowerLimit),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Aerobic Heart Rate Lower Limit") },
+    { quint16(QBluetoothUuid::CharacteristicType::AerobicThreshold),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Aerobic Threshold") },
+    //: Age of person
+    { quint16(QBluetoothUuid::CharacteristicType::Age),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Age") },
+    { quint16(QBluetoothUuid::CharacteristicType::AnaerobicHeartRateLowerLimit),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Anaerobic Heart Rate Lower Limit") },
+    { quint16(QBluetoothUuid::CharacteristicType::AnaerobicHeartRateUpperLimit),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Anaerobic Heart Rate Upper Limit") },
+    { quint16(QBluetoothUuid::CharacteristicType::AnaerobicThreshold),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Anaerobic Threshold") },
+    { quint16(QBluetoothUuid::CharacteristicType::AerobicHeartRateUpperLimit),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Aerobic Heart Rate Upper Limit") },
+    { quint16(QBluetoothUuid::CharacteristicType::DateOfBirth),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Date Of Birth") },
+    { quint16(QBluetoothUuid::CharacteristicType::DateOfThresholdAssessment),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Date Of Threshold Assessment") },
+    { quint16(QBluetoothUuid::CharacteristicType::EmailAddress),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Email Address") },
+    { quint16(QBluetoothUuid::CharacteristicType::FatBurnHeartRateLowerLimit),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Fat Burn Heart Rate Lower Limit") },
+    { quint16(QBluetoothUuid::CharacteristicType::FatBurnHeartRateUpperLimit),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Fat Burn Heart Rate Upper Limit") },
+    { quint16(QBluetoothUuid::CharacteristicType::FirstName),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "First Name") },
+    { quint16(QBluetoothUuid::CharacteristicType::FiveZoneHeartRateLimits),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "5-Zone Heart Rate Limits") },
+    { quint16(QBluetoothUuid::CharacteristicType::Gender),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Gender") },
+    { quint16(QBluetoothUuid::CharacteristicType::HeartRateMax),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Heart Rate Maximum") },
+    //: Height of a person
+    { quint16(QBluetoothUuid::CharacteristicType::Height),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Height") },
+    { quint16(QBluetoothUuid::CharacteristicType::HipCircumference),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Hip Circumference") },
+    { quint16(QBluetoothUuid::CharacteristicType::LastName),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Last Name") },
+    { quint16(QBluetoothUuid::CharacteristicType::MaximumRecommendedHeartRate),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Maximum Recommended Heart Rate") },
+    { quint16(QBluetoothUuid::CharacteristicType::RestingHeartRate),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Resting Heart Rate") },
+    { quint16(QBluetoothUuid::CharacteristicType::SportTypeForAerobicAnaerobicThresholds),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Sport Type For Aerobic/Anaerobic Thresholds") },
+    { quint16(QBluetoothUuid::CharacteristicType::ThreeZoneHeartRateLimits),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "3-Zone Heart Rate Limits") },
+    { quint16(QBluetoothUuid::CharacteristicType::TwoZoneHeartRateLimits),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "2-Zone Heart Rate Limits") },
+    { quint16(QBluetoothUuid::CharacteristicType::VO2Max),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Oxygen Uptake") },
+    { quint16(QBluetoothUuid::CharacteristicType::WaistCircumference),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Waist Circumference") },
+    { quint16(QBluetoothUuid::CharacteristicType::Weight),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Weight") },
+    //: Environmental sensing related
+    { quint16(QBluetoothUuid::CharacteristicType::DatabaseChangeIncrement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Database Change Increment") },
+    { quint16(QBluetoothUuid::CharacteristicType::UserIndex),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "User Index") },
+    { quint16(QBluetoothUuid::CharacteristicType::BodyCompositionFeature),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Body Composition Feature") },
+    { quint16(QBluetoothUuid::CharacteristicType::BodyCompositionMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Body Composition Measurement") },
+    { quint16(QBluetoothUuid::CharacteristicType::WeightMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Weight Measurement") },
+    { quint16(QBluetoothUuid::CharacteristicType::UserControlPoint),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "User Control Point") },
+    { quint16(QBluetoothUuid::CharacteristicType::MagneticFluxDensity2D),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Magnetic Flux Density 2D") },
+    { quint16(QBluetoothUuid::CharacteristicType::MagneticFluxDensity3D),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Magnetic Flux Density 3D") },
+    { quint16(QBluetoothUuid::CharacteristicType::Language),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Language") },
+    { quint16(QBluetoothUuid::CharacteristicType::BarometricPressureTrend),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Barometric Pressure Trend") },
+};
+
+static constexpr AssignedNumber descriptorNames[] = {
+    { quint16(QBluetoothUuid::DescriptorType::CharacteristicExtendedProperties),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Characteristic Extended Properties") },
+    { quint16(QBluetoothUuid::DescriptorType::CharacteristicUserDescription),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Characteristic User Description") },
+    { quint16(QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Client Characteristic Configuration") },
+    { quint16(QBluetoothUuid::DescriptorType::ServerCharacteristicConfiguration),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Server Characteristic Configuration") },
+    { quint16(QBluetoothUuid::DescriptorType::CharacteristicPresentationFormat),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Characteristic Presentation Format") },
+    { quint16(QBluetoothUuid::DescriptorType::CharacteristicAggregateFormat),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Characteristic Aggregate Format") },
+    { quint16(QBluetoothUuid::DescriptorType::ValidRange),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Valid Range") },
+    { quint16(QBluetoothUuid::DescriptorType::ExternalReportReference),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "External Report Reference") },
+    { quint16(QBluetoothUuid::DescriptorType::ReportReference),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Report Reference") },
+    { quint16(QBluetoothUuid::DescriptorType::EnvironmentalSensingConfiguration),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Environmental Sensing Configuration") },
+    { quint16(QBluetoothUuid::DescriptorType::EnvironmentalSensingMeasurement),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Environmental Sensing Measurement") },
+    { quint16(QBluetoothUuid::DescriptorType::EnvironmentalSensingTriggerSetting),
+      QT_TRANSLATE_NOOP("QBluetoothServiceDiscoveryAgent", "Environmental Sensing Trigger Setting") },
+};
+
+template <size_t N>
+static constexpr bool isSortedAndUnique(const AssignedNumber (&table)[N])
+{
+    for (size_t i = 1; i < N; ++i) {
+        if (table[i - 1].value >= table[i].value)
+            return false;
+    }
+    return true;
+}
+
+static_assert(isSortedAndUnique(serviceClassNames), "service class table must be sorted");
+static_assert(isSortedAndUnique(protocolNames), "protocol table must be sorted");
+static_assert(isSortedAndUnique(characteristicNames), "characteristic table must be sorted");
+static_assert(isSortedAndUnique(descriptorNames), "descriptor table must be sorted");
+
+struct AssignedNumberTable
+{
+    const AssignedNumber *entries;
+    qsizetype size;
+
+    const AssignedNumber *begin() const { return entries; }
+    const AssignedNumber *end() const { return entries + size; }
+};
+
+template <size_t N>
+static constexpr AssignedNumberTable makeTable(const AssignedNumber (&table)[N])
+{
+    return { table, qsizetype(N) };
+}
+
+using QtBluetoothPrivate::AssignedNumberCategory;
+
+// Indexed by AssignedNumberCategory
+static constexpr AssignedNumberTable assignedNumberTables[] = {
+    makeTable(serviceClassNames),
+    makeTable(protocolNames),
+    makeTable(characteristicNames),
+    makeTable(descriptorNames)
+};
+static constexpr int assignedNumberCategoryCount =
+        int(sizeof(assignedNumberTables) / sizeof(assignedNumberTables[0]));
+
+static const AssignedNumber *findAssignedNumber(AssignedNumberCategory category, quint32 value)
+{
+    const AssignedNumberTable &table = assignedNumberTables[int(category)];
+    const auto it = std::lower_bound(table.begin(), table.end(), value,
+                                     [](const AssignedNumber &entry, quint32 value) {
+                                         return entry.value < value;
+                                     });
+    return (it != table.end() && it->value == value) ? it : nullptr;
+}
+
+// Counts the LanguageChange events of the application, which are sent when translators
+// are installed, removed or reloaded. Installed as an application-wide event filter.
+class LanguageChangeCounter : public QObject
+{
+public:
+    LanguageChangeCounter(QAtomicInteger<uint> *generation, QObject *parent)
+        : QObject(parent), generation(generation)
+    {
+    }
+
+    bool eventFilter(QObject *, QEvent *event) override
+    {
+        if (event->type() == QEvent::LanguageChange)
+            generation->fetchAndAddRelease(1);
+        return false;
+    }
+
+private:
+    QAtomicInteger<uint> *generation;
+};
+
+// The names as QStrings, so that repeated lookups return a shared string instead of
+// allocating. The translated names are cached until the translators change.
+struct AssignedNameCache
+{
+    AssignedNameCache()
+    {
+        for (int i = 0; i < assignedNumberCategoryCount; ++i) {
+            QList<QString> &list = names[i];
+            list.reserve(assignedNumberTables[i].size);
+            for (const AssignedNumber &entry : assignedNumberTables[i])
+                list.append(QString::fromUtf8(entry.name));
+            translations[i].resize(assignedNumberTables[i].size);
+        }
+    }
+
+    ~AssignedNameCache()
+    {
+        // only left if the application outlives the cache
+        delete languageChangeCounter;
+    }
+
+    bool watchLanguageChanges();
+
+    QList<QString> names[assignedNumberCategoryCount];
+
+    QMutex mutex;
+    // null strings until the name has been translated for the current generation
+    QList<QString> translations[assignedNumberCategoryCount];
+    uint translationsGeneration = 0;
+    QAtomicInteger<uint> generation = 1;
+    QPointer<LanguageChangeCounter> languageChangeCounter;
+    QPointer<QCoreApplication> pendingApplication;
+};
+Q_GLOBAL_STATIC(AssignedNameCache, assignedNameCache)
+
+/*
+    Returns true if the language changes of the application are being counted, so
+    that translations can be cached. The counter is created in the thread of the
+    application, which happens later if the first lookup is made in another thread.
+    Must be called with the mutex locked.
+*/
+bool AssignedNameCache::watchLanguageChanges()
+{
+    if (languageChangeCounter)
+        return true;
+
+    QCoreApplication *app = QCoreApplication::instance();
+    if (!app) // translators require an application
+        return false;
+
+    const auto install = [this, app]() {
+        languageChangeCounter = new LanguageChangeCounter(&generation, app);
+        app->installEventFilter(languageChangeCounter);
+        // anything translated before is outdated
+        generation.fetchAndAddRelease(1);
+    };
+
+    if (app->thread() == QThread::currentThread()) {
+        install();
+        return true;
+    }
+
+    if (pendingApplication != app) {
+        pendingApplication = app;
+        QMetaObject::invokeMethod(app, [this, install]() {
+            QMutexLocker locker(&mutex);
+            if (!languageChangeCounter)
+                install();
+        }, Qt::QueuedConnection);
+    }
+    return false;
+}
+
+static QString assignedNumberToString(AssignedNumberCategory category, quint32 value)
+{
+    const AssignedNumber *entry = findAssignedNumber(category, value);
+    if (!entry)
+        return QString();
+
+    AssignedNameCache *cache = assignedNameCache();
+    if (!cache) // during shutdown
+        return QCoreApplication::translate(assignedNumberContext, entry->name);
+
+    const AssignedNumberTable &table = assignedNumberTables[int(category)];
+    const qsizetype index = entry - table.begin();
+    const QString &name = cache->names[int(category)].at(index);
+
+    QMutexLocker locker(&cache->mutex);
+    if (!cache->watchLanguageChanges()) {
+        locker.unlock();
+        const QString translated = QCoreApplication::translate(assignedNumberContext, entry->name);
+        return translated == name ? name : translated;
+    }
+
+    const uint generation = cache->generation.loadAcquire();
+    if (cache->translationsGeneration != generation) {
+        for (QList<QString> &translations : cache->translations)
+            translations.fill(QString());
+        cache->translationsGeneration = generation;
+    }
+
+    QString &translated = cache->translations[int(category)][index];
+    if (translated.isNull()) {
+        translated = QCoreApplication::translate(assignedNumberContext, entry->name);
+        if (translated == name)
+            translated = name;
+    }
+    return translated;
+}
+
+// Reverse index, the entries of each table sorted by their untranslated name
+struct AssignedNameIndex
+{
+    AssignedNameIndex()
+    {
+        for (int i = 0; i < assignedNumberCategoryCount; ++i) {
+            QList<const AssignedNumber *> &index = entries[i];
+            index.reserve(assignedNumberTables[i].size);
+            for (const AssignedNumber &entry : assignedNumberTables[i])
+                index.append(&entry);
+            // stable, so that the lowest number comes first if a name is used twice
+            std::stable_sort(index.begin(), index.end(),
+                             [](const AssignedNumber *a, const AssignedNumber *b) {
+                                 return qstricmp(a->name, b->name) < 0;
+                             });
+        }
+    }
+
+    QList<const AssignedNumber *> entries[assignedNumberCategoryCount];
+};
+Q_GLOBAL_STATIC(AssignedNameIndex, assignedNameIndex)
+
+QBluetoothUuid QtBluetoothPrivate::uuidFromAssignedName(AssignedNumberCategory category,
+                                                        QStringView name)
+{
+    const AssignedNameIndex *index = assignedNameIndex();
+    if (!index || name.isEmpty())
+        return QBluetoothUuid();
+
+    const auto compare = [](const AssignedNumber *entry, QStringView name) {
+        return QLatin1String(entry->name).compare(name, Qt::CaseInsensitive);
+    };
+    const QList<const AssignedNumber *> &entries = index->entries[int(category)];
+    const auto it = std::lower_bound(entries.cbegin(), entries.cend(), name,
+                                     [&compare](const AssignedNumber *entry, QStringView name) {
+                                         return compare(entry, name) < 0;
+                                     });
+    if (it == entries.cend() || compare(*it, name) != 0)
+        return QBluetoothUuid();
+    return QBluetoothUuid((*it)->value);
+}
+
 /*!
     Returns a human-readable and translated name for the given service class
     represented by \a uuid.
@@ -691,104 +1552,7 @@ quint128 QBluetoothUuid::toUInt128() const
  */
 QString QBluetoothUuid::serviceClassToString(QBluetoothUuid::ServiceClassUuid uuid)
 {
-    switch (uuid) {
-    case QBluetoothUuid::ServiceClassUuid::ServiceDiscoveryServer: return QBluetoothServiceDiscoveryAgent::tr("Service Discovery");
-    case QBluetoothUuid::ServiceClassUuid::BrowseGroupDescriptor: return QBluetoothServiceDiscoveryAgent::tr("Browse Group Descriptor");
-    case QBluetoothUuid::ServiceClassUuid::PublicBrowseGroup: return QBluetoothServiceDiscoveryAgent::tr("Public Browse Group");
-    case QBluetoothUuid::ServiceClassUuid::SerialPort: return QBluetoothServiceDiscoveryAgent::tr("Serial Port Profile");
-    case QBluetoothUuid::ServiceClassUuid::LANAccessUsingPPP: return QBluetoothServiceDiscoveryAgent::tr("LAN Access Profile");
-    case QBluetoothUuid::ServiceClassUuid::DialupNetworking: return QBluetoothServiceDiscoveryAgent::tr("Dial-Up Networking");
-    case QBluetoothUuid::ServiceClassUuid::IrMCSync: return QBluetoothServiceDiscoveryAgent::tr("Synchronization");
-    case QBluetoothUuid::ServiceClassUuid::ObexObjectPush: return QBluetoothServiceDiscoveryAgent::tr("Object Push");
-    case QBluetoothUuid::ServiceClassUuid::OBEXFileTransfer: return QBluetoothServiceDiscoveryAgent::tr("File Transfer");
-    case QBluetoothUuid::ServiceClassUuid::IrMCSyncCommand: return QBluetoothServiceDiscoveryAgent::tr("Synchronization Command");
-    case QBluetoothUuid::ServiceClassUuid::Headset: return QBluetoothServiceDiscoveryAgent::tr("Headset");
-    case QBluetoothUuid::ServiceClassUuid::AudioSource: return QBluetoothServiceDiscoveryAgent::tr("Audio Source");
-    case QBluetoothUuid::ServiceClassUuid::AudioSink: return QBluetoothServiceDiscoveryAgent::tr("Audio Sink");
-    case QBluetoothUuid::ServiceClassUuid::AV_RemoteControlTarget: return QBluetoothServiceDiscoveryAgent::tr("Audio/Video Remote Control Target");
-    case QBluetoothUuid::ServiceClassUuid::AdvancedAudioDistribution: return QBluetoothServiceDiscoveryAgent::tr("Advanced Audio Distribution");
-    case QBluetoothUuid::ServiceClassUuid::AV_RemoteControl: return QBluetoothServiceDiscoveryAgent::tr("Audio/Video Remote Control");
-    case QBluetoothUuid::ServiceClassUuid::AV_RemoteControlController: return QBluetoothServiceDiscoveryAgent::tr("Audio/Video Remote Control Controller");
-    case QBluetoothUuid::ServiceClassUuid::HeadsetAG: return QBluetoothServiceDiscoveryAgent::tr("Headset AG");
-    case QBluetoothUuid::ServiceClassUuid::PANU: return QBluetoothServiceDiscoveryAgent::tr("Personal Area Networking (PANU)");
-    case QBluetoothUuid::ServiceClassUuid::NAP: return QBluetoothServiceDiscoveryAgent::tr("Personal Area Networking (NAP)");
-    case QBluetoothUuid::ServiceClassUuid::GN: return QBluetoothServiceDiscoveryAgent::tr("Personal Area Networking (GN)");
-    case QBluetoothUuid::ServiceClassUuid::DirectPrinting: return QBluetoothServiceDiscoveryAgent::tr("Basic Direct Printing (BPP)");
-    case QBluetoothUuid::ServiceClassUuid::ReferencePrinting: return QBluetoothServiceDiscoveryAgent::tr("Basic Reference Printing (BPP)");
-    case QBluetoothUuid::ServiceClassUuid::BasicImage: return QBluetoothServiceDiscoveryAgent::tr("Basic Imaging Profile");
-    case QBluetoothUuid::ServiceClassUuid::ImagingResponder: return QBluetoothServiceDiscoveryAgent::tr("Basic Imaging Responder");
-    case QBluetoothUuid::ServiceClassUuid::ImagingAutomaticArchive: return QBluetoothServiceDiscoveryAgent::tr("Basic Imaging Archive");
-    case QBluetoothUuid::ServiceClassUuid::ImagingReferenceObjects: return QBluetoothServiceDiscoveryAgent::tr("Basic Imaging Ref Objects");
-    case QBluetoothUuid::ServiceClassUuid::Handsfree: return QBluetoothServiceDiscoveryAgent::tr("Hands-Free");
-    case QBluetoothUuid::ServiceClassUuid::HandsfreeAudioGateway: return QBluetoothServiceDiscoveryAgent::tr("Hands-Free AG");
-    case QBluetoothUuid::ServiceClassUuid::DirectPrintingReferenceObjectsService: return QBluetoothServiceDiscoveryAgent::tr("Basic Printing RefObject Service");
-    case QBluetoothUuid::ServiceClassUuid::ReflectedUI: return QBluetoothServiceDiscoveryAgent::tr("Basic Printing Reflected UI");
-    case QBluetoothUuid::ServiceClassUuid::BasicPrinting: return QBluetoothServiceDiscoveryAgent::tr("Basic Printing");
-    case QBluetoothUuid::ServiceClassUuid::PrintingStatus: return QBluetoothServiceDiscoveryAgent::tr("Basic Printing Status");
-    case QBluetoothUuid::ServiceClassUuid::HumanInterfaceDeviceService: return QBluetoothServiceDiscoveryAgent::tr("Human Interface Device");
-    case QBluetoothUuid::ServiceClassUuid::HardcopyCableReplacement: return QBluetoothServiceDiscoveryAgent::tr("Hardcopy Cable Replacement");
-    case QBluetoothUuid::ServiceClassUuid::HCRPrint: return QBluetoothServiceDiscoveryAgent::tr("Hardcopy Cable Replacement Print");
-    case QBluetoothUuid::ServiceClassUuid::HCRScan: return QBluetoothServiceDiscoveryAgent::tr("Hardcopy Cable Replacement Scan");
-    case QBluetoothUuid::ServiceClassUuid::SIMAccess: return QBluetoothServiceDiscoveryAgent::tr("SIM Access Server");
-    case QBluetoothUuid::ServiceClassUuid::PhonebookAccessPCE: return QBluetoothServiceDiscoveryAgent::tr("Phonebook Access PCE");
-    case QBluetoothUuid::ServiceClassUuid::PhonebookAccessPSE: return QBluetoothServiceDiscoveryAgent::tr("Phonebook Access PSE");
-    case QBluetoothUuid::ServiceClassUuid::PhonebookAccess: return QBluetoothServiceDiscoveryAgent::tr("Phonebook Access");
-    case QBluetoothUuid::ServiceClassUuid::HeadsetHS: return QBluetoothServiceDiscoveryAgent::tr("Headset HS");
-    case QBluetoothUuid::ServiceClassUuid::MessageAccessServer: return QBluetoothServiceDiscoveryAgent::tr("Message Access Server");
-    case QBluetoothUuid::ServiceClassUuid::MessageNotificationServer: return QBluetoothServiceDiscoveryAgent::tr("Message Notification Server");
-    case QBluetoothUuid::ServiceClassUuid::MessageAccessProfile: return QBluetoothServiceDiscoveryAgent::tr("Message Access");
-    case QBluetoothUuid::ServiceClassUuid::GNSS: return QBluetoothServiceDiscoveryAgent::tr("Global Navigation Satellite System");
-    case QBluetoothUuid::ServiceClassUuid::GNSSServer: return QBluetoothServiceDiscoveryAgent::tr("Global Navigation Satellite System Server");
-    case QBluetoothUuid::ServiceClassUuid::Display3D: return QBluetoothServiceDiscoveryAgent::tr("3D Synchronization Display");
-    case QBluetoothUuid::ServiceClassUuid::Glasses3D: return QBluetoothServiceDiscoveryAgent::tr("3D Synchronization Glasses");
-    case QBluetoothUuid::ServiceClassUuid::Synchronization3D: return QBluetoothServiceDiscoveryAgent::tr("3D Synchronization");
-    case QBluetoothUuid::ServiceClassUuid::MPSProfile: return QBluetoothServiceDiscoveryAgent::tr("Multi-Profile Specification (Profile)");
-    case QBluetoothUuid::ServiceClassUuid::MPSService: return QBluetoothServiceDiscoveryAgent::tr("Multi-Profile Specification");
-    case QBluetoothUuid::ServiceClassUuid::PnPInformation: return QBluetoothServiceDiscoveryAgent::tr("Device Identification");
-    case QBluetoothUuid::ServiceClassUuid::GenericNetworking: return QBluetoothServiceDiscoveryAgent::tr("Generic Networking");
-    case QBluetoothUuid::ServiceClassUuid::GenericFileTransfer: return QBluetoothServiceDiscoveryAgent::tr("Generic File Transfer");
-    case QBluetoothUuid::ServiceClassUuid::GenericAudio: return QBluetoothServiceDiscoveryAgent::tr("Generic Audio");
-    case QBluetoothUuid::ServiceClassUuid::GenericTelephony: return QBluetoothServiceDiscoveryAgent::tr("Generic Telephony");
-    case QBluetoothUuid::ServiceClassUuid::VideoSource: return QBluetoothServiceDiscoveryAgent::tr("Video Source");
-    case QBluetoothUuid::ServiceClassUuid::VideoSink: return QBluetoothServiceDiscoveryAgent::tr("Video Sink");
-    case QBluetoothUuid::ServiceClassUuid::VideoDistribution: return QBluetoothServiceDiscoveryAgent::tr("Video Distribution");
-    case QBluetoothUuid::ServiceClassUuid::HDP: return QBluetoothServiceDiscoveryAgent::tr("Health Device");
-    case QBluetoothUuid::ServiceClassUuid::HDPSource: return QBluetoothServiceDiscoveryAgent::tr("Health Device Source");
-    case QBluetoothUuid::ServiceClassUuid::HDPSink: return QBluetoothServiceDiscoveryAgent::tr("Health Device Sink");
-    case QBluetoothUuid::ServiceClassUuid::GenericAccess: return QBluetoothServiceDiscoveryAgent::tr("Generic Access");
-    case QBluetoothUuid::ServiceClassUuid::GenericAttribute: return QBluetoothServiceDiscoveryAgent::tr("Generic Attribute");
-    case QBluetoothUuid::ServiceClassUuid::ImmediateAlert: return QBluetoothServiceDiscoveryAgent::tr("Immediate Alert");
-    case QBluetoothUuid::ServiceClassUuid::LinkLoss: return QBluetoothServiceDiscoveryAgent::tr("Link Loss");
-    case QBluetoothUuid::ServiceClassUuid::TxPower: return QBluetoothServiceDiscoveryAgent::tr("Tx Power");
-    case QBluetoothUuid::ServiceClassUuid::CurrentTimeService: return QBluetoothServiceDiscoveryAgent::tr("Current Time Service");
-    case QBluetoothUuid::ServiceClassUuid::ReferenceTimeUpdateService: return QBluetoothServiceDiscoveryAgent::tr("Reference Time Update Service");
-    case QBluetoothUuid::ServiceClassUuid::NextDSTChangeService: return QBluetoothServiceDiscoveryAgent::tr("Next DST Change Service");
-    case QBluetoothUuid::ServiceClassUuid::Glucose: return QBluetoothServiceDiscoveryAgent::tr("Glucose");
-    case QBluetoothUuid::ServiceClassUuid::HealthThermometer: return QBluetoothServiceDiscoveryAgent::tr("Health Thermometer");
-    case QBluetoothUuid::ServiceClassUuid::DeviceInformation: return QBluetoothServiceDiscoveryAgent::tr("Device Information");
-    case QBluetoothUuid::ServiceClassUuid::HeartRate: return QBluetoothServiceDiscoveryAgent::tr("Heart Rate");
-    case QBluetoothUuid::ServiceClassUuid::PhoneAlertStatusService: return QBluetoothServiceDiscoveryAgent::tr("Phone Alert Status Service");
-    case QBluetoothUuid::ServiceClassUuid::BatteryService: return QBluetoothServiceDiscoveryAgent::tr("Battery Service");
-    case QBluetoothUuid::ServiceClassUuid::BloodPressure: return QBluetoothServiceDiscoveryAgent::tr("Blood Pressure");
-    case QBluetoothUuid::ServiceClassUuid::AlertNotificationService: return QBluetoothServiceDiscoveryAgent::tr("Alert Notification Service");
-    case QBluetoothUuid::ServiceClassUuid::HumanInterfaceDevice: return QBluetoothServiceDiscoveryAgent::tr("Human Interface Device");
-    case QBluetoothUuid::ServiceClassUuid::ScanParameters: return QBluetoothServiceDiscoveryAgent::tr("Scan Parameters");
-    case QBluetoothUuid::ServiceClassUuid::RunningSpeedAndCadence: return QBluetoothServiceDiscoveryAgent::tr("Running Speed and Cadence");
-    case QBluetoothUuid::ServiceClassUuid::CyclingSpeedAndCadence: return QBluetoothServiceDiscoveryAgent::tr("Cycling Speed and Cadence");
-    case QBluetoothUuid::ServiceClassUuid::CyclingPower: return QBluetoothServiceDiscoveryAgent::tr("Cycling Power");
-    case QBluetoothUuid::ServiceClassUuid::LocationAndNavigation: return QBluetoothServiceDiscoveryAgent::tr("Location and Navigation");
-    case QBluetoothUuid::ServiceClassUuid::EnvironmentalSensing: return QBluetoothServiceDiscoveryAgent::tr("Environmental Sensing");
-    case QBluetoothUuid::ServiceClassUuid::BodyComposition: return QBluetoothServiceDiscoveryAgent::tr("Body Composition");
-    case QBluetoothUuid::ServiceClassUuid::UserData: return QBluetoothServiceDiscoveryAgent::tr("User Data");
-    case QBluetoothUuid::ServiceClassUuid::WeightScale: return QBluetoothServiceDiscoveryAgent::tr("Weight Scale");
-    //: Connection management (Bluetooth)
-    case QBluetoothUuid::ServiceClassUuid::BondManagement: return QBluetoothServiceDiscoveryAgent::tr("Bond Management");
-    case QBluetoothUuid::ServiceClassUuid::ContinuousGlucoseMonitoring: return QBluetoothServiceDiscoveryAgent::tr("Continuous Glucose Monitoring");
-    default:
-        break;
-    }
-
-    return QString();
+    return assignedNumberToString(AssignedNumberCategory::ServiceClass, quint32(uuid));
 }
 
 
@@ -802,37 +1566,7 @@ QString QBluetoothUuid::serviceClassToString(QBluetoothUuid::ServiceClassUuid uu
  */
 QString QBluetoothUuid::protocolToString(QBluetoothUuid::ProtocolUuid uuid)
 {
-    switch (uuid) {
-    case QBluetoothUuid::ProtocolUuid::Sdp: return QBluetoothServiceDiscoveryAgent::tr("Service Discovery Protocol");
-    case QBluetoothUuid::ProtocolUuid::Udp: return QBluetoothServiceDiscoveryAgent::tr("User Datagram Protocol");
-    case QBluetoothUuid::ProtocolUuid::Rfcomm: return QBluetoothServiceDiscoveryAgent::tr("Radio Frequency Communication");
-    case QBluetoothUuid::ProtocolUuid::Tcp: return QBluetoothServiceDiscoveryAgent::tr("Transmission Control Protocol");
-    case QBluetoothUuid::ProtocolUuid::TcsBin: return QBluetoothServiceDiscoveryAgent::tr("Telephony Control Specification - Binary");
-    case QBluetoothUuid::ProtocolUuid::TcsAt: return QBluetoothServiceDiscoveryAgent::tr("Telephony Control Specification - AT");
-    case QBluetoothUuid::ProtocolUuid::Att: return QBluetoothServiceDiscoveryAgent::tr("Attribute Protocol");
-    case QBluetoothUuid::ProtocolUuid::Obex: return QBluetoothServiceDiscoveryAgent::tr("Object Exchange Protocol");
-    case QBluetoothUuid::ProtocolUuid::Ip: return QBluetoothServiceDiscoveryAgent::tr("Internet Protocol");
-    case QBluetoothUuid::ProtocolUuid::Ftp: return QBluetoothServiceDiscoveryAgent::tr("File Transfer Protocol");
-    case QBluetoothUuid::ProtocolUuid::Http: return QBluetoothServiceDiscoveryAgent::tr("Hypertext Transfer Protocol");
-    case QBluetoothUuid::ProtocolUuid::Wsp: return QBluetoothServiceDiscoveryAgent::tr("Wireless Short Packet Protocol");
-    case QBluetoothUuid::ProtocolUuid::Bnep: return QBluetoothServiceDiscoveryAgent::tr("Bluetooth Network Encapsulation Protocol");
-    case QBluetoothUuid::ProtocolUuid::Upnp: return QBluetoothServiceDiscoveryAgent::tr("Extended Service Discovery Protocol");
-    case QBluetoothUuid::ProtocolUuid::Hidp: return QBluetoothServiceDiscoveryAgent::tr("Human Interface Device Protocol");
-    case QBluetoothUuid::ProtocolUuid::HardcopyControlChannel: return QBluetoothServiceDiscoveryAgent::tr("Hardcopy Control Channel");
-    case QBluetoothUuid::ProtocolUuid::HardcopyDataChannel: return QBluetoothServiceDiscoveryAgent::tr("Hardcopy Data Channel");
-    case QBluetoothUuid::ProtocolUuid::HardcopyNotification: return QBluetoothServiceDiscoveryAgent::tr("Hardcopy Notification");
-    case QBluetoothUuid::ProtocolUuid::Avctp: return QBluetoothServiceDiscoveryAgent::tr("Audio/Video Control Transport Protocol");
-    case QBluetoothUuid::ProtocolUuid::Avdtp: return QBluetoothServiceDiscoveryAgent::tr("Audio/Video Distribution Transport Protocol");
-    case QBluetoothUuid::ProtocolUuid::Cmtp: return QBluetoothServiceDiscoveryAgent::tr("Common ISDN Access Protocol");
-    case QBluetoothUuid::ProtocolUuid::UdiCPlain: return QBluetoothServiceDiscoveryAgent::tr("UdiCPlain");
-    case QBluetoothUuid::ProtocolUuid::McapControlChannel: return QBluetoothServiceDiscoveryAgent::tr("Multi-Channel Adaptation Protocol - Control");
-    case QBluetoothUuid::ProtocolUuid::McapDataChannel: return QBluetoothServiceDiscoveryAgent::tr("Multi-Channel Adaptation Protocol - Data");
-    case QBluetoothUuid::ProtocolUuid::L2cap: return QBluetoothServiceDiscoveryAgent::tr("Layer 2 Control Protocol");
-    default:
-        break;
-    }
-
-    return QString();
+    return assignedNumberToString(AssignedNumberCategory::Protocol, quint32(uuid));
 }
 
 /*!
@@ -845,202 +1579,7 @@ QString QBluetoothUuid::protocolToString(QBluetoothUuid::ProtocolUuid uuid)
 */
 QString QBluetoothUuid::characteristicToString(CharacteristicType uuid)
 {
-    switch (uuid) {
-    //: GAP:  Generic Access Profile (Bluetooth)
-    case QBluetoothUuid::CharacteristicType::DeviceName: return QBluetoothServiceDiscoveryAgent::tr("GAP Device Name");
-    //: GAP:  Generic Access Profile (Bluetooth)
-    case QBluetoothUuid::CharacteristicType::Appearance: return QBluetoothServiceDiscoveryAgent::tr("GAP Appearance");
-    case QBluetoothUuid::CharacteristicType::PeripheralPrivacyFlag:
-        //: GAP:  Generic Access Profile (Bluetooth)
-        return QBluetoothServiceDiscoveryAgent::tr("GAP Peripheral Privacy Flag");
-    case QBluetoothUuid::CharacteristicType::ReconnectionAddress:
-        //: GAP:  Generic Access Profile (Bluetooth)
-        return QBluetoothServiceDiscoveryAgent::tr("GAP Reconnection Address");
-    case QBluetoothUuid::CharacteristicType::PeripheralPreferredConnectionParameters:
-        return QBluetoothServiceDiscoveryAgent::tr("GAP Peripheral Preferred Connection Parameters");
-    //: GATT: _G_eneric _Att_ribute Profile (Bluetooth)
-    case QBluetoothUuid::CharacteristicType::ServiceChanged: return QBluetoothServiceDiscoveryAgent::tr("GATT Service Changed");
-    case QBluetoothUuid::CharacteristicType::AlertLevel: return QBluetoothServiceDiscoveryAgent::tr("Alert Level");
-    case QBluetoothUuid::CharacteristicType::TxPowerLevel: return QBluetoothServiceDiscoveryAgent::tr("TX Power");
-    case QBluetoothUuid::CharacteristicType::DateTime: return QBluetoothServiceDiscoveryAgent::tr("Date Time");
-    case QBluetoothUuid::CharacteristicType::DayOfWeek: return QBluetoothServiceDiscoveryAgent::tr("Day Of Week");
-    case QBluetoothUuid::CharacteristicType::DayDateTime: return QBluetoothServiceDiscoveryAgent::tr("Day Date Time");
-    case QBluetoothUuid::CharacteristicType::ExactTime256: return QBluetoothServiceDiscoveryAgent::tr("Exact Time 256");
-    case QBluetoothUuid::CharacteristicType::DSTOffset: return QBluetoothServiceDiscoveryAgent::tr("DST Offset");
-    case QBluetoothUuid::CharacteristicType::TimeZone: return QBluetoothServiceDiscoveryAgent::tr("Time Zone");
-    case QBluetoothUuid::CharacteristicType::LocalTimeInformation:
-        return QBluetoothServiceDiscoveryAgent::tr("Local Time Information");
-    case QBluetoothUuid::CharacteristicType::TimeWithDST: return QBluetoothServiceDiscoveryAgent::tr("Time With DST");
-    case QBluetoothUuid::CharacteristicType::TimeAccuracy: return QBluetoothServiceDiscoveryAgent::tr("Time Accuracy");
-    case QBluetoothUuid::CharacteristicType::TimeSource: return QBluetoothServiceDiscoveryAgent::tr("Time Source");
-    case QBluetoothUuid::CharacteristicType::ReferenceTimeInformation:
-        return QBluetoothServiceDiscoveryAgent::tr("Reference Time Information");
-    case QBluetoothUuid::CharacteristicType::TimeUpdateControlPoint:
-        return QBluetoothServiceDiscoveryAgent::tr("Time Update Control Point");
-    case QBluetoothUuid::CharacteristicType::TimeUpdateState: return QBluetoothServiceDiscoveryAgent::tr("Time Update State");
-    case QBluetoothUuid::CharacteristicType::GlucoseMeasurement: return QBluetoothServiceDiscoveryAgent::tr("Glucose Measurement");
-    case QBluetoothUuid::CharacteristicType::BatteryLevel: return QBluetoothServiceDiscoveryAgent::tr("Battery Level");
-    case QBluetoothUuid::CharacteristicType::TemperatureMeasurement:
-        return QBluetoothServiceDiscoveryAgent::tr("Temperature Measurement");
-    case QBluetoothUuid::CharacteristicType::TemperatureType: return QBluetoothServiceDiscoveryAgent::tr("Temperature Type");
-    case QBluetoothUuid::CharacteristicType::IntermediateTemperature:
-        return QBluetoothServiceDiscoveryAgent::tr("Intermediate Temperature");
-    case QBluetoothUuid::CharacteristicType::MeasurementInterval: return QBluetoothServiceDiscoveryAgent::tr("Measurement Interval");
-    case QBluetoothUuid::CharacteristicType::BootKeyboardInputReport: return QBluetoothServiceDiscoveryAgent::tr("Boot Keyboard Input Report");
-    case QBluetoothUuid::CharacteristicType::SystemID: return QBluetoothServiceDiscoveryAgent::tr("System ID");
-    case QBluetoothUuid::CharacteristicType::ModelNumberString: return QBluetoothServiceDiscoveryAgent::tr("Model Number String");
-    case QBluetoothUuid::CharacteristicType::SerialNumberString: return QBluetoothServiceDiscoveryAgent::tr("Serial Number String");
-    case QBluetoothUuid::CharacteristicType::FirmwareRevisionString: return QBluetoothServiceDiscoveryAgent::tr("Firmware Revision String");
-    case QBluetoothUuid::CharacteristicType::HardwareRevisionString: return QBluetoothServiceDiscoveryAgent::tr("Hardware Revision String");
-    case QBluetoothUuid::CharacteristicType::SoftwareRevisionString: return QBluetoothServiceDiscoveryAgent::tr("Software Revision String");
-    case QBluetoothUuid::CharacteristicType::ManufacturerNameString: return QBluetoothServiceDiscoveryAgent::tr("Manufacturer Name String");
-    case QBluetoothUuid::CharacteristicType::IEEE1107320601RegulatoryCertificationDataList:
-        return QBluetoothServiceDiscoveryAgent::tr("IEEE 11073 20601 Regulatory Certification Data List");
-    case QBluetoothUuid::CharacteristicType::CurrentTime: return QBluetoothServiceDiscoveryAgent::tr("Current Time");
-    case QBluetoothUuid::CharacteristicType::ScanRefresh: return QBluetoothServiceDiscoveryAgent::tr("Scan Refresh");
-    case QBluetoothUuid::CharacteristicType::BootKeyboardOutputReport:
-        return QBluetoothServiceDiscoveryAgent::tr("Boot Keyboard Output Report");
-    case QBluetoothUuid::CharacteristicType::BootMouseInputReport: return QBluetoothServiceDiscoveryAgent::tr("Boot Mouse Input Report");
-    case QBluetoothUuid::CharacteristicType::GlucoseMeasurementContext:
-        return QBluetoothServiceDiscoveryAgent::tr("Glucose Measurement Context");
-    case QBluetoothUuid::CharacteristicType::BloodPressureMeasurement:
-        return QBluetoothServiceDiscoveryAgent::tr("Blood Pressure Measurement");
-    case QBluetoothUuid::CharacteristicType::IntermediateCuffPressure:
-        return QBluetoothServiceDiscoveryAgent::tr("Intermediate Cuff Pressure");
-    case QBluetoothUuid::CharacteristicType::HeartRateMeasurement: return QBluetoothServiceDiscoveryAgent::tr("Heart Rate Measurement");
-    case QBluetoothUuid::CharacteristicType::BodySensorLocation: return QBluetoothServiceDiscoveryAgent::tr("Body Sensor Location");
-    case QBluetoothUuid::CharacteristicType::HeartRateControlPoint: return QBluetoothServiceDiscoveryAgent::tr("Heart Rate Control Point");
-    case QBluetoothUuid::CharacteristicType::AlertStatus: return QBluetoothServiceDiscoveryAgent::tr("Alert Status");
-    case QBluetoothUuid::CharacteristicType::RingerControlPoint: return QBluetoothServiceDiscoveryAgent::tr("Ringer Control Point");
-    case QBluetoothUuid::CharacteristicType::RingerSetting: return QBluetoothServiceDiscoveryAgent::tr("Ringer Setting");
-    case QBluetoothUuid::CharacteristicType::AlertCategoryIDBitMask:
-        return QBluetoothServiceDiscoveryAgent::tr("Alert Category ID Bit Mask");
-    case QBluetoothUuid::CharacteristicType::AlertCategoryID: return QBluetoothServiceDiscoveryAgent::tr("Alert Category ID");
-    case QBluetoothUuid::CharacteristicType::AlertNotificationControlPoint:
-        return QBluetoothServiceDiscoveryAgent::tr("Alert Notification Control Point");
-    case QBluetoothUuid::CharacteristicType::UnreadAlertStatus: return QBluetoothServiceDiscoveryAgent::tr("Unread Alert Status");
-    case QBluetoothUuid::CharacteristicType::NewAlert: return QBluetoothServiceDiscoveryAgent::tr("New Alert");
-    case QBluetoothUuid::CharacteristicType::SupportedNewAlertCategory:
-        return QBluetoothServiceDiscoveryAgent::tr("Supported New Alert Category");
-    case QBluetoothUuid::CharacteristicType::SupportedUnreadAlertCategory:
-        return QBluetoothServiceDiscoveryAgent::tr("Supported Unread Alert Category");
-    case QBluetoothUuid::CharacteristicType::BloodPressureFeature: return QBluetoothServiceDiscoveryAgent::tr("Blood Pressure Feature");
-        //: HID: Human Interface Device Profile (Bluetooth)
-    case QBluetoothUuid::CharacteristicType::HIDInformation: return QBluetoothServiceDiscoveryAgent::tr("HID Information");
-    case QBluetoothUuid::CharacteristicType::ReportMap: return QBluetoothServiceDiscoveryAgent::tr("Report Map");
-        //: HID: Human Interface Device Profile (Bluetooth)
-    case QBluetoothUuid::CharacteristicType::HIDControlPoint: return QBluetoothServiceDiscoveryAgent::tr("HID Control Point");
-    case QBluetoothUuid::CharacteristicType::Report: return QBluetoothServiceDiscoveryAgent::tr("Report");
-    case QBluetoothUuid::CharacteristicType::ProtocolMode: return QBluetoothServiceDiscoveryAgent::tr("Protocol Mode");
-    case QBluetoothUuid::CharacteristicType::ScanIntervalWindow: return QBluetoothServiceDiscoveryAgent::tr("Scan Interval Window");
-    case QBluetoothUuid::CharacteristicType::PnPID: return QBluetoothServiceDiscoveryAgent::tr("PnP ID");
-    case QBluetoothUuid::CharacteristicType::GlucoseFeature: return QBluetoothServiceDiscoveryAgent::tr("Glucose Feature");
-    case QBluetoothUuid::CharacteristicType::RecordAccessControlPoint:
-        //: Glucose Sensor patient record database.
-        return QBluetoothServiceDiscoveryAgent::tr("Record Access Control Point");
-    //: RSC: Running Speed and Cadence
-    case QBluetoothUuid::CharacteristicType::RSCMeasurement: return QBluetoothServiceDiscoveryAgent::tr("RSC Measurement");
-    //: RSC: Running Speed and Cadence
-    case QBluetoothUuid::CharacteristicType::RSCFeature: return QBluetoothServiceDiscoveryAgent::tr("RSC Feature");
-    case QBluetoothUuid::CharacteristicType::SCControlPoint: return QBluetoothServiceDiscoveryAgent::tr("SC Control Point");
-    //: CSC: Cycling Speed and Cadence
-    case QBluetoothUuid::CharacteristicType::CSCMeasurement: return QBluetoothServiceDiscoveryAgent::tr("CSC Measurement");
-    //: CSC: Cycling Speed and Cadence
-    case QBluetoothUuid::CharacteristicType::CSCFeature: return QBluetoothServiceDiscoveryAgent::tr("CSC Feature");
-    case QBluetoothUuid::CharacteristicType::SensorLocation: return QBluetoothServiceDiscoveryAgent::tr("Sensor Location");
-    case QBluetoothUuid::CharacteristicType::CyclingPowerMeasurement:
-        return QBluetoothServiceDiscoveryAgent::tr("Cycling Power Measurement");
-    case QBluetoothUuid::CharacteristicType::CyclingPowerVector: return QBluetoothServiceDiscoveryAgent::tr("Cycling Power Vector");
-    case QBluetoothUuid::CharacteristicType::CyclingPowerFeature: return QBluetoothServiceDiscoveryAgent::tr("Cycling Power Feature");
-    case QBluetoothUuid::CharacteristicType::CyclingPowerControlPoint:
-        return QBluetoothServiceDiscoveryAgent::tr("Cycling Power Control Point");
-    case QBluetoothUuid::CharacteristicType::LocationAndSpeed: return QBluetoothServiceDiscoveryAgent::tr("Location And Speed");
-    case QBluetoothUuid::CharacteristicType::Navigation: return QBluetoothServiceDiscoveryAgent::tr("Navigation");
-    case QBluetoothUuid::CharacteristicType::PositionQuality: return QBluetoothServiceDiscoveryAgent::tr("Position Quality");
-    case QBluetoothUuid::CharacteristicType::LNFeature: return QBluetoothServiceDiscoveryAgent::tr("LN Feature");
-    case QBluetoothUuid::CharacteristicType::LNControlPoint: return QBluetoothServiceDiscoveryAgent::tr("LN Control Point");
-    case QBluetoothUuid::CharacteristicType::MagneticDeclination:
-        //: Angle between geographic and magnetic north
-        return QBluetoothServiceDiscoveryAgent::tr("Magnetic Declination");
-    //: Above/below sea level
-    case QBluetoothUuid::CharacteristicType::Elevation: return QBluetoothServiceDiscoveryAgent::tr("Elevation");
-    case QBluetoothUuid::CharacteristicType::Pressure: return QBluetoothServiceDiscoveryAgent::tr("Pressure");
-    case QBluetoothUuid::CharacteristicType::Temperature: return QBluetoothServiceDiscoveryAgent::tr("Temperature");
-    case QBluetoothUuid::CharacteristicType::Humidity: return QBluetoothServiceDiscoveryAgent::tr("Humidity");
-    //: Wind speed while standing
-    case QBluetoothUuid::CharacteristicType::TrueWindSpeed: return QBluetoothServiceDiscoveryAgent::tr("True Wind Speed");
-    case QBluetoothUuid::CharacteristicType::TrueWindDirection : return QBluetoothServiceDiscoveryAgent::tr("True Wind Direction");
-    case QBluetoothUuid::CharacteristicType::ApparentWindSpeed:
-        //: Wind speed while observer is moving
-        return QBluetoothServiceDiscoveryAgent::tr("Apparent Wind Speed");
-    case QBluetoothUuid::CharacteristicType::ApparentWindDirection: return QBluetoothServiceDiscoveryAgent::tr("Apparent Wind Direction");
-    case QBluetoothUuid::CharacteristicType::GustFactor:
-        //: Factor by which wind gust is stronger than average wind
-        return QBluetoothServiceDiscoveryAgent::tr("Gust Factor");
-    case QBluetoothUuid::CharacteristicType::PollenConcentration: return QBluetoothServiceDiscoveryAgent::tr("Pollen Concentration");
-    case QBluetoothUuid::CharacteristicType::UVIndex: return QBluetoothServiceDiscoveryAgent::tr("UV Index");
-    case QBluetoothUuid::CharacteristicType::Irradiance: return QBluetoothServiceDiscoveryAgent::tr("Irradiance");
-    case QBluetoothUuid::CharacteristicType::Rainfall: return QBluetoothServiceDiscoveryAgent::tr("Rainfall");
-    case QBluetoothUuid::CharacteristicType::WindChill: return QBluetoothServiceDiscoveryAgent::tr("Wind Chill");
-    case QBluetoothUuid::CharacteristicType::HeatIndex: return QBluetoothServiceDiscoveryAgent::tr("Heat Index");
-    case QBluetoothUuid::CharacteristicType::DewPoint: return QBluetoothServiceDiscoveryAgent::tr("Dew Point");
-    case QBluetoothUuid::CharacteristicType::DescriptorValueChanged:
-        //: Environmental sensing related
-        return QBluetoothServiceDiscoveryAgent::tr("Descriptor Value Changed");
-    case QBluetoothUuid::CharacteristicType::AerobicHeartRateLowerLimit:
-        return QBluetoothServiceDiscoveryAgent::tr("Aerobic Heart Rate Lower Limit");
-    case QBluetoothUuid::CharacteristicType::AerobicHeartRateUpperLimit:
-        return QBluetoothServiceDiscoveryAgent::tr("Aerobic Heart Rate Upper Limit");
-    case QBluetoothUuid::CharacteristicType::AerobicThreshold: return QBluetoothServiceDiscoveryAgent::tr("Aerobic Threshold");
-    //: Age of person
-    case QBluetoothUuid::CharacteristicType::Age: return QBluetoothServiceDiscoveryAgent::tr("Age");
-    case QBluetoothUuid::CharacteristicType::AnaerobicHeartRateLowerLimit:
-        return QBluetoothServiceDiscoveryAgent::tr("Anaerobic Heart Rate Lower Limit");
-    case QBluetoothUuid::CharacteristicType::AnaerobicHeartRateUpperLimit:
-        return QBluetoothServiceDiscoveryAgent::tr("Anaerobic Heart Rate Upper Limit");
-    case QBluetoothUuid::CharacteristicType::AnaerobicThreshold: return QBluetoothServiceDiscoveryAgent::tr("Anaerobic Threshold");
-    case QBluetoothUuid::CharacteristicType::DateOfBirth: return QBluetoothServiceDiscoveryAgent::tr("Date Of Birth");
-    case QBluetoothUuid::CharacteristicType::DateOfThresholdAssessment: return QBluetoothServiceDiscoveryAgent::tr("Date Of Threshold Assessment");
-    case QBluetoothUuid::CharacteristicType::EmailAddress: return QBluetoothServiceDiscoveryAgent::tr("Email Address");
-    case QBluetoothUuid::CharacteristicType::FatBurnHeartRateLowerLimit:
-        return QBluetoothServiceDiscoveryAgent::tr("Fat Burn Heart Rate Lower Limit");
-    case QBluetoothUuid::CharacteristicType::FatBurnHeartRateUpperLimit:
-        return QBluetoothServiceDiscoveryAgent::tr("Fat Burn Heart Rate Upper Limit");
-    case QBluetoothUuid::CharacteristicType::FirstName: return QBluetoothServiceDiscoveryAgent::tr("First Name");
-    case QBluetoothUuid::CharacteristicType::FiveZoneHeartRateLimits: return QBluetoothServiceDiscoveryAgent::tr("5-Zone Heart Rate Limits");
-    case QBluetoothUuid::CharacteristicType::Gender: return QBluetoothServiceDiscoveryAgent::tr("Gender");
-    case QBluetoothUuid::CharacteristicType::HeartRateMax: return QBluetoothServiceDiscoveryAgent::tr("Heart Rate Maximum");
-    //: Height of a person
-    case QBluetoothUuid::CharacteristicType::Height: return QBluetoothServiceDiscoveryAgent::tr("Height");
-    case QBluetoothUuid::CharacteristicType::HipCircumference: return QBluetoothServiceDiscoveryAgent::tr("Hip Circumference");
-    case QBluetoothUuid::CharacteristicType::LastName: return QBluetoothServiceDiscoveryAgent::tr("Last Name");
-    case QBluetoothUuid::CharacteristicType::MaximumRecommendedHeartRate:
-        return QBluetoothServiceDiscoveryAgent::tr("Maximum Recommended Heart Rate");
-    case QBluetoothUuid::CharacteristicType::RestingHeartRate: return QBluetoothServiceDiscoveryAgent::tr("Resting Heart Rate");
-    case QBluetoothUuid::CharacteristicType::SportTypeForAerobicAnaerobicThresholds:
-          return QBluetoothServiceDiscoveryAgent::tr("Sport Type For Aerobic/Anaerobic Thresholds");
-    case QBluetoothUuid::CharacteristicType::ThreeZoneHeartRateLimits: return QBluetoothServiceDiscoveryAgent::tr("3-Zone Heart Rate Limits");
-    case QBluetoothUuid::CharacteristicType::TwoZoneHeartRateLimits: return QBluetoothServiceDiscoveryAgent::tr("2-Zone Heart Rate Limits");
-    case QBluetoothUuid::CharacteristicType::VO2Max: return QBluetoothServiceDiscoveryAgent::tr("Oxygen Uptake");
-    case QBluetoothUuid::CharacteristicType::WaistCircumference: return QBluetoothServiceDiscoveryAgent::tr("Waist Circumference");
-    case QBluetoothUuid::CharacteristicType::Weight: return QBluetoothServiceDiscoveryAgent::tr("Weight");
-    case QBluetoothUuid::CharacteristicType::DatabaseChangeIncrement:
-        //: Environmental sensing related
-        return QBluetoothServiceDiscoveryAgent::tr("Database Change Increment");
-    case QBluetoothUuid::CharacteristicType::UserIndex: return QBluetoothServiceDiscoveryAgent::tr("User Index");
-    case QBluetoothUuid::CharacteristicType::BodyCompositionFeature: return QBluetoothServiceDiscoveryAgent::tr("Body Composition Feature");
-    case QBluetoothUuid::CharacteristicType::BodyCompositionMeasurement: return QBluetoothServiceDiscoveryAgent::tr("Body Composition Measurement");
-    case QBluetoothUuid::CharacteristicType::WeightMeasurement: return QBluetoothServiceDiscoveryAgent::tr("Weight Measurement");
-    case QBluetoothUuid::CharacteristicType::UserControlPoint: return QBluetoothServiceDiscoveryAgent::tr("User Control Point");
-    case QBluetoothUuid::CharacteristicType::MagneticFluxDensity2D: return QBluetoothServiceDiscoveryAgent::tr("Magnetic Flux Density 2D");
-    case QBluetoothUuid::CharacteristicType::MagneticFluxDensity3D: return QBluetoothServiceDiscoveryAgent::tr("Magnetic Flux Density 3D");
-    case QBluetoothUuid::CharacteristicType::Language: return QBluetoothServiceDiscoveryAgent::tr("Language");
-    case QBluetoothUuid::CharacteristicType::BarometricPressureTrend: return QBluetoothServiceDiscoveryAgent::tr("Barometric Pressure Trend");
-    default:
-        break;
-    }
-
-    return QString();
+    return assignedNumberToString(AssignedNumberCategory::Characteristic, quint32(uuid));
 }
 
 /*!
@@ -1053,36 +1592,7 @@ QString QBluetoothUuid::characteristicToString(CharacteristicType uuid)
 */
 QString QBluetoothUuid::descriptorToString(QBluetoothUuid::DescriptorType uuid)
 {
-    switch (uuid) {
-    case QBluetoothUuid::DescriptorType::CharacteristicExtendedProperties:
-        return QBluetoothServiceDiscoveryAgent::tr("Characteristic Extended Properties");
-    case QBluetoothUuid::DescriptorType::CharacteristicUserDescription:
-        return QBluetoothServiceDiscoveryAgent::tr("Characteristic User Description");
-    case QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration:
-        return QBluetoothServiceDiscoveryAgent::tr("Client Characteristic Configuration");
-    case QBluetoothUuid::DescriptorType::ServerCharacteristicConfiguration:
-        return QBluetoothServiceDiscoveryAgent::tr("Server Characteristic Configuration");
-    case QBluetoothUuid::DescriptorType::CharacteristicPresentationFormat:
-        return QBluetoothServiceDiscoveryAgent::tr("Characteristic Presentation Format");
-    case QBluetoothUuid::DescriptorType::CharacteristicAggregateFormat:
-        return QBluetoothServiceDiscoveryAgent::tr("Characteristic Aggregate Format");
-    case QBluetoothUuid::DescriptorType::ValidRange:
-        return QBluetoothServiceDiscoveryAgent::tr("Valid Range");
-    case QBluetoothUuid::DescriptorType::ExternalReportReference:
-        return QBluetoothServiceDiscoveryAgent::tr("External Report Reference");
-    case QBluetoothUuid::DescriptorType::ReportReference:
-        return QBluetoothServiceDiscoveryAgent::tr("Report Reference");
-    case QBluetoothUuid::DescriptorType::EnvironmentalSensingConfiguration:
-        return QBluetoothServiceDiscoveryAgent::tr("Environmental Sensing Configuration");
-    case QBluetoothUuid::DescriptorType::EnvironmentalSensingMeasurement:
-        return QBluetoothServiceDiscoveryAgent::tr("Environmental Sensing Measurement");
-    case QBluetoothUuid::DescriptorType::EnvironmentalSensingTriggerSetting:
-        return QBluetoothServiceDiscoveryAgent::tr("Environmental Sensing Trigger Setting");
-    default:
-        break;
-    }
-
-    return QString();
+    return assignedNumberToString(AssignedNumberCategory::Descriptor, quint32(uuid));
 }
 
 /*!
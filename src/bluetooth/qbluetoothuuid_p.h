@@ -0,0 +1,149 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBLUETOOTHUUID_P_H
+#define QBLUETOOTHUUID_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtBluetooth/qbluetoothuuid.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qstringview.h>
+
+QT_BEGIN_NAMESPACE
+
+// Helpers for the little-endian wire forms of Bluetooth UUIDs as they appear in
+// ATT PDUs, SDP records and advertising data (Bluetooth Core Spec v5.3, Vol 3, Part B, 2.5.1).
+// They read and write the QUuid fields directly instead of going through the
+// big-endian quint128 returned by QBluetoothUuid::toUInt128().
+namespace QtBluetoothPrivate {
+
+// Bluetooth base UUID 00000000-0000-1000-8000-00805F9B34FB
+constexpr quint16 baseUuidData2 = 0x0000;
+constexpr quint16 baseUuidData3 = 0x1000;
+constexpr quint64 baseUuidData4 = Q_UINT64_C(0x800000805F9B34FB);
+
+inline bool hasBluetoothBaseUuid(const QUuid &uuid) noexcept
+{
+    return uuid.data2 == baseUuidData2 && uuid.data3 == baseUuidData3
+            && qFromBigEndian<quint64>(uuid.data4) == baseUuidData4;
+}
+
+// ATT only knows 16 and 128 bit UUIDs, 32 bit UUIDs must be sent in their 128 bit form
+inline int attUuidSize(const QBluetoothUuid &uuid) noexcept
+{
+    return (hasBluetoothBaseUuid(uuid) && !(uuid.data1 & 0xFFFF0000)) ? 2 : 16;
+}
+
+// Writes the \a size (2, 4 or 16) byte little-endian form of \a uuid to \a dst and
+// returns the position behind it. The caller is responsible for \a size being a valid
+// representation of \a uuid.
+inline char *putUuidLittleEndian(const QBluetoothUuid &uuid, int size, char *dst) noexcept
+{
+    switch (size) {
+    case 2:
+        qToLittleEndian<quint16>(quint16(uuid.data1), dst);
+        break;
+    case 4:
+        qToLittleEndian<quint32>(uuid.data1, dst);
+        break;
+    default:
+        Q_ASSERT(size == 16);
+        qToLittleEndian<quint64>(qFromBigEndian<quint64>(uuid.data4), dst);
+        qToLittleEndian<quint16>(uuid.data3, dst + 8);
+        qToLittleEndian<quint16>(uuid.data2, dst + 10);
+        qToLittleEndian<quint32>(uuid.data1, dst + 12);
+        break;
+    }
+    return dst + size;
+}
+
+inline void appendUuidLittleEndian(QByteArray &dst, const QBluetoothUuid &uuid, int size)
+{
+    const qsizetype offset = dst.size();
+    dst.resize(offset + size);
+    putUuidLittleEndian(uuid, size, dst.data() + offset);
+}
+
+// Reads a 2, 4 or 16 byte little-endian UUID from \a src
+inline QBluetoothUuid uuidFromLittleEndian(const void *src, int size) noexcept
+{
+    const uchar *p = static_cast<const uchar *>(src);
+    switch (size) {
+    case 2:
+        return QBluetoothUuid(qFromLittleEndian<quint16>(p));
+    case 4:
+        return QBluetoothUuid(qFromLittleEndian<quint32>(p));
+    default:
+        Q_ASSERT(size == 16);
+        return QBluetoothUuid(QUuid(qFromLittleEndian<quint32>(p + 12),
+                                    qFromLittleEndian<quint16>(p + 10),
+                                    qFromLittleEndian<quint16>(p + 8),
+                                    p[7], p[6], p[5], p[4], p[3], p[2], p[1], p[0]));
+    }
+}
+
+enum class AssignedNumberCategory {
+    ServiceClass,
+    Protocol,
+    Characteristic,
+    Descriptor
+};
+
+// Returns the UUID of the assigned number whose untranslated name, as returned by
+// QBluetoothUuid::serviceClassToString() and friends without a translator, matches
+// \a name case-insensitively, or a null UUID if there is none.
+Q_BLUETOOTH_EXPORT QBluetoothUuid uuidFromAssignedName(AssignedNumberCategory category,
+                                                       QStringView name);
+
+} // namespace QtBluetoothPrivate
+
+QT_END_NAMESPACE
+
+#endif // QBLUETOOTHUUID_P_H
@@ -43,14 +43,29 @@
 #include "bluez/hcimanager_p.h"
 #include "qbluetoothsocketbase_p.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qloggingcategory.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qset.h>
 
+#include <algorithm>
 #include <cstring>
 
 QT_BEGIN_NAMESPACE
 
 Q_DECLARE_LOGGING_CATEGORY(QT_BT_BLUEZ)
 
+// Spec v4.2, Vol 3, Part C, 11
+static const int LegacyAdvDataLength = 31;
+// Spec v5.3, Vol 4, Part E, 7.8.57
+static const int ExtendedAdvDataMaxLength = 1650;
+// HCI command parameters are limited to 255 bytes, minus the fragment header
+static const int ExtendedAdvFragmentLength = 251;
+static const int PeriodicAdvFragmentLength = 252;
+// Advertising_Handle is in the range 0x00-0xEF, Advertising_SID in 0x0-0xF
+static const int MaxAdvertisingHandle = 0xef;
+static const int AdvertisingSidCount = 0x10;
+
 struct AdvParams {
     quint16 minInterval;
     quint16 maxInterval;
@@ -62,9 +77,43 @@ struct AdvParams {
     quint8 filterPolicy;
 } __attribute__ ((packed));
 
+struct ExtAdvParams {
+    quint8 handle;
+    quint16 properties;
+    quint8 minInterval[3];
+    quint8 maxInterval[3];
+    quint8 channelMap;
+    quint8 ownAddrType;
+    quint8 peerAddrType;
+    bdaddr_t peerAddr;
+    quint8 filterPolicy;
+    qint8 txPower;
+    quint8 primaryPhy;
+    quint8 secondaryMaxSkip;
+    quint8 secondaryPhy;
+    quint8 sid;
+    quint8 scanRequestNotification;
+} __attribute__ ((packed));
+
+struct ExtAdvEnable {
+    quint8 enable;
+    quint8 numberOfSets;
+    quint8 handle;
+    quint16 duration;
+    quint8 maxEvents;
+} __attribute__ ((packed));
+
+struct PeriodicAdvParams {
+    quint8 handle;
+    quint16 minInterval;
+    quint16 maxInterval;
+    quint16 properties;
+} __attribute__ ((packed));
+
 struct AdvData {
-    quint8 length;
-    quint8 data[31];
+    quint16 length;
+    quint16 capacity;
+    quint8 data[ExtendedAdvDataMaxLength];
 };
 
 struct WhiteListParams {
@@ -72,6 +121,26 @@ struct WhiteListParams {
     bdaddr_t addr;
 };
 
+// Advertising handles and SIDs are per-adapter resources shared by all controllers
+struct AdvertisingHandleRegistry {
+    QMutex mutex;
+    QHash<int, QSet<quint8>> usedHandles;
+    QHash<int, QList<int>> sidUsers; // number of our sets per SID
+};
+Q_GLOBAL_STATIC(AdvertisingHandleRegistry, advertisingHandleRegistry)
+
+static int takeAdvertisingHandle(QSet<quint8> &usedHandles)
+{
+    // The kernel numbers the advertising instances it manages for bluetoothd from the
+    // bottom of the range, so we allocate from the top.
+    for (int handle = MaxAdvertisingHandle; handle >= 0; --handle) {
+        if (!usedHandles.contains(handle)) {
+            usedHandles.insert(handle);
+            return handle;
+        }
+    }
+    return -1;
+}
 
 template<typename T> QByteArray byteArrayFromStruct(const T &data, int maxSize = -1)
 {
@@ -92,7 +161,26 @@ QLeAdvertiserBluez::~QLeAdvertiserBluez()
 {
     disconnect(&m_hciManager, &HciManager::commandCompleted, this,
                &QLeAdvertiserBluez::handleCommandCompleted);
-    doStopAdvertising();
+    if (m_advertisingHandle == -1) {
+        doStopAdvertising();
+        return;
+    }
+    if (!m_advertisingSetCreated) {
+        releaseAdvertisingHandle();
+        return;
+    }
+
+    // We will not see the command completions anymore, so send the teardown directly.
+    // The controller processes the commands in order.
+    m_pendingCommands.clear();
+    if (hasPeriodicAdvertising())
+        togglePeriodicAdvertising(false);
+    toggleExtendedAdvertising(false);
+    queueCommand(QBluezConst::OcfLeRemoveAdvSet, QByteArray(1, char(m_advertisingHandle)));
+    for (const Command &c : qAsConst(m_pendingCommands))
+        m_hciManager.sendCommand(QBluezConst::OgfLinkControl, c.ocf, c.data);
+    m_pendingCommands.clear();
+    releaseAdvertisingHandle();
 }
 
 void QLeAdvertiserBluez::doStartAdvertising()
@@ -104,19 +192,65 @@ void QLeAdvertiserBluez::doStartAdvertising()
 
     m_sendPowerLevel = advertisingData().includePowerLevel()
             || scanResponseData().includePowerLevel();
-    if (m_sendPowerLevel)
-        queueReadTxPowerLevelCommand();
-    else
-        queueAdvertisingCommands();
+    m_advertisingParamsRetried = false;
+    if (m_extendedSupport == ExtendedAdvertisingSupport::Unknown) {
+        // Spec v5.3, Vol 4, Part E, 7.8.58
+        // Controllers without extended advertising reject this command, in which case
+        // we stick to the legacy advertising commands.
+        queueCommand(QBluezConst::OcfLeReadNumberOfSupportedAdvSets, QByteArray());
+    } else {
+        if (m_extendedSupport == ExtendedAdvertisingSupport::Supported
+                && !allocateAdvertisingHandle()) {
+            qCWarning(QT_BT_BLUEZ) << "no free advertising handle";
+            handleError();
+            return;
+        }
+        queueStartCommands();
+    }
     sendNextCommand();
 }
 
 void QLeAdvertiserBluez::doStopAdvertising()
 {
-    toggleAdvertising(false);
+    if (m_extendedSupport == ExtendedAdvertisingSupport::Supported) {
+        if (m_advertisingSetCreated) {
+            if (hasPeriodicAdvertising())
+                togglePeriodicAdvertising(false);
+            toggleExtendedAdvertising(false);
+        }
+    } else {
+        toggleAdvertising(false);
+    }
     sendNextCommand();
 }
 
+void QLeAdvertiserBluez::doUpdateAdvertisingData(bool advDataChanged, bool responseDataChanged)
+{
+    // Still probing the controller; the start sequence will pick up the new data.
+    if (m_extendedSupport == ExtendedAdvertisingSupport::Unknown)
+        return;
+
+    const bool idle = m_pendingCommands.isEmpty();
+
+    if (m_extendedSupport == ExtendedAdvertisingSupport::Supported) {
+        if (extendedDataFitsCurrentSet()) {
+            queueExtendedDataCommands(advDataChanged, responseDataChanged);
+        } else {
+            // The new payload needs other advertising event properties or has to be
+            // fragmented, neither of which is possible while the set is enabled.
+            queueExtendedAdvertisingCommands();
+        }
+    } else {
+        if (advDataChanged)
+            setAdvertisingData();
+        if (responseDataChanged)
+            setScanResponseData();
+    }
+
+    if (idle)
+        sendNextCommand();
+}
+
 void QLeAdvertiserBluez::queueCommand(QBluezConst::OpCodeCommandField ocf, const QByteArray &data)
 {
     m_pendingCommands << Command(ocf, data);
@@ -135,6 +269,16 @@ void QLeAdvertiserBluez::sendNextCommand()
     }
 }
 
+void QLeAdvertiserBluez::queueStartCommands()
+{
+    if (m_extendedSupport == ExtendedAdvertisingSupport::Supported)
+        queueExtendedAdvertisingCommands();
+    else if (m_sendPowerLevel)
+        queueReadTxPowerLevelCommand();
+    else
+        queueAdvertisingCommands();
+}
+
 void QLeAdvertiserBluez::queueAdvertisingCommands()
 {
     toggleAdvertising(false); // Stop advertising first, in case it's currently active.
@@ -251,7 +395,8 @@ static void addServicesData(AdvData &data, const QList<T> &services)
 {
     if (services.isEmpty())
         return;
-    const int spaceAvailable = sizeof data.data - data.length;
+    // The length field of an AD structure is a single byte.
+    const int spaceAvailable = qMin(data.capacity - data.length, 1 + 0xff);
     const int maxServices = qMin<int>((spaceAvailable - 2) / sizeof(T), services.count());
     if (maxServices <= 0) {
         qCWarning(QT_BT_BLUEZ) << "services data does not fit into advertising data packet";
@@ -305,12 +450,13 @@ void QLeAdvertiserBluez::setManufacturerData(const QLowEnergyAdvertisingData &sr
 {
     if (src.manufacturerId() == QLowEnergyAdvertisingData::invalidManufacturerId())
         return;
-    if (dest.length >= sizeof dest.data - 1 - 1 - 2 - src.manufacturerData().count()) {
+    const int size = src.manufacturerData().count() + 1 + 2;
+    if (dest.length + 1 + size > dest.capacity || size > 0xff) {
         qCWarning(QT_BT_BLUEZ) << "manufacturer data does not fit into advertising data packet";
         return;
     }
 
-    dest.data[dest.length++] = src.manufacturerData().count() + 1 + 2;
+    dest.data[dest.length++] = size;
     dest.data[dest.length++] = 0xff;
     putBtData(src.manufacturerId(), dest.data + dest.length);
     dest.length += sizeof(quint16);
@@ -322,14 +468,14 @@ void QLeAdvertiserBluez::setLocalNameData(const QLowEnergyAdvertisingData &src,
 {
     if (src.localName().isEmpty())
         return;
-    if (dest.length >= sizeof dest.data - 3) {
+    if (dest.length >= dest.capacity - 3) {
         qCWarning(QT_BT_BLUEZ) << "local name does not fit into advertising data";
         return;
     }
 
     const QByteArray localNameUtf8 = src.localName().toUtf8();
     const int fullSize = localNameUtf8.count() + 1 + 1;
-    const int size = qMin<int>(fullSize, sizeof dest.data - dest.length);
+    const int size = qMin<int>(qMin(fullSize, 1 + 0xff), dest.capacity - dest.length);
     const bool isComplete = size == fullSize;
     dest.data[dest.length++] = size - 1;
     const int dataType = isComplete ? 0x9 : 0x8;
@@ -338,34 +484,40 @@ void QLeAdvertiserBluez::setLocalNameData(const QLowEnergyAdvertisingData &src,
     dest.length += size - 2;
 }
 
-void QLeAdvertiserBluez::setData(bool isScanResponseData)
+void QLeAdvertiserBluez::buildData(bool isScanResponseData, AdvData &dest)
 {
     // Spec v4.2, Vol 3, Part C, 11 and Supplement, Part 1
-    AdvData theData;
-    static_assert(sizeof theData == 32, "unexpected struct size");
-    theData.length = 0;
+    dest.length = 0;
 
     const QLowEnergyAdvertisingData &sourceData = isScanResponseData
             ? scanResponseData() : advertisingData();
 
     if (!sourceData.rawData().isEmpty()) {
-        theData.length = qMin<int>(sizeof theData.data, sourceData.rawData().count());
-        std::memcpy(theData.data, sourceData.rawData().constData(), theData.length);
+        dest.length = qMin<int>(dest.capacity, sourceData.rawData().count());
+        std::memcpy(dest.data, sourceData.rawData().constData(), dest.length);
     } else {
         if (sourceData.includePowerLevel())
-            setPowerLevel(theData);
+            setPowerLevel(dest);
         if (!isScanResponseData)
-            setFlags(theData);
+            setFlags(dest);
 
         // Insert new constant-length data here.
 
-        setLocalNameData(sourceData, theData);
-        setServicesData(sourceData, theData);
-        setManufacturerData(sourceData, theData);
+        setLocalNameData(sourceData, dest);
+        setServicesData(sourceData, dest);
+        setManufacturerData(sourceData, dest);
     }
+}
 
-    std::memset(theData.data + theData.length, 0, sizeof theData.data - theData.length);
-    const QByteArray dataToSend = byteArrayFromStruct(theData);
+void QLeAdvertiserBluez::setData(bool isScanResponseData)
+{
+    AdvData theData;
+    theData.capacity = LegacyAdvDataLength;
+    buildData(isScanResponseData, theData);
+
+    QByteArray dataToSend(1 + LegacyAdvDataLength, '\0');
+    dataToSend[0] = char(theData.length);
+    std::memcpy(dataToSend.data() + 1, theData.data, theData.length);
 
     if (!isScanResponseData) {
         qCDebug(QT_BT_BLUEZ) << "advertising data:" << dataToSend.toHex();
@@ -407,6 +559,273 @@ void QLeAdvertiserBluez::setWhiteList()
     }
 }
 
+bool QLeAdvertiserBluez::allocateAdvertisingHandle()
+{
+    if (m_advertisingHandle != -1)
+        return true;
+
+    AdvertisingHandleRegistry *registry = advertisingHandleRegistry();
+    QMutexLocker locker(&registry->mutex);
+    m_advertisingHandle = takeAdvertisingHandle(registry->usedHandles[m_hciManager.deviceId()]);
+    if (m_advertisingHandle == -1)
+        return false;
+
+    // Scanners tell sets apart by SID, so give each of our sets the least used one.
+    QList<int> &sidUsers = registry->sidUsers[m_hciManager.deviceId()];
+    if (sidUsers.isEmpty())
+        sidUsers.fill(0, AdvertisingSidCount);
+    m_advertisingSid = std::min_element(sidUsers.cbegin(), sidUsers.cend()) - sidUsers.cbegin();
+    ++sidUsers[m_advertisingSid];
+    return true;
+}
+
+bool QLeAdvertiserBluez::replaceAdvertisingHandle()
+{
+    // The current handle stays marked as used, so that no other advertiser in
+    // this process runs into the same set.
+    AdvertisingHandleRegistry *registry = advertisingHandleRegistry();
+    QMutexLocker locker(&registry->mutex);
+    m_advertisingHandle = takeAdvertisingHandle(registry->usedHandles[m_hciManager.deviceId()]);
+    if (m_advertisingHandle != -1)
+        return true;
+    --registry->sidUsers[m_hciManager.deviceId()][m_advertisingSid];
+    return false;
+}
+
+void QLeAdvertiserBluez::releaseAdvertisingHandle()
+{
+    if (m_advertisingHandle == -1)
+        return;
+
+    AdvertisingHandleRegistry *registry = advertisingHandleRegistry();
+    QMutexLocker locker(&registry->mutex);
+    registry->usedHandles[m_hciManager.deviceId()].remove(m_advertisingHandle);
+    --registry->sidUsers[m_hciManager.deviceId()][m_advertisingSid];
+    m_advertisingHandle = -1;
+}
+
+bool QLeAdvertiserBluez::hasPeriodicAdvertising() const
+{
+    return parameters().minimumPeriodicInterval() > 0
+            && parameters().mode() == QLowEnergyAdvertisingParameters::AdvNonConnInd;
+}
+
+void QLeAdvertiserBluez::queueExtendedAdvertisingCommands()
+{
+    // Legacy PDUs are understood by every scanner, so we only switch to extended PDUs
+    // if the payload or the requested features require it. The size of the TX power
+    // AD structure does not depend on its value, so the preliminary level is good enough.
+    AdvData advData;
+    advData.capacity = ExtendedAdvDataMaxLength;
+    buildData(false, advData);
+    AdvData responseData;
+    responseData.capacity = ExtendedAdvDataMaxLength;
+    buildData(true, responseData);
+    m_useLegacyPdus = advData.length <= LegacyAdvDataLength
+            && responseData.length <= LegacyAdvDataLength && !hasPeriodicAdvertising();
+
+    // Disable our set first, in case it's currently active. A handle we have not
+    // configured yet may belong to another process and must not be touched.
+    if (m_advertisingSetCreated) {
+        if (hasPeriodicAdvertising())
+            togglePeriodicAdvertising(false);
+        toggleExtendedAdvertising(false);
+    }
+    setWhiteList();
+    setExtendedAdvertisingParams();
+    // The remaining commands are queued once the controller has reported the selected
+    // TX power, see handleCommandCompleted().
+}
+
+void QLeAdvertiserBluez::queueExtendedDataCommands(bool includeAdvData,
+                                                   bool includeResponseData)
+{
+    const QLowEnergyAdvertisingParameters::Mode mode = parameters().mode();
+
+    AdvData advData;
+    advData.capacity = m_useLegacyPdus ? LegacyAdvDataLength : ExtendedAdvDataMaxLength;
+    buildData(false, advData);
+    if (!m_useLegacyPdus && mode == QLowEnergyAdvertisingParameters::AdvScanInd) {
+        // Spec v5.3, Vol 4, Part E, 7.8.54
+        if (advData.length > 0) {
+            qCWarning(QT_BT_BLUEZ) << "scannable extended advertising cannot carry advertising "
+                                      "data; only the scan response data is sent";
+        }
+    } else if (includeAdvData) {
+        // Spec v5.3, Vol 4, Part E, 7.8.54
+        queueExtendedData(QBluezConst::OcfLeSetExtAdvData, advData, ExtendedAdvFragmentLength);
+    }
+
+    AdvData responseData;
+    responseData.capacity = advData.capacity;
+    buildData(true, responseData);
+    const bool scannable = mode == QLowEnergyAdvertisingParameters::AdvScanInd
+            || (m_useLegacyPdus && mode == QLowEnergyAdvertisingParameters::AdvInd);
+    if (scannable && responseData.length > 0) {
+        if (includeResponseData) {
+            // Spec v5.3, Vol 4, Part E, 7.8.55
+            queueExtendedData(QBluezConst::OcfLeSetExtScanResponseData, responseData,
+                              ExtendedAdvFragmentLength);
+        }
+    } else if (responseData.length > 0 && includeResponseData) {
+        qCWarning(QT_BT_BLUEZ) << "scan response data is ignored for non-scannable "
+                                  "extended advertising";
+    }
+
+    if (hasPeriodicAdvertising() && includeAdvData) {
+        // Spec v5.3, Vol 4, Part E, 7.8.62
+        // The periodic advertising train carries the advertising data as well.
+        queueExtendedData(QBluezConst::OcfLeSetPeriodicAdvData, advData,
+                          PeriodicAdvFragmentLength);
+    }
+}
+
+void QLeAdvertiserBluez::queueExtendedData(QBluezConst::OpCodeCommandField ocf,
+                                           const AdvData &data, int maxFragmentLength)
+{
+    // Operation: 0x00 intermediate, 0x01 first, 0x02 last, 0x03 complete data
+    const bool periodic = ocf == QBluezConst::OcfLeSetPeriodicAdvData;
+    int offset = 0;
+    do {
+        const int fragmentLength = qMin(maxFragmentLength, data.length - offset);
+        const bool first = offset == 0;
+        const bool last = offset + fragmentLength == data.length;
+        quint8 operation = 0x00;
+        if (first && last)
+            operation = 0x03;
+        else if (first)
+            operation = 0x01;
+        else if (last)
+            operation = 0x02;
+
+        QByteArray fragment;
+        fragment.reserve(4 + fragmentLength);
+        fragment.append(char(m_advertisingHandle));
+        fragment.append(char(operation));
+        if (!periodic)
+            fragment.append(char(0x01)); // Controller should not fragment
+        fragment.append(char(fragmentLength));
+        fragment.append(reinterpret_cast<const char *>(data.data) + offset, fragmentLength);
+        qCDebug(QT_BT_BLUEZ) << "extended advertising data fragment" << ocf
+                             << fragment.toHex();
+        queueCommand(ocf, fragment);
+        offset += fragmentLength;
+    } while (offset < data.length);
+}
+
+static void putInterval24(quint32 value, quint8 *dest)
+{
+    dest[0] = value & 0xff;
+    dest[1] = (value >> 8) & 0xff;
+    dest[2] = (value >> 16) & 0xff;
+}
+
+void QLeAdvertiserBluez::setExtendedAdvertisingParams()
+{
+    // Spec v5.3, Vol 4, Part E, 7.8.53
+    ExtAdvParams params;
+    static_assert(sizeof params == 25, "unexpected struct size");
+    std::memset(&params, 0, sizeof params);
+    params.handle = m_advertisingHandle;
+
+    quint16 properties = 0;
+    switch (parameters().mode()) {
+    case QLowEnergyAdvertisingParameters::AdvInd:
+        properties = m_useLegacyPdus ? 0x03 : 0x01; // connectable (and scannable)
+        break;
+    case QLowEnergyAdvertisingParameters::AdvScanInd:
+        properties = 0x02; // scannable
+        break;
+    case QLowEnergyAdvertisingParameters::AdvNonConnInd:
+        break;
+    }
+    if (m_useLegacyPdus)
+        properties |= 0x10;
+    else if (m_sendPowerLevel)
+        properties |= 0x40; // include TX power in the extended header
+    params.properties = qToLittleEndian(properties);
+
+    // The 5.0 spec relaxed the interval minimum of non-connectable advertising.
+    const double multiplier = 0.625;
+    const quint32 specMinimum = 0x20;
+    const quint32 minVal = qMax<quint32>(parameters().minimumInterval() / multiplier, specMinimum);
+    const quint32 maxVal = qMax<quint32>(parameters().maximumInterval() / multiplier, minVal);
+    putInterval24(minVal, params.minInterval);
+    putInterval24(maxVal, params.maxInterval);
+
+    params.channelMap = 0x7; // All channels.
+    params.ownAddrType = QLowEnergyController::PublicAddress;
+    params.filterPolicy = parameters().filterPolicy();
+    if (params.filterPolicy != QLowEnergyAdvertisingParameters::IgnoreWhiteList
+            && advertisingData().discoverability() == QLowEnergyAdvertisingData::DiscoverabilityLimited) {
+        qCWarning(QT_BT_BLUEZ) << "limited discoverability is incompatible with "
+                                  "using a white list; disabling filtering";
+        params.filterPolicy = QLowEnergyAdvertisingParameters::IgnoreWhiteList;
+    }
+    params.txPower = parameters().txPowerLevel();
+    params.primaryPhy = 0x01; // LE 1M
+    params.secondaryPhy = 0x01; // LE 1M
+    params.sid = m_advertisingSid;
+
+    const QByteArray paramsData = byteArrayFromStruct(params);
+    qCDebug(QT_BT_BLUEZ) << "extended advertising parameters:" << paramsData.toHex();
+    queueCommand(QBluezConst::OcfLeSetExtAdvParams, paramsData);
+}
+
+void QLeAdvertiserBluez::toggleExtendedAdvertising(bool enable)
+{
+    // Spec v5.3, Vol 4, Part E, 7.8.56
+    ExtAdvEnable command;
+    static_assert(sizeof command == 6, "unexpected struct size");
+    command.enable = enable;
+    command.numberOfSets = 1;
+    command.handle = m_advertisingHandle;
+    command.duration = 0; // until disabled
+    command.maxEvents = 0; // no limit
+    queueCommand(QBluezConst::OcfLeSetExtAdvEnable, byteArrayFromStruct(command));
+}
+
+void QLeAdvertiserBluez::setPeriodicAdvertisingParams()
+{
+    // Spec v5.3, Vol 4, Part E, 7.8.61
+    PeriodicAdvParams params;
+    static_assert(sizeof params == 7, "unexpected struct size");
+    const double multiplier = 1.25;
+    const quint16 specMinimum = 0x6;
+    const quint16 minVal = qMax<int>(parameters().minimumPeriodicInterval() / multiplier,
+                                     specMinimum);
+    const quint16 maxVal = qMax<int>(parameters().maximumPeriodicInterval() / multiplier,
+                                     minVal);
+    params.handle = m_advertisingHandle;
+    params.minInterval = qToLittleEndian(minVal);
+    params.maxInterval = qToLittleEndian(maxVal);
+    params.properties = qToLittleEndian<quint16>(m_sendPowerLevel ? 0x40 : 0x00);
+    queueCommand(QBluezConst::OcfLeSetPeriodicAdvParams, byteArrayFromStruct(params));
+}
+
+void QLeAdvertiserBluez::togglePeriodicAdvertising(bool enable)
+{
+    // Spec v5.3, Vol 4, Part E, 7.8.63
+    QByteArray command(2, '\0');
+    command[0] = enable;
+    command[1] = char(m_advertisingHandle);
+    queueCommand(QBluezConst::OcfLeSetPeriodicAdvEnable, command);
+}
+
+bool QLeAdvertiserBluez::extendedDataFitsCurrentSet()
+{
+    // Data of an enabled set can only be replaced as a whole, and a switch between
+    // legacy and extended PDUs needs new parameters.
+    const int maxLength = m_useLegacyPdus ? LegacyAdvDataLength : ExtendedAdvFragmentLength;
+    AdvData data;
+    data.capacity = ExtendedAdvDataMaxLength;
+    buildData(false, data);
+    if (data.length > maxLength)
+        return false;
+    buildData(true, data);
+    return data.length <= maxLength;
+}
+
 void QLeAdvertiserBluez::handleCommandCompleted(quint16 opCode, quint8 status,
                                                 const QByteArray &data)
 {
@@ -429,6 +848,45 @@ void QLeAdvertiserBluez::handleCommandCompleted(quint16 opCode, quint8 status,
             sendNextCommand();
             return;
         }
+        if ((ocf == QBluezConst::OcfLeSetExtAdvEnable || ocf == QBluezConst::OcfLeSetPeriodicAdvEnable)
+                && currentCmd.data.at(0) == '\0') {
+            // Disabling a set that was never created (0x42, unknown advertising identifier)
+            // or that is not enabled is not an error for us.
+            qCDebug(QT_BT_BLUEZ) << "Advertising set disable failed, ignoring";
+            sendNextCommand();
+            return;
+        }
+        if (ocf == QBluezConst::OcfLeSetExtAdvParams
+                && status == quint8(HciManager::HciError::HCI_COMMAND_DISALLOWED)) {
+            if (m_advertisingSetCreated && !m_advertisingParamsRetried) {
+                // Our own set is still enabled, as the controller refused to disable it.
+                qCDebug(QT_BT_BLUEZ) << "advertising set" << m_advertisingHandle
+                                     << "is still enabled, disabling it again";
+                m_advertisingParamsRetried = true;
+                m_pendingCommands.clear();
+                queueExtendedAdvertisingCommands();
+                sendNextCommand();
+                return;
+            }
+            if (!m_advertisingSetCreated) {
+                // Another process has an enabled set with this handle. Other handles could
+                // belong to disabled sets of that process, so we don't try them on our own.
+                // The next start uses a handle that no advertiser of this process has
+                // run into yet.
+                qCWarning(QT_BT_BLUEZ) << "advertising handle" << m_advertisingHandle
+                                       << "is used by another process";
+                replaceAdvertisingHandle();
+            }
+            handleError();
+            return;
+        }
+        if (ocf == QBluezConst::OcfLeReadNumberOfSupportedAdvSets) {
+            qCDebug(QT_BT_BLUEZ) << "extended advertising not supported, using legacy commands";
+            m_extendedSupport = ExtendedAdvertisingSupport::NotSupported;
+            queueStartCommands();
+            sendNextCommand();
+            return;
+        }
         if (ocf == QBluezConst::OcfLeReadTxPowerLevel) {
             qCDebug(QT_BT_BLUEZ) << "reading power level failed, leaving it out of the "
                                     "advertising data";
@@ -449,6 +907,32 @@ void QLeAdvertiserBluez::handleCommandCompleted(quint16 opCode, quint8 status,
         }
         queueAdvertisingCommands();
         break;
+    case QBluezConst::OcfLeReadNumberOfSupportedAdvSets:
+        qCDebug(QT_BT_BLUEZ) << "controller supports"
+                             << (data.isEmpty() ? 0 : quint8(data.at(0))) << "advertising sets";
+        if (!allocateAdvertisingHandle()) {
+            qCWarning(QT_BT_BLUEZ) << "no free advertising handle";
+            handleError();
+            return;
+        }
+        m_extendedSupport = ExtendedAdvertisingSupport::Supported;
+        queueStartCommands();
+        break;
+    case QBluezConst::OcfLeSetExtAdvParams:
+        m_advertisingSetCreated = true;
+        m_advertisingParamsRetried = false;
+        // The return parameter is the TX power selected by the controller.
+        if (m_sendPowerLevel && !data.isEmpty()) {
+            m_powerLevel = data.at(0);
+            qCDebug(QT_BT_BLUEZ) << "TX power level is" << qint8(m_powerLevel);
+        }
+        if (hasPeriodicAdvertising())
+            setPeriodicAdvertisingParams();
+        queueExtendedDataCommands();
+        if (hasPeriodicAdvertising())
+            togglePeriodicAdvertising(true);
+        toggleExtendedAdvertising(true);
+        break;
     default:
         break;
     }
@@ -63,13 +63,27 @@
 
 QT_BEGIN_NAMESPACE
 
-class QLeAdvertiser : public QObject
+class Q_AUTOTEST_EXPORT QLeAdvertiser : public QObject
 {
     Q_OBJECT
 public:
     void startAdvertising() { doStartAdvertising(); }
     void stopAdvertising() { doStopAdvertising(); }
 
+    // Replaces the payload of a running advertisement without restarting it.
+    // Only the parts that differ from the current payload are sent.
+    void updateAdvertisingData(const QLowEnergyAdvertisingData &advData,
+                               const QLowEnergyAdvertisingData &responseData)
+    {
+        const bool advDataChanged = advData != m_advData;
+        const bool responseDataChanged = responseData != m_responseData;
+        if (!advDataChanged && !responseDataChanged)
+            return;
+        m_advData = advData;
+        m_responseData = responseData;
+        doUpdateAdvertisingData(advDataChanged, responseDataChanged);
+    }
+
 signals:
     void errorOccurred();
 
@@ -88,10 +102,11 @@ protected:
 private:
     virtual void doStartAdvertising() = 0;
     virtual void doStopAdvertising() = 0;
+    virtual void doUpdateAdvertisingData(bool advDataChanged, bool responseDataChanged) = 0;
 
     const QLowEnergyAdvertisingParameters m_params;
-    const QLowEnergyAdvertisingData m_advData;
-    const QLowEnergyAdvertisingData m_responseData;
+    QLowEnergyAdvertisingData m_advData;
+    QLowEnergyAdvertisingData m_responseData;
 };
 
 
@@ -100,7 +115,7 @@ struct AdvData;
 struct AdvParams;
 class HciManager;
 
-class QLeAdvertiserBluez : public QLeAdvertiser
+class Q_AUTOTEST_EXPORT QLeAdvertiserBluez : public QLeAdvertiser
 {
 public:
     QLeAdvertiserBluez(const QLowEnergyAdvertisingParameters &params,
@@ -112,6 +127,7 @@ public:
 private:
     void doStartAdvertising() override;
     void doStopAdvertising() override;
+    void doUpdateAdvertisingData(bool advDataChanged, bool responseDataChanged) override;
 
     void setPowerLevel(AdvData &advData);
     void setFlags(AdvData &advData);
@@ -121,16 +137,33 @@ private:
 
     void queueCommand(QBluezConst::OpCodeCommandField ocf, const QByteArray &advertisingData);
     void sendNextCommand();
+    void queueStartCommands();
     void queueAdvertisingCommands();
     void queueReadTxPowerLevelCommand();
     void toggleAdvertising(bool enable);
     void setAdvertisingParams();
     void setAdvertisingInterval(AdvParams &params);
+    void buildData(bool isScanResponseData, AdvData &dest);
     void setData(bool isScanResponseData);
     void setAdvertisingData();
     void setScanResponseData();
     void setWhiteList();
 
+    // LE Extended Advertising (Bluetooth 5.0 and later)
+    bool allocateAdvertisingHandle();
+    bool replaceAdvertisingHandle();
+    void releaseAdvertisingHandle();
+    void queueExtendedAdvertisingCommands();
+    void queueExtendedDataCommands(bool includeAdvData = true, bool includeResponseData = true);
+    void queueExtendedData(QBluezConst::OpCodeCommandField ocf, const AdvData &data,
+                           int maxFragmentLength);
+    void setExtendedAdvertisingParams();
+    void toggleExtendedAdvertising(bool enable);
+    void setPeriodicAdvertisingParams();
+    void togglePeriodicAdvertising(bool enable);
+    bool hasPeriodicAdvertising() const;
+    bool extendedDataFitsCurrentSet();
+
     void handleCommandCompleted(quint16 opCode, quint8 status, const QByteArray &advertisingData);
     void handleError();
 
@@ -144,8 +177,16 @@ private:
     };
     QList<Command> m_pendingCommands;
 
-    quint8 m_powerLevel;
-    bool m_sendPowerLevel;
+    enum class ExtendedAdvertisingSupport { Unknown, Supported, NotSupported };
+    ExtendedAdvertisingSupport m_extendedSupport = ExtendedAdvertisingSupport::Unknown;
+    int m_advertisingHandle = -1;
+    int m_advertisingSid = 0;
+    bool m_advertisingSetCreated = false;
+    bool m_advertisingParamsRetried = false;
+    bool m_useLegacyPdus = true;
+
+    quint8 m_powerLevel = 0;
+    bool m_sendPowerLevel = false;
 };
 #endif // QT_CONFIG(bluez)
 
@@ -78,6 +78,8 @@ public:
           bytes. If the variable-length data set via this class exceeds that limit, it will
           be left out of the packet or truncated, depending on the type.
           On Android, advertising will fail if advertising data is larger than 31 bytes.
+          On Linux, the limit is 1650 bytes if the local controller supports
+          LE Extended Advertising.
 
     \sa QLowEnergyAdvertisingParameters
     \sa QLowEnergyController::startAdvertising()
@@ -242,8 +244,8 @@ QList<QBluetoothUuid> QLowEnergyAdvertisingData::services() const
   Sets the data to be advertised to \a data. If the value is not an empty byte array, it will
   be sent as-is as the advertising data and all other data in this object will be ignored.
   This can be used to send non-standard data.
-  \note If \a data is longer than 31 bytes, it will be truncated. It is the caller's responsibility
-        to ensure that \a data is well-formed.
+  \note If \a data is longer than the maximum payload size, it will be truncated. It is the
+        caller's responsibility to ensure that \a data is well-formed.
  */
 void QLowEnergyAdvertisingData::setRawData(const QByteArray &data)
 {
@@ -41,6 +41,9 @@
 
 QT_BEGIN_NAMESPACE
 
+// Spec v5.3, Vol 4, Part E, 7.8.53: the host has no preference
+static const int NoTxPowerPreference = 127;
+
 class QLowEnergyAdvertisingParametersPrivate : public QSharedData
 {
 public:
@@ -49,6 +52,9 @@ public:
         , mode(QLowEnergyAdvertisingParameters::AdvInd)
         , minInterval(1280)
         , maxInterval(1280)
+        , txPowerLevel(NoTxPowerPreference)
+        , minPeriodicInterval(0)
+        , maxPeriodicInterval(0)
     {
     }
 
@@ -57,6 +63,9 @@ public:
     QLowEnergyAdvertisingParameters::Mode mode;
     int minInterval;
     int maxInterval;
+    int txPowerLevel;
+    int minPeriodicInterval;
+    int maxPeriodicInterval;
 };
 
 /*!
@@ -72,6 +81,13 @@ public:
     These parameters are set via this class, and their values will be used when advertising
     is started by calling \l QLowEnergyController::startAdvertising().
 
+    On Linux, controllers supporting the Bluetooth 5 LE Extended Advertising feature are
+    driven through the extended advertising commands. Each advertising
+    \l QLowEnergyController then owns a separate advertising set, so several controller
+    objects for the same local adapter can advertise concurrently, each with its own
+    interval, TX power and payload. Payloads longer than 31 bytes, up to 1650 bytes,
+    are sent in extended advertising PDUs.
+
     \sa QLowEnergyAdvertisingData
     \sa QLowEnergyController::startAdvertising()
 */
@@ -263,6 +279,73 @@ int QLowEnergyAdvertisingParameters::maximumInterval() const
     return d->maxInterval;
 }
 
+/*!
+   \since 6.4
+
+   Sets the requested transmit power for the advertising set to \a level, in dBm.
+   The controller may choose a lower power level. Valid values are between -127
+   and 20; the special value 127 means that the host has no preference, which is the
+   default.
+
+   \note This value is only honored on platforms and controllers supporting
+   LE Extended Advertising.
+ */
+void QLowEnergyAdvertisingParameters::setTxPowerLevel(int level)
+{
+    d->txPowerLevel = (level == NoTxPowerPreference) ? level : qBound(-127, level, 20);
+}
+
+/*!
+   \since 6.4
+
+   Returns the requested transmit power in dBm. The default is 127, meaning
+   that the host has no preference.
+ */
+int QLowEnergyAdvertisingParameters::txPowerLevel() const
+{
+    return d->txPowerLevel;
+}
+
+/*!
+   \since 6.4
+
+   Sets the interval of the periodic advertising train. Both \a minimum and \a maximum
+   are given in milliseconds. If \a maximum is smaller than \a minimum, it will be set to
+   the value of \a minimum. A \a minimum of \c 0 disables periodic advertising, which is
+   the default.
+
+   Periodic advertising is only available in the
+   \l QLowEnergyAdvertisingParameters::AdvNonConnInd mode and requires LE Extended
+   Advertising support. The periodic advertising train carries the advertising data.
+ */
+void QLowEnergyAdvertisingParameters::setPeriodicInterval(quint16 minimum, quint16 maximum)
+{
+    d->minPeriodicInterval = minimum;
+    d->maxPeriodicInterval = minimum ? qMax(minimum, maximum) : 0;
+}
+
+/*!
+   \since 6.4
+
+   Returns the minimum periodic advertising interval in milliseconds. The default is 0,
+   meaning periodic advertising is disabled.
+ */
+int QLowEnergyAdvertisingParameters::minimumPeriodicInterval() const
+{
+    return d->minPeriodicInterval;
+}
+
+/*!
+   \since 6.4
+
+   Returns the maximum periodic advertising interval in milliseconds. The default is 0,
+   meaning periodic advertising is disabled.
+ */
+int QLowEnergyAdvertisingParameters::maximumPeriodicInterval() const
+{
+    return d->maxPeriodicInterval;
+}
+
 /*!
    \fn void QLowEnergyAdvertisingParameters::swap(QLowEnergyAdvertisingParameters &other)
    Swaps this object with \a other.
@@ -280,7 +363,9 @@ bool QLowEnergyAdvertisingParameters::equals(const QLowEnergyAdvertisingParamete
         return true;
     return a.filterPolicy() == b.filterPolicy() && a.minimumInterval() == b.minimumInterval()
             && a.maximumInterval() == b.maximumInterval() && a.mode() == b.mode()
-            && a.whiteList() == b.whiteList();
+            && a.whiteList() == b.whiteList() && a.txPowerLevel() == b.txPowerLevel()
+            && a.minimumPeriodicInterval() == b.minimumPeriodicInterval()
+            && a.maximumPeriodicInterval() == b.maximumPeriodicInterval();
 }
 
 bool QLowEnergyAdvertisingParameters::AddressInfo::equals(
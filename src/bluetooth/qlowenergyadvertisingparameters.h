@@ -104,6 +104,13 @@ public:
     int minimumInterval() const;
     int maximumInterval() const;
 
+    void setTxPowerLevel(int level);
+    int txPowerLevel() const;
+
+    void setPeriodicInterval(quint16 minimum, quint16 maximum);
+    int minimumPeriodicInterval() const;
+    int maximumPeriodicInterval() const;
+
     // TODO: own address type
     // TODO: For ADV_DIRECT_IND: peer address + peer address type
 
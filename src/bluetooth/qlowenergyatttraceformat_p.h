@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QLOWENERGYATTTRACEFORMAT_P_H
+#define QLOWENERGYATTTRACEFORMAT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+// ATT trace file format written by QLowEnergyAttTracer. Only depends on
+// QtCore so that src/tools/atttrace2btsnoop can share it.
+//
+// Trace file layout, all integers are little endian:
+//   header: 8 byte FileMagic, quint32 FileVersion
+//   record: quint16 size (including the record header), quint8 Event,
+//           quint8 reserved, quint32 bearer id, qint64 time in ns since
+//           the epoch, quint32 arg0, quint32 arg1, PDU bytes
+struct QLowEnergyAttTraceFormat
+{
+    enum Event : quint8 {
+        SendPdu = 1,                // data: PDU
+        ReceivePdu,                 // data: PDU
+        EnqueueRequest,             // arg0: opcode, arg1: queue size | PrependedFlag
+        DequeueRequest,             // arg0: opcode, arg1: queue size
+        RequestTimeout,             // arg0: opcode
+        EncryptionChangeRequested,  // arg0: ATT error, arg1: requested security level
+        EncryptionChanged,          // arg0: success, arg1: security level
+        MtuExchanged                // arg0: MTU
+    };
+
+    static constexpr char FileMagic[8] = { 'Q', 'T', 'A', 'T', 'T', 'T', 'R', 'C' };
+    static constexpr quint32 FileVersion = 1;
+    static constexpr qsizetype FileHeaderSize = 12;
+    static constexpr qsizetype RecordHeaderSize = 24;
+    static constexpr quint32 PrependedFlag = 0x80000000;
+};
+
+QT_END_NAMESPACE
+
+#endif // QLOWENERGYATTTRACEFORMAT_P_H
@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qlowenergyatttracer_p.h"
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QFile>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/qendian.h>
+
+#include <chrono>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_BT)
+
+static QAtomicInteger<quint32> nextBearerId = 1;
+
+QLowEnergyAttTracer::QLowEnergyAttTracer()
+    : id(nextBearerId.fetchAndAddRelaxed(1))
+{
+}
+
+void QLowEnergyAttTracer::setEnabled(bool enable, qsizetype capacity)
+{
+    enabled = enable;
+    if (!enable) {
+        clear();
+        ring = QByteArray();
+        return;
+    }
+
+    capacity = qMax(capacity, RecordHeaderSize);
+    if (ring.size() != capacity) {
+        ring = QByteArray(capacity, Qt::Uninitialized);
+        clear();
+    }
+}
+
+void QLowEnergyAttTracer::clear()
+{
+    head = 0;
+    used = 0;
+    dropped = 0;
+}
+
+qsizetype QLowEnergyAttTracer::recordSizeAt(qsizetype position) const
+{
+    // the size field may wrap around the end of the ring
+    const uchar low = uchar(ring.at(position));
+    const uchar high = uchar(ring.at((position + 1) % ring.size()));
+    return qsizetype(low | (high << 8));
+}
+
+void QLowEnergyAttTracer::write(const char *data, qsizetype length)
+{
+    const qsizetype tail = (head + used) % ring.size();
+    const qsizetype first = qMin(length, ring.size() - tail);
+    memcpy(ring.data() + tail, data, size_t(first));
+    memcpy(ring.data(), data + first, size_t(length - first));
+    used += length;
+}
+
+void QLowEnergyAttTracer::record(Event event, quint32 arg0, quint32 arg1, const QByteArray &data)
+{
+    // ATT PDUs are at most 517 bytes, the limit only guards the size field
+    const qsizetype payloadSize = qMin(data.size(), qsizetype(0xffff) - RecordHeaderSize);
+    const qsizetype recordSize = RecordHeaderSize + payloadSize;
+    if (recordSize > ring.size()) {
+        ++dropped;
+        return;
+    }
+
+    while (ring.size() - used < recordSize) {
+        const qsizetype oldest = recordSizeAt(head);
+        head = (head + oldest) % ring.size();
+        used -= oldest;
+        ++dropped;
+    }
+
+    const qint64 time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+
+    char header[RecordHeaderSize];
+    qToLittleEndian<quint16>(quint16(recordSize), header);
+    header[2] = char(event);
+    header[3] = 0;
+    qToLittleEndian<quint32>(id, header + 4);
+    qToLittleEndian<qint64>(time, header + 8);
+    qToLittleEndian<quint32>(arg0, header + 16);
+    qToLittleEndian<quint32>(arg1, header + 20);
+
+    write(header, RecordHeaderSize);
+    if (payloadSize)
+        write(data.constData(), payloadSize);
+}
+
+QByteArray QLowEnergyAttTracer::records() const
+{
+    if (!used)
+        return QByteArray();
+
+    const qsizetype first = qMin(used, ring.size() - head);
+    QByteArray result = ring.mid(head, first);
+    result.append(ring.constData(), used - first);
+    return result;
+}
+
+bool QLowEnergyAttTracer::appendToFile(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qCWarning(QT_BT) << "Cannot open ATT trace file" << fileName << file.errorString();
+        return false;
+    }
+
+    if (file.size() == 0) {
+        char header[FileHeaderSize];
+        memcpy(header, FileMagic, sizeof(FileMagic));
+        qToLittleEndian<quint32>(FileVersion, header + sizeof(FileMagic));
+        file.write(header, FileHeaderSize);
+    }
+
+    const QByteArray data = records();
+    return file.write(data) == data.size();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QLOWENERGYATTTRACER_P_H
+#define QLOWENERGYATTTRACER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtBluetooth/private/qtbluetoothglobal_p.h>
+#include <QtCore/QByteArray>
+
+#include "qlowenergyatttraceformat_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QString;
+
+// Binary ring buffer trace of an ATT bearer. Tracepoints store fixed
+// binary records, nothing is formatted while tracing. A disabled tracer
+// costs one branch per tracepoint. The oldest records are overwritten
+// once the ring is full.
+//
+// appendToFile() writes the format described in QLowEnergyAttTraceFormat.
+class Q_BLUETOOTH_PRIVATE_EXPORT QLowEnergyAttTracer : public QLowEnergyAttTraceFormat
+{
+public:
+    static constexpr qsizetype DefaultCapacity = 1024 * 1024;
+
+    QLowEnergyAttTracer();
+
+    bool isEnabled() const { return enabled; }
+    void setEnabled(bool enable, qsizetype capacity = DefaultCapacity);
+    quint32 bearerId() const { return id; }
+
+    inline void trace(Event event, quint32 arg0 = 0, quint32 arg1 = 0,
+                      const QByteArray &data = QByteArray())
+    {
+        if (Q_UNLIKELY(enabled))
+            record(event, arg0, arg1, data);
+    }
+
+    // the records currently in the ring, oldest first
+    QByteArray records() const;
+    qsizetype size() const { return used; }
+    quint64 droppedCount() const { return dropped; }
+    void clear();
+
+    // appends the records to fileName, writing the file header if needed
+    bool appendToFile(const QString &fileName) const;
+
+private:
+    void record(Event event, quint32 arg0, quint32 arg1, const QByteArray &data);
+    void write(const char *data, qsizetype length);
+    qsizetype recordSizeAt(qsizetype position) const;
+
+    QByteArray ring;
+    qsizetype head = 0;
+    qsizetype used = 0;
+    quint64 dropped = 0;
+    quint32 id;
+    bool enabled = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QLOWENERGYATTTRACER_P_H
@@ -171,11 +171,14 @@ QString QLowEnergyCharacteristic::name() const
 */
 QBluetoothUuid QLowEnergyCharacteristic::uuid() const
 {
-    if (d_ptr.isNull() || !data
-        || !d_ptr->characteristicList.contains(data->handle))
+    if (d_ptr.isNull() || !data)
+        return QBluetoothUuid();
+
+    const auto charIt = d_ptr->characteristicList.constFind(data->handle);
+    if (charIt == d_ptr->characteristicList.constEnd())
         return QBluetoothUuid();
 
-    return d_ptr->characteristicList[data->handle].uuid;
+    return charIt->uuid;
 }
 
 /*!
@@ -185,11 +188,14 @@ QBluetoothUuid QLowEnergyCharacteristic::uuid() const
 */
 QLowEnergyCharacteristic::PropertyTypes QLowEnergyCharacteristic::properties() const
 {
-    if (d_ptr.isNull() || !data
-        || !d_ptr->characteristicList.contains(data->handle))
+    if (d_ptr.isNull() || !data)
         return QLowEnergyCharacteristic::Unknown;
 
-    return d_ptr->characteristicList[data->handle].properties;
+    const auto charIt = d_ptr->characteristicList.constFind(data->handle);
+    if (charIt == d_ptr->characteristicList.constEnd())
+        return QLowEnergyCharacteristic::Unknown;
+
+    return charIt->properties;
 }
 
 /*!
@@ -211,11 +217,14 @@ QLowEnergyCharacteristic::PropertyTypes QLowEnergyCharacteristic::properties() c
 */
 QByteArray QLowEnergyCharacteristic::value() const
 {
-    if (d_ptr.isNull() || !data
-        || !d_ptr->characteristicList.contains(data->handle))
+    if (d_ptr.isNull() || !data)
+        return QByteArray();
+
+    const auto charIt = d_ptr->characteristicList.constFind(data->handle);
+    if (charIt == d_ptr->characteristicList.constEnd())
         return QByteArray();
 
-    return d_ptr->characteristicList[data->handle].value;
+    return charIt->value;
 }
 
 /*!
@@ -230,11 +239,14 @@ QByteArray QLowEnergyCharacteristic::value() const
 */
 QLowEnergyHandle QLowEnergyCharacteristic::handle() const
 {
-    if (d_ptr.isNull() || !data
-        || !d_ptr->characteristicList.contains(data->handle))
+    if (d_ptr.isNull() || !data)
+        return 0;
+
+    const auto charIt = d_ptr->characteristicList.constFind(data->handle);
+    if (charIt == d_ptr->characteristicList.constEnd())
         return 0;
 
-    return d_ptr->characteristicList[data->handle].valueHandle;
+    return charIt->valueHandle;
 }
 
 /*!
@@ -364,14 +376,9 @@ QLowEnergyDescriptor QLowEnergyCharacteristic::descriptor(const QBluetoothUuid &
     if (charIt != d_ptr->characteristicList.constEnd()) {
         const QLowEnergyServicePrivate::CharData &charDetails = charIt.value();
 
-        DescriptorDataMap::const_iterator descIt = charDetails.descriptorList.constBegin();
-        for ( ; descIt != charDetails.descriptorList.constEnd(); ++descIt) {
-            const QLowEnergyHandle descHandle = descIt.key();
-            const QLowEnergyServicePrivate::DescData &descDetails = descIt.value();
-
-            if (descDetails.uuid == uuid)
-                return QLowEnergyDescriptor(d_ptr, data->handle, descHandle);
-        }
+        DescriptorDataMap::const_iterator descIt = charDetails.descriptorList.findByUuid(uuid);
+        if (descIt != charDetails.descriptorList.constEnd())
+            return QLowEnergyDescriptor(d_ptr, data->handle, descIt.key());
     }
 
     return QLowEnergyDescriptor();
@@ -441,19 +448,18 @@ QList<QLowEnergyDescriptor> QLowEnergyCharacteristic::descriptors() const
 {
     QList<QLowEnergyDescriptor> result;
 
-    if (d_ptr.isNull() || !data
-                       || !d_ptr->characteristicList.contains(data->handle))
+    if (d_ptr.isNull() || !data)
         return result;
 
-    QList<QLowEnergyHandle> descriptorKeys = d_ptr->characteristicList[data->handle].
-                                                    descriptorList.keys();
-
-    std::sort(descriptorKeys.begin(), descriptorKeys.end());
+    const auto charIt = d_ptr->characteristicList.constFind(data->handle);
+    if (charIt == d_ptr->characteristicList.constEnd())
+        return result;
 
-    for (const QLowEnergyHandle descHandle : qAsConst(descriptorKeys)) {
-        QLowEnergyDescriptor descriptor(d_ptr, data->handle, descHandle);
-        result.append(descriptor);
-    }
+    // the descriptor list is sorted by handle
+    const DescriptorDataMap &descriptorList = charIt->descriptorList;
+    result.reserve(descriptorList.size());
+    for (auto descIt = descriptorList.constBegin(); descIt != descriptorList.constEnd(); ++descIt)
+        result.append(QLowEnergyDescriptor(d_ptr, data->handle, descIt.key()));
 
     return result;
 }
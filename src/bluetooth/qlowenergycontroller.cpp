@@ -290,6 +290,27 @@ Q_DECLARE_LOGGING_CATEGORY(QT_BT_WINDOWS)
     \sa discoverServices(), error()
 */
 
+/*!
+    \fn void QLowEnergyController::serviceDetailsDiscovered(const QBluetoothUuid &service)
+    \since 6.4
+
+    This signal is emitted by \l discoverAllServiceDetails() each time the details
+    of \a service have been discovered. The service is in the
+    \l QLowEnergyService::RemoteServiceDiscovered state at this point.
+
+    \sa allServiceDetailsDiscovered()
+*/
+
+/*!
+    \fn void QLowEnergyController::allServiceDetailsDiscovered()
+    \since 6.4
+
+    This signal is emitted when \l discoverAllServiceDetails() has finished
+    with all services. It is not emitted if the connection is lost.
+
+    \sa serviceDetailsDiscovered()
+*/
+
 /*!
     \fn void QLowEnergyController::connectionUpdated(const QLowEnergyConnectionParameters &newParameters)
 
@@ -479,6 +500,20 @@ QLowEnergyController::QLowEnergyController(const QBluetoothAddress &localDevice,
     d->init();
 }
 
+/*!
+    \internal
+
+    Wraps the already configured backend \a d. Unlike the other constructors
+    this does not call QLowEnergyControllerPrivate::init(), so no local
+    adapter is required.
+ */
+QLowEnergyController::QLowEnergyController(QLowEnergyControllerPrivate *d, QObject *parent)
+    : QObject(parent), d_ptr(d)
+{
+    registerQLowEnergyControllerMetaType();
+    d->q_ptr = this;
+}
+
 /*!
     Destroys the QLowEnergyController instance.
  */
@@ -681,6 +716,41 @@ void QLowEnergyController::discoverServices()
     d->discoverServices();
 }
 
+/*!
+    \since 6.4
+
+    Discovers the details of all services found by \l discoverServices() which
+    are still in the \l QLowEnergyService::RemoteService state, as if
+    \l QLowEnergyService::discoverDetails() was called with \a mode for each
+    of them.
+
+    The progress is reported per service via the \l serviceDetailsDiscovered()
+    signal and the state changes of the service objects. The
+    \l allServiceDetailsDiscovered() signal is emitted once all services are done.
+
+    On Linux with BlueZ, the characteristics, descriptors and values of all services
+    are discovered in combined passes over the attribute handles of the device, which
+    needs considerably fewer requests than discovering one service after another.
+    Other platforms discover the services one after another.
+
+    This function does nothing unless the controller is in the \l DiscoveredState.
+
+    \sa discoverServices(), createServiceObject()
+ */
+void QLowEnergyController::discoverAllServiceDetails(QLowEnergyService::DiscoveryMode mode)
+{
+    Q_D(QLowEnergyController);
+
+    if (d->role != CentralRole) {
+        qCWarning(QT_BT) << "Cannot discover service details in peripheral role";
+        return;
+    }
+    if (d->state != QLowEnergyController::DiscoveredState)
+        return;
+
+    d->startServiceDetailsDiscovery(mode);
+}
+
 /*!
     Returns the list of services offered by the remote device, if the controller is in
     the \l CentralRole. Otherwise, the result is unspecified.
@@ -750,7 +820,7 @@ QLowEnergyService *QLowEnergyController::createServiceObject(
    If this object is currently not in the \l UnconnectedState, nothing happens.
 
    \since 5.7
-   \sa stopAdvertising()
+   \sa stopAdvertising(), updateAdvertisingData()
  */
 void QLowEnergyController::startAdvertising(const QLowEnergyAdvertisingParameters &parameters,
                                             const QLowEnergyAdvertisingData &advertisingData,
@@ -765,6 +835,7 @@ void QLowEnergyController::startAdvertising(const QLowEnergyAdvertisingParameter
         qCWarning(QT_BT) << "Cannot start advertising in state" << state();
         return;
     }
+    d->advertisingParameters = parameters;
     d->startAdvertising(parameters, advertisingData, scanResponseData);
 }
 
@@ -787,6 +858,38 @@ void QLowEnergyController::stopAdvertising()
     d->stopAdvertising();
 }
 
+/*!
+   Replaces the data of the currently running advertisement with \a advertisingData and
+   \a scanResponseData. The controller has to be in the \l PeripheralRole and in the
+   \l AdvertisingState.
+
+   The parameters passed to \l startAdvertising() remain in effect. Where supported, only
+   the parts of the payload that differ from the currently advertised data are sent to the
+   Bluetooth controller, and advertising is not interrupted. Calls arriving faster than the
+   minimum advertising interval are coalesced; the most recent data is applied once the
+   interval has passed.
+
+   On platforms that cannot update a running advertisement, advertising is stopped and
+   started again with the new data.
+
+   \since 6.4
+   \sa startAdvertising(), QLowEnergyAdvertisingParameters::setInterval()
+ */
+void QLowEnergyController::updateAdvertisingData(const QLowEnergyAdvertisingData &advertisingData,
+                                                 const QLowEnergyAdvertisingData &scanResponseData)
+{
+    Q_D(QLowEnergyController);
+    if (role() != PeripheralRole) {
+        qCWarning(QT_BT) << "Cannot update advertising data in central role";
+        return;
+    }
+    if (state() != AdvertisingState) {
+        qCWarning(QT_BT) << "Cannot update advertising data in state" << state();
+        return;
+    }
+    d->updateAdvertisingData(advertisingData, scanResponseData);
+}
+
 /*!
   Constructs and returns a \l QLowEnergyService object with \a parent from \a service.
   The controller must be in the \l PeripheralRole and in the \l UnconnectedState. The \a service
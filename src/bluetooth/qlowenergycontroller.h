@@ -120,6 +120,8 @@ public:
     void disconnectFromDevice();
 
     void discoverServices();
+    void discoverAllServiceDetails(
+            QLowEnergyService::DiscoveryMode mode = QLowEnergyService::FullDiscovery);
     QList<QBluetoothUuid> services() const;
     QLowEnergyService *createServiceObject(const QBluetoothUuid &service, QObject *parent = nullptr);
 
@@ -127,6 +129,8 @@ public:
                           const QLowEnergyAdvertisingData &advertisingData,
                           const QLowEnergyAdvertisingData &scanResponseData = QLowEnergyAdvertisingData());
     void stopAdvertising();
+    void updateAdvertisingData(const QLowEnergyAdvertisingData &advertisingData,
+                               const QLowEnergyAdvertisingData &scanResponseData = QLowEnergyAdvertisingData());
 
     QLowEnergyService *addService(const QLowEnergyServiceData &service, QObject *parent = nullptr);
 
@@ -148,6 +152,8 @@ Q_SIGNALS:
 
     void serviceDiscovered(const QBluetoothUuid &newService);
     void discoveryFinished();
+    void serviceDetailsDiscovered(const QBluetoothUuid &service);
+    void allServiceDetailsDiscovered();
     void connectionUpdated(const QLowEnergyConnectionParameters &parameters);
 
 private:
@@ -159,6 +165,9 @@ private:
                                   const QBluetoothAddress &localDevice,
                                   QObject *parent = nullptr);
 
+    // ctor for an already configured backend
+    explicit QLowEnergyController(QLowEnergyControllerPrivate *d, QObject *parent = nullptr);
+
 
     Q_DECLARE_PRIVATE(QLowEnergyController)
     QLowEnergyControllerPrivate *d_ptr;
@@ -42,6 +42,7 @@
 #include "qlowenergycontroller_bluez_p.h"
 #include "qbluetoothsocketbase_p.h"
 #include "qbluetoothsocket_bluez_p.h"
+#include "qbluetoothuuid_p.h"
 #include "qleadvertiser_p.h"
 #include "bluez/bluez_data_p.h"
 #include "bluez/hcimanager_p.h"
@@ -67,7 +68,9 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
+#include <linux/net_tstamp.h>
 
 #define ATT_DEFAULT_LE_MTU 23
 #define ATT_MAX_LE_MTU 0x200
@@ -97,24 +100,17 @@ QT_BEGIN_NAMESPACE
 Q_DECLARE_LOGGING_CATEGORY(QT_BT_BLUEZ)
 
 using namespace QBluetooth;
+using QtBluetoothPrivate::attUuidSize;
+using QtBluetoothPrivate::uuidFromLittleEndian;
 
 const int maxPrepareQueueSize = 1024;
 
-static inline QBluetoothUuid convert_uuid128(const quint128 *p)
-{
-    quint128 dst_hostOrder, dst_bigEndian;
-
-    // Bluetooth LE data comes as little endian
-    // uuids are constructed using high endian
-    btoh128(p, &dst_hostOrder);
-    hton128(&dst_hostOrder, &dst_bigEndian);
-
-    // convert to Qt's own data type
-    quint128 qtdst;
-    memcpy(&qtdst, &dst_bigEndian, sizeof(quint128));
-
-    return QBluetoothUuid(qtdst);
-}
+// Number of local sign counter values persisted ahead of use. The key
+// settings file is only rewritten once per range; after a crash, counting
+// resumes behind the range, so no counter value is ever used twice.
+const quint32 signCounterReservation = 64;
+// Delay after which a changed remote sign counter is written back.
+const int signCounterFlushInterval = 1000;
 
 static void dumpErrorInformation(const QByteArray &response)
 {
@@ -180,11 +176,6 @@ static void dumpErrorInformation(const QByteArray &response)
                          << "last command:" << lastCommand << "handle:" << handle;
 }
 
-static int getUuidSize(const QBluetoothUuid &uuid)
-{
-    return uuid.minimumSize() == 2 ? 2 : 16;
-}
-
 template<typename T> static void putDataAndIncrement(const T &src, char *&dst)
 {
     putBtData(src, dst);
@@ -192,16 +183,7 @@ template<typename T> static void putDataAndIncrement(const T &src, char *&dst)
 }
 template<> void putDataAndIncrement(const QBluetoothUuid &uuid, char *&dst)
 {
-    const int uuidSize = getUuidSize(uuid);
-    if (uuidSize == 2) {
-        putBtData(uuid.toUInt16(), dst);
-    } else {
-        quint128 hostOrder;
-        quint128 qtUuidOrder = uuid.toUInt128();
-        ntoh128(&qtUuidOrder, &hostOrder);
-        putBtData(hostOrder, dst);
-    }
-    dst += uuidSize;
+    dst = QtBluetoothPrivate::putUuidLittleEndian(uuid, attUuidSize(uuid), dst);
 }
 template<> void putDataAndIncrement(const QByteArray &value, char *&dst)
 {
@@ -210,15 +192,67 @@ template<> void putDataAndIncrement(const QByteArray &value, char *&dst)
     dst += value.count();
 }
 
+// Builds a list response (Find Information, Find By Type Value, Read By Type,
+// Read By Group Type) in place. The buffer keeps its capacity between requests,
+// so no allocation happens once it has grown to the largest MTU.
+class AttListResponseWriter
+{
+public:
+    AttListResponseWriter(QByteArray &buffer, int mtu, QBluezConst::AttCommand opCode,
+                          int headerSize)
+        : buffer(buffer)
+    {
+        buffer.resize(mtu);
+        buffer[0] = static_cast<quint8>(opCode);
+        position = buffer.data() + headerSize;
+        end = buffer.data() + mtu;
+    }
+
+    char *header() { return buffer.data(); }
+    int elementSize() const { return elemSize; }
+    void setElementSize(int size) { elemSize = size; }
+    bool isEmpty() const { return count == 0; }
+    bool isFull() const { return end - position < elemSize; }
+
+    char *appendElement()
+    {
+        Q_ASSERT(!isFull());
+        char *element = position;
+        position += elemSize;
+        ++count;
+        return element;
+    }
+
+    const QByteArray &finish()
+    {
+        buffer.truncate(position - buffer.constData());
+        return buffer;
+    }
+
+private:
+    QByteArray &buffer;
+    char *position;
+    char *end;
+    int elemSize = 0;
+    int count = 0;
+};
+
 QLowEnergyControllerPrivateBluez::QLowEnergyControllerPrivateBluez()
     : QLowEnergyControllerPrivate(),
       requestPending(false),
       mtuSize(ATT_DEFAULT_LE_MTU),
+      maximumMtu(ATT_MAX_LE_MTU),
       securityLevelValue(-1),
       encryptionChangePending(false)
 {
     registerQLowEnergyControllerMetaType();
     qRegisterMetaType<QList<QLowEnergyHandle> >();
+    listResponseBuffer.reserve(ATT_MAX_LE_MTU);
+
+    // read here rather than in init(), loopback controllers never call it
+    attTraceFile = qEnvironmentVariable("QT_BLUETOOTH_ATT_TRACE");
+    if (Q_UNLIKELY(!attTraceFile.isEmpty()))
+        attTracer.setEnabled(true);
 }
 
 void QLowEnergyControllerPrivateBluez::init()
@@ -289,8 +323,10 @@ void QLowEnergyControllerPrivateBluez::handleGattRequestTimeout()
     }
 
     if (!openRequests.isEmpty() && requestPending) {
-        const Request currentRequest = openRequests.dequeue();
+        const Request currentRequest = dequeueRequest();
         requestPending = false; // reset pending flag
+        attTracer.trace(QLowEnergyAttTracer::RequestTimeout,
+                        static_cast<quint8>(currentRequest.command));
 
         qCWarning(QT_BT_BLUEZ).nospace() << "****** Request type 0x" << currentRequest.command
                                          << " to server/peripheral timed out";
@@ -351,6 +387,10 @@ void QLowEnergyControllerPrivateBluez::handleGattRequestTimeout()
             processReply(currentRequest,
                          createRequestErrorMessage(command, attrHandle));
         } break;
+        case QBluezConst::AttCommand::ATT_OP_READ_MULTIPLE_REQUEST: // combined service details
+                                                                    // discovery
+            processReply(currentRequest, createRequestErrorMessage(command, 0));
+            break;
         default:
             // not a command used by central role implementation
             qCWarning(QT_BT_BLUEZ) << "Missing response for ATT peripheral command: "
@@ -365,6 +405,8 @@ void QLowEnergyControllerPrivateBluez::handleGattRequestTimeout()
 
 QLowEnergyControllerPrivateBluez::~QLowEnergyControllerPrivateBluez()
 {
+    flushAttTrace();
+    flushSignCounter();
     closeServerSocket();
     delete cmacCalculator;
 }
@@ -423,6 +465,12 @@ void QLowEnergyControllerPrivateBluez::startAdvertising(const QLowEnergyAdvertis
         const QLowEnergyAdvertisingData &advertisingData,
         const QLowEnergyAdvertisingData &scanResponseData)
 {
+    if (Q_UNLIKELY(loopback)) {
+        qCWarning(QT_BT_BLUEZ) << "Loopback controllers can only be connected via connectLoopback()";
+        setError(QLowEnergyController::AdvertisingError);
+        return;
+    }
+
     qCDebug(QT_BT_BLUEZ) << "Starting to advertise";
     if (!advertiser) {
         advertiser = new QLeAdvertiserBluez(params, advertisingData, scanResponseData, *hciManager,
@@ -455,15 +503,56 @@ void QLowEnergyControllerPrivateBluez::startAdvertising(const QLowEnergyAdvertis
 void QLowEnergyControllerPrivateBluez::stopAdvertising()
 {
     setState(QLowEnergyController::UnconnectedState);
+    advertisingUpdatePending = false;
+    if (advertisingUpdateTimer)
+        advertisingUpdateTimer->stop();
     advertiser->stopAdvertising();
 }
 
+void QLowEnergyControllerPrivateBluez::updateAdvertisingData(
+        const QLowEnergyAdvertisingData &advertisingData,
+        const QLowEnergyAdvertisingData &scanResponseData)
+{
+    pendingAdvertisingData = advertisingData;
+    pendingScanResponseData = scanResponseData;
+
+    if (!advertisingUpdateTimer) {
+        advertisingUpdateTimer = new QTimer(this);
+        advertisingUpdateTimer->setSingleShot(true);
+        connect(advertisingUpdateTimer, &QTimer::timeout, this, [this]() {
+            if (advertisingUpdatePending)
+                applyAdvertisingDataUpdate();
+        });
+    }
+
+    // Updates faster than the advertising interval would never make it on air,
+    // so only the most recent one is applied once the interval has passed.
+    if (advertisingUpdateTimer->isActive()) {
+        advertisingUpdatePending = true;
+        return;
+    }
+    applyAdvertisingDataUpdate();
+}
+
+void QLowEnergyControllerPrivateBluez::applyAdvertisingDataUpdate()
+{
+    advertisingUpdatePending = false;
+    if (!advertiser || state != QLowEnergyController::AdvertisingState)
+        return;
+
+    advertiser->updateAdvertisingData(pendingAdvertisingData, pendingScanResponseData);
+    advertisingUpdateTimer->start(advertisingParameters.minimumInterval());
+}
+
 void QLowEnergyControllerPrivateBluez::requestConnectionUpdate(const QLowEnergyConnectionParameters &params)
 {
     // The spec says that the connection update command can be used by both slave and master
     // devices, but BlueZ allows it only for master devices. So for slave devices, we have to use a
     // connection parameter update request, which we need to wrap in an ACL command, as BlueZ
     // does not allow user-space sockets for the signaling channel.
+    if (!hciManager)
+        return;
+
     if (role == QLowEnergyController::CentralRole)
         hciManager->sendConnectionUpdateCommand(connectionHandle, params);
     else
@@ -472,6 +561,12 @@ void QLowEnergyControllerPrivateBluez::requestConnectionUpdate(const QLowEnergyC
 
 void QLowEnergyControllerPrivateBluez::connectToDevice()
 {
+    if (Q_UNLIKELY(loopback)) {
+        qCWarning(QT_BT_BLUEZ) << "Loopback controllers can only be connected via connectLoopback()";
+        setError(QLowEnergyController::InvalidBluetoothAdapterError);
+        return;
+    }
+
     if (remoteDevice.isNull()) {
         qCWarning(QT_BT_BLUEZ) << "Invalid/null remote device address";
         setError(QLowEnergyController::UnknownRemoteDeviceError);
@@ -665,6 +760,8 @@ void QLowEnergyControllerPrivateBluez::l2cpConnected()
     Q_Q(QLowEnergyController);
 
     securityLevelValue = securityLevel();
+    if (instrumentation.isEnabled())
+        enableReceiveTimestamps();
     exchangeMTU();
 
     setState(QLowEnergyController::ConnectedState);
@@ -690,6 +787,7 @@ void QLowEnergyControllerPrivateBluez::l2cpDisconnected()
 {
     Q_Q(QLowEnergyController);
 
+    flushSignCounter();
     if (role == QLowEnergyController::PeripheralRole) {
         storeClientConfigurations();
         remoteDevice.clear();
@@ -736,7 +834,10 @@ void QLowEnergyControllerPrivateBluez::l2cpErrorChanged(QBluetoothSocket::Socket
 
 void QLowEnergyControllerPrivateBluez::resetController()
 {
+    flushAttTrace();
     openRequests.clear();
+    preparedWriteTransactions.clear();
+    serviceDetailsDiscovery = ServiceDetailsDiscovery();
     openPrepareWriteRequests.clear();
     scheduledIndications.clear();
     indicationInFlight = false;
@@ -754,6 +855,9 @@ void QLowEnergyControllerPrivateBluez::resetController()
             delete advertiser;
             advertiser = nullptr;
         }
+        advertisingUpdatePending = false;
+        if (advertisingUpdateTimer)
+            advertisingUpdateTimer->stop();
         localAttributes.clear();
     }
 }
@@ -767,6 +871,21 @@ void QLowEnergyControllerPrivateBluez::restartRequestTimer()
         requestTimer->start(gattRequestTimeout);
 }
 
+/*!
+ * Returns the time in nanoseconds since the kernel received the packet
+ * with the CLOCK_REALTIME \a kernelTimestamp, or 0 if it is unknown.
+ */
+static qint64 kernelReceiveDelay(qint64 kernelTimestamp)
+{
+    if (!kernelTimestamp)
+        return 0;
+
+    timespec now;
+    if (clock_gettime(CLOCK_REALTIME, &now) != 0)
+        return 0;
+    return qMax(Q_INT64_C(0), qint64(now.tv_sec) * 1000000000 + now.tv_nsec - kernelTimestamp);
+}
+
 void QLowEnergyControllerPrivateBluez::l2cpReadyRead()
 {
     const QByteArray incomingPacket = l2cpSocket->readAll();
@@ -775,11 +894,29 @@ void QLowEnergyControllerPrivateBluez::l2cpReadyRead()
     if (incomingPacket.isEmpty())
         return;
 
+    attTracer.trace(QLowEnergyAttTracer::ReceivePdu, 0, 0, incomingPacket);
+
     const QBluezConst::AttCommand command =
             static_cast<QBluezConst::AttCommand>(incomingPacket.constData()[0]);
+
+    // without kernel timestamps the time of readyRead() is the receive time
+    qint64 receiveTime = 0;
+    if (instrumentation.isEnabled()) {
+        receiveTime = QLowEnergyControllerInstrumentation::timestamp();
+        const qint64 delay = kernelReceiveDelay(l2cpSocket->d_ptr->lastReceiveTimestamp);
+        if (delay > 0) {
+            receiveTime -= delay;
+            instrumentation.recordReceiveDelay(static_cast<quint8>(command), delay);
+        }
+    }
+
     switch (command) {
     case QBluezConst::AttCommand::ATT_OP_HANDLE_VAL_NOTIFICATION: {
         processUnsolicitedReply(incomingPacket);
+        if (receiveTime) {
+            instrumentation.recordNotificationLatency(
+                    QLowEnergyControllerInstrumentation::timestamp() - receiveTime);
+        }
         return;
     }
     case QBluezConst::AttCommand::ATT_OP_HANDLE_VAL_INDICATION: {
@@ -789,6 +926,10 @@ void QLowEnergyControllerPrivateBluez::l2cpReadyRead()
         sendPacket(packet);
 
         processUnsolicitedReply(incomingPacket);
+        if (receiveTime) {
+            instrumentation.recordNotificationLatency(
+                    QLowEnergyControllerInstrumentation::timestamp() - receiveTime);
+        }
         return;
     }
     //--------------------------------------------------
@@ -849,7 +990,11 @@ void QLowEnergyControllerPrivateBluez::l2cpReadyRead()
         return;
     }
 
-    const Request request = openRequests.dequeue();
+    const Request request = dequeueRequest();
+    if (receiveTime && request.sendTime) {
+        instrumentation.recordResponseLatency(static_cast<quint8>(request.command),
+                                              receiveTime - request.sendTime);
+    }
     processReply(request, incomingPacket);
 
     sendNextPendingRequest();
@@ -874,6 +1019,8 @@ void QLowEnergyControllerPrivateBluez::encryptionChangedEvent(
         return;
 
     securityLevelValue = securityLevel();
+    attTracer.trace(QLowEnergyAttTracer::EncryptionChanged, wasSuccess,
+                    quint32(securityLevelValue));
 
     // On success continue to process ATT command queue
     if (!wasSuccess) {
@@ -881,9 +1028,21 @@ void QLowEnergyControllerPrivateBluez::encryptionChangedEvent(
         // The next request was requeued due to security error
         // skip it to avoid endless loop of security negotiations
         Q_ASSERT(!openRequests.isEmpty());
-        Request failedRequest = openRequests.takeFirst();
+        Request failedRequest = dequeueRequest();
 
-        if (failedRequest.command == QBluezConst::AttCommand::ATT_OP_WRITE_REQUEST) {
+        if (failedRequest.detailsStep != ServiceDetailsDiscovery::NoStep) {
+            // continue the discovery without the value or attribute range
+            QByteArray errorPackage(ERROR_RESPONSE_HEADER_SIZE, Qt::Uninitialized);
+            errorPackage[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_ERROR_RESPONSE);
+            errorPackage[1] = static_cast<quint8>(failedRequest.command);
+            putBtData(QLowEnergyHandle(failedRequest.detailsStep
+                                               == ServiceDetailsDiscovery::ValueRead
+                                       ? failedRequest.reference.toUInt() : 0),
+                      errorPackage.data() + 2);
+            errorPackage[4] = static_cast<quint8>(QBluezConst::AttError::ATT_ERROR_REQUEST_STALLED);
+            encryptionChangePending = false;
+            processServiceDetailsReply(failedRequest, errorPackage, true);
+        } else if (failedRequest.command == QBluezConst::AttCommand::ATT_OP_WRITE_REQUEST) {
             // Failing write requests trigger some sort of response
             uint ref = failedRequest.reference.toUInt();
             const QLowEnergyHandle charHandle = (ref & 0xffff);
@@ -898,14 +1057,10 @@ void QLowEnergyControllerPrivateBluez::encryptionChangedEvent(
                     service->setError(QLowEnergyService::DescriptorWriteError);
             }
         } else if (failedRequest.command == QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_REQUEST) {
-            uint handleData = failedRequest.reference.toUInt();
-            const QLowEnergyHandle attrHandle = (handleData & 0xffff);
-            const QByteArray newValue = failedRequest.reference2.toByteArray();
-
             // Prepare command failed, cancel pending prepare queue on
             // the device. The appropriate (Descriptor|Characteristic)WriteError
             // is emitted too once the execute write request comes through
-            sendExecuteWriteRequest(attrHandle, newValue, true);
+            cancelPreparedWriteTransaction();
         }
     }
 
@@ -915,6 +1070,21 @@ void QLowEnergyControllerPrivateBluez::encryptionChangedEvent(
 
 void QLowEnergyControllerPrivateBluez::sendPacket(const QByteArray &packet)
 {
+#ifdef QT_BUILD_INTERNAL
+    if (Q_UNLIKELY(loopbackPacketFilter)) {
+        QByteArray filtered = packet;
+        loopbackPacketFilter(filtered);
+        writePacket(filtered);
+        return;
+    }
+#endif
+    writePacket(packet);
+}
+
+void QLowEnergyControllerPrivateBluez::writePacket(const QByteArray &packet)
+{
+    attTracer.trace(QLowEnergyAttTracer::SendPdu, 0, 0, packet);
+
     qint64 result = l2cpSocket->write(packet.constData(),
                                       packet.size());
     // We ignore result == 0 which is likely to be caused by EAGAIN.
@@ -932,15 +1102,61 @@ void QLowEnergyControllerPrivateBluez::sendPacket(const QByteArray &packet)
 
 }
 
+void QLowEnergyControllerPrivateBluez::enqueueRequest(const Request &request, bool prepend)
+{
+    if (prepend)
+        openRequests.prepend(request);
+    else
+        openRequests.enqueue(request);
+
+    // requests retried after an encryption change keep their first enqueue time
+    Request &queued = prepend ? openRequests.first() : openRequests.last();
+    if (!queued.enqueueTime && instrumentation.isEnabled())
+        queued.enqueueTime = QLowEnergyControllerInstrumentation::timestamp();
+
+    attTracer.trace(QLowEnergyAttTracer::EnqueueRequest, static_cast<quint8>(queued.command),
+                    quint32(openRequests.size()) | (prepend ? QLowEnergyAttTracer::PrependedFlag : 0));
+}
+
+QLowEnergyControllerPrivateBluez::Request QLowEnergyControllerPrivateBluez::dequeueRequest()
+{
+    Request request = openRequests.dequeue();
+    attTracer.trace(QLowEnergyAttTracer::DequeueRequest, static_cast<quint8>(request.command),
+                    quint32(openRequests.size()));
+    return request;
+}
+
+void QLowEnergyControllerPrivateBluez::flushAttTrace()
+{
+    if (attTraceFile.isEmpty() || !attTracer.size())
+        return;
+
+    if (attTracer.droppedCount()) {
+        qCWarning(QT_BT_BLUEZ) << "ATT trace ring overflowed," << attTracer.droppedCount()
+                               << "records dropped";
+    }
+    attTracer.appendToFile(attTraceFile);
+    attTracer.clear();
+}
+
 void QLowEnergyControllerPrivateBluez::sendNextPendingRequest()
 {
     if (openRequests.isEmpty() || requestPending || encryptionChangePending)
         return;
 
-    const Request &request = openRequests.head();
+    Request &request = openRequests.head();
 //    qCDebug(QT_BT_BLUEZ) << "Sending request, type:" << Qt::hex << request.command
 //             << request.payload.toHex();
 
+    if (instrumentation.isEnabled()) {
+        request.sendTime = QLowEnergyControllerInstrumentation::timestamp();
+        if (request.enqueueTime) {
+            instrumentation.recordQueueLatency(static_cast<quint8>(request.command),
+                                               request.sendTime - request.enqueueTime);
+        }
+        instrumentation.recordQueueDepth(openRequests.size());
+    }
+
     requestPending = true;
     restartRequestTimer();
     sendPacket(request.payload);
@@ -961,7 +1177,7 @@ QLowEnergyHandle parseReadByTypeCharDiscovery(
     if (elementLength == 7) // 16 bit uuid
         charData->uuid = QBluetoothUuid(bt_get_le16(&data[5]));
     else
-        charData->uuid = convert_uuid128((quint128 *)&data[5]);
+        charData->uuid = uuidFromLittleEndian(&data[5], 16);
 
     qCDebug(QT_BT_BLUEZ) << "Found handle:" << Qt::hex << attributeHandle
              << "properties:" << charData->properties
@@ -989,7 +1205,7 @@ QLowEnergyHandle parseReadByTypeIncludeDiscovery(
     if (elementLength == 8) //16 bit uuid
         foundServices->append(QBluetoothUuid(bt_get_le16(&data[6])));
     else
-        foundServices->append(convert_uuid128((quint128 *) &data[6]));
+        foundServices->append(uuidFromLittleEndian(&data[6], 16));
 
     qCDebug(QT_BT_BLUEZ) << "Found included service: " << Qt::hex
                          << attributeHandle << "uuid:" << *foundServices;
@@ -1012,6 +1228,11 @@ void QLowEnergyControllerPrivateBluez::processReply(
         isErrorResponse = true;
     }
 
+    if (request.detailsStep != ServiceDetailsDiscovery::NoStep) {
+        processServiceDetailsReply(request, response, isErrorResponse);
+        return;
+    }
+
     switch (command) {
     case QBluezConst::AttCommand::ATT_OP_EXCHANGE_MTU_REQUEST: // in case of error
     case QBluezConst::AttCommand::ATT_OP_EXCHANGE_MTU_RESPONSE: {
@@ -1022,12 +1243,13 @@ void QLowEnergyControllerPrivateBluez::processReply(
         } else {
             const char *data = response.constData();
             quint16 mtu = bt_get_le16(&data[1]);
-            mtuSize = mtu;
+            mtuSize = qMin(mtu, maximumMtu);
             if (mtuSize < ATT_DEFAULT_LE_MTU)
                 mtuSize = ATT_DEFAULT_LE_MTU;
 
             qCDebug(QT_BT_BLUEZ) << "Server MTU:" << mtu << "resulting mtu:" << mtuSize;
         }
+        attTracer.trace(QLowEnergyAttTracer::MtuExchanged, mtuSize);
         if (oldMtuSize != mtuSize)
             emit q->mtuChanged(mtuSize);
     } break;
@@ -1061,7 +1283,7 @@ void QLowEnergyControllerPrivateBluez::processReply(
             if (elementLength == 6) //16 bit uuid
                 uuid = QBluetoothUuid(bt_get_le16(&data[offset+4]));
             else if (elementLength == 20) //128 bit uuid
-                uuid = convert_uuid128((quint128 *)&data[offset+4]);
+                uuid = uuidFromLittleEndian(&data[offset+4], 16);
             //else -> do nothing
 
             offset += elementLength;
@@ -1189,7 +1411,7 @@ void QLowEnergyControllerPrivateBluez::processReply(
             if (encryptionChangePending) {
                 // Just requested a security level change.
                 // Retry the same command again once the change has happened
-                openRequests.prepend(request);
+                enqueueRequest(request, true);
                 break;
             } else if (!isServiceDiscoveryRun) {
                 // not encryption problem -> abort readCharacteristic()/readDescriptor() run
@@ -1357,7 +1579,7 @@ void QLowEnergyControllerPrivateBluez::processReply(
             if (format == 0x01)
                 uuid = QBluetoothUuid(bt_get_le16(&data[offset+2]));
             else if (format == 0x02)
-                uuid = convert_uuid128((quint128 *)&data[offset+2]);
+                uuid = uuidFromLittleEndian(&data[offset+2], 16);
 
             offset += elementLength;
 
@@ -1430,7 +1652,7 @@ void QLowEnergyControllerPrivateBluez::processReply(
             QBluezConst::AttError err = static_cast<QBluezConst::AttError>(response.constData()[4]);
             encryptionChangePending = increaseEncryptLevelfRequired(err);
             if (encryptionChangePending) {
-                openRequests.prepend(request);
+                enqueueRequest(request, true);
                 break;
             }
 
@@ -1457,62 +1679,72 @@ void QLowEnergyControllerPrivateBluez::processReply(
     case QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_RESPONSE: {
         //Prepare write command response
         Q_ASSERT(request.command == QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_REQUEST);
-
-        uint handleData = request.reference.toUInt();
-        const QLowEnergyHandle attrHandle = (handleData & 0xffff);
-        const QByteArray newValue = request.reference2.toByteArray();
-        const int writtenPayload = ((handleData >> 16) & 0xffff);
+        Q_ASSERT(!preparedWriteTransactions.isEmpty());
 
         if (isErrorResponse) {
             Q_ASSERT(!encryptionChangePending);
             QBluezConst::AttError err = static_cast<QBluezConst::AttError>(response.constData()[4]);
             encryptionChangePending = increaseEncryptLevelfRequired(err);
             if (encryptionChangePending) {
-                openRequests.prepend(request);
+                enqueueRequest(request, true);
                 break;
             }
             //emits error on cancellation and aborts existing prepare reuqests
-            sendExecuteWriteRequest(attrHandle, newValue, true);
-        } else {
-            if (writtenPayload < newValue.size()) {
-                sendNextPrepareWriteRequest(attrHandle, newValue, writtenPayload);
-            } else {
-                sendExecuteWriteRequest(attrHandle, newValue, false);
-            }
+            cancelPreparedWriteTransaction();
+            break;
+        }
+
+        // The response echoes handle, offset and value of the fragment
+        if (response.size() != request.payload.size()
+                || memcmp(response.constData() + 1, request.payload.constData() + 1,
+                          response.size() - 1) != 0) {
+            qCWarning(QT_BT_BLUEZ) << "Prepare write response does not match the request";
+            preparedWriteTransactions.head().failed = true;
+        }
+
+        // all fragments are queued on the remote device, decide on the execute
+        if (!openRequests.isEmpty()
+                && openRequests.head().command
+                        == QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_REQUEST
+                && preparedWriteTransactions.head().failed) {
+            cancelPreparedWriteTransaction();
         }
     } break;
     case QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_REQUEST: // error case
     case QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_RESPONSE: {
-        // right now used in connection with long characteristic/descriptor value writes
-        // not catering for reliable writes
         Q_ASSERT(request.command == QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_REQUEST);
+        Q_ASSERT(!preparedWriteTransactions.isEmpty());
 
-        uint handleData = request.reference.toUInt();
-        const QLowEnergyHandle attrHandle = handleData & 0xffff;
-        bool wasCancellation = !((handleData >> 16) & 0xffff);
-        const QByteArray newValue = request.reference2.toByteArray();
-
-        // is it a descriptor or characteristic?
-        const QLowEnergyDescriptor descriptor = descriptorForHandle(attrHandle);
-        QSharedPointer<QLowEnergyServicePrivate> service = serviceForHandle(attrHandle);
-        Q_ASSERT(!service.isNull());
+        const PreparedWriteTransaction transaction = preparedWriteTransactions.dequeue();
+        bool wasCancellation = !((request.reference.toUInt() >> 16) & 0xffff);
 
         if (isErrorResponse || wasCancellation) {
-            // charHandle == 0 -> cancellation
-            if (descriptor.isValid())
+            // is it a descriptor or characteristic?
+            const QLowEnergyHandle attrHandle = transaction.values.first().handle;
+            QSharedPointer<QLowEnergyServicePrivate> service = serviceForHandle(attrHandle);
+            if (service.isNull())
+                break;
+            if (descriptorForHandle(attrHandle).isValid())
                 service->setError(QLowEnergyService::DescriptorWriteError);
             else
                 service->setError(QLowEnergyService::CharacteristicWriteError);
-        } else {
+            break;
+        }
+
+        for (const PreparedWriteTransaction::Value &value : transaction.values) {
+            QSharedPointer<QLowEnergyServicePrivate> service = serviceForHandle(value.handle);
+            if (service.isNull())
+                continue;
+            const QLowEnergyDescriptor descriptor = descriptorForHandle(value.handle);
             if (descriptor.isValid()) {
                 updateValueOfDescriptor(descriptor.characteristicHandle(),
-                                        attrHandle, newValue, NEW_VALUE);
-                emit service->descriptorWritten(descriptor, newValue);
+                                        value.handle, value.value, NEW_VALUE);
+                emit service->descriptorWritten(descriptor, value.value);
             } else {
-                QLowEnergyCharacteristic ch(service, attrHandle);
+                QLowEnergyCharacteristic ch(service, value.handle);
                 if (ch.properties() & QLowEnergyCharacteristic::Read)
-                    updateValueOfCharacteristic(attrHandle, newValue, NEW_VALUE);
-                emit service->characteristicWritten(ch, newValue);
+                    updateValueOfCharacteristic(value.handle, value.value, NEW_VALUE);
+                emit service->characteristicWritten(ch, value.value);
             }
         }
     } break;
@@ -1547,7 +1779,7 @@ void QLowEnergyControllerPrivateBluez::sendReadByGroupRequest(
     request.payload = data;
     request.command = QBluezConst::AttCommand::ATT_OP_READ_BY_GROUP_REQUEST;
     request.reference = type;
-    openRequests.enqueue(request);
+    enqueueRequest(request);
 
     sendNextPendingRequest();
 }
@@ -1589,7 +1821,7 @@ void QLowEnergyControllerPrivateBluez::sendReadByTypeRequest(
     request.command = QBluezConst::AttCommand::ATT_OP_READ_BY_TYPE_REQUEST;
     request.reference = QVariant::fromValue(serviceData);
     request.reference2 = attributeType;
-    openRequests.enqueue(request);
+    enqueueRequest(request);
 
     sendNextPendingRequest();
 }
@@ -1691,7 +1923,7 @@ void QLowEnergyControllerPrivateBluez::readServiceValues(
         request.reference = pair.second;
         // last entry?
         request.reference2 = QVariant((bool)(i + 1 == targetHandles.count()));
-        openRequests.enqueue(request);
+        enqueueRequest(request);
     }
 
     sendNextPendingRequest();
@@ -1743,7 +1975,7 @@ void QLowEnergyControllerPrivateBluez::readServiceValuesByOffset(
     request.command = QBluezConst::AttCommand::ATT_OP_READ_BLOB_REQUEST;
     request.reference = handleData;
     request.reference2 = isLastValue;
-    openRequests.prepend(request);
+    enqueueRequest(request, true);
 }
 
 void QLowEnergyControllerPrivateBluez::discoverServiceDescriptors(
@@ -1759,13 +1991,544 @@ void QLowEnergyControllerPrivateBluez::discoverServiceDescriptors(
         return;
     }
 
-    // start handle of all known characteristics
-    QList<QLowEnergyHandle> keys = service->characteristicList.keys();
-    std::sort(keys.begin(), keys.end());
+    // start handle of all known characteristics, sorted by handle
+    const QList<QLowEnergyHandle> keys = service->characteristicList.keys();
 
     discoverNextDescriptor(service, keys, keys[0]);
 }
 
+/*!
+    \internal
+
+    Discovers the details of all \a services in combined passes over their
+    attribute handles instead of one service after another:
+
+    \list
+        \li one Read By Type sweep each for included services and characteristics,
+        \li one Find Information sweep for the descriptors,
+        \li Read By Type requests for the values of characteristics sharing a uuid,
+            Read Multiple requests for fixed size descriptor values and plain reads
+            for everything else.
+    \endlist
+
+    Each service enters the RemoteServiceDiscovered state as soon as its last
+    value has been read.
+ */
+void QLowEnergyControllerPrivateBluez::discoverAllServiceDetails(
+        const QList<QBluetoothUuid> &services, QLowEnergyService::DiscoveryMode mode)
+{
+    if (!serviceDetailsDiscovery.services.isEmpty()) {
+        // a combined run is ongoing already
+        for (const QBluetoothUuid &service : services)
+            discoverServiceDetails(service, mode);
+        return;
+    }
+
+    ServiceDetailsDiscovery &discovery = serviceDetailsDiscovery;
+    for (const QBluetoothUuid &uuid : services) {
+        const QSharedPointer<QLowEnergyServicePrivate> service = serviceList.value(uuid);
+        if (service.isNull())
+            continue;
+        service->mode = mode;
+        service->characteristicList.clear();
+        service->includedServices.clear();
+        discovery.services.append(service);
+    }
+    if (discovery.services.isEmpty())
+        return;
+
+    std::sort(discovery.services.begin(), discovery.services.end(),
+              [](const QSharedPointer<QLowEnergyServicePrivate> &a,
+                 const QSharedPointer<QLowEnergyServicePrivate> &b) {
+                  return a->startHandle < b->startHandle;
+              });
+    discovery.mode = mode;
+    discovery.startHandle = discovery.services.first()->startHandle;
+    for (const auto &service : qAsConst(discovery.services))
+        discovery.endHandle = qMax(discovery.endHandle, service->endHandle);
+
+    qCDebug(QT_BT_BLUEZ) << "Discovering details of" << discovery.services.size()
+                         << "services, handles" << Qt::hex << discovery.startHandle
+                         << "to" << discovery.endHandle;
+
+    sendServiceDetailsReadByType(ServiceDetailsDiscovery::IncludeDiscovery,
+                                 discovery.startHandle);
+}
+
+void QLowEnergyControllerPrivateBluez::sendServiceDetailsRequest(
+        ServiceDetailsDiscovery::Step step, const QByteArray &payload,
+        const QVariant &reference, const QVariant &reference2, bool prepend)
+{
+    Request request;
+    request.payload = payload;
+    request.command = static_cast<QBluezConst::AttCommand>(payload.at(0));
+    request.reference = reference;
+    request.reference2 = reference2;
+    request.detailsStep = step;
+    if (prepend)
+        enqueueRequest(request, true);
+    else
+        enqueueRequest(request);
+}
+
+void QLowEnergyControllerPrivateBluez::sendServiceDetailsReadByType(
+        ServiceDetailsDiscovery::Step step, QLowEnergyHandle startHandle)
+{
+    Q_ASSERT(step == ServiceDetailsDiscovery::IncludeDiscovery
+             || step == ServiceDetailsDiscovery::CharacteristicDiscovery);
+
+    QByteArray data(READ_BY_TYPE_REQ_HEADER_SIZE, Qt::Uninitialized);
+    data[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_READ_BY_TYPE_REQUEST);
+    putBtData(startHandle, data.data() + 1);
+    putBtData(serviceDetailsDiscovery.endHandle, data.data() + 3);
+    putBtData(step == ServiceDetailsDiscovery::IncludeDiscovery ? GATT_INCLUDED_SERVICE
+                                                                : GATT_CHARACTERISTIC,
+              data.data() + 5);
+
+    sendServiceDetailsRequest(step, data);
+    sendNextPendingRequest();
+}
+
+QSharedPointer<QLowEnergyServicePrivate> QLowEnergyControllerPrivateBluez::serviceDetailsOwner(
+        QLowEnergyHandle handle) const
+{
+    const auto &services = serviceDetailsDiscovery.services;
+    auto it = std::upper_bound(services.cbegin(), services.cend(), handle,
+                               [](QLowEnergyHandle h,
+                                  const QSharedPointer<QLowEnergyServicePrivate> &service) {
+                                   return h < service->startHandle;
+                               });
+    if (it == services.cbegin())
+        return {};
+    --it;
+    return handle <= (*it)->endHandle ? *it : QSharedPointer<QLowEnergyServicePrivate>();
+}
+
+void QLowEnergyControllerPrivateBluez::discoverServiceDetailsDescriptors(
+        QLowEnergyHandle startHandle)
+{
+    QByteArray data(FIND_INFO_REQUEST_HEADER_SIZE, Qt::Uninitialized);
+    data[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_FIND_INFORMATION_REQUEST);
+    putBtData(startHandle, data.data() + 1);
+    putBtData(serviceDetailsDiscovery.endHandle, data.data() + 3);
+
+    sendServiceDetailsRequest(ServiceDetailsDiscovery::DescriptorDiscovery, data);
+    sendNextPendingRequest();
+}
+
+// Size of descriptor values which can be combined in a Read Multiple request, or 0.
+static int fixedDescriptorValueSize(const QBluetoothUuid &uuid)
+{
+    bool ok = false;
+    switch (static_cast<QBluetoothUuid::DescriptorType>(uuid.toUInt16(&ok))) {
+    case QBluetoothUuid::DescriptorType::CharacteristicExtendedProperties:
+    case QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration:
+    case QBluetoothUuid::DescriptorType::ServerCharacteristicConfiguration:
+        return ok ? 2 : 0;
+    case QBluetoothUuid::DescriptorType::CharacteristicPresentationFormat:
+        return ok ? 7 : 0;
+    default:
+        return 0;
+    }
+}
+
+void QLowEnergyControllerPrivateBluez::readServiceDetailsValues()
+{
+    ServiceDetailsDiscovery &discovery = serviceDetailsDiscovery;
+
+    if (discovery.mode == QLowEnergyService::SkipValueDiscovery) {
+        const auto services = discovery.services;
+        serviceDetailsDiscovery = ServiceDetailsDiscovery();
+        for (const auto &service : services)
+            service->setState(QLowEnergyService::RemoteServiceDiscovered);
+        return;
+    }
+
+    QHash<QBluetoothUuid, QList<QLowEnergyHandle>> valueHandlesByUuid;
+    QList<QLowEnergyHandle> fixedSizeDescriptors;
+    QList<QLowEnergyHandle> singleReads;
+
+    for (const auto &service : qAsConst(discovery.services)) {
+        int count = 0;
+        for (auto charIt = service->characteristicList.cbegin(),
+                  charEnd = service->characteristicList.cend(); charIt != charEnd; ++charIt) {
+            const QLowEnergyServicePrivate::CharData &charDetails = charIt.value();
+            // Don't try to read writeOnly characteristic
+            if (charDetails.properties & QLowEnergyCharacteristic::Read) {
+                discovery.pendingValues.insert(charDetails.valueHandle,
+                                               { service, charIt.key(), 0 });
+                valueHandlesByUuid[charDetails.uuid].append(charDetails.valueHandle);
+                ++count;
+            }
+            for (auto descIt = charDetails.descriptorList.cbegin(),
+                      descEnd = charDetails.descriptorList.cend(); descIt != descEnd; ++descIt) {
+                discovery.pendingValues.insert(descIt.key(),
+                                               { service, charIt.key(), descIt.key() });
+                if (fixedDescriptorValueSize(descIt.value().uuid))
+                    fixedSizeDescriptors.append(descIt.key());
+                else
+                    singleReads.append(descIt.key());
+                ++count;
+            }
+        }
+        discovery.pendingValueCount.insert(service.data(), count);
+    }
+
+    // One Read By Type request returns the values of all characteristics sharing
+    // a uuid, as far as they have the same length.
+    for (auto it = valueHandlesByUuid.begin(), end = valueHandlesByUuid.end(); it != end; ++it) {
+        QList<QLowEnergyHandle> &handles = it.value();
+        if (handles.size() == 1) {
+            singleReads.append(handles.first());
+            continue;
+        }
+        std::sort(handles.begin(), handles.end());
+
+        QByteArray data(READ_BY_TYPE_REQ_HEADER_SIZE - 2, Qt::Uninitialized);
+        data[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_READ_BY_TYPE_REQUEST);
+        putBtData(handles.first(), data.data() + 1);
+        putBtData(handles.last(), data.data() + 3);
+        QtBluetoothPrivate::appendUuidLittleEndian(data, it.key(), attUuidSize(it.key()));
+        sendServiceDetailsRequest(ServiceDetailsDiscovery::ValueReadByType, data,
+                                  QVariant::fromValue(handles));
+    }
+
+    // Read Multiple responses carry no lengths, so they are limited to
+    // descriptors with fixed value sizes.
+    std::sort(fixedSizeDescriptors.begin(), fixedSizeDescriptors.end());
+    for (qsizetype i = 0; i < fixedSizeDescriptors.size(); ) {
+        QList<QLowEnergyHandle> handles;
+        int responseSize = 1;
+        for (; i < fixedSizeDescriptors.size(); ++i) {
+            const QLowEnergyHandle handle = fixedSizeDescriptors.at(i);
+            const ServiceDetailsDiscovery::ValueTarget &target = discovery.pendingValues[handle];
+            const int size = fixedDescriptorValueSize(target.service->characteristicList
+                    [target.charHandle].descriptorList[handle].uuid);
+            if (responseSize + size > mtuSize || 1 + 2 * (handles.size() + 1) > mtuSize)
+                break;
+            responseSize += size;
+            handles.append(handle);
+        }
+        if (handles.size() == 1) {
+            singleReads.append(handles.first());
+            continue;
+        }
+
+        QByteArray data(1 + 2 * handles.size(), Qt::Uninitialized);
+        data[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_READ_MULTIPLE_REQUEST);
+        for (qsizetype j = 0; j < handles.size(); ++j)
+            putBtData(handles.at(j), data.data() + 1 + 2 * j);
+        sendServiceDetailsRequest(ServiceDetailsDiscovery::MultipleValueRead, data,
+                                  QVariant::fromValue(handles));
+    }
+
+    std::sort(singleReads.begin(), singleReads.end());
+    for (const QLowEnergyHandle handle : qAsConst(singleReads))
+        readServiceDetailsValue(handle);
+
+    // services without readable values are complete already
+    const auto services = discovery.services;
+    const bool finished = discovery.pendingValues.isEmpty();
+    if (finished)
+        serviceDetailsDiscovery = ServiceDetailsDiscovery();
+    for (const auto &service : services) {
+        if (finished || !serviceDetailsDiscovery.pendingValueCount.value(service.data()))
+            service->setState(QLowEnergyService::RemoteServiceDiscovered);
+    }
+
+    sendNextPendingRequest();
+}
+
+void QLowEnergyControllerPrivateBluez::readServiceDetailsValue(QLowEnergyHandle handle,
+                                                               quint16 offset)
+{
+    QByteArray data(offset ? READ_BLOB_REQUEST_HEADER_SIZE : READ_REQUEST_HEADER_SIZE,
+                    Qt::Uninitialized);
+    data[0] = static_cast<quint8>(offset ? QBluezConst::AttCommand::ATT_OP_READ_BLOB_REQUEST
+                                         : QBluezConst::AttCommand::ATT_OP_READ_REQUEST);
+    putBtData(handle, data.data() + 1);
+    if (offset)
+        putBtData(offset, data.data() + 3);
+
+    // blob reads finish the current value before the next one is read
+    sendServiceDetailsRequest(ServiceDetailsDiscovery::ValueRead, data, handle, offset,
+                              offset != 0);
+}
+
+void QLowEnergyControllerPrivateBluez::storeServiceDetailsValue(
+        QLowEnergyHandle handle, const QByteArray &value, bool appendValue)
+{
+    const ServiceDetailsDiscovery::ValueTarget target =
+            serviceDetailsDiscovery.pendingValues.value(handle);
+    if (target.service.isNull())
+        return;
+
+    if (target.descriptorHandle)
+        updateValueOfDescriptor(target.charHandle, target.descriptorHandle, value, appendValue);
+    else
+        updateValueOfCharacteristic(target.charHandle, value, appendValue);
+}
+
+void QLowEnergyControllerPrivateBluez::finishServiceDetailsValue(QLowEnergyHandle handle)
+{
+    ServiceDetailsDiscovery &discovery = serviceDetailsDiscovery;
+    const ServiceDetailsDiscovery::ValueTarget target = discovery.pendingValues.take(handle);
+    if (target.service.isNull())
+        return;
+
+    const bool serviceFinished = --discovery.pendingValueCount[target.service.data()] == 0;
+    if (discovery.pendingValues.isEmpty())
+        serviceDetailsDiscovery = ServiceDetailsDiscovery();
+    if (serviceFinished)
+        target.service->setState(QLowEnergyService::RemoteServiceDiscovered);
+}
+
+void QLowEnergyControllerPrivateBluez::processServiceDetailsReply(
+        const Request &request, const QByteArray &response, bool isErrorResponse)
+{
+    ServiceDetailsDiscovery &discovery = serviceDetailsDiscovery;
+    if (discovery.services.isEmpty())
+        return; // the discovery was reset in the meantime
+
+    QLowEnergyHandle errorHandle = 0;
+    if (isErrorResponse) {
+        if (response.size() < ERROR_RESPONSE_HEADER_SIZE)
+            return;
+        errorHandle = bt_get_le16(response.constData() + 2);
+        const auto err = static_cast<QBluezConst::AttError>(response.constData()[4]);
+        if (err != QBluezConst::AttError::ATT_ERROR_ATTRIBUTE_NOT_FOUND
+                && !encryptionChangePending) {
+            encryptionChangePending = increaseEncryptLevelfRequired(err);
+            if (encryptionChangePending) {
+                // Retry the same request once the security level has changed
+                enqueueRequest(request, true);
+                return;
+            }
+        }
+    }
+
+    const char *data = response.constData();
+
+    switch (request.detailsStep) {
+    case ServiceDetailsDiscovery::IncludeDiscovery:
+    case ServiceDetailsDiscovery::CharacteristicDiscovery: {
+        /* packet format:
+         *      <opcode><elementLength>
+         *          [<handle><property><valueHandle><uuid>]+ or
+         *          [<handle><startHandle_included><endHandle_included><uuid>]+
+         */
+        const quint8 elementLength = response.size() > 1 ? quint8(data[1]) : 0;
+        if (!isErrorResponse && elementLength >= 6) {
+            const qsizetype numElements = (response.size() - 2) / elementLength;
+            QLowEnergyHandle lastHandle = 0;
+            for (qsizetype i = 0; i < numElements; ++i) {
+                const char *element = data + 2 + i * elementLength;
+                lastHandle = bt_get_le16(element);
+                const auto owner = serviceDetailsOwner(lastHandle);
+
+                if (request.detailsStep == ServiceDetailsDiscovery::CharacteristicDiscovery) {
+                    if (elementLength != 7 && elementLength != 21)
+                        break;
+                    QLowEnergyServicePrivate::CharData characteristic;
+                    parseReadByTypeCharDiscovery(&characteristic, element, elementLength);
+                    if (!owner.isNull())
+                        owner->characteristicList[lastHandle] = characteristic;
+                    continue;
+                }
+
+                if (owner.isNull())
+                    continue;
+                // 128 bit uuids of included services are not part of the response
+                QBluetoothUuid uuid;
+                if (elementLength == 8) {
+                    uuid = QBluetoothUuid(bt_get_le16(element + 6));
+                } else {
+                    const QLowEnergyHandle includedStart = bt_get_le16(element + 2);
+                    for (auto it = serviceList.cbegin(); it != serviceList.cend(); ++it) {
+                        if (it.value()->startHandle == includedStart) {
+                            uuid = it.key();
+                            break;
+                        }
+                    }
+                }
+                if (uuid.isNull())
+                    continue;
+                owner->includedServices.append(uuid);
+                if (serviceList.contains(uuid))
+                    serviceList[uuid]->type |= QLowEnergyService::IncludedService;
+            }
+
+            if (numElements && lastHandle < discovery.endHandle) {
+                sendServiceDetailsReadByType(request.detailsStep, lastHandle + 1);
+                break;
+            }
+        }
+
+        if (request.detailsStep == ServiceDetailsDiscovery::IncludeDiscovery) {
+            sendServiceDetailsReadByType(ServiceDetailsDiscovery::CharacteristicDiscovery,
+                                         discovery.startHandle);
+            break;
+        }
+
+        // descriptors can only follow a characteristic value
+        QLowEnergyHandle startHandle = 0;
+        for (const auto &service : qAsConst(discovery.services)) {
+            for (auto it = service->characteristicList.cbegin(),
+                      end = service->characteristicList.cend(); it != end; ++it) {
+                discovery.charHandles.append(it.key());
+                if (!startHandle || it.value().valueHandle < startHandle)
+                    startHandle = it.value().valueHandle;
+            }
+        }
+        std::sort(discovery.charHandles.begin(), discovery.charHandles.end());
+        if (startHandle && startHandle < discovery.endHandle)
+            discoverServiceDetailsDescriptors(startHandle + 1);
+        else
+            readServiceDetailsValues();
+    } break;
+    case ServiceDetailsDiscovery::DescriptorDiscovery: {
+        /* packet format:
+         *  <opcode><format>[<handle><descriptor_uuid>]+
+         */
+        const quint8 format = response.size() > 1 ? quint8(data[1]) : 0;
+        if (!isErrorResponse && (format == 0x01 || format == 0x02)) {
+            const int elementLength = format == 0x01 ? 2 + 2 : 2 + 16;
+            const qsizetype numElements = (response.size() - 2) / elementLength;
+            QLowEnergyHandle lastHandle = 0;
+            for (qsizetype i = 0; i < numElements; ++i) {
+                const char *element = data + 2 + i * elementLength;
+                lastHandle = bt_get_le16(element);
+                const QBluetoothUuid uuid = format == 0x01
+                        ? QBluetoothUuid(bt_get_le16(element + 2))
+                        : uuidFromLittleEndian(element + 2, 16);
+
+                // ignore service, include and characteristic declarations
+                bool ok = false;
+                const quint16 shortUuid = uuid.toUInt16(&ok);
+                if (ok && shortUuid >= QLowEnergyServicePrivate::PrimaryService
+                       && shortUuid <= QLowEnergyServicePrivate::Characteristic) {
+                    continue;
+                }
+
+                const auto charIt = std::upper_bound(discovery.charHandles.cbegin(),
+                                                     discovery.charHandles.cend(), lastHandle);
+                if (charIt == discovery.charHandles.cbegin())
+                    continue;
+                const QLowEnergyHandle charHandle = *(charIt - 1);
+                const auto owner = serviceDetailsOwner(lastHandle);
+                if (owner.isNull() || !owner->characteristicList.contains(charHandle))
+                    continue;
+
+                // ignore value handles
+                QLowEnergyServicePrivate::CharData &characteristic =
+                        owner->characteristicList[charHandle];
+                if (lastHandle <= characteristic.valueHandle)
+                    continue;
+
+                QLowEnergyServicePrivate::DescData descriptor;
+                descriptor.uuid = uuid;
+                characteristic.descriptorList.insert(lastHandle, descriptor);
+            }
+
+            if (numElements && lastHandle < discovery.endHandle) {
+                discoverServiceDetailsDescriptors(lastHandle + 1);
+                break;
+            }
+        }
+
+        readServiceDetailsValues();
+    } break;
+    case ServiceDetailsDiscovery::ValueRead: {
+        const QLowEnergyHandle handle = request.reference.toUInt();
+        const quint16 offset = request.reference2.toUInt();
+        if (!isErrorResponse) {
+            storeServiceDetailsValue(handle, response.mid(1), offset != 0);
+            if (response.size() == mtuSize) {
+                // Potentially more data -> continue with blob reads
+                readServiceDetailsValue(handle, offset + response.size() - 1);
+                break;
+            }
+        }
+        finishServiceDetailsValue(handle);
+    } break;
+    case ServiceDetailsDiscovery::ValueReadByType: {
+        /* packet format:
+         *  <opcode><elementLength>[<handle><value>]+
+         */
+        QList<QLowEnergyHandle> handles = request.reference.value<QList<QLowEnergyHandle>>();
+        const quint8 elementLength = response.size() > 1 ? quint8(data[1]) : 0;
+        if (!isErrorResponse && elementLength >= 2) {
+            // longer values are truncated to the maximum element size
+            const int valueLength = elementLength - 2;
+            const int maxValueLength = qMin(mtuSize - 4, 253);
+            const qsizetype numElements = (response.size() - 2) / elementLength;
+            QLowEnergyHandle lastHandle = 0;
+            for (qsizetype i = 0; i < numElements; ++i) {
+                const qsizetype offset = 2 + i * elementLength;
+                lastHandle = bt_get_le16(data + offset);
+                if (!handles.removeOne(lastHandle))
+                    continue; // characteristic of another service
+                storeServiceDetailsValue(lastHandle, response.mid(offset + 2, valueLength),
+                                         NEW_VALUE);
+                if (valueLength == maxValueLength)
+                    readServiceDetailsValue(lastHandle, valueLength);
+                else
+                    finishServiceDetailsValue(lastHandle);
+            }
+
+            if (numElements && !handles.isEmpty() && lastHandle < handles.last()) {
+                QByteArray payload = request.payload;
+                putBtData(QLowEnergyHandle(lastHandle + 1), payload.data() + 1);
+                sendServiceDetailsRequest(ServiceDetailsDiscovery::ValueReadByType, payload,
+                                          QVariant::fromValue(handles), QVariant(), true);
+                break;
+            }
+        }
+
+        // The rest is read one by one; the attribute causing an error stays empty.
+        for (const QLowEnergyHandle handle : qAsConst(handles)) {
+            if (isErrorResponse && handle == errorHandle)
+                finishServiceDetailsValue(handle);
+            else
+                readServiceDetailsValue(handle);
+        }
+    } break;
+    case ServiceDetailsDiscovery::MultipleValueRead: {
+        const QList<QLowEnergyHandle> handles =
+                request.reference.value<QList<QLowEnergyHandle>>();
+
+        QList<int> sizes;
+        int expectedSize = 1;
+        for (const QLowEnergyHandle handle : handles) {
+            const ServiceDetailsDiscovery::ValueTarget target = discovery.pendingValues.value(handle);
+            const int size = target.service.isNull() ? 0 : fixedDescriptorValueSize(
+                    target.service->characteristicList[target.charHandle]
+                            .descriptorList[handle].uuid);
+            sizes.append(size);
+            expectedSize += size;
+        }
+
+        if (!isErrorResponse && response.size() == expectedSize) {
+            qsizetype offset = 1;
+            for (qsizetype i = 0; i < handles.size(); ++i) {
+                storeServiceDetailsValue(handles.at(i), response.mid(offset, sizes.at(i)),
+                                         NEW_VALUE);
+                offset += sizes.at(i);
+                finishServiceDetailsValue(handles.at(i));
+            }
+            break;
+        }
+
+        // fall back to reading the values one by one
+        for (const QLowEnergyHandle handle : handles)
+            readServiceDetailsValue(handle);
+    } break;
+    case ServiceDetailsDiscovery::NoStep:
+        Q_UNREACHABLE();
+        break;
+    }
+}
+
 void QLowEnergyControllerPrivateBluez::processUnsolicitedReply(const QByteArray &payload)
 {
     const char *data = payload.constData();
@@ -1797,7 +2560,7 @@ void QLowEnergyControllerPrivateBluez::exchangeMTU()
 
     quint8 packet[MTU_EXCHANGE_HEADER_SIZE];
     packet[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_EXCHANGE_MTU_REQUEST);
-    putBtData(quint16(ATT_MAX_LE_MTU), &packet[1]);
+    putBtData(maximumMtu, &packet[1]);
 
     QByteArray data(MTU_EXCHANGE_HEADER_SIZE, Qt::Uninitialized);
     memcpy(data.data(), packet, MTU_EXCHANGE_HEADER_SIZE);
@@ -1805,13 +2568,16 @@ void QLowEnergyControllerPrivateBluez::exchangeMTU()
     Request request;
     request.payload = data;
     request.command = QBluezConst::AttCommand::ATT_OP_EXCHANGE_MTU_REQUEST;
-    openRequests.enqueue(request);
+    enqueueRequest(request);
 
     sendNextPendingRequest();
 }
 
 int QLowEnergyControllerPrivateBluez::securityLevel() const
 {
+    if (loopback)
+        return BT_SECURITY_LOW; // the loopback bearer is never encrypted
+
     int socket = l2cpSocket->socketDescriptor();
     if (socket < 0) {
         qCWarning(QT_BT_BLUEZ) << "Invalid l2cp socket, aborting getting of sec level";
@@ -1849,6 +2615,36 @@ int QLowEnergyControllerPrivateBluez::securityLevel() const
     return -1;
 }
 
+/*!
+ * Asks the kernel to timestamp received ATT packets. SO_TIMESTAMPING
+ * is preferred, older kernels only support SO_TIMESTAMPNS. Both provide
+ * software timestamps taken when the packet reaches the socket.
+ */
+void QLowEnergyControllerPrivateBluez::enableReceiveTimestamps()
+{
+    int socket = l2cpSocket->socketDescriptor();
+    if (socket < 0) {
+        qCWarning(QT_BT_BLUEZ) << "Invalid l2cp socket, aborting enabling of receive timestamps";
+        return;
+    }
+
+#ifdef SO_TIMESTAMPING
+    const int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0) {
+        l2cpSocket->d_ptr->receiveTimestamps = true;
+        return;
+    }
+#endif
+
+    const int enable = 1;
+    if (setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0) {
+        l2cpSocket->d_ptr->receiveTimestamps = true;
+        return;
+    }
+
+    qCDebug(QT_BT_BLUEZ) << "Kernel receive timestamps not available:" << qt_error_string(errno);
+}
+
 bool QLowEnergyControllerPrivateBluez::setSecurityLevel(int level)
 {
     if (level > BT_SECURITY_HIGH || level < BT_SECURITY_LOW)
@@ -1928,97 +2724,117 @@ void QLowEnergyControllerPrivateBluez::discoverNextDescriptor(
     request.command = QBluezConst::AttCommand::ATT_OP_FIND_INFORMATION_REQUEST;
     request.reference = QVariant::fromValue<QList<QLowEnergyHandle> >(pendingCharHandles);
     request.reference2 = startingHandle;
-    openRequests.enqueue(request);
+    enqueueRequest(request);
 
     sendNextPendingRequest();
 }
 
-void QLowEnergyControllerPrivateBluez::sendNextPrepareWriteRequest(
-        const QLowEnergyHandle handle, const QByteArray &newValue,
-        quint16 offset)
+/*!
+    Queues the "Prepare Write Requests" for all fragments of \a values and the
+    "Execute Write Request" committing them, so that the fragments are sent back
+    to back without further lookups. The echoed fragments are compared with the
+    sent ones, and the execute request becomes a cancellation if any of them
+    differs or fails.
+ */
+void QLowEnergyControllerPrivateBluez::sendPreparedWriteRequests(
+        const QList<PreparedWriteTransaction::Value> &values)
 {
-    // is it a descriptor or characteristic?
-    QLowEnergyHandle targetHandle = 0;
-    const QLowEnergyDescriptor descriptor = descriptorForHandle(handle);
-    if (descriptor.isValid())
-        targetHandle = descriptor.handle();
-    else
-        targetHandle = characteristicForHandle(handle).handle();
-
-    if (!targetHandle) {
-        qCWarning(QT_BT_BLUEZ) << "sendNextPrepareWriteRequest cancelled due to invalid handle"
-                               << handle;
-        return;
-    }
-
-    quint8 packet[PREPARE_WRITE_HEADER_SIZE];
-    packet[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_REQUEST);
-    putBtData(targetHandle, &packet[1]); // attribute handle
-    putBtData(offset, &packet[3]); // offset into newValue
+    Q_ASSERT(!values.isEmpty());
 
-    qCDebug(QT_BT_BLUEZ) << "Writing long characteristic (prepare):"
-                         << Qt::hex << handle;
+    const int maxAvailablePayload = mtuSize - PREPARE_WRITE_HEADER_SIZE;
+    QList<Request> requests;
 
+    for (const PreparedWriteTransaction::Value &value : values) {
+        // is it a descriptor or characteristic?
+        QLowEnergyHandle targetHandle = 0;
+        const QLowEnergyDescriptor descriptor = descriptorForHandle(value.handle);
+        if (descriptor.isValid())
+            targetHandle = descriptor.handle();
+        else
+            targetHandle = characteristicForHandle(value.handle).handle();
 
-    const int maxAvailablePayload = mtuSize - PREPARE_WRITE_HEADER_SIZE;
-    const int requiredPayload = qMin(newValue.size() - offset, maxAvailablePayload);
-    const int dataSize = PREPARE_WRITE_HEADER_SIZE + requiredPayload;
+        if (!targetHandle) {
+            qCWarning(QT_BT_BLUEZ) << "Prepared write cancelled due to invalid handle"
+                                   << value.handle;
+            return;
+        }
 
-    Q_ASSERT((offset + requiredPayload) <= newValue.size());
-    Q_ASSERT(dataSize <= mtuSize);
+        qCDebug(QT_BT_BLUEZ) << "Writing long characteristic (prepare):"
+                             << Qt::hex << value.handle << "(size:" << value.value.size() << ")";
+
+        int offset = 0;
+        do {
+            const int requiredPayload = qMin(value.value.size() - offset, maxAvailablePayload);
+            const int dataSize = PREPARE_WRITE_HEADER_SIZE + requiredPayload;
+            Q_ASSERT(dataSize <= mtuSize);
+
+            QByteArray data(dataSize, Qt::Uninitialized);
+            data[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_REQUEST);
+            putBtData(targetHandle, data.data() + 1); // attribute handle
+            putBtData(quint16(offset), data.data() + 3); // offset into value
+            memcpy(data.data() + PREPARE_WRITE_HEADER_SIZE, value.value.constData() + offset,
+                   requiredPayload);
+
+            offset += requiredPayload;
+
+            Request request;
+            request.payload = data;
+            request.command = QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_REQUEST;
+            request.reference = (value.handle | (offset << 16));
+            requests.append(request);
+        } while (offset < value.value.size());
+    }
 
-    QByteArray data(dataSize, Qt::Uninitialized);
-    memcpy(data.data(), packet, PREPARE_WRITE_HEADER_SIZE);
-    memcpy(&(data.data()[PREPARE_WRITE_HEADER_SIZE]), &(newValue.constData()[offset]),
-                                               requiredPayload);
+    QByteArray data(EXECUTE_WRITE_HEADER_SIZE, Qt::Uninitialized);
+    data[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_REQUEST);
+    data[1] = 0x01; // execute pending write prepare requests
 
     Request request;
     request.payload = data;
-    request.command = QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_REQUEST;
-    request.reference = (handle | ((offset + requiredPayload) << 16));
-    request.reference2 = newValue;
-    openRequests.enqueue(request);
+    request.command = QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_REQUEST;
+    request.reference = (values.first().handle | (0x01 << 16));
+    requests.append(request);
+
+    for (const Request &queued : qAsConst(requests))
+        enqueueRequest(queued);
+
+    PreparedWriteTransaction transaction;
+    transaction.values = values;
+    preparedWriteTransactions.enqueue(transaction);
 }
 
 /*!
-    Sends an "Execute Write Request" for a long characteristic or descriptor write.
-    This cannot be used for executes in relation to reliable write requests.
-
-    A cancellation removes all pending prepare write request on the GATT server.
-    Otherwise this function sends an execute request for all pending prepare
-    write requests.
+    Drops the unsent fragments of the current prepared write transaction and
+    turns its "Execute Write Request" into a cancellation, which removes all
+    pending prepare write requests on the GATT server. The appropriate write
+    error is emitted once the cancellation comes through.
  */
-void QLowEnergyControllerPrivateBluez::sendExecuteWriteRequest(
-        const QLowEnergyHandle attrHandle, const QByteArray &newValue,
-        bool isCancelation)
-{
-    quint8 packet[EXECUTE_WRITE_HEADER_SIZE];
-    packet[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_REQUEST);
-    if (isCancelation)
-        packet[1] = 0x00; // cancel pending write prepare requests
-    else
-        packet[1] = 0x01; // execute pending write prepare requests
+void QLowEnergyControllerPrivateBluez::cancelPreparedWriteTransaction()
+{
+    Q_ASSERT(!preparedWriteTransactions.isEmpty());
+    preparedWriteTransactions.head().failed = true;
 
-    QByteArray data(EXECUTE_WRITE_HEADER_SIZE, Qt::Uninitialized);
-    memcpy(data.data(), packet, EXECUTE_WRITE_HEADER_SIZE);
+    while (!openRequests.isEmpty() && openRequests.head().command
+                   == QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_REQUEST) {
+        dequeueRequest();
+    }
 
-    qCDebug(QT_BT_BLUEZ) << "Sending Execute Write Request for long characteristic value"
-                         << Qt::hex << attrHandle;
+    Q_ASSERT(!openRequests.isEmpty() && openRequests.head().command
+                     == QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_REQUEST);
+    Request &request = openRequests.head();
+    request.payload[1] = 0x00; // cancel pending write prepare requests
+    request.reference = (request.reference.toUInt() & 0xffff);
 
-    Request request;
-    request.payload = data;
-    request.command = QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_REQUEST;
-    request.reference  = (attrHandle | ((isCancelation ? 0x00 : 0x01) << 16));
-    request.reference2 = newValue;
-    openRequests.prepend(request);
+    qCDebug(QT_BT_BLUEZ) << "Cancelling prepared write of"
+                         << Qt::hex << preparedWriteTransactions.head().values.first().handle;
 }
 
-
 /*!
     Writes long (prepare write request), short (write request)
     and writeWithoutResponse characteristic values.
 
-    TODO Reliable/prepare write across multiple characteristics is not supported
+    Reliable writes across multiple characteristics are handled by
+    writeCharacteristicsReliably().
  */
 void QLowEnergyControllerPrivateBluez::writeCharacteristic(
         const QSharedPointer<QLowEnergyServicePrivate> service,
@@ -2038,6 +2854,35 @@ void QLowEnergyControllerPrivateBluez::writeCharacteristic(
         writeCharacteristicForCentral(service, charHandle, charData.valueHandle, newValue, mode);
 }
 
+/*!
+    \internal
+
+    Queues all \a values on the remote prepare queue and writes them with a
+    single execute request.
+ */
+void QLowEnergyControllerPrivateBluez::writeCharacteristicsReliably(
+        const QSharedPointer<QLowEnergyServicePrivate> service,
+        const QList<QPair<QLowEnergyHandle, QByteArray>> &values)
+{
+    Q_ASSERT(!service.isNull());
+    Q_ASSERT(role == QLowEnergyController::CentralRole);
+
+    QList<PreparedWriteTransaction::Value> preparedValues;
+    preparedValues.reserve(values.size());
+    for (const auto &value : values) {
+        if (!service->characteristicList.contains(value.first)) {
+            service->setError(QLowEnergyService::CharacteristicWriteError);
+            return;
+        }
+        preparedValues.append({ value.first, value.second });
+    }
+    if (preparedValues.isEmpty())
+        return;
+
+    sendPreparedWriteRequests(preparedValues);
+    sendNextPendingRequest();
+}
+
 void QLowEnergyControllerPrivateBluez::writeDescriptor(
         const QSharedPointer<QLowEnergyServicePrivate> service,
         const QLowEnergyHandle charHandle,
@@ -2090,7 +2935,7 @@ void QLowEnergyControllerPrivateBluez::readCharacteristic(
     // reference2 not really required but false prevents service discovery
     // code from running in QBluezConst::AttCommand::ATT_OP_READ_RESPONSE handler
     request.reference2 = false;
-    openRequests.enqueue(request);
+    enqueueRequest(request);
 
     sendNextPendingRequest();
 }
@@ -2125,7 +2970,7 @@ void QLowEnergyControllerPrivateBluez::readDescriptor(
     // reference2 not really required but false prevents service discovery
     // code from running in QBluezConst::AttCommand::ATT_OP_READ_RESPONSE handler
     request.reference2 = false;
-    openRequests.enqueue(request);
+    enqueueRequest(request);
 
     sendNextPendingRequest();
 }
@@ -2144,13 +2989,15 @@ bool QLowEnergyControllerPrivateBluez::increaseEncryptLevelfRequired(
     case QBluezConst::AttError::ATT_ERROR_INSUF_ENCRYPTION:
     case QBluezConst::AttError::ATT_ERROR_INSUF_AUTHENTICATION:
     case QBluezConst::AttError::ATT_ERROR_INSUF_ENCR_KEY_SIZE:
-        if (!hciManager->isValid())
+        if (!hciManager || !hciManager->isValid())
             return false;
         if (!hciManager->monitorEvent(HciManager::HciEvent::EVT_ENCRYPT_CHANGE))
             return false;
         if (securityLevelValue != BT_SECURITY_HIGH) {
             qCDebug(QT_BT_BLUEZ) << "Requesting encrypted link";
             if (setSecurityLevel(BT_SECURITY_HIGH)) {
+                attTracer.trace(QLowEnergyAttTracer::EncryptionChangeRequested,
+                                static_cast<quint8>(errorCode), BT_SECURITY_HIGH);
                 restartRequestTimer();
                 return true;
             }
@@ -2222,15 +3069,16 @@ void QLowEnergyControllerPrivateBluez::handleExchangeMtuRequest(const QByteArray
     // Send reply.
     QByteArray reply(MTU_EXCHANGE_HEADER_SIZE, Qt::Uninitialized);
     reply[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_EXCHANGE_MTU_RESPONSE);
-    putBtData(static_cast<quint16>(ATT_MAX_LE_MTU), reply.data() + 1);
+    putBtData(maximumMtu, reply.data() + 1);
     sendPacket(reply);
 
     // Apply requested MTU.
     const quint16 clientRxMtu = bt_get_le16(packet.constData() + 1);
-    mtuSize = qMax<quint16>(ATT_DEFAULT_LE_MTU, qMin<quint16>(clientRxMtu, ATT_MAX_LE_MTU));
+    mtuSize = qMax<quint16>(ATT_DEFAULT_LE_MTU, qMin<quint16>(clientRxMtu, maximumMtu));
+    attTracer.trace(QLowEnergyAttTracer::MtuExchanged, mtuSize);
     qCDebug(QT_BT_BLUEZ) << "MTU request from client:" << clientRxMtu
                          << "effective client RX MTU:" << mtuSize;
-    qCDebug(QT_BT_BLUEZ) << "Sending server RX MTU" << ATT_MAX_LE_MTU;
+    qCDebug(QT_BT_BLUEZ) << "Sending server RX MTU" << maximumMtu;
 }
 
 void QLowEnergyControllerPrivateBluez::handleFindInformationRequest(const QByteArray &packet)
@@ -2247,26 +3095,30 @@ void QLowEnergyControllerPrivateBluez::handleFindInformationRequest(const QByteA
                          endingHandle))
         return;
 
-    QList<Attribute> results = getAttributes(startingHandle, endingHandle);
-    if (results.isEmpty()) {
+    AttListResponseWriter response(listResponseBuffer, mtuSize,
+                                   QBluezConst::AttCommand::ATT_OP_FIND_INFORMATION_RESPONSE, 2);
+    const int lastHandle = qMin(endingHandle, lastLocalHandle);
+    int uuidSize = 0;
+    for (int handle = startingHandle; handle <= lastHandle && !response.isFull(); ++handle) {
+        const Attribute &attr = localAttributes.at(handle);
+        // All elements must have the UUID size of the first one.
+        if (uuidSize == 0) {
+            uuidSize = attUuidSize(attr.type);
+            response.header()[1] = uuidSize == 2 ? 0x1 : 0x2;
+            response.setElementSize(sizeof(QLowEnergyHandle) + uuidSize);
+        } else if (attUuidSize(attr.type) != uuidSize) {
+            break;
+        }
+        char *data = response.appendElement();
+        putDataAndIncrement(attr.handle, data);
+        putDataAndIncrement(attr.type, data);
+    }
+    if (response.isEmpty()) {
         sendErrorResponse(static_cast<QBluezConst::AttCommand>(packet.at(0)), startingHandle,
                           QBluezConst::AttError::ATT_ERROR_ATTRIBUTE_NOT_FOUND);
         return;
     }
-    ensureUniformUuidSizes(results);
-
-    QByteArray responsePrefix(2, Qt::Uninitialized);
-    const int uuidSize = getUuidSize(results.first().type);
-    responsePrefix[0] =
-            static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_FIND_INFORMATION_RESPONSE);
-    responsePrefix[1] = uuidSize == 2 ? 0x1 : 0x2;
-    const int elementSize = sizeof(QLowEnergyHandle) + uuidSize;
-    const auto elemWriter = [](const Attribute &attr, char *&data) {
-        putDataAndIncrement(attr.handle, data);
-        putDataAndIncrement(attr.type, data);
-    };
-    sendListResponse(responsePrefix, elementSize, results, elemWriter);
-
+    sendListResponse(response.finish());
 }
 
 void QLowEnergyControllerPrivateBluez::handleFindByTypeValueRequest(const QByteArray &packet)
@@ -2286,25 +3138,27 @@ void QLowEnergyControllerPrivateBluez::handleFindByTypeValueRequest(const QByteA
                          endingHandle))
         return;
 
-    const auto predicate = [value, this, type](const Attribute &attr) {
-        return attr.type == QBluetoothUuid(type) && attr.value == value
-                && checkReadPermissions(attr) == QBluezConst::AttError::ATT_ERROR_NO_ERROR;
-    };
-    const QList<Attribute> results = getAttributes(startingHandle, endingHandle, predicate);
-    if (results.isEmpty()) {
+    AttListResponseWriter response(listResponseBuffer, mtuSize,
+                                   QBluezConst::AttCommand::ATT_OP_FIND_BY_TYPE_VALUE_RESPONSE, 1);
+    response.setElementSize(2 * sizeof(QLowEnergyHandle));
+    const QBluetoothUuid typeUuid(type);
+    const int lastHandle = qMin(endingHandle, lastLocalHandle);
+    for (int handle = startingHandle; handle <= lastHandle && !response.isFull(); ++handle) {
+        const Attribute &attr = localAttributes.at(handle);
+        if (attr.type != typeUuid || attr.value != value
+                || checkReadPermissions(attr) != QBluezConst::AttError::ATT_ERROR_NO_ERROR) {
+            continue;
+        }
+        char *data = response.appendElement();
+        putDataAndIncrement(attr.handle, data);
+        putDataAndIncrement(attr.groupEndHandle, data);
+    }
+    if (response.isEmpty()) {
         sendErrorResponse(static_cast<QBluezConst::AttCommand>(packet.at(0)), startingHandle,
                           QBluezConst::AttError::ATT_ERROR_ATTRIBUTE_NOT_FOUND);
         return;
     }
-
-    QByteArray responsePrefix(
-            1, static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_FIND_BY_TYPE_VALUE_RESPONSE));
-    const int elemSize = 2 * sizeof(QLowEnergyHandle);
-    const auto elemWriter = [](const Attribute &attr, char *&data) {
-        putDataAndIncrement(attr.handle, data);
-        putDataAndIncrement(attr.groupEndHandle, data);
-    };
-    sendListResponse(responsePrefix, elemSize, results, elemWriter);
+    sendListResponse(response.finish());
 }
 
 void QLowEnergyControllerPrivateBluez::handleReadByTypeRequest(const QByteArray &packet)
@@ -2322,7 +3176,7 @@ void QLowEnergyControllerPrivateBluez::handleReadByTypeRequest(const QByteArray
     if (is16BitUuid) {
         type = QBluetoothUuid(bt_get_le16(typeStart));
     } else if (is128BitUuid) {
-        type = QBluetoothUuid(convert_uuid128(reinterpret_cast<const quint128 *>(typeStart)));
+        type = uuidFromLittleEndian(typeStart, 16);
     } else {
         qCWarning(QT_BT_BLUEZ) << "read by type request has invalid packet size" << packet.count();
         sendErrorResponse(static_cast<QBluezConst::AttCommand>(packet.at(0)), 0,
@@ -2335,34 +3189,43 @@ void QLowEnergyControllerPrivateBluez::handleReadByTypeRequest(const QByteArray
                          endingHandle))
         return;
 
-    // Get all attributes with matching type.
-    QList<Attribute> results =
-            getAttributes(startingHandle, endingHandle,
-                          [type](const Attribute &attr) { return attr.type == type; });
-    ensureUniformValueSizes(results);
-
-    if (results.isEmpty()) {
+    AttListResponseWriter response(listResponseBuffer, mtuSize,
+                                   QBluezConst::AttCommand::ATT_OP_READ_BY_TYPE_RESPONSE, 2);
+    // Longer values are cut to what fits into the response and its length field.
+    const int maxValueLength = qMin(mtuSize - 4, 253);
+    const int lastHandle = qMin(endingHandle, lastLocalHandle);
+    int valueLength = -1;
+    for (int handle = startingHandle; handle <= lastHandle && !response.isFull(); ++handle) {
+        const Attribute &attr = localAttributes.at(handle);
+        if (attr.type != type)
+            continue;
+        const QBluezConst::AttError error = checkReadPermissions(attr);
+        if (valueLength == -1) {
+            // Only the first match reports a permissions error. Any later match with an error
+            // or a different value size ends the list.
+            if (error != QBluezConst::AttError::ATT_ERROR_NO_ERROR) {
+                sendErrorResponse(static_cast<QBluezConst::AttCommand>(packet.at(0)),
+                                  attr.handle, error);
+                return;
+            }
+            valueLength = attr.value.count();
+            const int elementSize = sizeof(QLowEnergyHandle) + qMin(valueLength, maxValueLength);
+            response.header()[1] = elementSize;
+            response.setElementSize(elementSize);
+        } else if (error != QBluezConst::AttError::ATT_ERROR_NO_ERROR
+                   || attr.value.count() != valueLength) {
+            break;
+        }
+        char *data = response.appendElement();
+        putDataAndIncrement(attr.handle, data);
+        memcpy(data, attr.value.constData(), response.elementSize() - sizeof(QLowEnergyHandle));
+    }
+    if (response.isEmpty()) {
         sendErrorResponse(static_cast<QBluezConst::AttCommand>(packet.at(0)), startingHandle,
                           QBluezConst::AttError::ATT_ERROR_ATTRIBUTE_NOT_FOUND);
         return;
     }
-
-    const QBluezConst::AttError error = checkReadPermissions(results);
-    if (error != QBluezConst::AttError::ATT_ERROR_NO_ERROR) {
-        sendErrorResponse(static_cast<QBluezConst::AttCommand>(packet.at(0)),
-                          results.first().handle, error);
-        return;
-    }
-
-    const int elementSize = sizeof(QLowEnergyHandle) + results.first().value.count();
-    QByteArray responsePrefix(2, Qt::Uninitialized);
-    responsePrefix[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_READ_BY_TYPE_RESPONSE);
-    responsePrefix[1] = elementSize;
-    const auto elemWriter = [](const Attribute &attr, char *&data) {
-        putDataAndIncrement(attr.handle, data);
-        putDataAndIncrement(attr.value, data);
-    };
-    sendListResponse(responsePrefix, elementSize, results, elemWriter);
+    sendListResponse(response.finish());
 }
 
 void QLowEnergyControllerPrivateBluez::handleReadRequest(const QByteArray &packet)
@@ -2489,7 +3352,7 @@ void QLowEnergyControllerPrivateBluez::handleReadByGroupTypeRequest(const QByteA
     if (is16BitUuid) {
         type = QBluetoothUuid(bt_get_le16(typeStart));
     } else if (is128BitUuid) {
-        type = QBluetoothUuid(convert_uuid128(reinterpret_cast<const quint128 *>(typeStart)));
+        type = uuidFromLittleEndian(typeStart, 16);
     } else {
         qCWarning(QT_BT_BLUEZ) << "read by group type request has invalid packet size"
                                << packet.count();
@@ -2510,33 +3373,44 @@ void QLowEnergyControllerPrivateBluez::handleReadByGroupTypeRequest(const QByteA
         return;
     }
 
-    QList<Attribute> results =
-            getAttributes(startingHandle, endingHandle,
-                          [type](const Attribute &attr) { return attr.type == type; });
-    if (results.isEmpty()) {
+    AttListResponseWriter response(listResponseBuffer, mtuSize,
+                                   QBluezConst::AttCommand::ATT_OP_READ_BY_GROUP_RESPONSE, 2);
+    const int maxValueLength = qMin(mtuSize - 6, 251);
+    const int lastHandle = qMin(endingHandle, lastLocalHandle);
+    int valueLength = -1;
+    for (int handle = startingHandle; handle <= lastHandle && !response.isFull(); ++handle) {
+        const Attribute &attr = localAttributes.at(handle);
+        if (attr.type != type)
+            continue;
+        // Same rules as for Read By Type.
+        const QBluezConst::AttError error = checkReadPermissions(attr);
+        if (valueLength == -1) {
+            if (error != QBluezConst::AttError::ATT_ERROR_NO_ERROR) {
+                sendErrorResponse(static_cast<QBluezConst::AttCommand>(packet.at(0)),
+                                  attr.handle, error);
+                return;
+            }
+            valueLength = attr.value.count();
+            const int elementSize =
+                    2 * sizeof(QLowEnergyHandle) + qMin(valueLength, maxValueLength);
+            response.header()[1] = elementSize;
+            response.setElementSize(elementSize);
+        } else if (error != QBluezConst::AttError::ATT_ERROR_NO_ERROR
+                   || attr.value.count() != valueLength) {
+            break;
+        }
+        char *data = response.appendElement();
+        putDataAndIncrement(attr.handle, data);
+        putDataAndIncrement(attr.groupEndHandle, data);
+        memcpy(data, attr.value.constData(),
+               response.elementSize() - 2 * sizeof(QLowEnergyHandle));
+    }
+    if (response.isEmpty()) {
         sendErrorResponse(static_cast<QBluezConst::AttCommand>(packet.at(0)), startingHandle,
                           QBluezConst::AttError::ATT_ERROR_ATTRIBUTE_NOT_FOUND);
         return;
     }
-    const QBluezConst::AttError error = checkReadPermissions(results);
-    if (error != QBluezConst::AttError::ATT_ERROR_NO_ERROR) {
-        sendErrorResponse(static_cast<QBluezConst::AttCommand>(packet.at(0)),
-                          results.first().handle, error);
-        return;
-    }
-
-    ensureUniformValueSizes(results);
-
-    const int elementSize = 2 * sizeof(QLowEnergyHandle) + results.first().value.count();
-    QByteArray responsePrefix(2, Qt::Uninitialized);
-    responsePrefix[0] = static_cast<quint8>(QBluezConst::AttCommand::ATT_OP_READ_BY_GROUP_RESPONSE);
-    responsePrefix[1] = elementSize;
-    const auto elemWriter = [](const Attribute &attr, char *&data) {
-        putDataAndIncrement(attr.handle, data);
-        putDataAndIncrement(attr.groupEndHandle, data);
-        putDataAndIncrement(attr.value, data);
-    };
-    sendListResponse(responsePrefix, elementSize, results, elemWriter);
+    sendListResponse(response.finish());
 }
 
 void QLowEnergyControllerPrivateBluez::updateLocalAttributeValue(
@@ -2643,7 +3517,7 @@ void QLowEnergyControllerPrivateBluez::writeCharacteristicForCentral(const QShar
     switch (mode) {
     case QLowEnergyService::WriteWithResponse:
         if (newValue.size() > (mtuSize - WRITE_REQUEST_HEADER_SIZE)) {
-            sendNextPrepareWriteRequest(charHandle, newValue, 0);
+            sendPreparedWriteRequests({ { charHandle, newValue } });
             sendNextPendingRequest();
             return;
         }
@@ -2674,7 +3548,8 @@ void QLowEnergyControllerPrivateBluez::writeCharacteristicForCentral(const QShar
         }
         ++signingDataIt.value().counter;
         packet = LeCmacCalculator::createFullMessage(packet, signingDataIt.value().counter);
-        const quint64 mac = LeCmacCalculator().calculateMac(packet, signingDataIt.value().key);
+        const quint64 mac = macCalculator()->calculateMac(packet,
+                                                          signingDataIt.value().keySchedule);
         packet.resize(packet.count() + sizeof mac);
         putBtData(mac, packet.data() + packet.count() - sizeof mac);
         storeSignCounter(LocalSigningKey);
@@ -2699,7 +3574,7 @@ void QLowEnergyControllerPrivateBluez::writeCharacteristicForCentral(const QShar
     request.command = QBluezConst::AttCommand::ATT_OP_WRITE_REQUEST;
     request.reference = charHandle;
     request.reference2 = newValue;
-    openRequests.enqueue(request);
+    enqueueRequest(request);
 
     sendNextPendingRequest();
 }
@@ -2727,7 +3602,7 @@ void QLowEnergyControllerPrivateBluez::writeDescriptorForCentral(
         const QByteArray &newValue)
 {
     if (newValue.size() > (mtuSize - WRITE_REQUEST_HEADER_SIZE)) {
-        sendNextPrepareWriteRequest(descriptorHandle, newValue, 0);
+        sendPreparedWriteRequests({ { descriptorHandle, newValue } });
         sendNextPendingRequest();
         return;
     }
@@ -2749,7 +3624,7 @@ void QLowEnergyControllerPrivateBluez::writeDescriptorForCentral(
     request.command = QBluezConst::AttCommand::ATT_OP_WRITE_REQUEST;
     request.reference = (charHandle | (descriptorHandle << 16));
     request.reference2 = newValue;
-    openRequests.enqueue(request);
+    enqueueRequest(request);
 
     sendNextPendingRequest();
 }
@@ -2809,7 +3684,7 @@ void QLowEnergyControllerPrivateBluez::handleWriteRequestOrCommand(const QByteAr
 
         const quint64 macFromClient = getBtData<quint64>(packet.data() + packet.count() - 8);
         const bool signatureCorrect = verifyMac(packet.left(packet.count() - 12),
-                signingDataIt.value().key, signCounter, macFromClient);
+                signingDataIt.value().keySchedule, signCounter, macFromClient);
         if (!signatureCorrect) {
             qCWarning(QT_BT_BLUEZ) << "Signed Write packet has wrong signature, disconnecting";
             disconnectFromDevice(); // Recommended by spec v4.2, Vol 3, part C, 10.4.2
@@ -2958,19 +3833,8 @@ void QLowEnergyControllerPrivateBluez::sendErrorResponse(QBluezConst::AttCommand
     sendPacket(packet);
 }
 
-void QLowEnergyControllerPrivateBluez::sendListResponse(const QByteArray &packetStart, int elemSize,
-                                                        const QList<Attribute> &attributes,
-                                                        const ElemWriter &elemWriter)
+void QLowEnergyControllerPrivateBluez::sendListResponse(const QByteArray &response)
 {
-    const int offset = packetStart.count();
-    const int elemCount = qMin(attributes.count(), (mtuSize - offset) / elemSize);
-    const int totalPacketSize = offset + elemCount * elemSize;
-    QByteArray response(totalPacketSize, Qt::Uninitialized);
-    using namespace std;
-    memcpy(response.data(), packetStart.constData(), offset);
-    char *data = response.data() + offset;
-    for_each(attributes.constBegin(), attributes.constBegin() + elemCount,
-             [&data, elemWriter](const Attribute &attr) { elemWriter(attr, data); });
     qCDebug(QT_BT_BLUEZ) << "sending response:" << response.toHex();
     sendPacket(response);
 }
@@ -3085,6 +3949,122 @@ void QLowEnergyControllerPrivateBluez::handleConnectionRequest()
             ? BDADDR_LE_PUBLIC : BDADDR_LE_RANDOM;
     l2cpSocket->setSocketDescriptor(clientSocket, QBluetoothServiceInfo::L2capProtocol,
             QBluetoothSocket::SocketState::ConnectedState, QIODevice::ReadWrite | QIODevice::Unbuffered);
+    if (instrumentation.isEnabled())
+        enableReceiveTimestamps();
+    restoreClientConfigurations();
+    loadSigningDataIfNecessary(RemoteSigningKey);
+
+    Q_Q(QLowEnergyController);
+    setState(QLowEnergyController::ConnectedState);
+    emit q->connected();
+}
+
+QLowEnergyController *QLowEnergyControllerPrivateBluez::createLoopbackController(
+        QLowEnergyController::Role role, QObject *parent)
+{
+    QLowEnergyControllerPrivateBluez *d = new QLowEnergyControllerPrivateBluez();
+    d->role = role;
+    d->addressType = QLowEnergyController::PublicAddress;
+    d->loopback = true;
+    return createController(d, parent);
+}
+
+/*!
+ * Connects the loopback controllers \a central and \a peripheral, as created
+ * by createLoopbackController(), over a socket pair. Both controllers must be
+ * unconnected. Returns \c false if the bearer could not be established.
+ */
+bool QLowEnergyControllerPrivateBluez::connectLoopback(QLowEnergyController *central,
+                                                       QLowEnergyController *peripheral,
+                                                       quint16 mtu)
+{
+    Q_ASSERT(central && peripheral);
+    auto *centralPrivate = static_cast<QLowEnergyControllerPrivateBluez *>(get(central));
+    auto *peripheralPrivate = static_cast<QLowEnergyControllerPrivateBluez *>(get(peripheral));
+    if (!centralPrivate->loopback || !peripheralPrivate->loopback
+            || centralPrivate->role != QLowEnergyController::CentralRole
+            || peripheralPrivate->role != QLowEnergyController::PeripheralRole
+            || centralPrivate->state != QLowEnergyController::UnconnectedState
+            || peripheralPrivate->state != QLowEnergyController::UnconnectedState) {
+        qCWarning(QT_BT_BLUEZ) << "Loopback requires an unconnected loopback central"
+                               << "and peripheral";
+        return false;
+    }
+
+    int sockets[2];
+    if (::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sockets) < 0) {
+        qCWarning(QT_BT_BLUEZ) << "Cannot create loopback socket pair:" << qt_error_string(errno);
+        return false;
+    }
+
+    const quint16 offeredMtu = qBound<quint16>(ATT_DEFAULT_LE_MTU, mtu, ATT_MAX_LE_MTU);
+    centralPrivate->maximumMtu = offeredMtu;
+    peripheralPrivate->maximumMtu = offeredMtu;
+
+    // the addresses only identify the peers in logs and key settings
+    peripheralPrivate->attachLoopbackSocket(sockets[1], QBluetoothAddress(Q_UINT64_C(0x00005154c000)));
+    centralPrivate->attachLoopbackSocket(sockets[0], QBluetoothAddress(Q_UINT64_C(0x00005154c001)));
+    return true;
+}
+
+#ifdef QT_BUILD_INTERNAL
+void QLowEnergyControllerPrivateBluez::setLoopbackKeySettingsDirectory(
+        QLowEnergyController *controller, const QString &directory)
+{
+    Q_ASSERT(controller);
+    auto *d = static_cast<QLowEnergyControllerPrivateBluez *>(get(controller));
+    Q_ASSERT(d->loopback);
+    d->keySettingsDirectory = directory;
+    d->loopbackBonded = true;
+}
+
+void QLowEnergyControllerPrivateBluez::setLoopbackPacketFilter(
+        QLowEnergyController *controller, const std::function<void(QByteArray &)> &filter)
+{
+    Q_ASSERT(controller);
+    auto *d = static_cast<QLowEnergyControllerPrivateBluez *>(get(controller));
+    Q_ASSERT(d->loopback);
+    d->loopbackPacketFilter = filter;
+}
+#endif
+
+void QLowEnergyControllerPrivateBluez::attachLoopbackSocket(int socketDescriptor,
+                                                            const QBluetoothAddress &peer)
+{
+    remoteDevice = peer;
+    if (role == QLowEnergyController::CentralRole) {
+        setState(QLowEnergyController::ConnectingState);
+        createServicesForCentralIfRequired();
+    }
+
+    if (l2cpSocket) {
+        disconnect(l2cpSocket);
+        if (l2cpSocket->isOpen())
+            l2cpSocket->close();
+
+        l2cpSocket->deleteLater();
+        l2cpSocket = nullptr;
+    }
+
+    QBluetoothSocketPrivateBluez *rawSocketPrivate = new QBluetoothSocketPrivateBluez();
+    l2cpSocket = new QBluetoothSocket(
+                rawSocketPrivate, QBluetoothServiceInfo::L2capProtocol, this);
+    connect(l2cpSocket, &QBluetoothSocket::disconnected,
+            this, &QLowEnergyControllerPrivateBluez::l2cpDisconnected);
+    connect(l2cpSocket, &QBluetoothSocket::errorOccurred, this,
+            &QLowEnergyControllerPrivateBluez::l2cpErrorChanged);
+    connect(l2cpSocket, &QIODevice::readyRead, this, &QLowEnergyControllerPrivateBluez::l2cpReadyRead);
+    l2cpSocket->setSocketDescriptor(socketDescriptor, QBluetoothServiceInfo::L2capProtocol,
+            QBluetoothSocket::SocketState::ConnectedState, QIODevice::ReadWrite | QIODevice::Unbuffered);
+
+    if (role == QLowEnergyController::CentralRole) {
+        loadSigningDataIfNecessary(LocalSigningKey);
+        l2cpConnected();
+        return;
+    }
+
+    if (instrumentation.isEnabled())
+        enableReceiveTimestamps();
     restoreClientConfigurations();
     loadSigningDataIfNecessary(RemoteSigningKey);
 
@@ -3105,6 +4085,14 @@ void QLowEnergyControllerPrivateBluez::closeServerSocket()
 
 bool QLowEnergyControllerPrivateBluez::isBonded() const
 {
+    if (loopback) {
+#ifdef QT_BUILD_INTERNAL
+        return loopbackBonded;
+#else
+        return false;
+#endif
+    }
+
     // Pairing does not necessarily imply bonding, but we don't know whether the
     // bonding flag was set in the original pairing request.
     return QBluetoothLocalDevice(localAdapter).pairingStatus(remoteDevice)
@@ -3216,28 +4204,95 @@ void QLowEnergyControllerPrivateBluez::loadSigningDataIfNecessary(SigningKeyType
     quint128 csrk;
     using namespace std;
     memcpy(csrk.data, keyData.constData(), keyData.count());
-    signingData.insert(remoteDevice.toUInt64(), SigningData(csrk, counter - 1));
+    SigningData data(csrk, counter - 1);
+    LeCmacCalculator::wipe(&csrk, sizeof csrk);
+    data.keyType = keyType;
+    signingData.insert(remoteDevice.toUInt64(), data);
 }
 
-void QLowEnergyControllerPrivateBluez::storeSignCounter(SigningKeyType keyType) const
+/*
+    Called whenever the sign counter of the current peer has advanced.
+
+    The counters are kept in memory. The local counter is persisted in
+    reserved ranges ahead of its use, the remote one is written back after
+    signCounterFlushInterval and when the connection goes away.
+
+    The remote counter cannot be reserved ahead, as the peer's next writes
+    would then be rejected as replays after a restart. If the process dies
+    before the write back, signed writes received within the last
+    signCounterFlushInterval could be replayed once against the next
+    instance.
+*/
+void QLowEnergyControllerPrivateBluez::storeSignCounter(SigningKeyType keyType)
 {
-    const auto signingDataIt = signingData.constFind(remoteDevice.toUInt64());
-    if (signingDataIt == signingData.constEnd())
+    const auto signingDataIt = signingData.find(remoteDevice.toUInt64());
+    if (signingDataIt == signingData.end())
+        return;
+    SigningData &data = signingDataIt.value();
+    data.keyType = keyType;
+
+    if (keyType == LocalSigningKey) {
+        // all counters below the stored value may be used without writing
+        if (data.counter + 1 <= data.storedCounter)
+            return;
+        writeSignCounter(data, data.counter + 1 + signCounterReservation);
+        return;
+    }
+
+    data.counterDirty = true;
+    if (!signCounterFlushTimer) {
+        signCounterFlushTimer = new QTimer(this);
+        signCounterFlushTimer->setSingleShot(true);
+        signCounterFlushTimer->setInterval(signCounterFlushInterval);
+        connect(signCounterFlushTimer, &QTimer::timeout,
+                this, &QLowEnergyControllerPrivateBluez::flushSignCounter);
+    }
+    if (!signCounterFlushTimer->isActive())
+        signCounterFlushTimer->start();
+}
+
+/*
+    Writes the exact sign counter of the current peer, releasing the
+    unused part of a local reservation.
+*/
+void QLowEnergyControllerPrivateBluez::flushSignCounter()
+{
+    if (signCounterFlushTimer)
+        signCounterFlushTimer->stop();
+
+    const auto signingDataIt = signingData.find(remoteDevice.toUInt64());
+    if (signingDataIt == signingData.end())
         return;
+    SigningData &data = signingDataIt.value();
+    if (data.counterDirty || data.counter + 1 != data.storedCounter)
+        writeSignCounter(data, data.counter + 1);
+}
+
+void QLowEnergyControllerPrivateBluez::writeSignCounter(SigningData &data, quint32 counterValue)
+{
+    // A counter that could not be written stays pending and is written again
+    // with the next signed write or flush.
     const QString settingsFilePath = keySettingsFilePath();
     if (!QFileInfo(settingsFilePath).exists())
         return;
     QSettings settings(settingsFilePath, QSettings::IniFormat);
     if (!settings.isWritable())
         return;
-    settings.beginGroup(signingKeySettingsGroup(keyType));
+    settings.beginGroup(signingKeySettingsGroup(data.keyType));
     const QString counterKey = QLatin1String("Counter");
-    if (!settings.allKeys().contains(counterKey))
+    if (!settings.contains(counterKey))
         return;
-    const quint32 counterValue = signingDataIt.value().counter + 1;
-    if (counterValue == settings.value(counterKey).toUInt())
-        return;
-    settings.setValue(counterKey, counterValue);
+    if (counterValue != settings.value(counterKey).toUInt()) {
+        settings.setValue(counterKey, counterValue);
+        settings.sync();
+        if (settings.status() != QSettings::NoError) {
+            qCDebug(QT_BT_BLUEZ) << "Cannot store the sign counter in" << settingsFilePath;
+            return;
+        }
+    }
+
+    data.storedCounter = counterValue;
+    data.counterDirty = false;
 }
 
 QString QLowEnergyControllerPrivateBluez::signingKeySettingsGroup(SigningKeyType keyType) const
@@ -3247,23 +4302,19 @@ QString QLowEnergyControllerPrivateBluez::signingKeySettingsGroup(SigningKeyType
 
 QString QLowEnergyControllerPrivateBluez::keySettingsFilePath() const
 {
+#ifdef QT_BUILD_INTERNAL
+    return QString::fromLatin1("%1/%2/%3/info")
+            .arg(keySettingsDirectory, localAdapter.toString(), remoteDevice.toString());
+#else
     return QString::fromLatin1("/var/lib/bluetooth/%1/%2/info")
             .arg(localAdapter.toString(), remoteDevice.toString());
+#endif
 }
 
 static QByteArray uuidToByteArray(const QBluetoothUuid &uuid)
 {
     QByteArray ba;
-    if (uuid.minimumSize() == 2) {
-        ba.resize(2);
-        putBtData(uuid.toUInt16(), ba.data());
-    } else {
-        ba.resize(16);
-        quint128 hostOrder;
-        quint128 qtUuidOrder = uuid.toUInt128();
-        ntoh128(&qtUuidOrder, &hostOrder);
-        putBtData(hostOrder, ba.data());
-    }
+    QtBluetoothPrivate::appendUuidLittleEndian(ba, uuid, attUuidSize(uuid));
     return ba;
 }
 
@@ -3385,31 +4436,6 @@ int QLowEnergyControllerPrivateBluez::mtu() const
     return mtuSize;
 }
 
-void QLowEnergyControllerPrivateBluez::ensureUniformAttributes(
-        QList<Attribute> &attributes, const std::function<int(const Attribute &)> &getSize)
-{
-    if (attributes.isEmpty())
-        return;
-    const int firstSize = getSize(attributes.first());
-    const auto it = std::find_if(attributes.begin() + 1, attributes.end(),
-            [firstSize, getSize](const Attribute &attr) { return getSize(attr) != firstSize; });
-    if (it != attributes.end())
-        attributes.erase(it, attributes.end());
-
-}
-
-void QLowEnergyControllerPrivateBluez::ensureUniformUuidSizes(QList<Attribute> &attributes)
-{
-    ensureUniformAttributes(attributes,
-                            [](const Attribute &attr) { return getUuidSize(attr.type); });
-}
-
-void QLowEnergyControllerPrivateBluez::ensureUniformValueSizes(QList<Attribute> &attributes)
-{
-    ensureUniformAttributes(attributes,
-                            [](const Attribute &attr) { return attr.value.count(); });
-}
-
 QList<QLowEnergyControllerPrivateBluez::Attribute>
 QLowEnergyControllerPrivateBluez::getAttributes(QLowEnergyHandle startHandle,
                                                 QLowEnergyHandle endHandle,
@@ -3474,36 +4500,19 @@ QBluezConst::AttError QLowEnergyControllerPrivateBluez::checkReadPermissions(con
     return checkPermissions(attr, QLowEnergyCharacteristic::Read);
 }
 
-QBluezConst::AttError
-QLowEnergyControllerPrivateBluez::checkReadPermissions(QList<Attribute> &attributes)
-{
-    if (attributes.isEmpty())
-        return QBluezConst::AttError::ATT_ERROR_NO_ERROR;
-
-    // The logic prescribed in the spec is as follows:
-    //    1) If the first in a list of matching attributes has a permissions error,
-    //       then that error is returned via an error response.
-    //    2) If any other element of that list would cause a permissions error, then all
-    //       attributes from this one on are not part of the result set, but no error is returned.
-    const QBluezConst::AttError error = checkReadPermissions(attributes.first());
-    if (error != QBluezConst::AttError::ATT_ERROR_NO_ERROR)
-        return error;
-    const auto it =
-            std::find_if(attributes.begin() + 1, attributes.end(), [this](const Attribute &attr) {
-                return checkReadPermissions(attr) != QBluezConst::AttError::ATT_ERROR_NO_ERROR;
-            });
-    if (it != attributes.end())
-        attributes.erase(it, attributes.end());
-    return QBluezConst::AttError::ATT_ERROR_NO_ERROR;
+bool QLowEnergyControllerPrivateBluez::verifyMac(const QByteArray &message,
+                                                 const LeCmacCalculator::KeySchedule &key,
+                                                 quint32 signCounter, quint64 expectedMac)
+{
+    return macCalculator()->verify(LeCmacCalculator::createFullMessage(message, signCounter), key,
+                                   expectedMac);
 }
 
-bool QLowEnergyControllerPrivateBluez::verifyMac(const QByteArray &message, const quint128 &csrk,
-                                             quint32 signCounter, quint64 expectedMac)
+LeCmacCalculator *QLowEnergyControllerPrivateBluez::macCalculator()
 {
     if (!cmacCalculator)
         cmacCalculator = new LeCmacCalculator;
-    return cmacCalculator->verify(LeCmacCalculator::createFullMessage(message, signCounter), csrk,
-                                expectedMac);
+    return cmacCalculator;
 }
 
 QT_END_NAMESPACE
@@ -58,7 +58,9 @@
 #include <QtBluetooth/qlowenergycharacteristic.h>
 #include "qlowenergycontroller.h"
 #include "qlowenergycontrollerbase_p.h"
+#include "qlowenergyatttracer_p.h"
 #include "bluez/bluez_data_p.h"
+#include "lecmaccalculator_p.h"
 
 #include <QtBluetooth/QBluetoothSocket>
 #include <functional>
@@ -69,7 +71,6 @@ class QLowEnergyServiceData;
 class QTimer;
 
 class HciManager;
-class LeCmacCalculator;
 class QSocketNotifier;
 class RemoteDeviceManager;
 
@@ -92,11 +93,15 @@ public:
     void discoverServices() override;
     void discoverServiceDetails(const QBluetoothUuid &service,
                                 QLowEnergyService::DiscoveryMode mode) override;
+    void discoverAllServiceDetails(const QList<QBluetoothUuid> &services,
+                                   QLowEnergyService::DiscoveryMode mode) override;
 
     void startAdvertising(const QLowEnergyAdvertisingParameters &params,
                           const QLowEnergyAdvertisingData &advertisingData,
                           const QLowEnergyAdvertisingData &scanResponseData) override;
     void stopAdvertising() override;
+    void updateAdvertisingData(const QLowEnergyAdvertisingData &advertisingData,
+                               const QLowEnergyAdvertisingData &scanResponseData) override;
 
     void requestConnectionUpdate(const QLowEnergyConnectionParameters &params) override;
 
@@ -111,6 +116,10 @@ public:
     void writeCharacteristic(const QSharedPointer<QLowEnergyServicePrivate> service,
                              const QLowEnergyHandle charHandle,
                              const QByteArray &newValue, QLowEnergyService::WriteMode mode) override;
+    void writeCharacteristicsReliably(const QSharedPointer<QLowEnergyServicePrivate> service,
+                                      const QList<QPair<QLowEnergyHandle, QByteArray>> &values)
+                                      override;
+
     void writeDescriptor(const QSharedPointer<QLowEnergyServicePrivate> service,
                          const QLowEnergyHandle charHandle,
                          const QLowEnergyHandle descriptorHandle,
@@ -121,6 +130,26 @@ public:
 
     int mtu() const override;
 
+    // In-process ATT bearer over socketpair(AF_UNIX, SOCK_SEQPACKET) instead
+    // of an L2CAP channel, for tests and benchmarks without radio hardware.
+    // Loopback controllers have no local adapter and are only connected via
+    // connectLoopback(). Both sides offer mtu during the MTU exchange.
+    static QLowEnergyController *createLoopbackController(QLowEnergyController::Role role,
+                                                          QObject *parent = nullptr);
+    static bool connectLoopback(QLowEnergyController *central,
+                                QLowEnergyController *peripheral, quint16 mtu);
+#ifdef QT_BUILD_INTERNAL
+    // Key settings of a loopback controller are kept in
+    // <directory>/<adapter>/<peer>/info instead of the BlueZ storage, and its
+    // peer counts as bonded, so that the two can exchange signed writes.
+    static void setLoopbackKeySettingsDirectory(QLowEnergyController *controller,
+                                                const QString &directory);
+    // Every PDU a loopback controller sends is passed to filter first, which
+    // may change it, so that tests can observe the traffic or inject faults.
+    static void setLoopbackPacketFilter(QLowEnergyController *controller,
+                                        const std::function<void(QByteArray &)> &filter);
+#endif
+
     struct Attribute {
         Attribute() : handle(0) {}
 
@@ -137,8 +166,44 @@ public:
     QList<Attribute> localAttributes;
 
 private:
+    void attachLoopbackSocket(int socketDescriptor, const QBluetoothAddress &peer);
+
     quint16 connectionHandle = 0;
     QBluetoothSocket *l2cpSocket = nullptr;
+    bool loopback = false;
+#ifdef QT_BUILD_INTERNAL
+    bool loopbackBonded = false;
+    std::function<void(QByteArray &)> loopbackPacketFilter;
+    QString keySettingsDirectory = QStringLiteral("/var/lib/bluetooth");
+#endif
+    // Detail discovery of several services in combined passes over their
+    // attribute handles, see discoverAllServiceDetails()
+    struct ServiceDetailsDiscovery {
+        enum Step {
+            NoStep = -1,
+            IncludeDiscovery,
+            CharacteristicDiscovery,
+            DescriptorDiscovery,
+            ValueRead, // read or read blob request
+            ValueReadByType, // values of all characteristics sharing a uuid
+            MultipleValueRead // fixed size descriptor values
+        };
+        struct ValueTarget {
+            QSharedPointer<QLowEnergyServicePrivate> service;
+            QLowEnergyHandle charHandle = 0;
+            QLowEnergyHandle descriptorHandle = 0;
+        };
+
+        QList<QSharedPointer<QLowEnergyServicePrivate>> services; // sorted by start handle
+        QLowEnergyService::DiscoveryMode mode = QLowEnergyService::FullDiscovery;
+        QLowEnergyHandle startHandle = 0;
+        QLowEnergyHandle endHandle = 0;
+        QList<QLowEnergyHandle> charHandles; // sorted, of all services
+        QHash<QLowEnergyHandle, ValueTarget> pendingValues;
+        QHash<QLowEnergyServicePrivate *, int> pendingValueCount;
+    };
+    ServiceDetailsDiscovery serviceDetailsDiscovery;
+
     struct Request {
         QBluezConst::AttCommand command;
         QByteArray payload;
@@ -146,6 +211,10 @@ private:
         // requirements this is WIP
         QVariant reference;
         QVariant reference2;
+        ServiceDetailsDiscovery::Step detailsStep = ServiceDetailsDiscovery::NoStep;
+        // monotonic timestamps for QLowEnergyControllerInstrumentation
+        qint64 enqueueTime = 0;
+        qint64 sendTime = 0;
     };
     QQueue<Request> openRequests;
 
@@ -159,6 +228,19 @@ private:
     };
     QList<WriteRequest> openPrepareWriteRequests;
 
+    // Values queued on the remote prepare queue and written by one execute
+    // request. All fragments and the execute request of a transaction are
+    // enqueued at once and stay adjacent in openRequests.
+    struct PreparedWriteTransaction {
+        struct Value {
+            QLowEnergyHandle handle; // characteristic or descriptor handle
+            QByteArray value;
+        };
+        QList<Value> values;
+        bool failed = false; // error response or mismatching fragment echo
+    };
+    QQueue<PreparedWriteTransaction> preparedWriteTransactions;
+
     // Invariant: !scheduledIndications.isEmpty => indicationInFlight == true
     QList<QLowEnergyHandle> scheduledIndications;
     bool indicationInFlight = false;
@@ -185,25 +267,43 @@ private:
     };
     QHash<quint64, QList<ClientConfigurationData>> clientConfigData;
 
+    enum SigningKeyType { LocalSigningKey, RemoteSigningKey };
     struct SigningData {
         SigningData() = default;
         SigningData(const quint128 &csrk, quint32 signCounter = quint32(-1))
-            : key(csrk), counter(signCounter) {}
+            : keySchedule(LeCmacCalculator::expandKey(csrk)), counter(signCounter),
+              storedCounter(signCounter + 1) {}
 
-        quint128 key;
+        // holds the CSRK, cached as expanding the key is expensive
+        LeCmacCalculator::KeySchedule keySchedule;
         quint32 counter = quint32(-1);
+        quint32 storedCounter = 0; // next counter value in the key settings file
+        SigningKeyType keyType = LocalSigningKey;
+        bool counterDirty = false;
     };
     QHash<quint64, SigningData> signingData;
+    QTimer *signCounterFlushTimer = nullptr;
     LeCmacCalculator *cmacCalculator = nullptr;
 
+    // binary trace of the ATT bearer, written to attTraceFile on disconnect
+    QLowEnergyAttTracer attTracer;
+    QString attTraceFile;
+
     bool requestPending;
     quint16 mtuSize;
+    quint16 maximumMtu; // offered during the MTU exchange
+    QByteArray listResponseBuffer; // reused by the server for list responses
     int securityLevelValue;
     bool encryptionChangePending;
     bool receivedMtuExchangeRequest = false;
 
     HciManager *hciManager = nullptr;
     QLeAdvertiser *advertiser = nullptr;
+    // Rate limiting of advertising data updates; the latest pending data wins.
+    QTimer *advertisingUpdateTimer = nullptr;
+    QLowEnergyAdvertisingData pendingAdvertisingData;
+    QLowEnergyAdvertisingData pendingScanResponseData;
+    bool advertisingUpdatePending = false;
     QSocketNotifier *serverSocketNotifier = nullptr;
     QTimer *requestTimer = nullptr;
     RemoteDeviceManager* device1Manager = nullptr;
@@ -233,13 +333,18 @@ private:
     void storeClientConfigurations();
     void restoreClientConfigurations();
 
-    enum SigningKeyType { LocalSigningKey, RemoteSigningKey };
     void loadSigningDataIfNecessary(SigningKeyType keyType);
-    void storeSignCounter(SigningKeyType keyType) const;
+    void storeSignCounter(SigningKeyType keyType);
+    void flushSignCounter();
+    void writeSignCounter(SigningData &data, quint32 counterValue);
     QString signingKeySettingsGroup(SigningKeyType keyType) const;
     QString keySettingsFilePath() const;
 
     void sendPacket(const QByteArray &packet);
+    void writePacket(const QByteArray &packet);
+    void enqueueRequest(const Request &request, bool prepend = false);
+    Request dequeueRequest();
+    void flushAttTrace();
     void sendNextPendingRequest();
     void processReply(const Request &request, const QByteArray &reply);
 
@@ -254,6 +359,21 @@ private:
                                    bool isLastValue);
 
     void discoverServiceDescriptors(const QBluetoothUuid &serviceUuid);
+
+    void sendServiceDetailsRequest(ServiceDetailsDiscovery::Step step, const QByteArray &payload,
+                                   const QVariant &reference = QVariant(),
+                                   const QVariant &reference2 = QVariant(), bool prepend = false);
+    void sendServiceDetailsReadByType(ServiceDetailsDiscovery::Step step,
+                                      QLowEnergyHandle startHandle);
+    void processServiceDetailsReply(const Request &request, const QByteArray &response,
+                                    bool isErrorResponse);
+    QSharedPointer<QLowEnergyServicePrivate> serviceDetailsOwner(QLowEnergyHandle handle) const;
+    void discoverServiceDetailsDescriptors(QLowEnergyHandle startHandle);
+    void readServiceDetailsValues();
+    void readServiceDetailsValue(QLowEnergyHandle handle, quint16 offset = 0);
+    void storeServiceDetailsValue(QLowEnergyHandle handle, const QByteArray &value,
+                                  bool appendValue);
+    void finishServiceDetailsValue(QLowEnergyHandle handle);
     void discoverNextDescriptor(QSharedPointer<QLowEnergyServicePrivate> serviceData,
                                 const QList<QLowEnergyHandle> pendingCharHandles,
                                 QLowEnergyHandle startingHandle);
@@ -261,16 +381,15 @@ private:
     void exchangeMTU();
     bool setSecurityLevel(int level);
     int securityLevel() const;
-    void sendExecuteWriteRequest(const QLowEnergyHandle attrHandle,
-                                 const QByteArray &newValue,
-                                 bool isCancelation);
-    void sendNextPrepareWriteRequest(const QLowEnergyHandle handle,
-                                     const QByteArray &newValue, quint16 offset);
+    void enableReceiveTimestamps();
+    void sendPreparedWriteRequests(const QList<PreparedWriteTransaction::Value> &values);
+    void cancelPreparedWriteTransaction();
     bool increaseEncryptLevelfRequired(QBluezConst::AttError errorCode);
 
     void resetController();
 
     void handleAdvertisingError();
+    void applyAdvertisingDataUpdate();
 
     bool checkPacketSize(const QByteArray &packet, int minSize, int maxSize = -1);
     bool checkHandle(const QByteArray &packet, QLowEnergyHandle handle);
@@ -292,20 +411,13 @@ private:
     void sendErrorResponse(QBluezConst::AttCommand request, quint16 handle,
                            QBluezConst::AttError code);
 
-    using ElemWriter = std::function<void(const Attribute &, char *&)>;
-    void sendListResponse(const QByteArray &packetStart, int elemSize,
-                          const QList<Attribute> &attributes, const ElemWriter &elemWriter);
+    void sendListResponse(const QByteArray &response);
 
     void sendNotification(QLowEnergyHandle handle);
     void sendIndication(QLowEnergyHandle handle);
     void sendNotificationOrIndication(QBluezConst::AttCommand opCode, QLowEnergyHandle handle);
     void sendNextIndication();
 
-    void ensureUniformAttributes(QList<Attribute> &attributes,
-                                 const std::function<int(const Attribute &)> &getSize);
-    void ensureUniformUuidSizes(QList<Attribute> &attributes);
-    void ensureUniformValueSizes(QList<Attribute> &attributes);
-
     using AttributePredicate = std::function<bool(const Attribute &)>;
     QList<Attribute> getAttributes(
             QLowEnergyHandle startHandle, QLowEnergyHandle endHandle,
@@ -314,10 +426,10 @@ private:
     QBluezConst::AttError checkPermissions(const Attribute &attr,
                                            QLowEnergyCharacteristic::PropertyType type);
     QBluezConst::AttError checkReadPermissions(const Attribute &attr);
-    QBluezConst::AttError checkReadPermissions(QList<Attribute> &attributes);
 
-    bool verifyMac(const QByteArray &message, const quint128 &csrk, quint32 signCounter,
-                   quint64 expectedMac);
+    bool verifyMac(const QByteArray &message, const LeCmacCalculator::KeySchedule &key,
+                   quint32 signCounter, quint64 expectedMac);
+    LeCmacCalculator *macCalculator();
 
     void updateLocalAttributeValue(
             QLowEnergyHandle handle,
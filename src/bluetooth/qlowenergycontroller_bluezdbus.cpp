@@ -147,7 +147,7 @@ void QLowEnergyControllerPrivateBluezDBus::devicePropertiesChanged(
             if (serviceData->state != QLowEnergyService::RemoteServiceDiscovered)
                 return;
 
-            QHash<QLowEnergyHandle, QLowEnergyServicePrivate::CharData>::iterator iter;
+            CharacteristicDataMap::iterator iter;
             iter = serviceData->characteristicList.begin();
             while (iter != serviceData->characteristicList.end()) {
                 auto &charData = iter.value();
@@ -960,6 +960,18 @@ void QLowEnergyControllerPrivateDarwin::writeDescriptor(const QSharedPointer<QLo
     });
 }
 
+void QLowEnergyControllerPrivateDarwin::writeClientCharacteristicConfiguration(
+        const QSharedPointer<QLowEnergyServicePrivate> service,
+        const QLowEnergyHandle charHandle,
+        const QLowEnergyHandle descriptorHandle,
+        const QByteArray &newValue)
+{
+    Q_UNUSED(descriptorHandle);
+
+    // CoreBluetooth does not allow writing the client characteristic configuration
+    setNotifyValue(service, charHandle, newValue);
+}
+
 quint16 QLowEnergyControllerPrivateDarwin::updateValueOfDescriptor(QLowEnergyHandle charHandle, QLowEnergyHandle descHandle,
                                                                    const QByteArray &value, bool appendValue)
 {
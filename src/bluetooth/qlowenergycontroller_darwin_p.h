@@ -98,6 +98,11 @@ public:
                          const QLowEnergyHandle charHandle,
                          const QLowEnergyHandle descriptorHandle,
                          const QByteArray &newValue) override;
+    void writeClientCharacteristicConfiguration(
+            const QSharedPointer<QLowEnergyServicePrivate> service,
+            const QLowEnergyHandle charHandle,
+            const QLowEnergyHandle descriptorHandle,
+            const QByteArray &newValue) override;
 
 
     void requestConnectionUpdate(const QLowEnergyConnectionParameters &params) override;
@@ -351,7 +351,7 @@ public:
     QBluetoothUuid mService;
     QLowEnergyService::DiscoveryMode mMode;
     ComPtr<IGattDeviceService3> mDeviceService;
-    QHash<QLowEnergyHandle, QLowEnergyServicePrivate::CharData> mCharacteristicList;
+    CharacteristicDataMap mCharacteristicList;
     uint mCharacteristicsCountToBeDiscovered;
     quint16 mStartHandle = 0;
     quint16 mEndHandle = 0;
@@ -359,7 +359,7 @@ public:
 
 signals:
     void charListObtained(const QBluetoothUuid &service,
-                          QHash<QLowEnergyHandle, QLowEnergyServicePrivate::CharData> charList,
+                          CharacteristicDataMap charList,
                           QList<QBluetoothUuid> indicateChars, QLowEnergyHandle startHandle,
                           QLowEnergyHandle endHandle);
     void errorOccured(const QString &error);
@@ -1264,8 +1264,8 @@ void QLowEnergyControllerPrivateWinRT::discoverServiceDetails(
     connect(worker, &QWinRTLowEnergyServiceHandler::errorOccured,
             this, &QLowEnergyControllerPrivateWinRT::handleServiceHandlerError);
     connect(worker, &QWinRTLowEnergyServiceHandler::charListObtained, this,
-            [this](const QBluetoothUuid &service, QHash<QLowEnergyHandle,
-            QLowEnergyServicePrivate::CharData> charList, QList<QBluetoothUuid> indicateChars,
+            [this](const QBluetoothUuid &service, CharacteristicDataMap charList,
+            QList<QBluetoothUuid> indicateChars,
             QLowEnergyHandle startHandle, QLowEnergyHandle endHandle) {
         if (!serviceList.contains(service)) {
             qCWarning(QT_BT_WINDOWS)
@@ -162,24 +162,15 @@ QLowEnergyCharacteristic QLowEnergyControllerPrivate::characteristicForHandle(
     if (service.isNull())
         return QLowEnergyCharacteristic();
 
-    if (service->characteristicList.isEmpty())
-        return QLowEnergyCharacteristic();
-
-    // check whether it is the handle of a characteristic header
-    if (service->characteristicList.contains(handle))
-        return QLowEnergyCharacteristic(service, handle);
-
-    // check whether it is the handle of the characteristic value or its descriptors
-    QList<QLowEnergyHandle> charHandles = service->characteristicList.keys();
-    std::sort(charHandles.begin(), charHandles.end());
-    for (int i = charHandles.size() - 1; i >= 0; i--) {
-        if (charHandles.at(i) > handle)
-            continue;
+    const CharacteristicDataMap &characteristicList = service->characteristicList;
 
-        return QLowEnergyCharacteristic(service, charHandles.at(i));
-    }
+    // The handle is either a characteristic header or belongs to the value or
+    // descriptors following the closest header before it.
+    const auto it = characteristicList.upperBound(handle);
+    if (it == characteristicList.constBegin())
+        return QLowEnergyCharacteristic();
 
-    return QLowEnergyCharacteristic();
+    return QLowEnergyCharacteristic(service, std::prev(it).key());
 }
 
 /*!
@@ -193,10 +184,9 @@ QLowEnergyDescriptor QLowEnergyControllerPrivate::descriptorForHandle(
     if (!matchingChar.isValid())
         return QLowEnergyDescriptor();
 
-    const QLowEnergyServicePrivate::CharData charData = matchingChar.
-            d_ptr->characteristicList[matchingChar.attributeHandle()];
-
-    if (charData.descriptorList.contains(handle))
+    const CharacteristicDataMap &characteristicList = matchingChar.d_ptr->characteristicList;
+    const auto charIt = characteristicList.constFind(matchingChar.attributeHandle());
+    if (charIt != characteristicList.constEnd() && charIt->descriptorList.contains(handle))
         return QLowEnergyDescriptor(matchingChar.d_ptr, matchingChar.attributeHandle(),
                                     handle);
 
@@ -270,6 +260,215 @@ void QLowEnergyControllerPrivate::invalidateServices()
     lastLocalHandle = {};
 }
 
+void QLowEnergyControllerPrivate::startServiceDetailsDiscovery(
+                            QLowEnergyService::DiscoveryMode mode)
+{
+    Q_Q(QLowEnergyController);
+
+    QList<QBluetoothUuid> services;
+    for (auto it = serviceList.cbegin(), end = serviceList.cend(); it != end; ++it) {
+        QLowEnergyServicePrivate *service = it.value().data();
+        if (service->state != QLowEnergyService::RemoteService)
+            continue;
+
+        const QBluetoothUuid uuid = it.key();
+        services.append(uuid);
+        pendingServiceDetails.insert(uuid, connect(service, &QLowEnergyServicePrivate::stateChanged,
+                this, [this, uuid](QLowEnergyService::ServiceState state) {
+                    serviceDetailsStateChanged(uuid, state);
+                }));
+        service->setState(QLowEnergyService::RemoteServiceDiscovering);
+    }
+
+    if (services.isEmpty()) {
+        if (pendingServiceDetails.isEmpty()) {
+            QMetaObject::invokeMethod(q, &QLowEnergyController::allServiceDetailsDiscovered,
+                                      Qt::QueuedConnection);
+        }
+        return;
+    }
+
+    discoverAllServiceDetails(services, mode);
+}
+
+void QLowEnergyControllerPrivate::serviceDetailsStateChanged(
+                            const QBluetoothUuid &service, QLowEnergyService::ServiceState state)
+{
+    Q_Q(QLowEnergyController);
+
+    if (state == QLowEnergyService::RemoteServiceDiscovering)
+        return;
+
+    const auto it = pendingServiceDetails.find(service);
+    if (it == pendingServiceDetails.end())
+        return;
+    QObject::disconnect(it.value());
+    pendingServiceDetails.erase(it);
+
+    if (state == QLowEnergyService::InvalidService) {
+        // the connection is gone, nothing left to wait for
+        for (const QMetaObject::Connection &connection : qAsConst(pendingServiceDetails))
+            QObject::disconnect(connection);
+        pendingServiceDetails.clear();
+        queuedServiceDetails.clear();
+        return;
+    }
+
+    if (state == QLowEnergyService::RemoteServiceDiscovered)
+        emit q->serviceDetailsDiscovered(service);
+
+    if (!queuedServiceDetails.isEmpty()) {
+        const auto next = queuedServiceDetails.takeFirst();
+        discoverServiceDetails(next.first, next.second);
+    } else if (pendingServiceDetails.isEmpty())
+        emit q->allServiceDetailsDiscovered();
+}
+
+void QLowEnergyControllerPrivate::discoverAllServiceDetails(
+                            const QList<QBluetoothUuid> &services,
+                            QLowEnergyService::DiscoveryMode mode)
+{
+    // Backends without a combined discovery run the services one after another.
+    // If a run is active already, the new services are appended to it.
+    Q_ASSERT(!services.isEmpty());
+    const bool running = pendingServiceDetails.size() > services.size();
+    for (const QBluetoothUuid &service : services)
+        queuedServiceDetails.append({ service, mode });
+    if (running)
+        return;
+
+    const auto next = queuedServiceDetails.takeFirst();
+    discoverServiceDetails(next.first, next.second);
+}
+
+void QLowEnergyControllerPrivate::updateAdvertisingData(
+                            const QLowEnergyAdvertisingData &advertisingData,
+                            const QLowEnergyAdvertisingData &scanResponseData)
+{
+    // Backends which cannot replace the payload of a running advertisement
+    // fall back to restarting it.
+    stopAdvertising();
+    startAdvertising(advertisingParameters, advertisingData, scanResponseData);
+}
+
+void QLowEnergyControllerPrivate::writeCharacteristicsReliably(
+                            const QSharedPointer<QLowEnergyServicePrivate> service,
+                            const QList<QPair<QLowEnergyHandle, QByteArray>> &values)
+{
+    Q_UNUSED(values);
+
+    qCWarning(QT_BT) << "Reliable writes are not supported on this platform";
+    service->setError(QLowEnergyService::CharacteristicWriteError);
+}
+
+/*!
+    Writes the Client Characteristic Configuration Descriptor on behalf of
+    QLowEnergyService::subscribe(). Backends which cannot write the descriptor
+    directly override this function.
+ */
+void QLowEnergyControllerPrivate::writeClientCharacteristicConfiguration(
+                            const QSharedPointer<QLowEnergyServicePrivate> service,
+                            const QLowEnergyHandle charHandle,
+                            const QLowEnergyHandle descriptorHandle,
+                            const QByteArray &newValue)
+{
+    writeDescriptor(service, charHandle, descriptorHandle, newValue);
+}
+
+static QByteArray clientCharacteristicConfiguration(QLowEnergyService::SubscriptionMode mode)
+{
+    switch (mode) {
+    case QLowEnergyService::NotificationSubscription:
+        return QLowEnergyCharacteristic::CCCDEnableNotification;
+    case QLowEnergyService::IndicationSubscription:
+        return QLowEnergyCharacteristic::CCCDEnableIndication;
+    case QLowEnergyService::NoSubscription:
+        break;
+    }
+    return QLowEnergyCharacteristic::CCCDDisable;
+}
+
+/*!
+    Records the subscription of the characteristics in \a configurations, given as
+    pairs of characteristic and Client Characteristic Configuration Descriptor handles,
+    and writes the descriptors which do not hold the configuration for \a mode yet.
+ */
+void QLowEnergyControllerPrivate::subscribe(
+        const QSharedPointer<QLowEnergyServicePrivate> &service,
+        const QList<QPair<QLowEnergyHandle, QLowEnergyHandle>> &configurations,
+        QLowEnergyService::SubscriptionMode mode)
+{
+    const QByteArray newValue = clientCharacteristicConfiguration(mode);
+    QList<Subscription> &records = subscriptions[service->uuid];
+    QList<QLowEnergyHandle> written;
+
+    for (const auto &configuration : configurations) {
+        const QLowEnergyHandle charHandle = configuration.first;
+        const QLowEnergyHandle descriptorHandle = configuration.second;
+        if (written.contains(charHandle))
+            continue;
+
+        const auto charIt = service->characteristicList.constFind(charHandle);
+        if (charIt == service->characteristicList.constEnd())
+            continue;
+
+        records.removeIf([charHandle](const Subscription &record) {
+            return record.charHandle == charHandle;
+        });
+        if (mode != QLowEnergyService::NoSubscription)
+            records.append({ charHandle, charIt->uuid, mode });
+
+        written.append(charHandle);
+        if (charIt->descriptorList.value(descriptorHandle).value == newValue)
+            continue;
+
+        writeClientCharacteristicConfiguration(service, charHandle, descriptorHandle, newValue);
+    }
+
+    if (records.isEmpty())
+        subscriptions.remove(service->uuid);
+}
+
+/*!
+    Writes the recorded subscriptions of \a service again once its details have
+    been discovered. Descriptors the peripheral reports as configured already
+    are skipped.
+ */
+void QLowEnergyControllerPrivate::restoreSubscriptions(const QBluetoothUuid &service)
+{
+    if (role != QLowEnergyController::CentralRole)
+        return;
+
+    const auto recordsIt = subscriptions.find(service);
+    const QSharedPointer<QLowEnergyServicePrivate> servicePrivate = serviceList.value(service);
+    if (recordsIt == subscriptions.end() || servicePrivate.isNull())
+        return;
+
+    const QBluetoothUuid cccdUuid(QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration);
+    const CharacteristicDataMap &characteristicList = servicePrivate->characteristicList;
+    for (Subscription &record : recordsIt.value()) {
+        // handles usually survive a reconnect, otherwise fall back to the uuid
+        auto charIt = characteristicList.constFind(record.charHandle);
+        if (charIt == characteristicList.constEnd() || charIt->uuid != record.charUuid)
+            charIt = characteristicList.findByUuid(record.charUuid);
+        if (charIt == characteristicList.constEnd()) {
+            qCDebug(QT_BT) << "Cannot restore subscription of" << record.charUuid;
+            continue;
+        }
+        record.charHandle = charIt.key();
+
+        const auto descIt = charIt->descriptorList.findByUuid(cccdUuid);
+        if (descIt == charIt->descriptorList.constEnd())
+            continue;
+
+        const QByteArray newValue = clientCharacteristicConfiguration(record.mode);
+        if (descIt->value != newValue) {
+            writeClientCharacteristicConfiguration(servicePrivate, record.charHandle,
+                                                   descIt.key(), newValue);
+        }
+    }
+}
+
 QLowEnergyService *QLowEnergyControllerPrivate::addServiceHelper(
                             const QLowEnergyServiceData &service)
 {
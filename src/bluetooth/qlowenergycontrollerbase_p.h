@@ -55,7 +55,9 @@
 #include <QtCore/qobject.h>
 
 #include <QtBluetooth/qlowenergycontroller.h>
+#include <QtBluetooth/qlowenergyadvertisingparameters.h>
 
+#include "qlowenergycontrollerinstrumentation_p.h"
 #include "qlowenergyserviceprivate_p.h"
 
 QT_BEGIN_NAMESPACE
@@ -82,6 +84,8 @@ public:
     virtual void discoverServices() = 0;
     virtual void discoverServiceDetails(const QBluetoothUuid &service,
                                         QLowEnergyService::DiscoveryMode mode) = 0;
+    virtual void discoverAllServiceDetails(const QList<QBluetoothUuid> &services,
+                                           QLowEnergyService::DiscoveryMode mode);
 
     virtual void readCharacteristic(
                         const QSharedPointer<QLowEnergyServicePrivate> service,
@@ -96,17 +100,28 @@ public:
                         const QLowEnergyHandle charHandle,
                         const QByteArray &newValue,
                         QLowEnergyService::WriteMode writeMode) = 0;
+    virtual void writeCharacteristicsReliably(
+                        const QSharedPointer<QLowEnergyServicePrivate> service,
+                        const QList<QPair<QLowEnergyHandle, QByteArray>> &values);
     virtual void writeDescriptor(
                         const QSharedPointer<QLowEnergyServicePrivate> service,
                         const QLowEnergyHandle charHandle,
                         const QLowEnergyHandle descriptorHandle,
                         const QByteArray &newValue) = 0;
+    virtual void writeClientCharacteristicConfiguration(
+                        const QSharedPointer<QLowEnergyServicePrivate> service,
+                        const QLowEnergyHandle charHandle,
+                        const QLowEnergyHandle descriptorHandle,
+                        const QByteArray &newValue);
 
     virtual void startAdvertising(
                         const QLowEnergyAdvertisingParameters &params,
                         const QLowEnergyAdvertisingData &advertisingData,
                         const QLowEnergyAdvertisingData &scanResponseData) = 0;
     virtual void stopAdvertising() = 0;
+    virtual void updateAdvertisingData(
+                        const QLowEnergyAdvertisingData &advertisingData,
+                        const QLowEnergyAdvertisingData &scanResponseData);
 
     virtual void requestConnectionUpdate(
                         const QLowEnergyConnectionParameters & params) = 0;
@@ -146,6 +161,35 @@ public:
                                  bool appendValue);
     void invalidateServices();
 
+    // bookkeeping of discoverAllServiceDetails()
+    void startServiceDetailsDiscovery(QLowEnergyService::DiscoveryMode mode);
+    void serviceDetailsStateChanged(const QBluetoothUuid &service,
+                                    QLowEnergyService::ServiceState state);
+    QHash<QBluetoothUuid, QMetaObject::Connection> pendingServiceDetails;
+    // services the default discoverAllServiceDetails() has not started yet
+    QList<QPair<QBluetoothUuid, QLowEnergyService::DiscoveryMode>> queuedServiceDetails;
+
+    // subscriptions made via QLowEnergyService::subscribe(), kept across reconnects
+    struct Subscription {
+        QLowEnergyHandle charHandle;
+        QBluetoothUuid charUuid;
+        QLowEnergyService::SubscriptionMode mode;
+    };
+    void subscribe(const QSharedPointer<QLowEnergyServicePrivate> &service,
+                   const QList<QPair<QLowEnergyHandle, QLowEnergyHandle>> &configurations,
+                   QLowEnergyService::SubscriptionMode mode);
+    void restoreSubscriptions(const QBluetoothUuid &service);
+    QHash<QBluetoothUuid, QList<Subscription>> subscriptions;
+
+    // ATT latency statistics, filled by backends which support them
+    QLowEnergyControllerInstrumentation instrumentation;
+    static QLowEnergyControllerPrivate *get(QLowEnergyController *controller)
+    { return controller->d_func(); }
+    // wraps the backend d without calling init()
+    static QLowEnergyController *createController(QLowEnergyControllerPrivate *d,
+                                                  QObject *parent = nullptr)
+    { return new QLowEnergyController(d, parent); }
+
 protected:
     QLowEnergyController::ControllerState state = QLowEnergyController::UnconnectedState;
     QLowEnergyController::Error error = QLowEnergyController::NoError;
@@ -156,6 +200,9 @@ protected:
 
     QLowEnergyHandle lastLocalHandle{};
 
+    // parameters of the most recent startAdvertising() call
+    QLowEnergyAdvertisingParameters advertisingParameters;
+
     QString remoteName; // device name of the remote
     QBluetoothUuid deviceUuid; // quite useless anywhere but Darwin (CoreBluetooth).
 
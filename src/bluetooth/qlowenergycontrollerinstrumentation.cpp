@@ -0,0 +1,239 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qlowenergycontrollerinstrumentation_p.h"
+
+#include <QtCore/QDeadlineTimer>
+#include <QtCore/QJsonArray>
+#include <QtCore/qalgorithms.h>
+
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+qsizetype QLowEnergyLatencyHistogram::bucketIndex(qint64 value)
+{
+    value = qBound(Q_INT64_C(0), value, MaximumValue);
+    if (value < SubBucketCount)
+        return qsizetype(value);
+
+    // the top SubBucketBits bits of the value select the sub bucket
+    const int shift = 63 - int(qCountLeadingZeroBits(quint64(value))) - (SubBucketBits - 1);
+    const qint64 subBucket = (value >> shift) - SubBucketCount / 2;
+    return qsizetype(SubBucketCount + (shift - 1) * (SubBucketCount / 2) + subBucket);
+}
+
+QLowEnergyLatencyHistogram::Bucket QLowEnergyLatencyHistogram::bucketRange(qsizetype index)
+{
+    Bucket bucket;
+    if (index < SubBucketCount) {
+        bucket.lowerBound = bucket.upperBound = index;
+        return bucket;
+    }
+
+    const qsizetype offset = index - SubBucketCount;
+    const int shift = int(offset / (SubBucketCount / 2)) + 1;
+    const qint64 subBucket = SubBucketCount / 2 + offset % (SubBucketCount / 2);
+    bucket.lowerBound = subBucket << shift;
+    bucket.upperBound = bucket.lowerBound + (Q_INT64_C(1) << shift) - 1;
+    return bucket;
+}
+
+void QLowEnergyLatencyHistogram::record(qint64 value)
+{
+    value = qBound(Q_INT64_C(0), value, MaximumValue);
+    if (counts.isEmpty())
+        counts.resize(bucketCount());
+
+    ++counts[bucketIndex(value)];
+    if (total == 0 || value < min)
+        min = value;
+    if (total == 0 || value > max)
+        max = value;
+    sum += double(value);
+    ++total;
+}
+
+void QLowEnergyLatencyHistogram::add(const QLowEnergyLatencyHistogram &other)
+{
+    if (other.isEmpty())
+        return;
+
+    if (counts.isEmpty())
+        counts.resize(bucketCount());
+    for (qsizetype i = 0; i < other.counts.size(); ++i)
+        counts[i] += other.counts.at(i);
+
+    min = isEmpty() ? other.min : qMin(min, other.min);
+    max = isEmpty() ? other.max : qMax(max, other.max);
+    sum += other.sum;
+    total += other.total;
+}
+
+void QLowEnergyLatencyHistogram::reset()
+{
+    *this = QLowEnergyLatencyHistogram();
+}
+
+/*
+    Returns the highest value equivalent to the recorded value at
+    \a percentile (0 - 100), limited to the recorded minimum and maximum.
+*/
+qint64 QLowEnergyLatencyHistogram::valueAtPercentile(double percentile) const
+{
+    if (isEmpty())
+        return 0;
+
+    percentile = qBound(0.0, percentile, 100.0);
+    const quint64 rank = qMax(quint64(1), quint64(std::ceil(percentile / 100.0 * double(total))));
+    quint64 seen = 0;
+    for (qsizetype i = 0; i < counts.size(); ++i) {
+        seen += counts.at(i);
+        if (seen >= rank)
+            return qBound(min, bucketRange(i).upperBound, max);
+    }
+    return max;
+}
+
+QList<QLowEnergyLatencyHistogram::Bucket> QLowEnergyLatencyHistogram::buckets() const
+{
+    QList<Bucket> result;
+    for (qsizetype i = 0; i < counts.size(); ++i) {
+        if (!counts.at(i))
+            continue;
+        Bucket bucket = bucketRange(i);
+        bucket.count = counts.at(i);
+        result.append(bucket);
+    }
+    return result;
+}
+
+QJsonObject QLowEnergyLatencyHistogram::toJson() const
+{
+    QJsonArray bucketArray;
+    const QList<Bucket> nonEmpty = buckets();
+    for (const Bucket &bucket : nonEmpty) {
+        bucketArray.append(QJsonArray{ bucket.lowerBound, bucket.upperBound,
+                                       qint64(bucket.count) });
+    }
+
+    return QJsonObject{
+        { QStringLiteral("count"), qint64(total) },
+        { QStringLiteral("min"), minimum() },
+        { QStringLiteral("max"), maximum() },
+        { QStringLiteral("mean"), mean() },
+        { QStringLiteral("p50"), valueAtPercentile(50.0) },
+        { QStringLiteral("p90"), valueAtPercentile(90.0) },
+        { QStringLiteral("p99"), valueAtPercentile(99.0) },
+        { QStringLiteral("p999"), valueAtPercentile(99.9) },
+        { QStringLiteral("buckets"), bucketArray }
+    };
+}
+
+QLowEnergyControllerInstrumentation::QLowEnergyControllerInstrumentation()
+    : enabled(qEnvironmentVariableIntValue("QT_BLUETOOTH_LE_INSTRUMENTATION") > 0)
+{
+}
+
+void QLowEnergyControllerInstrumentation::reset()
+{
+    queueLatencyHistograms.clear();
+    responseLatencyHistograms.clear();
+    receiveDelayHistograms.clear();
+    notificationLatencyHistogram.reset();
+    queueDepthHistogram.reset();
+}
+
+qint64 QLowEnergyControllerInstrumentation::timestamp()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+void QLowEnergyControllerInstrumentation::recordQueueLatency(quint8 opcode, qint64 latency)
+{
+    queueLatencyHistograms[opcode].record(latency);
+}
+
+void QLowEnergyControllerInstrumentation::recordResponseLatency(quint8 opcode, qint64 latency)
+{
+    responseLatencyHistograms[opcode].record(latency);
+}
+
+void QLowEnergyControllerInstrumentation::recordReceiveDelay(quint8 opcode, qint64 delay)
+{
+    receiveDelayHistograms[opcode].record(delay);
+}
+
+void QLowEnergyControllerInstrumentation::recordNotificationLatency(qint64 latency)
+{
+    notificationLatencyHistogram.record(latency);
+}
+
+void QLowEnergyControllerInstrumentation::recordQueueDepth(qsizetype depth)
+{
+    queueDepthHistogram.record(depth);
+}
+
+static QJsonObject opcodeHistogramsToJson(const QMap<quint8, QLowEnergyLatencyHistogram> &map)
+{
+    QJsonObject result;
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        result.insert(QStringLiteral("0x%1").arg(uint(it.key()), 2, 16, QLatin1Char('0')),
+                      it.value().toJson());
+    }
+    return result;
+}
+
+/*
+    Returns a snapshot of all histograms. Per opcode histograms are keyed
+    by the hex value of the ATT request opcode, or of the received PDU
+    opcode for receive delays.
+*/
+QJsonObject QLowEnergyControllerInstrumentation::toJson() const
+{
+    return QJsonObject{
+        { QStringLiteral("queueLatency"), opcodeHistogramsToJson(queueLatencyHistograms) },
+        { QStringLiteral("responseLatency"), opcodeHistogramsToJson(responseLatencyHistograms) },
+        { QStringLiteral("receiveDelay"), opcodeHistogramsToJson(receiveDelayHistograms) },
+        { QStringLiteral("notificationLatency"), notificationLatencyHistogram.toJson() },
+        { QStringLiteral("queueDepth"), queueDepthHistogram.toJson() }
+    };
+}
+
+QT_END_NAMESPACE
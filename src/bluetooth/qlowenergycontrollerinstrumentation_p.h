@@ -0,0 +1,158 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QLOWENERGYCONTROLLERINSTRUMENTATION_P_H
+#define QLOWENERGYCONTROLLERINSTRUMENTATION_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtBluetooth/private/qtbluetoothglobal_p.h>
+#include <QtCore/QJsonObject>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+
+QT_BEGIN_NAMESPACE
+
+// Log-linear histogram in the spirit of HdrHistogram. Values below
+// SubBucketCount are counted exactly, larger values land in buckets whose
+// width is at most 1/(SubBucketCount / 2) of their lower bound. Values
+// above MaximumValue are clamped. The counts are only allocated on the
+// first record() call.
+class Q_BLUETOOTH_PRIVATE_EXPORT QLowEnergyLatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 6;
+    static constexpr qint64 SubBucketCount = Q_INT64_C(1) << SubBucketBits;
+    static constexpr int MagnitudeBits = 40;
+    static constexpr qint64 MaximumValue = (Q_INT64_C(1) << MagnitudeBits) - 1;
+
+    struct Bucket {
+        qint64 lowerBound = 0;
+        qint64 upperBound = 0; // inclusive
+        quint64 count = 0;
+    };
+
+    void record(qint64 value);
+    void add(const QLowEnergyLatencyHistogram &other);
+    void reset();
+
+    bool isEmpty() const { return total == 0; }
+    quint64 totalCount() const { return total; }
+    qint64 minimum() const { return total ? min : 0; }
+    qint64 maximum() const { return total ? max : 0; }
+    double mean() const { return total ? sum / double(total) : 0.0; }
+    qint64 valueAtPercentile(double percentile) const;
+
+    QList<Bucket> buckets() const;
+    QJsonObject toJson() const;
+
+    static qsizetype bucketIndex(qint64 value);
+    static Bucket bucketRange(qsizetype index);
+    static constexpr qsizetype bucketCount()
+    {
+        return SubBucketCount + (MagnitudeBits - SubBucketBits) * (SubBucketCount / 2);
+    }
+
+private:
+    QList<quint64> counts;
+    quint64 total = 0;
+    qint64 min = 0;
+    qint64 max = 0;
+    double sum = 0.0;
+};
+
+// Latency and queue depth statistics of the ATT bearer. All durations are
+// in nanoseconds. The object lives in and is only accessed from the
+// controller's thread.
+class Q_BLUETOOTH_PRIVATE_EXPORT QLowEnergyControllerInstrumentation
+{
+public:
+    QLowEnergyControllerInstrumentation();
+
+    bool isEnabled() const { return enabled; }
+    void setEnabled(bool enable) { enabled = enable; }
+    void reset();
+
+    // monotonic clock used for all locally taken timestamps
+    static qint64 timestamp();
+
+    // request enqueued -> request sent, per request opcode
+    void recordQueueLatency(quint8 opcode, qint64 latency);
+    // request sent -> response received, per request opcode
+    void recordResponseLatency(quint8 opcode, qint64 latency);
+    // kernel receive timestamp -> packet read by the controller, per PDU opcode
+    void recordReceiveDelay(quint8 opcode, qint64 delay);
+    // notification or indication received -> characteristicChanged() handled
+    void recordNotificationLatency(qint64 latency);
+    // pending requests when a request is sent, including the sent one
+    void recordQueueDepth(qsizetype depth);
+
+    const QMap<quint8, QLowEnergyLatencyHistogram> &queueLatencies() const
+    { return queueLatencyHistograms; }
+    const QMap<quint8, QLowEnergyLatencyHistogram> &responseLatencies() const
+    { return responseLatencyHistograms; }
+    const QMap<quint8, QLowEnergyLatencyHistogram> &receiveDelays() const
+    { return receiveDelayHistograms; }
+    const QLowEnergyLatencyHistogram &notificationLatency() const
+    { return notificationLatencyHistogram; }
+    const QLowEnergyLatencyHistogram &queueDepths() const { return queueDepthHistogram; }
+
+    QJsonObject toJson() const;
+
+private:
+    bool enabled = false;
+    QMap<quint8, QLowEnergyLatencyHistogram> queueLatencyHistograms;
+    QMap<quint8, QLowEnergyLatencyHistogram> responseLatencyHistograms;
+    QMap<quint8, QLowEnergyLatencyHistogram> receiveDelayHistograms;
+    QLowEnergyLatencyHistogram notificationLatencyHistogram;
+    QLowEnergyLatencyHistogram queueDepthHistogram;
+};
+
+QT_END_NAMESPACE
+
+#endif // QLOWENERGYCONTROLLERINSTRUMENTATION_P_H
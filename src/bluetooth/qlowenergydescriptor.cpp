@@ -221,14 +221,18 @@ bool QLowEnergyDescriptor::isValid() const
 */
 QBluetoothUuid QLowEnergyDescriptor::uuid() const
 {
-    if (d_ptr.isNull() || !data
-                       || !d_ptr->characteristicList.contains(data->charHandle)
-                       || !d_ptr->characteristicList[data->charHandle].
-                                        descriptorList.contains(data->descHandle)) {
+    if (d_ptr.isNull() || !data)
+        return QBluetoothUuid();
+
+    const auto charIt = d_ptr->characteristicList.constFind(data->charHandle);
+    if (charIt == d_ptr->characteristicList.constEnd())
+        return QBluetoothUuid();
+
+    const auto descIt = charIt->descriptorList.constFind(data->descHandle);
+    if (descIt == charIt->descriptorList.constEnd())
         return QBluetoothUuid();
-    }
 
-    return d_ptr->characteristicList[data->charHandle].descriptorList[data->descHandle].uuid;
+    return descIt->uuid;
 }
 
 /*!
@@ -256,14 +260,18 @@ QLowEnergyHandle QLowEnergyDescriptor::handle() const
 */
 QByteArray QLowEnergyDescriptor::value() const
 {
-    if (d_ptr.isNull() || !data
-                       || !d_ptr->characteristicList.contains(data->charHandle)
-                       || !d_ptr->characteristicList[data->charHandle].
-                                        descriptorList.contains(data->descHandle)) {
+    if (d_ptr.isNull() || !data)
+        return QByteArray();
+
+    const auto charIt = d_ptr->characteristicList.constFind(data->charHandle);
+    if (charIt == d_ptr->characteristicList.constEnd())
+        return QByteArray();
+
+    const auto descIt = charIt->descriptorList.constFind(data->descHandle);
+    if (descIt == charIt->descriptorList.constEnd())
         return QByteArray();
-    }
 
-    return d_ptr->characteristicList[data->charHandle].descriptorList[data->descHandle].value;
+    return descIt->value;
 }
 
 /*!
@@ -0,0 +1,342 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QLOWENERGYHANDLEMAP_P_H
+#define QLOWENERGYHANDLEMAP_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtBluetooth/qbluetooth.h>
+#include <QtBluetooth/qbluetoothuuid.h>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+QT_BEGIN_NAMESPACE
+
+// Attribute table of a service or characteristic, keyed by attribute handle.
+//
+// The entries are kept in one contiguous list sorted by handle. Iteration
+// therefore follows the attribute order, lookups by handle are binary
+// searches and the index of an entry only changes when entries with a lower
+// handle are inserted or removed. The interface follows QHash so that the
+// backends can use both interchangeably.
+//
+// T must have a QBluetoothUuid member named uuid. findByUuid() uses a side
+// table which the modifying functions keep up to date, so that concurrent
+// const lookups never write. The entry last returned by operator[]() may
+// still be changed through the reference; every other entry must be
+// replaced with insert() or operator[]() rather than having its uuid changed
+// in place through an iterator.
+template <typename T>
+class QLowEnergyHandleMap
+{
+    struct Entry {
+        QLowEnergyHandle handle;
+        T value;
+    };
+
+    template <typename EntryPointer, typename Reference>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using difference_type = qptrdiff;
+        using value_type = T;
+        using pointer = std::remove_reference_t<Reference> *;
+        using reference = Reference;
+
+        Iterator() = default;
+        explicit Iterator(EntryPointer entry) : e(entry) {}
+        template <typename OtherPointer, typename OtherReference>
+        Iterator(const Iterator<OtherPointer, OtherReference> &other) : e(other.e) {}
+
+        QLowEnergyHandle key() const { return e->handle; }
+        Reference value() const { return e->value; }
+        Reference operator*() const { return e->value; }
+        pointer operator->() const { return &e->value; }
+
+        Iterator &operator++() { ++e; return *this; }
+        Iterator operator++(int) { Iterator it = *this; ++e; return it; }
+        Iterator &operator--() { --e; return *this; }
+        Iterator operator--(int) { Iterator it = *this; --e; return it; }
+
+        friend bool operator==(const Iterator &lhs, const Iterator &rhs) { return lhs.e == rhs.e; }
+        friend bool operator!=(const Iterator &lhs, const Iterator &rhs) { return lhs.e != rhs.e; }
+
+        EntryPointer e = nullptr;
+    };
+
+public:
+    using key_type = QLowEnergyHandle;
+    using mapped_type = T;
+    using size_type = qsizetype;
+    using iterator = Iterator<Entry *, T &>;
+    using const_iterator = Iterator<const Entry *, const T &>;
+
+    QLowEnergyHandleMap() = default;
+
+    qsizetype size() const { return entries.size(); }
+    qsizetype count() const { return entries.size(); }
+    bool isEmpty() const { return entries.isEmpty(); }
+    void reserve(qsizetype size) { entries.reserve(size); }
+
+    void clear()
+    {
+        entries.clear();
+        uuidIndex.clear();
+        hasPendingEntry = false;
+    }
+
+    iterator begin() { return iterator(entries.data()); }
+    iterator end() { return iterator(entries.data() + entries.size()); }
+    const_iterator begin() const { return constBegin(); }
+    const_iterator end() const { return constEnd(); }
+    const_iterator cbegin() const { return constBegin(); }
+    const_iterator cend() const { return constEnd(); }
+    const_iterator constBegin() const { return const_iterator(entries.constData()); }
+    const_iterator constEnd() const
+    {
+        return const_iterator(entries.constData() + entries.size());
+    }
+
+    // Position of handle in the attribute order, or -1
+    qsizetype indexOf(QLowEnergyHandle handle) const
+    {
+        const qsizetype i = lowerBound(handle);
+        return (i < entries.size() && entries.at(i).handle == handle) ? i : -1;
+    }
+    QLowEnergyHandle keyAt(qsizetype i) const { return entries.at(i).handle; }
+    const T &at(qsizetype i) const { return entries.at(i).value; }
+
+    bool contains(QLowEnergyHandle handle) const { return indexOf(handle) != -1; }
+
+    iterator find(QLowEnergyHandle handle)
+    {
+        const qsizetype i = indexOf(handle);
+        return i == -1 ? end() : iterator(entries.data() + i);
+    }
+    const_iterator find(QLowEnergyHandle handle) const { return constFind(handle); }
+    const_iterator constFind(QLowEnergyHandle handle) const
+    {
+        const qsizetype i = indexOf(handle);
+        return i == -1 ? constEnd() : const_iterator(entries.constData() + i);
+    }
+
+    // First entry with a handle greater than handle
+    const_iterator upperBound(QLowEnergyHandle handle) const
+    {
+        const auto it = std::upper_bound(entries.cbegin(), entries.cend(), handle,
+                                         [](QLowEnergyHandle h, const Entry &entry) {
+                                             return h < entry.handle;
+                                         });
+        return const_iterator(entries.constData() + (it - entries.cbegin()));
+    }
+
+    // First entry in handle order with the given uuid
+    const_iterator findByUuid(const QBluetoothUuid &uuid) const
+    {
+        qsizetype result = -1;
+        const auto it = uuidIndex.constFind(uuid);
+        if (it != uuidIndex.constEnd()) {
+            result = indexOf(it.value());
+            if (result == -1 || entries.at(result).value.uuid != uuid) {
+                // the uuid was changed in place, fall back to a scan
+                return std::find_if(constBegin(), constEnd(),
+                                    [&uuid](const T &value) { return value.uuid == uuid; });
+            }
+        }
+
+        // the entry returned by operator[]() is not indexed yet
+        if (hasPendingEntry && (result == -1 || pendingHandle < entries.at(result).handle)) {
+            const qsizetype i = indexOf(pendingHandle);
+            if (entries.at(i).value.uuid == uuid)
+                result = i;
+        }
+        return result == -1 ? constEnd() : const_iterator(entries.constData() + result);
+    }
+
+    T value(QLowEnergyHandle handle, const T &defaultValue = T()) const
+    {
+        const qsizetype i = indexOf(handle);
+        return i == -1 ? defaultValue : entries.at(i).value;
+    }
+
+    QList<QLowEnergyHandle> keys() const
+    {
+        QList<QLowEnergyHandle> result;
+        result.reserve(entries.size());
+        for (const Entry &entry : entries)
+            result.append(entry.handle);
+        return result;
+    }
+
+    QList<T> values() const
+    {
+        QList<T> result;
+        result.reserve(entries.size());
+        for (const Entry &entry : entries)
+            result.append(entry.value);
+        return result;
+    }
+
+    T &operator[](QLowEnergyHandle handle)
+    {
+        indexPendingEntry();
+        const qsizetype i = lowerBound(handle);
+        if (i == entries.size() || entries.at(i).handle != handle) {
+            entries.insert(i, Entry{ handle, T() });
+            addToUuidIndex(handle, entries.at(i).value.uuid);
+        }
+        // the caller may change the uuid through the returned reference
+        hasPendingEntry = true;
+        pendingHandle = handle;
+        pendingUuid = entries.at(i).value.uuid;
+        return entries[i].value;
+    }
+    const T operator[](QLowEnergyHandle handle) const { return value(handle); }
+
+    iterator insert(QLowEnergyHandle handle, const T &value)
+    {
+        indexPendingEntry();
+        const qsizetype i = lowerBound(handle);
+        if (i < entries.size() && entries.at(i).handle == handle) {
+            removeFromUuidIndex(handle, entries.at(i).value.uuid);
+            entries[i].value = value;
+        } else {
+            entries.insert(i, Entry{ handle, value });
+        }
+        addToUuidIndex(handle, value.uuid);
+        return iterator(entries.data() + i);
+    }
+
+    bool remove(QLowEnergyHandle handle)
+    {
+        indexPendingEntry();
+        const qsizetype i = indexOf(handle);
+        if (i == -1)
+            return false;
+        removeFromUuidIndex(handle, entries.at(i).value.uuid);
+        entries.removeAt(i);
+        return true;
+    }
+
+    iterator erase(const_iterator it)
+    {
+        indexPendingEntry();
+        const qsizetype i = it.e - entries.constData();
+        removeFromUuidIndex(entries.at(i).handle, entries.at(i).value.uuid);
+        entries.removeAt(i);
+        return iterator(entries.data() + i);
+    }
+
+private:
+    qsizetype lowerBound(QLowEnergyHandle handle) const
+    {
+        // discovery appends in handle order
+        if (entries.isEmpty() || entries.constLast().handle < handle)
+            return entries.size();
+        const auto it = std::lower_bound(entries.cbegin(), entries.cend(), handle,
+                                         [](const Entry &entry, QLowEnergyHandle h) {
+                                             return entry.handle < h;
+                                         });
+        return it - entries.cbegin();
+    }
+
+    void addToUuidIndex(QLowEnergyHandle handle, const QBluetoothUuid &uuid)
+    {
+        // the index holds the lowest handle of each uuid
+        const auto it = uuidIndex.find(uuid);
+        if (it == uuidIndex.end())
+            uuidIndex.insert(uuid, handle);
+        else if (handle < it.value())
+            it.value() = handle;
+    }
+
+    void removeFromUuidIndex(QLowEnergyHandle handle, const QBluetoothUuid &uuid)
+    {
+        const auto it = uuidIndex.find(uuid);
+        if (it == uuidIndex.end() || it.value() != handle)
+            return;
+        const auto next = std::find_if(entries.cbegin(), entries.cend(),
+                                       [&](const Entry &entry) {
+                                           return entry.handle != handle
+                                                   && entry.value.uuid == uuid;
+                                       });
+        if (next == entries.cend())
+            uuidIndex.erase(it);
+        else
+            it.value() = next->handle;
+    }
+
+    void indexPendingEntry()
+    {
+        if (!hasPendingEntry)
+            return;
+        hasPendingEntry = false;
+        const QBluetoothUuid &uuid = entries.at(indexOf(pendingHandle)).value.uuid;
+        if (uuid == pendingUuid)
+            return;
+        removeFromUuidIndex(pendingHandle, pendingUuid);
+        addToUuidIndex(pendingHandle, uuid);
+    }
+
+    QList<Entry> entries;
+    QHash<QBluetoothUuid, QLowEnergyHandle> uuidIndex;
+    // entry last returned by operator[]() and its uuid at that time
+    bool hasPendingEntry = false;
+    QLowEnergyHandle pendingHandle = 0;
+    QBluetoothUuid pendingUuid;
+};
+
+QT_END_NAMESPACE
+
+#endif // QLOWENERGYHANDLEMAP_P_H
@@ -0,0 +1,318 @@
+/***************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qlowenergynotificationqueue.h"
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QDeadlineTimer>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QLowEnergyNotificationQueue
+    \brief The QLowEnergyNotificationQueue class hands characteristic notifications
+    over to a worker thread.
+
+    \inmodule QtBluetooth
+    \since 6.4
+
+    By default, value changes of a characteristic are reported by the
+    \l QLowEnergyService::characteristicChanged() signal. Receivers in other threads
+    get each notification as a separate queued call. An application which processes
+    a high rate of notifications in a worker thread can instead attach a
+    QLowEnergyNotificationQueue to its services using
+    \l QLowEnergyService::setNotificationQueue(). The notifications are then also
+    appended to the queue, without involving the event loop, and the worker thread
+    collects them in batches using dequeue() or dequeueAll().
+
+    The queue is a bounded ring buffer for exactly one producer and one consumer.
+    All services attached to a queue must belong to controllers living in the same
+    thread, and only one thread at a time may dequeue. Neither side ever blocks or
+    takes a lock.
+
+    If the queue is full, the overflowPolicy() decides which notification is lost.
+    enqueuedCount(), droppedCount() and dequeuedCount() report how many
+    notifications went through the queue. Every notification passed to enqueue()
+    is counted by enqueuedCount() and is eventually either dequeued or dropped,
+    whatever the policy. Once the queue is empty, enqueuedCount() equals the sum
+    of dequeuedCount() and droppedCount().
+
+    \sa QLowEnergyService::setNotificationQueue()
+*/
+
+/*!
+    \enum QLowEnergyNotificationQueue::OverflowPolicy
+
+    This enum describes what happens to a notification arriving at a full queue.
+
+    \value DropNewest   The new notification is discarded.
+    \value DropOldest   The oldest notification still in the queue is discarded to
+                        make room for the new one.
+*/
+
+/*!
+    \class QLowEnergyNotificationQueue::Notification
+    \inmodule QtBluetooth
+    \since 6.4
+
+    \brief A notification taken from a QLowEnergyNotificationQueue.
+
+    \c handle is the value handle of the characteristic as returned by
+    \l QLowEnergyCharacteristic::handle(). \c timestamp is the time at which the
+    notification was queued, in nanoseconds of the clock used by
+    \l QDeadlineTimer::current(). \c value is the new value of the characteristic.
+*/
+
+class QLowEnergyNotificationQueuePrivate
+{
+public:
+    struct Cell {
+        // pos + 1 while the cell holds the item queued at pos,
+        // pos + capacity once that item has been taken out
+        QAtomicInteger<quint64> sequence;
+        QLowEnergyHandle handle = 0;
+        qint64 timestamp = 0;
+        QByteArray value;
+    };
+
+    QLowEnergyNotificationQueuePrivate(qsizetype capacity,
+                                       QLowEnergyNotificationQueue::OverflowPolicy policy);
+
+    bool take(quint64 pos, QLowEnergyNotificationQueue::Notification *notification);
+
+    const QLowEnergyNotificationQueue::OverflowPolicy policy;
+    const qsizetype capacity;
+    const quint64 mask;
+    std::unique_ptr<Cell[]> cells;
+
+    // producer and consumer side on separate cache lines
+    alignas(64) QAtomicInteger<quint64> tail = 0;
+    QAtomicInteger<quint64> enqueued = 0;
+    QAtomicInteger<quint64> dropped = 0;
+    alignas(64) QAtomicInteger<quint64> head = 0;
+    QAtomicInteger<quint64> dequeued = 0;
+};
+
+QLowEnergyNotificationQueuePrivate::QLowEnergyNotificationQueuePrivate(
+        qsizetype requestedCapacity, QLowEnergyNotificationQueue::OverflowPolicy overflowPolicy)
+    : policy(overflowPolicy),
+      capacity(qNextPowerOfTwo(quint64(qMax(requestedCapacity, qsizetype(2)) - 1))),
+      mask(quint64(capacity) - 1),
+      cells(new Cell[capacity])
+{
+    for (qsizetype i = 0; i < capacity; ++i)
+        cells[i].sequence.storeRelaxed(quint64(i));
+}
+
+/*
+    Takes the item queued at pos out of the queue. Used by the consumer and,
+    with a null notification, by the producer to make room under DropOldest.
+    Returns false if the item was taken by the other side first.
+ */
+bool QLowEnergyNotificationQueuePrivate::take(
+        quint64 pos, QLowEnergyNotificationQueue::Notification *notification)
+{
+    Cell &cell = cells[pos & mask];
+    if (cell.sequence.loadAcquire() != pos + 1 || !head.testAndSetAcquire(pos, pos + 1))
+        return false;
+
+    if (notification) {
+        notification->handle = cell.handle;
+        notification->timestamp = cell.timestamp;
+        notification->value = std::move(cell.value);
+    }
+    cell.value = QByteArray();
+    cell.sequence.storeRelease(pos + capacity);
+    return true;
+}
+
+/*!
+    Constructs a queue which holds up to \a capacity notifications and handles a
+    full queue according to \a policy. The capacity is rounded up to the next
+    power of two.
+*/
+QLowEnergyNotificationQueue::QLowEnergyNotificationQueue(qsizetype capacity,
+                                                         OverflowPolicy policy)
+    : d(new QLowEnergyNotificationQueuePrivate(capacity, policy))
+{
+}
+
+/*!
+    Destroys the queue. It must have been detached from all services before.
+*/
+QLowEnergyNotificationQueue::~QLowEnergyNotificationQueue()
+{
+    delete d;
+}
+
+/*!
+    Returns the maximum number of notifications the queue holds.
+*/
+qsizetype QLowEnergyNotificationQueue::capacity() const
+{
+    return d->capacity;
+}
+
+/*!
+    Returns the policy applied when a notification arrives at a full queue.
+*/
+QLowEnergyNotificationQueue::OverflowPolicy QLowEnergyNotificationQueue::overflowPolicy() const
+{
+    return d->policy;
+}
+
+/*!
+    Appends the notification of \a value for the characteristic with the value
+    handle \a handle. Returns \c false if the notification was dropped because the
+    queue is full.
+
+    The attached services call this function in the thread of their controller.
+    It may be called directly as long as there is no other producer.
+*/
+bool QLowEnergyNotificationQueue::enqueue(QLowEnergyHandle handle, const QByteArray &value)
+{
+    const quint64 pos = d->tail.loadRelaxed();
+    QLowEnergyNotificationQueuePrivate::Cell &cell = d->cells[pos & d->mask];
+
+    if (cell.sequence.loadAcquire() != pos) {
+        // Full. The oldest item can only be dropped if the consumer is not
+        // just taking it out, otherwise the new one goes.
+        if (d->policy != DropOldest || !d->take(pos - d->capacity, nullptr)
+                || cell.sequence.loadAcquire() != pos) {
+            d->enqueued.fetchAndAddRelaxed(1);
+            d->dropped.fetchAndAddRelaxed(1);
+            return false;
+        }
+        d->dropped.fetchAndAddRelaxed(1);
+    }
+
+    cell.handle = handle;
+    cell.timestamp = QDeadlineTimer::current().deadlineNSecs();
+    cell.value = value;
+    cell.sequence.storeRelease(pos + 1);
+    d->tail.storeRelease(pos + 1);
+    d->enqueued.fetchAndAddRelaxed(1);
+    return true;
+}
+
+/*!
+    Moves up to \a maxCount of the oldest notifications into \a notifications and
+    returns how many were moved. Returns \c 0 if the queue is empty.
+
+    Only one thread at a time may call this function.
+*/
+qsizetype QLowEnergyNotificationQueue::dequeue(Notification *notifications, qsizetype maxCount)
+{
+    qsizetype count = 0;
+    while (count < maxCount) {
+        const quint64 pos = d->head.loadRelaxed();
+        if (d->take(pos, notifications + count)) {
+            ++count;
+            continue;
+        }
+        // either empty or the producer dropped the item at pos just now
+        if (d->head.loadRelaxed() == pos)
+            break;
+    }
+
+    d->dequeued.fetchAndAddRelaxed(quint64(count));
+    return count;
+}
+
+/*!
+    Takes all queued notifications out of the queue and returns them, oldest first.
+
+    \sa dequeue()
+*/
+QList<QLowEnergyNotificationQueue::Notification> QLowEnergyNotificationQueue::dequeueAll()
+{
+    QList<Notification> notifications(size());
+    notifications.resize(dequeue(notifications.data(), notifications.size()));
+    return notifications;
+}
+
+/*!
+    Returns \c true if no notification is queued.
+*/
+bool QLowEnergyNotificationQueue::isEmpty() const
+{
+    return size() == 0;
+}
+
+/*!
+    Returns the number of queued notifications. The value is a snapshot only, the
+    producer may add notifications at any time.
+*/
+qsizetype QLowEnergyNotificationQueue::size() const
+{
+    const quint64 head = d->head.loadAcquire();
+    const quint64 tail = d->tail.loadAcquire();
+    return tail > head ? qsizetype(tail - head) : 0;
+}
+
+/*!
+    Returns the number of notifications passed to enqueue(), including the ones
+    that were dropped because the queue was full.
+*/
+quint64 QLowEnergyNotificationQueue::enqueuedCount() const
+{
+    return d->enqueued.loadRelaxed();
+}
+
+/*!
+    Returns the number of notifications lost because the queue was full. With
+    DropNewest these are the rejected new notifications, with DropOldest the
+    evicted old ones.
+*/
+quint64 QLowEnergyNotificationQueue::droppedCount() const
+{
+    return d->dropped.loadRelaxed();
+}
+
+/*!
+    Returns the number of notifications taken out of the queue.
+*/
+quint64 QLowEnergyNotificationQueue::dequeuedCount() const
+{
+    return d->dequeued.loadRelaxed();
+}
+
+QT_END_NAMESPACE
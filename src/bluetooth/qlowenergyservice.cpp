@@ -41,6 +41,7 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QPointer>
 #include <QtBluetooth/QLowEnergyService>
+#include <QtBluetooth/QLowEnergyNotificationQueue>
 
 #include <algorithm>
 
@@ -297,6 +298,21 @@ QT_BEGIN_NAMESPACE
                                 3.7 or newer.
  */
 
+/*!
+  \enum QLowEnergyService::SubscriptionMode
+  \since 6.4
+
+  This enum describes which updates \l subscribe() requests for a characteristic.
+
+  \value NoSubscription            Neither notifications nor indications are sent.
+  \value NotificationSubscription  Value changes are sent as notifications. The
+                                   characteristic must have set the
+                                   \l QLowEnergyCharacteristic::Notify property.
+  \value IndicationSubscription    Value changes are sent as indications. The
+                                   characteristic must have set the
+                                   \l QLowEnergyCharacteristic::Indicate property.
+ */
+
 /*!
     \fn void QLowEnergyService::stateChanged(QLowEnergyService::ServiceState newState)
 
@@ -410,6 +426,7 @@ QLowEnergyService::QLowEnergyService(QSharedPointer<QLowEnergyServicePrivate> p,
     qRegisterMetaType<QLowEnergyService::ServiceError>();
     qRegisterMetaType<QLowEnergyService::ServiceType>();
     qRegisterMetaType<QLowEnergyService::WriteMode>();
+    qRegisterMetaType<QLowEnergyService::SubscriptionMode>();
 
     connect(p.data(), &QLowEnergyServicePrivate::errorOccurred, this,
             &QLowEnergyService::errorOccurred);
@@ -432,6 +449,15 @@ QLowEnergyService::QLowEnergyService(QSharedPointer<QLowEnergyServicePrivate> p,
  */
 QLowEnergyService::~QLowEnergyService()
 {
+    Q_D(QLowEnergyService);
+
+    // The private object is kept by the controller, detach the queue which
+    // was attached through this instance
+    if (d->notificationQueueService == this) {
+        QObject::disconnect(d->notificationQueueConnection);
+        d->notificationQueue = nullptr;
+        d->notificationQueueService = nullptr;
+    }
 }
 
 /*!
@@ -513,14 +539,9 @@ QLowEnergyService::ServiceTypes QLowEnergyService::type() const
 */
 QLowEnergyCharacteristic QLowEnergyService::characteristic(const QBluetoothUuid &uuid) const
 {
-    CharacteristicDataMap::const_iterator charIt = d_ptr->characteristicList.constBegin();
-    for ( ; charIt != d_ptr->characteristicList.constEnd(); ++charIt) {
-        const QLowEnergyHandle charHandle = charIt.key();
-        const QLowEnergyServicePrivate::CharData &charDetails = charIt.value();
-
-        if (charDetails.uuid == uuid)
-            return QLowEnergyCharacteristic(d_ptr, charHandle);
-    }
+    CharacteristicDataMap::const_iterator charIt = d_ptr->characteristicList.findByUuid(uuid);
+    if (charIt != d_ptr->characteristicList.constEnd())
+        return QLowEnergyCharacteristic(d_ptr, charIt.key());
 
     return QLowEnergyCharacteristic();
 }
@@ -537,12 +558,13 @@ QLowEnergyCharacteristic QLowEnergyService::characteristic(const QBluetoothUuid
 QList<QLowEnergyCharacteristic> QLowEnergyService::characteristics() const
 {
     QList<QLowEnergyCharacteristic> results;
-    QList<QLowEnergyHandle> handles = d_ptr->characteristicList.keys();
-    std::sort(handles.begin(), handles.end());
+    const CharacteristicDataMap &characteristicList = d_ptr->characteristicList;
+    results.reserve(characteristicList.size());
 
-    for (const QLowEnergyHandle &handle : qAsConst(handles)) {
-        QLowEnergyCharacteristic characteristic(d_ptr, handle);
-        results.append(characteristic);
+    // the characteristic list is sorted by handle
+    for (auto charIt = characteristicList.constBegin(); charIt != characteristicList.constEnd();
+         ++charIt) {
+        results.append(QLowEnergyCharacteristic(d_ptr, charIt.key()));
     }
     return results;
 }
@@ -713,8 +735,9 @@ void QLowEnergyService::readCharacteristic(
     For example, if the same descriptor is set to the value A and immediately afterwards
     to B, the two write request are executed in the given order.
 
-    \note Currently, it is not possible to use signed or reliable writes as defined by the
-    Bluetooth specification.
+    \note Currently, it is not possible to use signed writes as defined by the
+    Bluetooth specification. Reliable writes are available through
+    \l writeCharacteristicsReliably().
 
     A characteristic can only be written if this service is in the \l ServiceDiscovered state
     and belongs to the service. If one of these conditions is
@@ -766,6 +789,68 @@ void QLowEnergyService::writeCharacteristic(
                                        mode);
 }
 
+/*!
+    \since 6.4
+
+    Writes all characteristic and value pairs in \a values as one reliable write.
+
+    \b {Central role}
+
+    The values are queued on the remote peripheral and written together by a single
+    execute request. Each queued fragment is echoed by the peripheral; if any echo
+    differs from what was sent, or the peripheral rejects a fragment, the whole queue is
+    cancelled and none of the values are written. On success the
+    \l characteristicWritten() signal is emitted for each pair in the order given;
+    otherwise the \l CharacteristicWriteError is set.
+
+    All characteristics must belong to this service, which must be in the
+    \l RemoteServiceDiscovered state; otherwise the \l QLowEnergyService::OperationError
+    is set and nothing is written.
+
+    \note Reliable writes are currently only supported on Linux with BlueZ.
+    Other platforms set the \l CharacteristicWriteError.
+
+    \b {Peripheral role}
+
+    The values are written to the local database one after another, as if
+    \l writeCharacteristic() was called for each pair.
+
+    \sa writeCharacteristic(), characteristicWritten()
+ */
+void QLowEnergyService::writeCharacteristicsReliably(
+        const QList<QPair<QLowEnergyCharacteristic, QByteArray>> &values)
+{
+    Q_D(QLowEnergyService);
+
+    if (d->controller == nullptr) {
+        d->setError(QLowEnergyService::OperationError);
+        return;
+    }
+
+    if (d->controller->role == QLowEnergyController::PeripheralRole) {
+        for (const auto &value : values)
+            writeCharacteristic(value.first, value.second);
+        return;
+    }
+
+    if (state() != RemoteServiceDiscovered || values.isEmpty()) {
+        d->setError(QLowEnergyService::OperationError);
+        return;
+    }
+
+    QList<QPair<QLowEnergyHandle, QByteArray>> handleValues;
+    handleValues.reserve(values.size());
+    for (const auto &value : values) {
+        if (!contains(value.first)) {
+            d->setError(QLowEnergyService::OperationError);
+            return;
+        }
+        handleValues.append(qMakePair(value.first.attributeHandle(), value.second));
+    }
+
+    d->controller->writeCharacteristicsReliably(d_ptr, handleValues);
+}
+
 /*!
     Returns \c true if \a descriptor belongs to this service; otherwise \c false.
  */
@@ -881,4 +966,111 @@ void QLowEnergyService::writeDescriptor(const QLowEnergyDescriptor &descriptor,
                                    newValue);
 }
 
+/*!
+    \since 6.4
+
+    Sets the Client Characteristic Configuration Descriptor of each characteristic
+    in \a characteristics according to \a mode.
+
+    The descriptor writes are queued together. A characteristic whose descriptor already
+    holds the requested configuration, or which appears more than once in
+    \a characteristics, causes no further write. Each write that is performed is reported
+    like a \l writeDescriptor() call, either through \l descriptorWritten() or the
+    \l DescriptorWriteError.
+
+    The subscriptions are remembered by the controller. Whenever the details of this
+    service are discovered again, for example after a reconnect, the remembered
+    configuration is written again unless the peripheral already reports it. Subscribing
+    with \l NoSubscription removes the characteristics from this record.
+
+    This service must be in the \l RemoteServiceDiscovered state and the controller must be
+    in the \l {QLowEnergyController::CentralRole}{central role}. A characteristic that does
+    not belong to this service, has no Client Characteristic Configuration Descriptor or
+    does not support \a mode is skipped and the \l QLowEnergyService::OperationError is set.
+
+    \sa QLowEnergyCharacteristic::clientCharacteristicConfiguration(), writeDescriptor()
+ */
+void QLowEnergyService::subscribe(const QList<QLowEnergyCharacteristic> &characteristics,
+                                  SubscriptionMode mode)
+{
+    Q_D(QLowEnergyService);
+
+    if (d->controller == nullptr || d->controller->role != QLowEnergyController::CentralRole
+            || state() != RemoteServiceDiscovered) {
+        d->setError(QLowEnergyService::OperationError);
+        return;
+    }
+
+    QList<QPair<QLowEnergyHandle, QLowEnergyHandle>> configurations;
+    configurations.reserve(characteristics.size());
+    bool skipped = false;
+    for (const QLowEnergyCharacteristic &characteristic : characteristics) {
+        const QLowEnergyDescriptor cccd = characteristic.clientCharacteristicConfiguration();
+        const QLowEnergyCharacteristic::PropertyTypes properties = characteristic.properties();
+        if (!contains(characteristic) || !cccd.isValid()
+                || (mode == NotificationSubscription
+                    && !(properties & QLowEnergyCharacteristic::Notify))
+                || (mode == IndicationSubscription
+                    && !(properties & QLowEnergyCharacteristic::Indicate))) {
+            skipped = true;
+            continue;
+        }
+
+        configurations.append({ characteristic.attributeHandle(), cccd.handle() });
+    }
+
+    if (!configurations.isEmpty())
+        d->controller->subscribe(d_ptr, configurations, mode);
+    if (skipped)
+        d->setError(QLowEnergyService::OperationError);
+}
+
+/*!
+    \since 6.4
+
+    Attaches \a queue to this service. Every value change which is reported by
+    \l characteristicChanged() is also appended to \a queue, directly in the thread
+    of the controller. The signal is emitted as before. Passing \c nullptr detaches
+    the current queue.
+
+    The queue is not owned by the service. It must stay alive until it has been
+    detached or this service object has been destroyed. Other service objects
+    created for the same service share the attached queue, but destroying them
+    does not detach it.
+
+    \sa notificationQueue(), QLowEnergyNotificationQueue
+ */
+void QLowEnergyService::setNotificationQueue(QLowEnergyNotificationQueue *queue)
+{
+    Q_D(QLowEnergyService);
+
+    if (d->notificationQueue == queue)
+        return;
+
+    QObject::disconnect(d->notificationQueueConnection);
+    d->notificationQueue = queue;
+    d->notificationQueueService = queue ? this : nullptr;
+    if (!queue)
+        return;
+
+    d->notificationQueueConnection = connect(
+            d, &QLowEnergyServicePrivate::characteristicChanged, this,
+            [queue](const QLowEnergyCharacteristic &characteristic, const QByteArray &value) {
+                queue->enqueue(characteristic.handle(), value);
+            }, Qt::DirectConnection);
+}
+
+/*!
+    \since 6.4
+
+    Returns the notification queue attached to this service, or \c nullptr.
+
+    \sa setNotificationQueue()
+ */
+QLowEnergyNotificationQueue *QLowEnergyService::notificationQueue() const
+{
+    Q_D(const QLowEnergyService);
+    return d->notificationQueue;
+}
+
 QT_END_NAMESPACE
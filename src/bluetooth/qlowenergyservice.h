@@ -46,6 +46,7 @@
 
 QT_BEGIN_NAMESPACE
 
+class QLowEnergyNotificationQueue;
 class QLowEnergyServicePrivate;
 class Q_BLUETOOTH_EXPORT QLowEnergyService : public QObject
 {
@@ -107,6 +108,13 @@ public:
     };
     Q_ENUM(WriteMode)
 
+    enum SubscriptionMode {
+        NoSubscription = 0,
+        NotificationSubscription,
+        IndicationSubscription
+    };
+    Q_ENUM(SubscriptionMode)
+
     ~QLowEnergyService();
 
     QList<QBluetoothUuid> includedServices() const;
@@ -128,12 +136,20 @@ public:
     void writeCharacteristic(const QLowEnergyCharacteristic &characteristic,
                              const QByteArray &newValue,
                              WriteMode mode = WriteWithResponse);
+    void writeCharacteristicsReliably(
+            const QList<QPair<QLowEnergyCharacteristic, QByteArray>> &values);
 
     bool contains(const QLowEnergyDescriptor &descriptor) const;
     void readDescriptor(const QLowEnergyDescriptor &descriptor);
     void writeDescriptor(const QLowEnergyDescriptor &descriptor,
                          const QByteArray &newValue);
 
+    void subscribe(const QList<QLowEnergyCharacteristic> &characteristics,
+                   SubscriptionMode mode = NotificationSubscription);
+
+    void setNotificationQueue(QLowEnergyNotificationQueue *queue);
+    QLowEnergyNotificationQueue *notificationQueue() const;
+
 Q_SIGNALS:
     void stateChanged(QLowEnergyService::ServiceState newState);
     void characteristicChanged(const QLowEnergyCharacteristic &info,
@@ -71,6 +71,11 @@ void QLowEnergyServicePrivate::setState(QLowEnergyService::ServiceState newState
         return;
 
     state = newState;
+
+    // queue the remembered subscriptions before anybody reacts to the new state
+    if (newState == QLowEnergyService::RemoteServiceDiscovered && controller)
+        controller->restoreSubscriptions(uuid);
+
     emit stateChanged(newState);
 }
 
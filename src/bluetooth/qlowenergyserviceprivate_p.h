@@ -58,6 +58,8 @@
 #include <QtBluetooth/QLowEnergyCharacteristic>
 #include <QtCore/private/qglobal_p.h>
 
+#include "qlowenergyhandlemap_p.h"
+
 #if defined(QT_ANDROID_BLUETOOTH)
 #include <QtCore/QJniObject>
 #endif
@@ -65,6 +67,7 @@
 QT_BEGIN_NAMESPACE
 
 class QLowEnergyControllerPrivate;
+class QLowEnergyNotificationQueue;
 
 class QLowEnergyServicePrivate : public QObject
 {
@@ -83,7 +86,7 @@ public:
         QBluetoothUuid uuid;
         QLowEnergyCharacteristic::PropertyTypes properties;
         QByteArray value;
-        QHash<QLowEnergyHandle, DescData> descriptorList;
+        QLowEnergyHandleMap<DescData> descriptorList;
     };
 
     enum GattAttributeTypes {
@@ -122,10 +125,17 @@ public:
     QLowEnergyService::ServiceError lastError = QLowEnergyService::NoError;
     QLowEnergyService::DiscoveryMode mode = QLowEnergyService::FullDiscovery;
 
-    QHash<QLowEnergyHandle, CharData> characteristicList;
+    QLowEnergyHandleMap<CharData> characteristicList;
 
     QPointer<QLowEnergyControllerPrivate> controller;
 
+    // receives characteristicChanged() in addition to the signal, see
+    // QLowEnergyService::setNotificationQueue(). Detached when the service
+    // object which attached it is destroyed.
+    QLowEnergyNotificationQueue *notificationQueue = nullptr;
+    QLowEnergyService *notificationQueueService = nullptr;
+    QMetaObject::Connection notificationQueueConnection;
+
 #if defined(QT_ANDROID_BLUETOOTH)
     // reference to the BluetoothGattService object
     QJniObject androidService;
@@ -133,8 +143,8 @@ public:
 
 };
 
-typedef QHash<QLowEnergyHandle, QLowEnergyServicePrivate::CharData> CharacteristicDataMap;
-typedef QHash<QLowEnergyHandle, QLowEnergyServicePrivate::DescData> DescriptorDataMap;
+typedef QLowEnergyHandleMap<QLowEnergyServicePrivate::CharData> CharacteristicDataMap;
+typedef QLowEnergyHandleMap<QLowEnergyServicePrivate::DescData> DescriptorDataMap;
 
 QT_END_NAMESPACE
 
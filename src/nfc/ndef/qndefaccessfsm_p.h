@@ -99,12 +99,13 @@ public:
 
     /*
         This method must be called by the user to provide response for
-        a completed command.
+        a completed command. The response is not referenced after this
+        method returns.
 
-        An empty QByteArray can be provided to indicate that the command
+        An empty response can be provided to indicate that the command
         has failed.
     */
-    virtual Action provideResponse(const QByteArray &response) = 0;
+    virtual Action provideResponse(QByteArrayView response) = 0;
 
     /*
         Returns an NDEF message that was read from the card.
@@ -132,6 +133,31 @@ public:
         This call also performs NDEF detection if is was not performed earlier.
     */
     virtual Action writeMessages(const QList<QNdefMessage> &messages) = 0;
+
+    /*
+        Start writing a single message that was already serialized with
+        QNdefMessage::toByteArray().
+
+        This call also performs NDEF detection if is was not performed earlier.
+    */
+    virtual Action writeMessageData(const QByteArray &messageData) = 0;
+
+    /*
+        Returns an opaque description of the NDEF support detected on the
+        card, or an empty QByteArray if the detection has not succeeded.
+    */
+    virtual QByteArray ndefSupportState() const { return {}; }
+
+    /*
+        Restores the result of an earlier NDEF support detection for the
+        same card instead of detecting it again. Must be called before any
+        task is started. Returns true if the state was accepted.
+    */
+    virtual bool restoreNdefSupportState(QByteArrayView state)
+    {
+        Q_UNUSED(state);
+        return false;
+    }
 };
 
 QT_END_NAMESPACE
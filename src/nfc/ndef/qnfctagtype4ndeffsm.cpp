@@ -49,8 +49,16 @@ Q_LOGGING_CATEGORY(QT_NFC_T4T, "qt.nfc.t4t")
     NDEF support for NFC Type 4 tags.
 
     Based on Type 4 Tag Operation Specification, Version 2.0 (T4TOP 2.0).
+
+    Extended length APDUs are used for reading and updating the NDEF file
+    if both the reader and the MLe/MLc values of the capability container
+    allow it. Otherwise the data is transferred in short APDU sized chunks.
 */
 
+// Largest offset that can be encoded in P1-P2 of ReadBinary and UpdateBinary.
+// The ODO variants needed for larger offsets are not supported.
+static constexpr uint16_t MaxBinaryOffset = 0x7FFF;
+
 QByteArray QNfcTagType4NdefFsm::getCommand(QNdefAccessFsm::Action &nextAction)
 {
     // ID of the NDEF Tag Application
@@ -66,44 +74,59 @@ QByteArray QNfcTagType4NdefFsm::getCommand(QNdefAccessFsm::Action &nextAction)
     case SelectApplicationForProbe:
     case SelectApplicationForRead:
     case SelectApplicationForWrite:
-        return QCommandApdu::build(0x00, QCommandApdu::Select, 0x04, 0x00,
-                                   QByteArrayView::fromArray(NtagApplicationIdV2), 256);
+        return buildCommand(QCommandApdu::Select, 0x04, 0x00,
+                            QByteArrayView::fromArray(NtagApplicationIdV2), 256);
     case SelectCCFile:
-        return QCommandApdu::build(0x00, QCommandApdu::Select, 0x00, 0x0C,
-                                   QByteArrayView::fromArray(CapabilityContainerId));
+        return buildCommand(QCommandApdu::Select, 0x00, 0x0C,
+                            QByteArrayView::fromArray(CapabilityContainerId));
     case ReadCCFile:
-        return QCommandApdu::build(0x00, QCommandApdu::ReadBinary, 0x00, 0x00, {}, 15);
+        return buildCommand(QCommandApdu::ReadBinary, 0x00, 0x00, {}, CapabilityContainerSize);
     case SelectNdefFileForRead:
     case SelectNdefFileForWrite:
-        return QCommandApdu::build(0x00, QCommandApdu::Select, 0x00, 0x0C, m_ndefFileId);
+        return buildCommand(QCommandApdu::Select, 0x00, 0x0C, m_ndefFileId);
     case ReadNdefMessageLength:
-        return QCommandApdu::build(0x00, QCommandApdu::ReadBinary, 0x00, 0x00, {}, 2);
+        return buildCommand(QCommandApdu::ReadBinary, 0x00, 0x00, {}, 2);
     case ReadNdefMessage: {
         uint16_t readSize = qMin(m_fileSize, m_maxReadSize);
 
-        return QCommandApdu::build(0x00, QCommandApdu::ReadBinary, m_fileOffset >> 8,
-                                   m_fileOffset & 0xFF, {}, readSize);
+        if (m_fileOffset > MaxBinaryOffset) {
+            qCDebug(QT_NFC_T4T) << "Read offset is too large:" << m_fileOffset;
+            m_currentState = NdefSupportDetected;
+            nextAction = Failed;
+            return {};
+        }
+
+        return buildCommand(QCommandApdu::ReadBinary, m_fileOffset >> 8, m_fileOffset & 0xFF,
+                            {}, readSize);
     }
     case ClearNdefLength:
         m_fileOffset = 2;
         m_fileSize = m_ndefData.size();
-        return QCommandApdu::build(0x00, QCommandApdu::UpdateBinary, 0x00, 0x00,
-                                   QByteArrayView::fromArray(ZeroLength));
+        return buildCommand(QCommandApdu::UpdateBinary, 0x00, 0x00,
+                            QByteArrayView::fromArray(ZeroLength));
     case WriteNdefFile: {
         uint16_t updateSize = qMin(m_fileSize, m_maxUpdateSize);
         uint16_t fileOffset = m_fileOffset;
 
+        if (fileOffset > MaxBinaryOffset) {
+            qCDebug(QT_NFC_T4T) << "Update offset is too large:" << fileOffset;
+            m_currentState = NdefSupportDetected;
+            nextAction = Failed;
+            return {};
+        }
+
         m_fileOffset += updateSize;
         m_fileSize -= updateSize;
 
-        return QCommandApdu::build(0x00, QCommandApdu::UpdateBinary, fileOffset >> 8,
-                                   fileOffset & 0xFF, m_ndefData.mid(fileOffset - 2, updateSize));
+        return buildCommand(QCommandApdu::UpdateBinary, fileOffset >> 8, fileOffset & 0xFF,
+                            QByteArrayView(m_ndefData).sliced(fileOffset - 2, updateSize));
     }
     case WriteNdefLength: {
-        QByteArray data(2, Qt::Uninitialized);
-        qToUnaligned(qToBigEndian<uint16_t>(m_ndefData.size()), data.data());
+        uint8_t data[2];
+        qToUnaligned(qToBigEndian<uint16_t>(m_ndefData.size()), data);
 
-        return QCommandApdu::build(0x00, QCommandApdu::UpdateBinary, 0x00, 0x00, data);
+        return buildCommand(QCommandApdu::UpdateBinary, 0x00, 0x00,
+                            QByteArrayView::fromArray(data));
     }
     default:
         nextAction = Unexpected;
@@ -111,11 +134,29 @@ QByteArray QNfcTagType4NdefFsm::getCommand(QNdefAccessFsm::Action &nextAction)
     }
 }
 
+/*
+    Builds a command with CLA 0x00 into the reused command buffer.
+
+    The returned copy shares data with the buffer. The buffer does not need
+    to be reallocated for the next command as long as the caller releases
+    the previous one before calling getCommand() again.
+*/
+QByteArray QNfcTagType4NdefFsm::buildCommand(uint8_t ins, uint8_t p1, uint8_t p2,
+                                             QByteArrayView data, int ne)
+{
+    QCommandApdu::buildInto(m_command, 0x00, ins, p1, p2, data, ne);
+    return m_command;
+}
+
 QNdefMessage QNfcTagType4NdefFsm::getMessage(QNdefAccessFsm::Action &nextAction)
 {
     if (m_currentState == NdefMessageRead) {
-        auto message = QNdefMessage::fromByteArray(m_ndefData);
-        m_ndefData.clear();
+        QNdefMessage message;
+        if (m_parser.status() == QNdefMessageParser::Status::Complete)
+            message = m_parser.message().toMessage();
+        else if (m_parser.status() == QNdefMessageParser::Status::NeedMoreData)
+            qCDebug(QT_NFC_T4T) << "NDEF file ended before the final record";
+        m_parser.clear();
         m_currentState = NdefSupportDetected;
         nextAction = Done;
         return message;
@@ -163,7 +204,11 @@ QNdefAccessFsm::Action QNfcTagType4NdefFsm::writeMessages(const QList<QNdefMessa
     if (messages.isEmpty() || messages.size() > 1)
         return Failed;
 
-    auto messageData = messages.first().toByteArray();
+    return writeMessageData(messages.first().toByteArray());
+}
+
+QNdefAccessFsm::Action QNfcTagType4NdefFsm::writeMessageData(const QByteArray &messageData)
+{
     if (messageData.size() > m_maxNdefSize - 2)
         return Failed;
 
@@ -190,7 +235,25 @@ QNdefAccessFsm::Action QNfcTagType4NdefFsm::writeMessages(const QList<QNdefMessa
     };
 }
 
-QNdefAccessFsm::Action QNfcTagType4NdefFsm::provideResponse(const QByteArray &response)
+/*
+    The state is the content of the capability container file.
+*/
+QByteArray QNfcTagType4NdefFsm::ndefSupportState() const
+{
+    return m_capabilityContainer;
+}
+
+bool QNfcTagType4NdefFsm::restoreNdefSupportState(QByteArrayView state)
+{
+    if (m_currentState != SelectApplicationForProbe || !parseCapabilityContainer(state))
+        return false;
+
+    m_capabilityContainer = state.toByteArray();
+    m_currentState = NdefSupportDetected;
+    return true;
+}
+
+QNdefAccessFsm::Action QNfcTagType4NdefFsm::provideResponse(QByteArrayView response)
 {
     QResponseApdu apdu(response);
 
@@ -240,66 +303,78 @@ QNdefAccessFsm::Action QNfcTagType4NdefFsm::handleSimpleResponse(
     return okAction;
 }
 
-QNdefAccessFsm::Action QNfcTagType4NdefFsm::handleReadCCResponse(const QResponseApdu &response)
+/*
+    Parses the mandatory part of the capability container and initializes
+    the NDEF file parameters from it.
+*/
+bool QNfcTagType4NdefFsm::parseCapabilityContainer(QByteArrayView data)
 {
-    m_currentState = NdefNotSupported;
-
-    if (!response.isOk())
-        return Failed;
-
-    if (response.data().size() < 15) {
+    if (data.size() < CapabilityContainerSize) {
         qCDebug(QT_NFC_T4T) << "Invalid response size";
-        return Failed;
+        return false;
     }
 
     qsizetype idx = 0;
-    auto readU8 = [&data = response.data(), &idx]() {
+    auto readU8 = [data, &idx]() {
         return static_cast<uint8_t>(data.at(idx++));
     };
-    auto readU16 = [&data = response.data(), &idx]() {
+    auto readU16 = [data, &idx]() {
         Q_ASSERT(idx >= 0 && idx <= data.size() - 2);
         uint16_t res = qFromBigEndian(qFromUnaligned<uint16_t>(data.constData() + idx));
         idx += 2;
         return res;
     };
-    auto readBytes = [&data = response.data(), &idx](qsizetype count) {
-        auto res = data.sliced(idx, count);
+    auto readBytes = [data, &idx](qsizetype count) {
+        auto res = data.sliced(idx, count).toByteArray();
         idx += count;
         return res;
     };
     auto ccLen = readU16();
     if (ccLen < 15) {
         qCDebug(QT_NFC_T4T) << "CC length is too small";
-        return Failed;
+        return false;
     }
     auto mapping = readU8();
     if ((mapping & 0xF0) != 0x20) {
         qCDebug(QT_NFC_T4T) << "Unsupported mapping:" << Qt::hex << mapping;
-        return Failed;
+        return false;
     }
-    m_maxReadSize = readU16();
-    if (m_maxReadSize < 0xF) {
-        qCDebug(QT_NFC_T4T) << "Invalid maxReadSize" << m_maxReadSize;
-        return Failed;
+    auto maxLe = readU16();
+    if (maxLe < 0xF) {
+        qCDebug(QT_NFC_T4T) << "Invalid maxReadSize" << maxLe;
+        return false;
     }
-
-    m_maxUpdateSize = readU16();
+    auto maxLc = readU16();
+
+    // Extended length APDUs are only used if the reader accepts commands
+    // longer than the largest short APDU. The response length is not
+    // limited by the reader.
+    if (m_maxCommandLength > QCommandApdu::MaxShortLength) {
+        m_maxReadSize = maxLe;
+        m_maxUpdateSize = qMin<int>(maxLc,
+                                    m_maxCommandLength - QCommandApdu::ExtendedHeaderLength);
+    } else {
+        m_maxReadSize = qMin<int>(maxLe, QCommandApdu::MaxShortNe);
+        m_maxUpdateSize = qMin<int>(maxLc, QCommandApdu::MaxShortNc);
+    }
+    qCDebug(QT_NFC_T4T) << "Read chunk size" << m_maxReadSize << "update chunk size"
+                        << m_maxUpdateSize;
     auto tlvTag = readU8();
     if (tlvTag != 0x04) {
         qCDebug(QT_NFC_T4T) << "Invalid TLV tag";
-        return Failed;
+        return false;
     }
     auto tlvSize = readU8();
     if (tlvSize == 0xFF || tlvSize < 6) {
         qCDebug(QT_NFC_T4T) << "Invalid TLV size";
-        return Failed;
+        return false;
     }
     m_ndefFileId = readBytes(2);
 
     m_maxNdefSize = readU16();
     if (m_maxNdefSize < 2) {
         qCDebug(QT_NFC_T4T) << "No space for NDEF file length";
-        return Failed;
+        return false;
     }
 
     /*
@@ -312,7 +387,7 @@ QNdefAccessFsm::Action QNfcTagType4NdefFsm::handleReadCCResponse(const QResponse
     auto readAccess = readU8();
     if (readAccess != 0) {
         qCDebug(QT_NFC_T4T) << "No read access";
-        return Failed;
+        return false;
     }
     auto writeAccess = readU8();
     // It's not possible to atomically clear the length field if update
@@ -321,6 +396,18 @@ QNdefAccessFsm::Action QNfcTagType4NdefFsm::handleReadCCResponse(const QResponse
     // states)
     m_writable = writeAccess == 0 && m_maxUpdateSize >= 2;
 
+    return true;
+}
+
+QNdefAccessFsm::Action QNfcTagType4NdefFsm::handleReadCCResponse(const QResponseApdu &response)
+{
+    m_currentState = NdefNotSupported;
+
+    if (!response.isOk() || !parseCapabilityContainer(response.data()))
+        return Failed;
+
+    m_capabilityContainer = response.data().first(CapabilityContainerSize).toByteArray();
+
     m_currentState = NdefSupportDetected;
 
     if (m_targetState == NdefSupportDetected) {
@@ -362,7 +449,8 @@ QNfcTagType4NdefFsm::handleReadFileLengthResponse(const QResponseApdu &response)
     }
 
     m_fileOffset = 2;
-    m_ndefData.clear();
+    m_parser.clear();
+    m_parser.reserve(m_fileSize);
 
     if (m_fileSize == 0) {
         m_currentState = NdefMessageRead;
@@ -381,11 +469,13 @@ QNdefAccessFsm::Action QNfcTagType4NdefFsm::handleReadFileResponse(const QRespon
     }
 
     auto readSize = qMin<qsizetype>(m_fileSize, response.data().size());
-    m_ndefData.append(response.data().first(readSize));
+    const auto status = m_parser.append(response.data().first(readSize));
     m_fileOffset += readSize;
     m_fileSize -= readSize;
 
-    if (m_fileSize == 0) {
+    // Records are validated as they arrive, so there is no need to read the
+    // rest of the file once the message is complete or known to be broken.
+    if (m_fileSize == 0 || status != QNdefMessageParser::Status::NeedMoreData) {
         m_currentState = NdefMessageRead;
         return GetMessage;
     }
@@ -53,21 +53,34 @@
 
 #include "qndefaccessfsm_p.h"
 #include "qapduutils_p.h"
+#include "qndefmessageview_p.h"
 
 QT_BEGIN_NAMESPACE
 
 class QNfcTagType4NdefFsm : public QNdefAccessFsm
 {
 public:
+    explicit QNfcTagType4NdefFsm(int maxCommandLength = QCommandApdu::MaxShortLength)
+        : m_maxCommandLength(maxCommandLength)
+    {
+    }
+
     QByteArray getCommand(Action &nextAction) override;
     QNdefMessage getMessage(Action &nextAction) override;
-    Action provideResponse(const QByteArray &response) override;
+    Action provideResponse(QByteArrayView response) override;
 
     Action detectNdefSupport() override;
     Action readMessages() override;
     Action writeMessages(const QList<QNdefMessage> &messages) override;
+    Action writeMessageData(const QByteArray &messageData) override;
+
+    QByteArray ndefSupportState() const override;
+    bool restoreNdefSupportState(QByteArrayView state) override;
 
 private:
+    // Size of the mandatory part of the capability container
+    static constexpr qsizetype CapabilityContainerSize = 15;
+
     enum State {
         SelectApplicationForProbe,
         SelectCCFile,
@@ -92,21 +105,35 @@ private:
     State m_currentState = SelectApplicationForProbe;
     State m_targetState = SelectApplicationForProbe;
 
-    // Initialized during the detection phase
+    // Maximum command APDU length accepted by the reader
+    const int m_maxCommandLength;
+
+    // Initialized during the detection phase. Limited by both the card and
+    // the reader.
     uint16_t m_maxReadSize;
     uint16_t m_maxUpdateSize;
+    QByteArray m_capabilityContainer;
     QByteArray m_ndefFileId;
     uint16_t m_maxNdefSize = 0xFFFF;
     bool m_writable;
 
+    // Reused for all commands to avoid allocations
+    QByteArray m_command;
+
     // Used during the read and write operations
     uint16_t m_fileSize;
     uint16_t m_fileOffset;
     QByteArray m_ndefData;
+    QNdefMessageParser m_parser;
+
+    QByteArray buildCommand(uint8_t ins, uint8_t p1, uint8_t p2, QByteArrayView data = {},
+                            int ne = 0);
 
     Action handleSimpleResponse(const QResponseApdu &response, State okState, State failedState,
                                 Action okAction = SendCommand);
 
+    bool parseCapabilityContainer(QByteArrayView data);
+
     Action handleReadCCResponse(const QResponseApdu &response);
     Action handleReadFileLengthResponse(const QResponseApdu &response);
     Action handleReadFileResponse(const QResponseApdu &response);
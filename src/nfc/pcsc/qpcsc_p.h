@@ -62,15 +62,19 @@
 #    include <winscard.h>
 #endif
 #include <QtCore/QByteArray>
+#include <QtCore/QByteArrayView>
+#include <QtCore/QList>
 #include <QtCore/QString>
 
 QT_BEGIN_NAMESPACE
 
 namespace QPcsc {
+// The response refers to a buffer owned by the sender and is only valid
+// until the next command is sent
 struct RawCommandResult
 {
     LONG ret = SCARD_E_READER_UNAVAILABLE;
-    QByteArray response;
+    QByteArrayView response;
 
     bool isOk() const { return ret == SCARD_S_SUCCESS; }
 };
@@ -103,6 +107,12 @@ public:
     static qsizetype nameSize(CPtr p);
 };
 
+namespace QPcsc {
+
+LONG listReaders(SCARDCONTEXT context, QList<QPcscSlotName> &readers);
+
+} // namespace QPcsc
+
 QT_END_NAMESPACE
 
 #endif // QPCSC_P_H
@@ -115,10 +115,18 @@ QPcscCard::QPcscCard(SCARDHANDLE handle, DWORD protocol, QObject *parent)
     m_ioPci.dwProtocol = protocol;
     m_ioPci.cbPciLength = sizeof(m_ioPci);
 
-    // Assume that everything is NFC Tag Type 4 for now
-    m_tagDetectionFsm = std::make_unique<QNfcTagType4NdefFsm>();
+    // The NDEF access uses extended length APDUs if the reader accepts them
+    m_maxInputLength = readMaxInputLength();
+
+    // Responses to extended length commands may use all of the 65536 bytes
+    // of data, otherwise short responses are expected. The buffer is grown
+    // if a command asks for a longer response.
+    const bool extendedApdus = m_maxInputLength > QCommandApdu::MaxShortLength;
+    m_receiveBuffer.resize(
+            (extendedApdus ? QCommandApdu::MaxExtendedNe : QCommandApdu::MaxShortNe) + 2);
 
-    performNdefDetection();
+    // Assume that everything is NFC Tag Type 4 for now
+    m_tagDetectionFsm = std::make_unique<QNfcTagType4NdefFsm>(m_maxInputLength);
 }
 
 QPcscCard::~QPcscCard()
@@ -127,13 +135,30 @@ QPcscCard::~QPcscCard()
     invalidate();
 }
 
-void QPcscCard::performNdefDetection()
+/*
+    Detects NDEF support of the card. Must be called once after the card is
+    created.
+
+    If knownState is not empty, it must have been returned by
+    ndefSupportState() of an earlier connection to the same card. The
+    detection commands are skipped if the state can be restored. If an
+    NDEF request fails later, restoredNdefStateFailed() is emitted so that
+    the caller can discard the state.
+*/
+void QPcscCard::detectNdefSupport(const QByteArray &knownState)
 {
     qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
 
     if (!m_isValid)
         return;
 
+    if (!knownState.isEmpty() && m_tagDetectionFsm->restoreNdefSupportState(knownState)) {
+        qCDebug(QT_NFC_PCSC) << "Restored known NDEF support state";
+        m_supportsNdef = true;
+        m_ndefStateRestored = true;
+        return;
+    }
+
     Transaction transaction(this);
 
     auto action = m_tagDetectionFsm->detectNdefSupport();
@@ -187,6 +212,9 @@ void QPcscCard::invalidate()
     If autoTransaction is NoAutoTransaction, then the calling code should ensure
     that either the command is atomic or that a temporary transaction is started
     using Transaction object.
+
+    The response refers to the receive buffer of the card and is overwritten
+    by the next command.
 */
 QPcsc::RawCommandResult QPcscCard::sendCommand(const QByteArray &command,
                                                QPcscCard::AutoTransaction autoTransaction)
@@ -208,22 +236,28 @@ QPcsc::RawCommandResult QPcscCard::sendCommand(const QByteArray &command,
         m_keepAliveTimer->start();
     }
 
+    // Malformed commands are passed to the card as is, reserve space for any
+    // response in that case
+    int ne = QCommandApdu::expectedResponseLength(command);
+    if (ne < 0)
+        ne = QCommandApdu::MaxExtendedNe;
+    if (m_receiveBuffer.size() < ne + 2)
+        m_receiveBuffer.resize(ne + 2);
+
     QPcsc::RawCommandResult result;
-    result.response.resize(0xFFFF + 2);
-    DWORD recvLength = result.response.size();
+    DWORD recvLength = m_receiveBuffer.size();
 
     qCDebug(QT_NFC_PCSC) << "TX:" << command.toHex(':');
 
     result.ret = SCardTransmit(m_handle, &m_ioPci, reinterpret_cast<LPCBYTE>(command.constData()),
                                command.size(), nullptr,
-                               reinterpret_cast<LPBYTE>(result.response.data()), &recvLength);
+                               reinterpret_cast<LPBYTE>(m_receiveBuffer.data()), &recvLength);
     if (result.ret != SCARD_S_SUCCESS) {
         qCWarning(QT_NFC_PCSC) << "SCardTransmit failed:" << QPcsc::errorMessage(result.ret);
-        result.response.clear();
         invalidate();
     } else {
-        result.response.resize(recvLength);
-        qCDebug(QT_NFC_PCSC) << "RX:" << result.response.toHex(':');
+        result.response = QByteArrayView(m_receiveBuffer).first(recvLength);
+        qCDebug(QT_NFC_PCSC) << "RX:" << result.response.toByteArray().toHex(':');
     }
 
     return result;
@@ -247,7 +281,7 @@ QByteArray QPcscCard::readUid()
     QResponseApdu res(sendCommand(command, NoAutoTransaction).response);
     if (!res.isOk())
         return {};
-    return res.data();
+    return res.data().toByteArray();
 }
 
 void QPcscCard::onReadNdefMessagesRequest(const QNearFieldTarget::RequestId &request)
@@ -287,6 +321,8 @@ void QPcscCard::onReadNdefMessagesRequest(const QNearFieldTarget::RequestId &req
     qCDebug(QT_NFC_PCSC) << "Final state:" << nextState;
     auto errorCode = (nextState == QNdefAccessFsm::Done) ? QNearFieldTarget::NoError
                                                          : QNearFieldTarget::NdefReadError;
+    if (errorCode != QNearFieldTarget::NoError)
+        reportRestoredNdefStateFailure();
     Q_EMIT requestCompleted(request, errorCode, {});
 }
 
@@ -348,7 +384,8 @@ void QPcscCard::onSendCommandRequest(const QNearFieldTarget::RequestId &request,
 
     auto result = sendCommand(command, StartAutoTransaction);
     if (result.isOk())
-        Q_EMIT requestCompleted(request, QNearFieldTarget::NoError, result.response);
+        Q_EMIT requestCompleted(request, QNearFieldTarget::NoError,
+                                result.response.toByteArray());
     else
         Q_EMIT requestCompleted(request, QNearFieldTarget::CommandError, {});
 }
@@ -370,8 +407,40 @@ void QPcscCard::onWriteNdefMessagesRequest(const QNearFieldTarget::RequestId &re
 
     Transaction transaction(this);
 
-    auto nextState = m_tagDetectionFsm->writeMessages(messages);
+    completeNdefWrite(request, m_tagDetectionFsm->writeMessages(messages));
+}
+
+/*
+    Writes a message that was serialized in advance, which is used by the
+    NDEF encoding station of QNearFieldManager.
+*/
+void QPcscCard::onWriteNdefMessageDataRequest(const QNearFieldTarget::RequestId &request,
+                                              const QByteArray &messageData)
+{
+    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
+
+    if (!m_isValid) {
+        Q_EMIT requestCompleted(request, QNearFieldTarget::ConnectionError, {});
+        return;
+    }
+
+    if (!m_supportsNdef) {
+        Q_EMIT requestCompleted(request, QNearFieldTarget::UnsupportedError, {});
+        return;
+    }
+
+    Transaction transaction(this);
+
+    completeNdefWrite(request, m_tagDetectionFsm->writeMessageData(messageData));
+}
 
+/*
+    Runs the write task started with the given action. The caller must
+    start a transaction.
+*/
+void QPcscCard::completeNdefWrite(const QNearFieldTarget::RequestId &request,
+                                  QNdefAccessFsm::Action nextState)
+{
     while (nextState == QNdefAccessFsm::SendCommand) {
         auto command = m_tagDetectionFsm->getCommand(nextState);
         if (nextState == QNdefAccessFsm::ProvideResponse) {
@@ -382,9 +451,24 @@ void QPcscCard::onWriteNdefMessagesRequest(const QNearFieldTarget::RequestId &re
 
     auto errorCode = (nextState == QNdefAccessFsm::Done) ? QNearFieldTarget::NoError
                                                          : QNearFieldTarget::NdefWriteError;
+    if (errorCode != QNearFieldTarget::NoError)
+        reportRestoredNdefStateFailure();
     Q_EMIT requestCompleted(request, errorCode, {});
 }
 
+/*
+    Lets the creator of the card know that a restored NDEF support state
+    may be outdated. The card keeps using it until it is disconnected.
+*/
+void QPcscCard::reportRestoredNdefStateFailure()
+{
+    if (!m_ndefStateRestored)
+        return;
+
+    m_ndefStateRestored = false;
+    Q_EMIT restoredNdefStateFailed();
+}
+
 /*
     Enable automatic card deletion when the connection is closed by the user
     or the card otherwise becomes unavailable.
@@ -432,8 +516,8 @@ int QPcscCard::readMaxInputLength()
     if (!m_isValid)
         return 0;
 
-    // Maximum standard APDU length
-    static constexpr int DefaultMaxInputLength = 261;
+    // Maximum short APDU length
+    static constexpr int DefaultMaxInputLength = QCommandApdu::MaxShortLength;
 
     uint32_t maxInput;
     DWORD attrSize = sizeof(maxInput);
@@ -74,26 +74,35 @@ public:
     Q_INVOKABLE void enableAutodelete();
 
     QByteArray readUid();
-    int readMaxInputLength();
+    int maxInputLength() const { return m_maxInputLength; }
 
+    void detectNdefSupport(const QByteArray &knownState = {});
     bool supportsNdef() const { return m_supportsNdef; }
+    QByteArray ndefSupportState() const { return m_tagDetectionFsm->ndefSupportState(); }
 
 private:
     SCARDHANDLE m_handle;
     SCARD_IO_REQUEST m_ioPci;
     bool m_isValid = true;
-    bool m_supportsNdef;
+    bool m_supportsNdef = false;
+    bool m_ndefStateRestored = false;
+    int m_maxInputLength;
     bool m_autodelete = false;
     // Indicates that an _automatic_ transaction was started
     bool m_inAutoTransaction = false;
     QTimer *m_keepAliveTimer;
+    // Reused for all responses, sized from the negotiated limits
+    QByteArray m_receiveBuffer;
 
     std::unique_ptr<QNdefAccessFsm> m_tagDetectionFsm;
 
     enum AutoTransaction { NoAutoTransaction, StartAutoTransaction };
 
     QPcsc::RawCommandResult sendCommand(const QByteArray &command, AutoTransaction autoTransaction);
-    void performNdefDetection();
+    int readMaxInputLength();
+    void completeNdefWrite(const QNearFieldTarget::RequestId &request,
+                           QNdefAccessFsm::Action nextState);
+    void reportRestoredNdefStateFailure();
 
     class Transaction
     {
@@ -114,6 +123,8 @@ public Q_SLOTS:
     void onReadNdefMessagesRequest(const QNearFieldTarget::RequestId &request);
     void onWriteNdefMessagesRequest(const QNearFieldTarget::RequestId &request,
                                     const QList<QNdefMessage> &messages);
+    void onWriteNdefMessageDataRequest(const QNearFieldTarget::RequestId &request,
+                                       const QByteArray &messageData);
 
 private Q_SLOTS:
     void onKeepAliveTimeout();
@@ -121,6 +132,7 @@ private Q_SLOTS:
 Q_SIGNALS:
     void disconnected();
     void invalidated();
+    void restoredNdefStateFailed();
 
     void requestCompleted(const QNearFieldTarget::RequestId &request,
                           QNearFieldTarget::Error reason, const QVariant &result);
@@ -40,33 +40,62 @@
 #include "qpcscmanager_p.h"
 #include "qpcscslot_p.h"
 #include "qpcsccard_p.h"
+#include "qpcscstatewatcher_p.h"
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QThread>
 #include <QtCore/QTimer>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 Q_DECLARE_LOGGING_CATEGORY(QT_NFC_PCSC)
 
-static constexpr int StateUpdateIntervalMs = 1000;
+// Delay before retrying after a failure that no state change will report
+static constexpr int StateUpdateRetryIntervalMs = 1000;
 
-QPcscManager::QPcscManager(QObject *parent) : QObject(parent)
+/*
+    State changes are reported by QPcscStateWatcher, which waits for them in
+    its own thread. The manager then collects the new states with a
+    non-blocking SCardGetStatusChange() call on its own context.
+
+    All card communication is done by the QPcscSlotWorker of each slot. By
+    default the workers live in the manager's thread. If QT_NFC_PCSC_READER_THREADS
+    is set to a non-zero value, each reader gets a thread of its own instead,
+    so that a slow card on one reader does not delay the others. Decisions of
+    the manager are therefore based on the reader states it has collected
+    itself, never on the state of the workers.
+*/
+QPcscManager::QPcscManager(QObject *parent)
+    : QObject(parent), m_useReaderThreads(qEnvironmentVariableIntValue("QT_NFC_PCSC_READER_THREADS"))
 {
     qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
 
+    m_watcher = new QPcscStateWatcher(this);
+    connect(m_watcher, &QPcscStateWatcher::stateChanged, this, &QPcscManager::onStateUpdate);
+
     m_stateUpdateTimer = new QTimer(this);
-    m_stateUpdateTimer->setInterval(StateUpdateIntervalMs);
+    m_stateUpdateTimer->setSingleShot(true);
+    m_stateUpdateTimer->setInterval(StateUpdateRetryIntervalMs);
     connect(m_stateUpdateTimer, &QTimer::timeout, this, &QPcscManager::onStateUpdate);
 }
 
 QPcscManager::~QPcscManager()
 {
     qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
-    if (m_hasContext) {
-        // Destroy all card handles before destroying the PCSC context.
-        for (auto slot : std::as_const(m_slots))
-            slot->invalidateInsertedCard();
+    m_watcher->stopWatching();
+
+    // The slot workers close their card handles when deleted, which happens
+    // at the latest when their thread finishes.
+    qDeleteAll(m_slots);
+    m_slots.clear();
+    m_slotStates.clear();
+    if (m_hasContext)
         SCardReleaseContext(m_context);
+
+    for (auto readerThread : std::as_const(m_readerThreads)) {
+        readerThread->quit();
+        readerThread->wait();
     }
 
     // Stop the worker thread.
@@ -89,7 +118,7 @@ void QPcscManager::processSlotUpdates()
                              << slot->name();
 
         state.dwCurrentState = state.dwEventState;
-        slot->processStateChange(state.dwEventState, m_targetDetectionRunning);
+        slot->processStateChange(state.dwEventState, m_targetDetectionRunning, m_requestedMethod);
     }
 }
 
@@ -103,9 +132,11 @@ void QPcscManager::removeSlots()
         Q_ASSERT(slot != nullptr);
 
         // Remove slots that no longer exist, or all slots without cards if
-        // target detection is stopped.
+        // target detection is stopped. The presence of a card is taken from
+        // the reader state, a worker in a reader thread may still be
+        // connecting to a card that has just been inserted.
         if ((state.dwEventState & SCARD_STATE_UNKNOWN) != 0
-            || !(m_targetDetectionRunning || slot->hasCard())) {
+            || !(m_targetDetectionRunning || (state.dwEventState & SCARD_STATE_PRESENT) != 0)) {
             qCDebug(QT_NFC_PCSC) << "Removing slot:" << slot;
             state.dwEventState = SCARD_STATE_UNKNOWN;
             slot->invalidateInsertedCard();
@@ -128,65 +159,14 @@ void QPcscManager::updateSlotList()
 {
     Q_ASSERT(m_hasContext);
 
-#ifndef SCARD_AUTOALLOCATE
-    // macOS does not support automatic allocation. Try using a fixed-size
-    // buffer first, extending it if it is not sufficient.
-#define LIST_READER_BUFFER_EXTRA 1024
-    QPcscSlotName buf(nullptr);
-    DWORD listSize = LIST_READER_BUFFER_EXTRA;
-    buf.resize(listSize);
-    QPcscSlotName::Ptr list = buf.ptr();
-
-    auto ret = SCardListReaders(m_context, nullptr, list, &listSize);
-#else
-    QPcscSlotName::Ptr list;
-    DWORD listSize = SCARD_AUTOALLOCATE;
-    auto ret = SCardListReaders(m_context, nullptr, reinterpret_cast<QPcscSlotName::Ptr>(&list),
-                                &listSize);
-#endif
-
-    if (ret == LONG(SCARD_E_NO_READERS_AVAILABLE)) {
-        list = nullptr;
-        ret = SCARD_S_SUCCESS;
-    }
-#ifndef SCARD_AUTOALLOCATE
-    else if (ret == LONG(SCARD_E_INSUFFICIENT_BUFFER)) {
-        // SCardListReaders() has set listSize to the required size. We add
-        // extra space to reduce possibility of failure if the reader list has
-        // changed since the last call.
-        listSize += LIST_READER_BUFFER_EXTRA;
-        buf.resize(listSize);
-        list = buf.ptr();
-
-        ret = SCardListReaders(m_context, nullptr, list, &listSize);
-        if (ret == LONG(SCARD_E_NO_READERS_AVAILABLE)) {
-            list = nullptr;
-            ret = SCARD_S_SUCCESS;
-        }
-    }
-#undef LIST_READER_BUFFER_EXTRA
-#endif
-
+    QList<QPcscSlotName> readers;
+    const LONG ret = QPcsc::listReaders(m_context, readers);
     if (ret != SCARD_S_SUCCESS) {
         qCDebug(QT_NFC_PCSC) << "Failed to list readers:" << QPcsc::errorMessage(ret);
         return;
     }
 
-#ifdef SCARD_AUTOALLOCATE
-    auto freeList = qScopeGuard([this, list] {
-        if (list) {
-            Q_ASSERT(m_hasContext);
-            SCardFreeMemory(m_context, list);
-        }
-    });
-#endif
-
-    QSet<QPcscSlotName> presentSlots;
-
-    if (list != nullptr) {
-        for (const auto *p = list; *p; p += QPcscSlotName::nameSize(p) + 1)
-            presentSlots.insert(QPcscSlotName(p));
-    }
+    QSet<QPcscSlotName> presentSlots(readers.cbegin(), readers.cend());
 
     // Check current state list and mark slots that are not present anymore to
     // be removed later.
@@ -205,7 +185,7 @@ void QPcscManager::updateSlotList()
 
     // Add new slots
     for (auto &&slotName : std::as_const(presentSlots)) {
-        QPcscSlot *slot = new QPcscSlot(slotName, this);
+        QPcscSlot *slot = new QPcscSlot(slotName, readerThreadForNewSlot(), this);
         qCDebug(QT_NFC_PCSC) << "New slot:" << slot;
 
         m_slots[slotName] = slot;
@@ -235,16 +215,26 @@ bool QPcscManager::establishContext()
     return true;
 }
 
+void QPcscManager::stopStateUpdates()
+{
+    m_stateUpdateTimer->stop();
+    m_watcher->stopWatching();
+}
+
 void QPcscManager::onStateUpdate()
 {
+    m_watcher->acknowledgeStateChange();
+
     if (!m_hasContext) {
         if (!m_targetDetectionRunning) {
-            m_stateUpdateTimer->stop();
+            stopStateUpdates();
             return;
         }
 
-        if (!establishContext())
+        if (!establishContext()) {
+            m_stateUpdateTimer->start();
             return;
+        }
     }
 
     updateSlotList();
@@ -256,21 +246,14 @@ void QPcscManager::onStateUpdate()
             SCardReleaseContext(m_context);
             m_hasContext = false;
 
-            m_stateUpdateTimer->stop();
+            stopStateUpdates();
         }
         return;
     }
 
-    // Both Windows and PCSCLite support interruptable continuos state detection
-    // where SCardCancel() can be used to abort it from another thread.
-    // But that introduces a problem of reliable cancelling of the status change
-    // call and no other. Reliable use of SCardCancel() would probably require
-    // some form of synchronization and polling, and would make the code much
-    // more complicated.
-    // Alternatively, the state detection code could run in a yet another thread
-    // that will not need to be cancelled too often.
-    // For simplicity, the current code just checks for status changes every
-    // second.
+    // The watcher has already waited for the change, so only collect it here.
+    // Blocking calls are never made on this context, so it never needs to be
+    // cancelled.
     LONG ret = SCardGetStatusChange(m_context, 0, m_slotStates.data(), m_slotStates.size());
 
     if (ret == SCARD_S_SUCCESS || ret == LONG(SCARD_E_UNKNOWN_READER)) {
@@ -287,13 +270,12 @@ void QPcscManager::onStateUpdate()
         // next iteration.
         Q_ASSERT(m_hasContext);
         m_hasContext = false;
-        for (auto slot : std::as_const(m_slots)) {
-            slot->invalidateInsertedCard();
-            slot->deleteLater();
-        }
+        qDeleteAll(m_slots);
         SCardReleaseContext(m_context);
         m_slots.clear();
         m_slotStates.clear();
+
+        m_stateUpdateTimer->start();
     }
 }
 
@@ -307,59 +289,42 @@ void QPcscManager::onStartTargetDetectionRequest(QNearFieldTarget::AccessMethod
         return;
 
     m_targetDetectionRunning = true;
-    m_stateUpdateTimer->start();
+    m_watcher->startWatching();
+    onStateUpdate();
 }
 
 void QPcscManager::onStopTargetDetectionRequest()
 {
     qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
     m_targetDetectionRunning = false;
+
+    // Drop the slots without cards right away
+    onStateUpdate();
 }
 
-QPcscCard *QPcscManager::connectToCard(QPcscSlot *slot)
+/*
+    Returns a reader thread that no other slot is using, starting a new one
+    if needed, or nullptr if the slot workers live in the manager's thread.
+*/
+QThread *QPcscManager::readerThreadForNewSlot()
 {
-    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
-    Q_ASSERT(slot != nullptr);
-    Q_ASSERT(m_hasContext);
-
-    SCARDHANDLE cardHandle;
-    DWORD activeProtocol;
-
-    LONG ret = SCardConnect(m_context, slot->name().ptr(), SCARD_SHARE_SHARED,
-                            SCARD_PROTOCOL_T0 | SCARD_PROTOCOL_T1, &cardHandle, &activeProtocol);
-    if (ret != SCARD_S_SUCCESS) {
-        qCDebug(QT_NFC_PCSC) << "Failed to connect to card:" << QPcsc::errorMessage(ret);
-        retryCardDetection(slot);
+    if (!m_useReaderThreads)
         return nullptr;
-    }
 
-    auto card = new QPcscCard(cardHandle, activeProtocol, this);
-    auto uid = card->readUid();
-    auto maxInputLength = card->readMaxInputLength();
-
-    QNearFieldTarget::AccessMethods accessMethods = QNearFieldTarget::TagTypeSpecificAccess;
-    if (card->supportsNdef())
-        accessMethods |= QNearFieldTarget::NdefAccess;
-
-    if (m_requestedMethod != QNearFieldTarget::UnknownAccess
-        && (accessMethods & m_requestedMethod) == 0) {
-        qCDebug(QT_NFC_PCSC) << "Dropping card without required access support";
-        card->deleteLater();
-        return nullptr;
-    }
-
-    if (!card->isValid()) {
-        qCDebug(QT_NFC_PCSC) << "Card became invalid";
-        card->deleteLater();
-
-        retryCardDetection(slot);
-
-        return nullptr;
+    for (auto readerThread : std::as_const(m_readerThreads)) {
+        const bool inUse = std::any_of(m_slots.cbegin(), m_slots.cend(), [readerThread](auto slot) {
+            return slot->workerThread() == readerThread;
+        });
+        if (!inUse)
+            return readerThread;
     }
 
-    Q_EMIT cardInserted(card, uid, accessMethods, maxInputLength);
+    auto readerThread = new QThread(this);
+    readerThread->setObjectName(u"QtNfcReaderThread"_qs);
+    readerThread->start();
+    m_readerThreads.append(readerThread);
 
-    return card;
+    return readerThread;
 }
 
 /*
@@ -378,6 +343,9 @@ void QPcscManager::retryCardDetection(const QPcscSlot *slot)
             break;
         }
     }
+
+    // The watcher will not report anything unless the state changes again
+    m_stateUpdateTimer->start();
 }
 
 QT_END_NAMESPACE
@@ -58,6 +58,8 @@ QT_BEGIN_NAMESPACE
 
 class QPcscSlot;
 class QPcscCard;
+class QPcscStateWatcher;
+class QThread;
 class QTimer;
 
 class QPcscManager : public QObject
@@ -67,9 +69,10 @@ public:
     explicit QPcscManager(QObject *parent = nullptr);
     ~QPcscManager() override;
 
-    QPcscCard *connectToCard(QPcscSlot *slot);
+    void retryCardDetection(const QPcscSlot *slot);
 
 private:
+    QPcscStateWatcher *m_watcher;
     QTimer *m_stateUpdateTimer;
     bool m_targetDetectionRunning = false;
     bool m_hasContext = false;
@@ -77,12 +80,15 @@ private:
     QMap<QPcscSlotName, QPcscSlot *> m_slots;
     QList<SCARD_READERSTATE> m_slotStates;
     QNearFieldTarget::AccessMethod m_requestedMethod;
+    const bool m_useReaderThreads;
+    QList<QThread *> m_readerThreads;
 
     [[nodiscard]] bool establishContext();
     void processSlotUpdates();
     void updateSlotList();
     void removeSlots();
-    void retryCardDetection(const QPcscSlot *slot);
+    void stopStateUpdates();
+    QThread *readerThreadForNewSlot();
 
 public Q_SLOTS:
     void onStartTargetDetectionRequest(QNearFieldTarget::AccessMethod accessMethod);
@@ -41,24 +41,66 @@
 #include "qpcscmanager_p.h"
 #include "qpcsccard_p.h"
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QThread>
 
 QT_BEGIN_NAMESPACE
 
 Q_DECLARE_LOGGING_CATEGORY(QT_NFC_PCSC)
 
-QPcscSlot::QPcscSlot(const QPcscSlotName &name, QPcscManager *manager)
-    : QObject(manager), m_name(name)
+// Upper bound for remembered NDEF support states, the cache is simply
+// started over when it is reached
+static constexpr qsizetype MaxKnownNdefStates = 256;
+
+/*
+    Returns true if the UID identifies the tag permanently. ISO/IEC 14443-3
+    single size UIDs starting with 0x08 are generated randomly on each
+    activation and can not be used to recognize a tag.
+*/
+static bool isPermanentUid(const QByteArray &uid)
 {
+    return !uid.isEmpty() && !(uid.size() == 4 && static_cast<uint8_t>(uid.at(0)) == 0x08);
 }
 
-QPcscSlot::~QPcscSlot()
+QPcscSlotWorker::QPcscSlotWorker(const QPcscSlotName &name) : m_name(name) { }
+
+QPcscSlotWorker::~QPcscSlotWorker()
 {
-    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO << this;
-    if (m_insertedCard)
-        m_insertedCard->invalidate();
+    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO << m_name;
+
+    // Card objects may outlive the worker until the manager has handed them
+    // to their targets, but their handles must be closed before the context.
+    for (const auto &card : std::as_const(m_cards)) {
+        if (card)
+            card->invalidate();
+    }
+    releaseContext();
 }
 
-void QPcscSlot::processStateChange(DWORD eventId, bool createCards)
+bool QPcscSlotWorker::establishContext()
+{
+    Q_ASSERT(!m_hasContext);
+
+    LONG ret = SCardEstablishContext(SCARD_SCOPE_USER, nullptr, nullptr, &m_context);
+    if (ret != SCARD_S_SUCCESS) {
+        qCWarning(QT_NFC_PCSC) << "Failed to establish context:" << QPcsc::errorMessage(ret);
+        return false;
+    }
+    m_hasContext = true;
+
+    return true;
+}
+
+void QPcscSlotWorker::releaseContext()
+{
+    if (!m_hasContext)
+        return;
+
+    SCardReleaseContext(m_context);
+    m_hasContext = false;
+}
+
+void QPcscSlotWorker::processStateChange(DWORD eventId, bool createCards,
+                                         QNearFieldTarget::AccessMethod requestedMethod)
 {
     qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
 
@@ -71,23 +113,140 @@ void QPcscSlot::processStateChange(DWORD eventId, bool createCards)
         m_insertedCard.clear();
     }
 
-    auto manager = qobject_cast<QPcscManager *>(parent());
-
-    if (manager != nullptr && createCards
+    if (createCards
         && (eventId
             & (SCARD_STATE_PRESENT | SCARD_STATE_MUTE | SCARD_STATE_UNPOWERED
                | SCARD_STATE_EXCLUSIVE))
                 == SCARD_STATE_PRESENT) {
         qCDebug(QT_NFC_PCSC) << "New card in slot" << m_name;
 
-        m_insertedCard = manager->connectToCard(this);
+        m_insertedCard = connectToCard(requestedMethod);
     }
 }
 
-void QPcscSlot::invalidateInsertedCard()
+void QPcscSlotWorker::invalidateInsertedCard()
 {
     if (m_insertedCard)
         m_insertedCard->invalidate();
 }
 
+QPcscCard *QPcscSlotWorker::connectToCard(QNearFieldTarget::AccessMethod requestedMethod)
+{
+    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
+
+    if (!m_hasContext && !establishContext()) {
+        Q_EMIT retryRequested();
+        return nullptr;
+    }
+
+    SCARDHANDLE cardHandle;
+    DWORD activeProtocol;
+
+    LONG ret = SCardConnect(m_context, m_name.ptr(), SCARD_SHARE_SHARED,
+                            SCARD_PROTOCOL_T0 | SCARD_PROTOCOL_T1, &cardHandle, &activeProtocol);
+    if (ret != SCARD_S_SUCCESS) {
+        qCDebug(QT_NFC_PCSC) << "Failed to connect to card:" << QPcsc::errorMessage(ret);
+        if (ret == LONG(SCARD_E_INVALID_HANDLE) || ret == LONG(SCARD_E_NO_SERVICE)
+            || ret == LONG(SCARD_E_SERVICE_STOPPED)) {
+            // Start over with a new context on the next attempt
+            for (const auto &card : std::as_const(m_cards)) {
+                if (card)
+                    card->invalidate();
+            }
+            releaseContext();
+        }
+        Q_EMIT retryRequested();
+        return nullptr;
+    }
+
+    // The card is deleted when it becomes invalid after the manager has
+    // enabled automatic deletion, or at the latest when its thread finishes.
+    auto card = new QPcscCard(cardHandle, activeProtocol);
+    connect(thread(), &QThread::finished, card, &QObject::deleteLater);
+    m_cards.removeIf([](const auto &card) { return card.isNull(); });
+    m_cards.append(card);
+
+    auto uid = card->readUid();
+    auto maxInputLength = card->maxInputLength();
+
+    // Tags seen before, for example when they are presented again for
+    // verification, do not need to be probed again
+    if (isPermanentUid(uid)) {
+        card->detectNdefSupport(m_knownNdefStates.value(uid));
+
+        const QByteArray state = card->ndefSupportState();
+        if (!state.isEmpty()) {
+            if (m_knownNdefStates.size() >= MaxKnownNdefStates && !m_knownNdefStates.contains(uid))
+                m_knownNdefStates.clear();
+            m_knownNdefStates.insert(uid, state);
+            connect(card, &QPcscCard::restoredNdefStateFailed, this,
+                    [this, uid] { m_knownNdefStates.remove(uid); });
+        }
+    } else {
+        card->detectNdefSupport();
+    }
+
+    QNearFieldTarget::AccessMethods accessMethods = QNearFieldTarget::TagTypeSpecificAccess;
+    if (card->supportsNdef())
+        accessMethods |= QNearFieldTarget::NdefAccess;
+
+    if (requestedMethod != QNearFieldTarget::UnknownAccess
+        && (accessMethods & requestedMethod) == 0) {
+        qCDebug(QT_NFC_PCSC) << "Dropping card without required access support";
+        card->deleteLater();
+        return nullptr;
+    }
+
+    if (!card->isValid()) {
+        qCDebug(QT_NFC_PCSC) << "Card became invalid";
+        card->deleteLater();
+
+        Q_EMIT retryRequested();
+
+        return nullptr;
+    }
+
+    Q_EMIT cardInserted(card, uid, accessMethods, maxInputLength);
+
+    return card;
+}
+
+QPcscSlot::QPcscSlot(const QPcscSlotName &name, QThread *workerThread, QPcscManager *manager)
+    : QObject(manager),
+      m_name(name),
+      m_workerThread(workerThread),
+      m_worker(new QPcscSlotWorker(name))
+{
+    if (workerThread)
+        m_worker->moveToThread(workerThread);
+
+    connect(m_worker, &QPcscSlotWorker::retryRequested, this,
+            [this, manager] { manager->retryCardDetection(this); });
+    // Forwarded from the worker thread, the manager only routes the event
+    connect(m_worker, &QPcscSlotWorker::cardInserted, manager, &QPcscManager::cardInserted,
+            Qt::DirectConnection);
+}
+
+QPcscSlot::~QPcscSlot()
+{
+    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO << this;
+    m_worker->deleteLater();
+}
+
+void QPcscSlot::processStateChange(DWORD eventId, bool createCards,
+                                   QNearFieldTarget::AccessMethod requestedMethod)
+{
+    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
+
+    // Called directly if the worker lives in this thread
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, eventId, createCards, requestedMethod] {
+        worker->processStateChange(eventId, createCards, requestedMethod);
+    });
+}
+
+void QPcscSlot::invalidateInsertedCard()
+{
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker] { worker->invalidateInsertedCard(); });
+}
+
 QT_END_NAMESPACE
@@ -52,6 +52,9 @@
 //
 
 #include "qpcsc_p.h"
+#include "qnearfieldtarget.h"
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QObject>
 #include <QtCore/QPointer>
 
@@ -59,22 +62,66 @@ QT_BEGIN_NAMESPACE
 
 class QPcscManager;
 class QPcscCard;
+class QThread;
 
+/*
+    Performs all card related PC/SC calls for a single slot and owns the
+    QPcscCard objects created for it. The worker uses a PC/SC context of its
+    own, so that it can live in a separate thread and talk to its reader
+    without being serialized with other readers.
+*/
+class QPcscSlotWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QPcscSlotWorker(const QPcscSlotName &name);
+    ~QPcscSlotWorker() override;
+
+    void processStateChange(DWORD eventId, bool createCards,
+                            QNearFieldTarget::AccessMethod requestedMethod);
+    void invalidateInsertedCard();
+
+Q_SIGNALS:
+    void cardInserted(QPcscCard *card, const QByteArray &uid,
+                      QNearFieldTarget::AccessMethods accessMethods, int maxInputLength);
+    void retryRequested();
+
+private:
+    const QPcscSlotName m_name;
+    SCARDCONTEXT m_context;
+    bool m_hasContext = false;
+    QPointer<QPcscCard> m_insertedCard;
+    QList<QPointer<QPcscCard>> m_cards;
+    // NDEF support states of recently seen tags, indexed by UID
+    QHash<QByteArray, QByteArray> m_knownNdefStates;
+
+    [[nodiscard]] bool establishContext();
+    void releaseContext();
+    QPcscCard *connectToCard(QNearFieldTarget::AccessMethod requestedMethod);
+};
+
+/*
+    Represents a slot in QPcscManager's thread and forwards the state changes
+    to its QPcscSlotWorker, which lives either in the same thread or in one
+    of the reader threads of the manager.
+*/
 class QPcscSlot : public QObject
 {
     Q_OBJECT
 public:
-    QPcscSlot(const QPcscSlotName &name, QPcscManager *manager);
+    QPcscSlot(const QPcscSlotName &name, QThread *workerThread, QPcscManager *manager);
     ~QPcscSlot() override;
 
     const QPcscSlotName &name() const { return m_name; }
-    void processStateChange(DWORD eventId, bool createCards);
-    bool hasCard() const { return !m_insertedCard.isNull(); }
+    QThread *workerThread() const { return m_workerThread; }
+    void processStateChange(DWORD eventId, bool createCards,
+                            QNearFieldTarget::AccessMethod requestedMethod);
     void invalidateInsertedCard();
 
 private:
     const QPcscSlotName m_name;
-    QPointer<QPcscCard> m_insertedCard;
+    QThread *m_workerThread;
+    QPcscSlotWorker *m_worker;
 };
 
 QT_END_NAMESPACE
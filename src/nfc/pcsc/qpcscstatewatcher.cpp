@@ -0,0 +1,275 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpcscstatewatcher_p.h"
+#include <QtCore/QHash>
+#include <QtCore/QLoggingCategory>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(QT_NFC_PCSC)
+
+static constexpr int ContextRetryIntervalMs = 1000;
+// Only used if the PC/SC implementation does not support PnP notifications
+static constexpr int ReaderPollIntervalMs = 1000;
+static constexpr int CancelRetryIntervalMs = 10;
+
+#ifdef Q_OS_WIN
+static const wchar_t PnpNotificationReader[] = L"\\\\?PnP?\\Notification";
+#else
+static const char PnpNotificationReader[] = "\\\\?PnP?\\Notification";
+#endif
+
+QPcscStateWatcher::QPcscStateWatcher(QObject *parent) : QThread(parent)
+{
+    setObjectName(u"QtNfcPcscWatcher"_qs);
+}
+
+QPcscStateWatcher::~QPcscStateWatcher()
+{
+    stopWatching();
+}
+
+void QPcscStateWatcher::startWatching()
+{
+    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
+
+    if (isRunning())
+        return;
+
+    m_stopRequested.storeRelaxed(false);
+    m_changePending.storeRelaxed(false);
+    m_wakeUp.tryAcquire(m_wakeUp.available());
+    start();
+}
+
+void QPcscStateWatcher::stopWatching()
+{
+    if (!isRunning())
+        return;
+
+    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
+
+    m_stopRequested.storeRelease(true);
+    m_wakeUp.release();
+
+    // SCardCancel() only has an effect if the thread is already blocked in
+    // SCardGetStatusChange(). It might be just about to enter it, so keep
+    // cancelling until the thread has noticed the stop request.
+    do {
+        QMutexLocker locker(&m_contextMutex);
+        if (m_hasContext)
+            SCardCancel(m_context);
+    } while (!wait(CancelRetryIntervalMs));
+}
+
+void QPcscStateWatcher::run()
+{
+    while (!m_stopRequested.loadAcquire()) {
+        if (!m_hasContext) {
+            if (!establishContext()) {
+                m_wakeUp.tryAcquire(1, ContextRetryIntervalMs);
+                continue;
+            }
+            resetStates();
+        }
+
+        if (m_states.isEmpty()) {
+            // No readers and no PnP notifications, nothing to block on
+            m_wakeUp.tryAcquire(1, ReaderPollIntervalMs);
+            if (!m_stopRequested.loadAcquire() && updateReaderList())
+                notifyStateChange();
+            continue;
+        }
+
+        const DWORD timeout = m_pnpSupported ? INFINITE : ReaderPollIntervalMs;
+        const LONG ret = SCardGetStatusChange(m_context, timeout, m_states.data(),
+                                              DWORD(m_states.size()));
+        if (m_stopRequested.loadAcquire())
+            break;
+
+        bool stateChanged = false;
+        bool readersChanged = false;
+
+        if (ret == SCARD_S_SUCCESS || ret == LONG(SCARD_E_UNKNOWN_READER)) {
+            if (m_pnpSupported && (m_states.first().dwEventState & SCARD_STATE_UNKNOWN) != 0) {
+                qCDebug(QT_NFC_PCSC) << "PnP notifications not supported, polling reader list";
+                m_pnpSupported = false;
+                resetStates();
+                continue;
+            }
+
+            // A reader has disappeared before SCardGetStatusChange() could wait for it
+            if (ret == LONG(SCARD_E_UNKNOWN_READER))
+                readersChanged = true;
+
+            for (auto &state : m_states) {
+                if ((state.dwEventState & SCARD_STATE_CHANGED) == 0)
+                    continue;
+
+                if (state.szReader == PnpNotificationReader
+                    || (state.dwEventState & SCARD_STATE_UNKNOWN) != 0) {
+                    readersChanged = true;
+                } else {
+                    stateChanged = true;
+                }
+                state.dwCurrentState = state.dwEventState & ~DWORD(SCARD_STATE_CHANGED);
+            }
+        } else if (ret == LONG(SCARD_E_TIMEOUT)) {
+            readersChanged = true;
+        } else if (ret == LONG(SCARD_E_CANCELLED)) {
+            // Cancelled without a stop request, just wait again
+        } else {
+            qCWarning(QT_NFC_PCSC) << "SCardGetStatusChange failed:" << QPcsc::errorMessage(ret);
+
+            // Start over with a new context, and let the manager find out
+            // whether its own context is affected as well.
+            releaseContext();
+            notifyStateChange();
+            m_wakeUp.tryAcquire(1, ContextRetryIntervalMs);
+            continue;
+        }
+
+        if (readersChanged && updateReaderList())
+            stateChanged = true;
+        if (stateChanged)
+            notifyStateChange();
+    }
+
+    releaseContext();
+}
+
+bool QPcscStateWatcher::establishContext()
+{
+    SCARDCONTEXT context;
+    const LONG ret = SCardEstablishContext(SCARD_SCOPE_USER, nullptr, nullptr, &context);
+    if (ret != SCARD_S_SUCCESS) {
+        qCDebug(QT_NFC_PCSC) << "Failed to establish watcher context:" << QPcsc::errorMessage(ret);
+        return false;
+    }
+
+    QMutexLocker locker(&m_contextMutex);
+    m_context = context;
+    m_hasContext = true;
+    m_pnpSupported = true;
+
+    return true;
+}
+
+void QPcscStateWatcher::releaseContext()
+{
+    QMutexLocker locker(&m_contextMutex);
+    if (!m_hasContext)
+        return;
+
+    SCardReleaseContext(m_context);
+    m_hasContext = false;
+    m_states.clear();
+    m_readers.clear();
+}
+
+/*
+    Rebuilds the state list from scratch, which makes the next
+    SCardGetStatusChange() call report the current state of all readers.
+*/
+void QPcscStateWatcher::resetStates()
+{
+    m_states.clear();
+    m_readers.clear();
+    updateReaderList();
+}
+
+/*
+    Lists the readers again and rebuilds the state list if it has changed.
+    m_states holds the PnP pseudo-reader first, if supported, followed by
+    the entries of m_readers in the same order.
+*/
+bool QPcscStateWatcher::updateReaderList()
+{
+    QList<QPcscSlotName> readers;
+    const LONG ret = QPcsc::listReaders(m_context, readers);
+    if (ret != SCARD_S_SUCCESS) {
+        qCDebug(QT_NFC_PCSC) << "Failed to list readers:" << QPcsc::errorMessage(ret);
+        return false;
+    }
+
+    const qsizetype pnpEntries = m_pnpSupported ? 1 : 0;
+    if (readers == m_readers && m_states.size() == m_readers.size() + pnpEntries)
+        return false;
+
+    // Keep the known state of readers that are still present, so that only
+    // actual changes are reported for them.
+    QHash<QPcscSlotName, DWORD> knownStates;
+    const qsizetype oldPnpEntries = m_states.size() - m_readers.size();
+    for (qsizetype i = 0; i < m_readers.size() && oldPnpEntries >= 0; ++i)
+        knownStates.insert(m_readers.at(i), m_states.at(i + oldPnpEntries).dwCurrentState);
+
+    m_readers = readers;
+    m_states.clear();
+    m_states.reserve(m_readers.size() + pnpEntries);
+
+    if (m_pnpSupported) {
+        SCARD_READERSTATE state {};
+        state.szReader = PnpNotificationReader;
+        state.dwCurrentState = SCARD_STATE_UNAWARE;
+        m_states.append(state);
+    }
+
+    for (const auto &reader : std::as_const(m_readers)) {
+        SCARD_READERSTATE state {};
+        state.szReader = reader.ptr();
+        state.dwCurrentState = knownStates.value(reader, SCARD_STATE_UNAWARE);
+        m_states.append(state);
+    }
+
+    qCDebug(QT_NFC_PCSC) << "Watching" << m_readers.size() << "readers";
+
+    return true;
+}
+
+void QPcscStateWatcher::notifyStateChange()
+{
+    // Coalesce notifications until the manager has processed the last one
+    if (!m_changePending.testAndSetOrdered(false, true))
+        return;
+
+    Q_EMIT stateChanged();
+}
+
+QT_END_NAMESPACE
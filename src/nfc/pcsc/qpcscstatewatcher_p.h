@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPCSCSTATEWATCHER_P_H
+#define QPCSCSTATEWATCHER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qpcsc_p.h"
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Thread that blocks in SCardGetStatusChange() on all readers and on the
+    PnP notification pseudo-reader, and emits stateChanged() whenever a card
+    or the reader list changes.
+
+    It uses its own PC/SC context, so that SCardCancel() only ever interrupts
+    the watcher and never a card operation of QPcscManager.
+*/
+class QPcscStateWatcher : public QThread
+{
+    Q_OBJECT
+public:
+    explicit QPcscStateWatcher(QObject *parent = nullptr);
+    ~QPcscStateWatcher() override;
+
+    void startWatching();
+    void stopWatching();
+
+    // Allows the next change to emit stateChanged() again
+    void acknowledgeStateChange() { m_changePending.storeRelease(false); }
+
+Q_SIGNALS:
+    void stateChanged();
+
+protected:
+    void run() override;
+
+private:
+    bool establishContext();
+    void releaseContext();
+    void resetStates();
+    bool updateReaderList();
+    void notifyStateChange();
+
+    QMutex m_contextMutex;
+    SCARDCONTEXT m_context;
+    bool m_hasContext = false;
+    bool m_pnpSupported = true;
+
+    QAtomicInteger<bool> m_stopRequested = false;
+    QAtomicInteger<bool> m_changePending = false;
+    QSemaphore m_wakeUp;
+
+    QList<QPcscSlotName> m_readers;
+    QList<SCARD_READERSTATE> m_states;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPCSCSTATEWATCHER_P_H
@@ -40,6 +40,8 @@
 #include "qapduutils_p.h"
 #include <QtCore/QtEndian>
 
+#include <cstring>
+
 QT_BEGIN_NAMESPACE
 
 /*
@@ -56,61 +58,163 @@ QT_BEGIN_NAMESPACE
 
     If the data is too short to contain SW bytes, the returned responses SW
     is set to QResponseApdu::Empty.
+
+    No data is copied, the response must outlive this object.
 */
-QResponseApdu::QResponseApdu(const QByteArray &response)
+QResponseApdu::QResponseApdu(QByteArrayView response)
 {
     if (response.size() < 2) {
         m_status = Empty;
         m_data = response;
     } else {
         const auto dataSize = response.size() - 2;
-        m_status = qFromBigEndian(qFromUnaligned<uint16_t>(response.constData() + dataSize));
-        m_data = response.left(dataSize);
+        m_status = qFromBigEndian(qFromUnaligned<uint16_t>(response.data() + dataSize));
+        m_data = response.first(dataSize);
     }
 }
 
+static bool isExtended(qsizetype nc, int ne)
+{
+    return nc > QCommandApdu::MaxShortNc || ne > QCommandApdu::MaxShortNe;
+}
+
 /*
-    Builds a command APDU from components according to ISO/IEC 7816.
+    Returns the size of a command APDU with nc bytes of data and expected
+    response length ne.
 */
-QByteArray QCommandApdu::build(uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
-                               QByteArrayView data, uint16_t ne)
+qsizetype QCommandApdu::encodedLength(qsizetype nc, int ne)
 {
-    Q_ASSERT(data.size() <= 0xFFFF);
+    const qsizetype fieldSize = isExtended(nc, ne) ? 3 : 1;
+    qsizetype size = 4;
 
-    QByteArray apdu;
-    apdu.append(static_cast<char>(cla));
-    apdu.append(static_cast<char>(ins));
-    apdu.append(static_cast<char>(p1));
-    apdu.append(static_cast<char>(p2));
+    if (nc > 0)
+        size += fieldSize + nc;
+    if (ne > 0)
+        size += (nc > 0 && fieldSize == 3) ? 2 : fieldSize;
+
+    return size;
+}
 
-    bool extendedLc = false;
-    uint16_t nc = data.size();
+/*
+    Returns the expected response length Ne encoded in the given command
+    APDU, or -1 if the command is malformed.
+*/
+int QCommandApdu::expectedResponseLength(QByteArrayView command)
+{
+    const qsizetype size = command.size();
+    if (size < 4)
+        return -1;
+    if (size == 4)
+        return 0;
+
+    const auto byteAt = [command](qsizetype idx) { return static_cast<uint8_t>(command[idx]); };
+
+    if (size == 5) {
+        const int le = byteAt(4);
+        return le ? le : MaxShortNe;
+    }
+
+    if (byteAt(4) != 0) {
+        const qsizetype nc = byteAt(4);
+        if (size == 5 + nc)
+            return 0;
+        if (size == 5 + nc + 1) {
+            const int le = byteAt(size - 1);
+            return le ? le : MaxShortNe;
+        }
+        return -1;
+    }
+
+    const int le = (byteAt(size - 2) << 8) | byteAt(size - 1);
+    if (size == 7)
+        return le ? le : MaxExtendedNe;
+
+    const qsizetype nc = (byteAt(5) << 8) | byteAt(6);
+    if (nc == 0)
+        return -1;
+    if (size == 7 + nc)
+        return 0;
+    if (size == 7 + nc + 2)
+        return le ? le : MaxExtendedNe;
+
+    return -1;
+}
+
+/*
+    Writes a command APDU to dst and returns the pointer past its last byte.
+
+    The buffer must have space for at least encodedLength(data.size(), ne)
+    bytes.
+
+    Extended length fields are used if either the command data or the
+    expected response length ne do not fit the short encoding. In that
+    case both Lc and Le are encoded in extended form, as required by
+    ISO/IEC 7816-4. An ne of 256 (short) or 65536 (extended) is encoded as
+    zero.
+*/
+char *QCommandApdu::buildInto(char *dst, uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+                              QByteArrayView data, int ne)
+{
+    Q_ASSERT(data.size() <= MaxExtendedNc);
+    Q_ASSERT(ne >= 0 && ne <= MaxExtendedNe);
+
+    const qsizetype nc = data.size();
+    const bool extended = isExtended(nc, ne);
+
+    *dst++ = static_cast<char>(cla);
+    *dst++ = static_cast<char>(ins);
+    *dst++ = static_cast<char>(p1);
+    *dst++ = static_cast<char>(p2);
 
     if (nc > 0) {
-        if (nc < 256) {
-            apdu.append(static_cast<char>(nc));
+        if (extended) {
+            *dst++ = '\0';
+            *dst++ = static_cast<char>(nc >> 8);
+            *dst++ = static_cast<char>(nc & 0xFF);
         } else {
-            extendedLc = true;
-            apdu.append('\0');
-            apdu.append(static_cast<char>(nc >> 8));
-            apdu.append(static_cast<char>(nc & 0xFF));
+            *dst++ = static_cast<char>(nc);
         }
-        apdu.append(data);
+        memcpy(dst, data.data(), nc);
+        dst += nc;
     }
 
     if (ne) {
-        if (ne < 256) {
-            apdu.append(static_cast<char>(ne));
-        } else if (ne == 256) {
-            apdu.append(static_cast<char>('\0'));
+        if (extended) {
+            // The leading zero is shared with Lc if there is one
+            if (nc == 0)
+                *dst++ = '\0';
+            *dst++ = static_cast<char>((ne >> 8) & 0xFF);
+            *dst++ = static_cast<char>(ne & 0xFF);
         } else {
-            if (!extendedLc)
-                apdu.append('\0');
-            apdu.append(static_cast<char>(ne >> 8));
-            apdu.append(static_cast<char>(ne & 0xFF));
+            *dst++ = static_cast<char>(ne & 0xFF);
         }
     }
 
+    return dst;
+}
+
+/*
+    Builds a command APDU into apdu, replacing its contents.
+
+    The capacity of apdu is reused, so no memory is allocated when the same
+    buffer is used for a sequence of commands of similar size.
+*/
+void QCommandApdu::buildInto(QByteArray &apdu, uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+                             QByteArrayView data, int ne)
+{
+    apdu.resize(encodedLength(data.size(), ne));
+    [[maybe_unused]] char *end = buildInto(apdu.data(), cla, ins, p1, p2, data, ne);
+    Q_ASSERT(end == apdu.constData() + apdu.size());
+}
+
+/*
+    Builds a command APDU from components according to ISO/IEC 7816.
+*/
+QByteArray QCommandApdu::build(uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+                               QByteArrayView data, int ne)
+{
+    QByteArray apdu;
+    buildInto(apdu, cla, ins, p1, p2, data, ne);
     return apdu;
 }
 
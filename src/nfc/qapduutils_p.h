@@ -52,6 +52,7 @@
 //
 
 #include <QtCore/QByteArray>
+#include <QtCore/QByteArrayView>
 
 QT_BEGIN_NAMESPACE
 
@@ -61,14 +62,15 @@ public:
     static constexpr uint16_t Empty = 0x0000;
     static constexpr uint16_t Success = 0x9000;
 
-    explicit QResponseApdu(const QByteArray &response = {});
+    explicit QResponseApdu(QByteArrayView response = {});
 
-    const QByteArray &data() const { return m_data; }
+    // Refers to the data passed to the constructor
+    QByteArrayView data() const { return m_data; }
     uint16_t status() const { return m_status; }
     bool isOk() const { return m_status == Success; }
 
 private:
-    QByteArray m_data;
+    QByteArrayView m_data;
     uint16_t m_status;
 };
 
@@ -80,8 +82,26 @@ constexpr uint8_t ReadBinary = 0xB0;
 constexpr uint8_t GetData = 0xCA;
 constexpr uint8_t UpdateBinary = 0xD6;
 
+// Limits of the short and extended Lc and Le fields
+constexpr qsizetype MaxShortNc = 255;
+constexpr int MaxShortNe = 256;
+constexpr qsizetype MaxExtendedNc = 65535;
+constexpr int MaxExtendedNe = 65536;
+
+// Largest short command APDU: header, Lc, 255 bytes of data and Le
+constexpr int MaxShortLength = 4 + 1 + MaxShortNc + 1;
+// Size of header and Lc of an extended command APDU with data
+constexpr int ExtendedHeaderLength = 4 + 3;
+
+qsizetype encodedLength(qsizetype nc, int ne);
+int expectedResponseLength(QByteArrayView command);
+
+char *buildInto(char *dst, uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+                QByteArrayView data, int ne = 0);
+void buildInto(QByteArray &apdu, uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2,
+               QByteArrayView data, int ne = 0);
 QByteArray build(uint8_t cla, uint8_t ins, uint8_t p1, uint8_t p2, QByteArrayView data,
-                 uint16_t ne = 0);
+                 int ne = 0);
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,200 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qndefencodingstation_p.h"
+#include "qnearfieldmanager_p.h"
+#include "qnearfieldtarget_p.h"
+#include "qndefmessage.h"
+
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+QNdefEncodingStation::QNdefEncodingStation(QNearFieldManagerPrivate *backend)
+    : QObject(backend), m_backend(backend)
+{
+    connect(backend, &QNearFieldManagerPrivate::targetDetected, this,
+            &QNdefEncodingStation::onTargetDetected);
+    connect(backend, &QNearFieldManagerPrivate::targetLost, this, [this](QNearFieldTarget *target) {
+        if (m_jobs.contains(target))
+            finishJob(target, QNearFieldTarget::TargetOutOfRangeError);
+    });
+}
+
+QNdefEncodingStation::~QNdefEncodingStation() = default;
+
+void QNdefEncodingStation::enqueue(const QList<QNdefMessage> &messages)
+{
+    m_queue.reserve(m_queue.size() + messages.size());
+    for (const auto &message : messages)
+        m_queue.append(message.toByteArray());
+}
+
+bool QNdefEncodingStation::start(QNearFieldManager::EncodingOptions options)
+{
+    if (m_active || m_queue.isEmpty())
+        return false;
+
+    if (!m_backend->detectionStartedByApplication) {
+        if (!m_backend->startTargetDetection(QNearFieldTarget::NdefAccess))
+            return false;
+        m_startedDetection = true;
+    }
+
+    m_options = options;
+    m_active = true;
+    return true;
+}
+
+void QNdefEncodingStation::stop()
+{
+    if (!m_active)
+        return;
+
+    m_active = false;
+
+    // Detection that the application started itself is left running
+    if (std::exchange(m_startedDetection, false) && !m_backend->detectionStartedByApplication)
+        m_backend->stopTargetDetection(QString());
+}
+
+void QNdefEncodingStation::onTargetDetected(QNearFieldTarget *target)
+{
+    if (!m_active || m_queue.isEmpty() || m_jobs.contains(target))
+        return;
+
+    if (!(target->accessMethods() & QNearFieldTarget::NdefAccess))
+        return;
+
+    Job &job = m_jobs[target];
+    job.timer.start();
+    job.uid = target->uid();
+    job.messageData = m_queue.takeFirst();
+
+    connect(target, &QNearFieldTarget::requestCompleted, this,
+            [this, target](const QNearFieldTarget::RequestId &id) {
+                onRequestCompleted(target, id);
+            });
+    connect(target, &QNearFieldTarget::error, this,
+            [this, target](QNearFieldTarget::Error error, const QNearFieldTarget::RequestId &id) {
+                onError(target, error, id);
+            });
+    connect(target, &QNearFieldTarget::ndefMessageRead, this,
+            [this, target](const QNdefMessage &message) {
+                auto it = m_jobs.find(target);
+                if (it != m_jobs.end() && it->verifyId.isValid())
+                    it->readBack.append(message.toByteArray());
+            });
+    connect(target, &QObject::destroyed, this, [this, target] {
+        if (m_jobs.contains(target))
+            finishJob(target, QNearFieldTarget::TargetOutOfRangeError);
+    });
+
+    // Completion is always reported asynchronously, so the request id can be
+    // stored after the call
+    const auto id = QNearFieldTargetPrivate::get(target)->writeNdefMessageData(job.messageData);
+    if (!id.isValid()) {
+        finishJob(target, QNearFieldTarget::ConnectionError);
+        return;
+    }
+    m_jobs[target].writeId = id;
+}
+
+void QNdefEncodingStation::onRequestCompleted(QNearFieldTarget *target,
+                                              const QNearFieldTarget::RequestId &id)
+{
+    auto it = m_jobs.find(target);
+    if (it == m_jobs.end())
+        return;
+
+    if (id == it->writeId) {
+        if (!m_options.testFlag(QNearFieldManager::EncodingOption::VerifyAfterWrite)) {
+            finishJob(target, QNearFieldTarget::NoError);
+            return;
+        }
+
+        const auto verifyId = target->readNdefMessages();
+        if (!verifyId.isValid()) {
+            finishJob(target, QNearFieldTarget::NdefReadError);
+            return;
+        }
+        m_jobs[target].verifyId = verifyId;
+    } else if (id == it->verifyId) {
+        const bool matches = it->readBack.size() == 1 && it->readBack.first() == it->messageData;
+        finishJob(target, matches ? QNearFieldTarget::NoError : QNearFieldTarget::NdefWriteError);
+    }
+}
+
+void QNdefEncodingStation::onError(QNearFieldTarget *target, QNearFieldTarget::Error error,
+                                   const QNearFieldTarget::RequestId &id)
+{
+    auto it = m_jobs.find(target);
+    if (it == m_jobs.end())
+        return;
+
+    if (id == it->writeId || id == it->verifyId)
+        finishJob(target, error);
+}
+
+/*
+    Reports the result of the job for the target. If the message was not
+    written, it is returned to the front of the queue.
+*/
+void QNdefEncodingStation::finishJob(QNearFieldTarget *target, QNearFieldTarget::Error error)
+{
+    disconnect(target, nullptr, this, nullptr);
+
+    Job job = m_jobs.take(target);
+    const int elapsedMs = int(job.timer.elapsed());
+
+    if (error == QNearFieldTarget::NoError) {
+        Q_EMIT messageEncoded(job.uid, elapsedMs);
+    } else {
+        m_queue.prepend(std::move(job.messageData));
+        Q_EMIT encodingFailed(job.uid, error);
+    }
+
+    if (m_queue.isEmpty() && m_jobs.isEmpty() && m_active) {
+        stop();
+        Q_EMIT finished();
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,122 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QNDEFENCODINGSTATION_P_H
+#define QNDEFENCODINGSTATION_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qnearfieldmanager.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+
+QT_BEGIN_NAMESPACE
+
+class QNearFieldManagerPrivate;
+
+/*
+    Implements the NDEF encoding station of QNearFieldManager on top of the
+    generic backend interface.
+
+    Each detected target with NDEF access gets the next message of the queue
+    written to it. The messages are serialized when they are queued, so that
+    the time between the detection of a tag and the start of the write is as
+    short as possible. A message that could not be written is returned to the
+    front of the queue and used for the next target.
+*/
+class QNdefEncodingStation : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QNdefEncodingStation(QNearFieldManagerPrivate *backend);
+    ~QNdefEncodingStation() override;
+
+    void enqueue(const QList<QNdefMessage> &messages);
+    qsizetype pendingCount() const { return m_queue.size() + m_jobs.size(); }
+
+    bool start(QNearFieldManager::EncodingOptions options);
+    void stop();
+    bool isActive() const { return m_active; }
+
+Q_SIGNALS:
+    void messageEncoded(const QByteArray &uid, int elapsedMs);
+    void encodingFailed(const QByteArray &uid, QNearFieldTarget::Error error);
+    void finished();
+
+private:
+    struct Job
+    {
+        QByteArray uid;
+        QByteArray messageData;
+        QNearFieldTarget::RequestId writeId;
+        QNearFieldTarget::RequestId verifyId;
+        QByteArray readBack;
+        QElapsedTimer timer;
+    };
+
+    QNearFieldManagerPrivate *m_backend;
+    QList<QByteArray> m_queue;
+    QHash<QNearFieldTarget *, Job> m_jobs;
+    QNearFieldManager::EncodingOptions m_options;
+    bool m_active = false;
+    bool m_startedDetection = false;
+
+    void onTargetDetected(QNearFieldTarget *target);
+    void onRequestCompleted(QNearFieldTarget *target, const QNearFieldTarget::RequestId &id);
+    void onError(QNearFieldTarget *target, QNearFieldTarget::Error error,
+                 const QNearFieldTarget::RequestId &id);
+    void finishJob(QNearFieldTarget *target, QNearFieldTarget::Error error);
+};
+
+QT_END_NAMESPACE
+
+#endif // QNDEFENCODINGSTATION_P_H
@@ -38,11 +38,9 @@
 ****************************************************************************/
 
 #include "qndeffilter.h"
+#include "qndeffilter_p.h"
 #include "qndefmessage.h"
 
-#include <QtCore/QList>
-#include <QtCore/QMap>
-
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -254,18 +252,53 @@ QT_BEGIN_NAMESPACE
     \c false.
 */
 
-class QNdefFilterPrivate : public QSharedData
-{
-public:
-    QNdefFilterPrivate();
-
-    bool orderMatching;
-    QList<QNdefFilter::Record> filterRecords;
-};
-
 QNdefFilterPrivate::QNdefFilterPrivate()
 :   orderMatching(false)
 {
+    wildcardIndex.fill(-1);
+}
+
+void QNdefFilterPrivate::compile()
+{
+    joinedRecords.clear();
+    recordIndex.clear();
+    wildcardIndex.fill(-1);
+
+    if (orderMatching) {
+        for (const auto &rec : std::as_const(filterRecords)) {
+            if (!joinedRecords.isEmpty() && joinedRecords.last().typeNameFormat == rec.typeNameFormat
+                && joinedRecords.last().type == rec.type) {
+                joinedRecords.last().minimum += rec.minimum;
+                joinedRecords.last().maximum += rec.maximum;
+            } else {
+                joinedRecords.append(rec);
+            }
+        }
+        return;
+    }
+
+    for (const auto &rec : std::as_const(filterRecords)) {
+        const auto tnf = quint8(rec.typeNameFormat);
+        qsizetype idx = -1;
+        if (rec.type.isEmpty())
+            idx = wildcardIndexOf(rec.typeNameFormat);
+        else
+            idx = recordIndex.value(qMakePair(tnf, rec.type), -1);
+
+        if (idx >= 0) {
+            joinedRecords[idx].minimum += rec.minimum;
+            joinedRecords[idx].maximum += rec.maximum;
+            continue;
+        }
+
+        idx = joinedRecords.size();
+        joinedRecords.append(rec);
+        if (!rec.type.isEmpty())
+            recordIndex.insert(qMakePair(tnf, rec.type), idx);
+        else if (tnf < wildcardIndex.size())
+            wildcardIndex[tnf] = idx;
+        // Records with an invalid type name format can never be counted
+    }
 }
 
 /*!
@@ -312,120 +345,22 @@ QNdefFilter &QNdefFilter::operator=(const QNdefFilter &other)
 */
 bool QNdefFilter::match(const QNdefMessage &message) const
 {
-    // empty filter matches only empty message
-    if (d->filterRecords.isEmpty())
-        return message.isEmpty();
-
-    bool matched = true;
-    int totalCount = 0;
-
+    // The filter is compiled when it is modified, so matching only walks the
+    // message once and does not allocate for typical filters.
     if (!d->orderMatching) {
-        // Order is not important. The most reliable way is to merge all the
-        // similar records, and then simply check the amount of occurrences.
-        using MapKey = QPair<QNdefRecord::TypeNameFormat, QByteArray>;
-
-        // Creating a map from the list of filter records.
-        QMap<MapKey, Record> joinedFilterRecords;
-        for (const auto &rec : d->filterRecords) {
-            const auto key = qMakePair(rec.typeNameFormat, rec.type);
-            if (joinedFilterRecords.contains(key)) {
-                joinedFilterRecords[key].minimum += rec.minimum;
-                joinedFilterRecords[key].maximum += rec.maximum;
-            } else {
-                joinedFilterRecords.insert(key, rec);
-            }
-        }
-        // Checking the message, calculate occurrences.
-        QMap<MapKey, unsigned int> counts; // current number of occurrences
-        for (const auto &record : message) {
-            const auto key = qMakePair(record.typeNameFormat(), record.type());
-            // Do not forget that we handle an empty type as "any type".
-            const auto emptyTypeKey = qMakePair(record.typeNameFormat(), QByteArray());
-
-            if (joinedFilterRecords.contains(key))
-                counts[key] += 1;
-            else if (joinedFilterRecords.contains(emptyTypeKey))
-                counts[emptyTypeKey] += 1;
-        }
-        // Check that the occurrences match [min; max] range.
-        for (auto it = joinedFilterRecords.cbegin(); it != joinedFilterRecords.cend(); ++it) {
-            const auto count = counts.value(it.key(), 0);
-            totalCount += count;
-            if (count < it.value().minimum || count > it.value().maximum) {
-                matched = false;
-                break;
-            }
-        }
-    } else {
-        // Order *is* important. Need to iterate the list.
-
-        // Here we need to merge consecutive records with the same parameters.
-        QList<Record> mergedRecords;
-        // we know that filer is not empty here
-        Record currentRecord = d->filterRecords.first();
-        for (qsizetype i = 1; i < d->filterRecords.size(); ++i) {
-            const auto &rec = d->filterRecords.at(i);
-            if (rec.typeNameFormat == currentRecord.typeNameFormat
-                && rec.type == currentRecord.type) {
-                currentRecord.minimum += rec.minimum;
-                currentRecord.maximum += rec.maximum;
-            } else {
-                mergedRecords.push_back(currentRecord);
-                currentRecord = rec;
-            }
-        }
-        mergedRecords.push_back(currentRecord);
-
-        // The list contains the current number of occurrences of each record.
-        QList<unsigned int> counts(mergedRecords.size(), 0);
-
-        // Iterate through the messages and calculate the number of occurrences.
-        qsizetype filterIndex = 0;
-        for (qsizetype messageIndex = 0; matched && messageIndex < message.size(); ++messageIndex) {
-            const auto &messageRec = message.at(messageIndex);
-            // Try to find a filter record that matches the message record.
-            // We start from the last processed filter record, not from the very
-            // beginning (because the order matters).
-            qsizetype idx = filterIndex;
-            for (; idx < mergedRecords.size(); ++idx) {
-                const auto &filterRec = mergedRecords.at(idx);
-                if (filterRec.typeNameFormat == messageRec.typeNameFormat()
-                    && (filterRec.type == messageRec.type() || filterRec.type.isEmpty())) {
-                    counts[idx] += 1;
-                    break;
-                } else if (counts[idx] < filterRec.minimum || counts[idx] > filterRec.maximum) {
-                    // The current message record does not match the current
-                    // filter record, but we didn't get enough records to
-                    // fulfill the filter => that's an error.
-                    matched = false;
-                    break;
-                }
-            }
-            filterIndex = idx;
-        }
-
-        if (matched) {
-            // Check that the occurrences match [min; max] range.
-            for (qsizetype i = 0; i < mergedRecords.count(); ++i) {
-                const auto &rec = mergedRecords.at(i);
-                totalCount += counts[i];
-                if (counts[i] < rec.minimum || counts[i] > rec.maximum) {
-                    matched = false;
-                    break;
-                }
-            }
-        }
+        return d->matchUnordered(message.size(), [&message, this](qsizetype i) {
+            const QNdefRecord &record = message.at(i);
+            return d->indexOf(record.typeNameFormat(), record.type());
+        });
     }
 
-    // Check if the message has records that do not match any record from the
-    // filter. To do it we just need to compare the total count of records,
-    // detected by filter, with the full message size. If they do not match,
-    // we have some records, that are not covered by the filter.
-    if (matched && (totalCount != message.size())) {
-        matched = false;
-    }
-
-    return matched;
+    return d->matchOrdered(message.size(), [&message, this](qsizetype messageIndex,
+                                                             qsizetype filterIndex) {
+        const QNdefRecord &record = message.at(messageIndex);
+        const Record &filterRecord = d->joinedRecords.at(filterIndex);
+        return filterRecord.typeNameFormat == record.typeNameFormat()
+                && (filterRecord.type.isEmpty() || filterRecord.type == record.type());
+    });
 }
 
 /*!
@@ -435,6 +370,7 @@ void QNdefFilter::clear()
 {
     d->orderMatching = false;
     d->filterRecords.clear();
+    d->compile();
 }
 
 /*!
@@ -447,7 +383,11 @@ void QNdefFilter::clear()
 */
 void QNdefFilter::setOrderMatch(bool on)
 {
+    if (d->orderMatching == on)
+        return;
+
     d->orderMatching = on;
+    d->compile();
 }
 
 /*!
@@ -495,6 +435,7 @@ bool QNdefFilter::appendRecord(const Record &record)
 {
     if (verifyRecord(record)) {
         d->filterRecords.append(record);
+        d->compile();
         return true;
     }
     return false;
@@ -520,4 +461,91 @@ qsizetype QNdefFilter::recordCount() const
     return d->filterRecords.count();
 }
 
+QNdefFilterMatcher::QNdefFilterMatcher(const QList<QNdefFilter> &filters)
+{
+    m_filters.reserve(filters.size());
+    for (const auto &filter : filters)
+        addFilter(filter);
+}
+
+/*
+    Adds \a filter to the matcher and returns its index. The types used by
+    the filter are given ids shared with the other filters, so that matching
+    only has to look up each message record once.
+*/
+qsizetype QNdefFilterMatcher::addFilter(const QNdefFilter &filter)
+{
+    const auto *d = QNdefFilterPrivate::get(filter);
+
+    CompiledFilter compiled;
+    compiled.filter = filter;
+    compiled.recordTypes.reserve(d->joinedRecords.size());
+    for (qsizetype i = 0; i < d->joinedRecords.size(); ++i) {
+        const auto &rec = d->joinedRecords.at(i);
+        if (rec.type.isEmpty()) {
+            compiled.recordTypes.append(-1);
+            continue;
+        }
+
+        const auto key = qMakePair(quint8(rec.typeNameFormat), rec.type);
+        auto it = m_typeIds.constFind(key);
+        if (it == m_typeIds.cend())
+            it = m_typeIds.insert(key, int(m_typeIds.size()));
+        compiled.recordTypes.append(it.value());
+
+        while (compiled.typeRecords.size() <= it.value())
+            compiled.typeRecords.append(-1);
+        compiled.typeRecords[it.value()] = i;
+    }
+
+    m_filters.append(compiled);
+    return m_filters.size() - 1;
+}
+
+QList<qsizetype> QNdefFilterMatcher::match(const QNdefMessage &message) const
+{
+    // Resolve the type of every record once for all the filters
+    QVarLengthArray<int, 16> typeIds(message.size());
+    QVarLengthArray<QNdefRecord::TypeNameFormat, 16> typeNameFormats(message.size());
+    for (qsizetype i = 0; i < message.size(); ++i) {
+        const QNdefRecord &record = message.at(i);
+        typeNameFormats[i] = record.typeNameFormat();
+        const QByteArray type = record.type();
+        typeIds[i] = type.isEmpty()
+                ? -1
+                : m_typeIds.value(qMakePair(quint8(typeNameFormats[i]), type), -1);
+    }
+
+    QList<qsizetype> result;
+    for (qsizetype f = 0; f < m_filters.size(); ++f) {
+        const CompiledFilter &compiled = m_filters.at(f);
+        const auto *d = QNdefFilterPrivate::get(compiled.filter);
+
+        bool matched;
+        if (!d->orderMatching) {
+            matched = d->matchUnordered(message.size(), [&](qsizetype i) {
+                const int typeId = typeIds[i];
+                if (typeId >= 0 && typeId < compiled.typeRecords.size()
+                    && compiled.typeRecords.at(typeId) >= 0) {
+                    return compiled.typeRecords.at(typeId);
+                }
+                return d->wildcardIndexOf(typeNameFormats[i]);
+            });
+        } else {
+            matched = d->matchOrdered(message.size(), [&](qsizetype messageIndex,
+                                                          qsizetype filterIndex) {
+                const int recordType = compiled.recordTypes.at(filterIndex);
+                return d->joinedRecords.at(filterIndex).typeNameFormat
+                        == typeNameFormats[messageIndex]
+                        && (recordType < 0 || recordType == typeIds[messageIndex]);
+            });
+        }
+
+        if (matched)
+            result.append(f);
+    }
+
+    return result;
+}
+
 QT_END_NAMESPACE
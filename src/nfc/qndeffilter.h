@@ -83,6 +83,7 @@ public:
 
 private:
     QSharedDataPointer<QNdefFilterPrivate> d;
+    friend class QNdefFilterPrivate;
 };
 
 template <typename T>
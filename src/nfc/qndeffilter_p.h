@@ -0,0 +1,210 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QNDEFFILTER_P_H
+#define QNDEFFILTER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qndeffilter.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QSharedData>
+#include <QtCore/QVarLengthArray>
+
+#include <algorithm>
+#include <array>
+
+QT_BEGIN_NAMESPACE
+
+class QNdefFilterPrivate : public QSharedData
+{
+public:
+    QNdefFilterPrivate();
+
+    static const QNdefFilterPrivate *get(const QNdefFilter &filter) { return filter.d.constData(); }
+
+    // Rebuilds the compiled form of the filter. Must be called whenever
+    // orderMatching or filterRecords change.
+    void compile();
+
+    // Index of the joined record that counts a message record, or -1
+    qsizetype indexOf(QNdefRecord::TypeNameFormat typeNameFormat, const QByteArray &type) const;
+    qsizetype wildcardIndexOf(QNdefRecord::TypeNameFormat typeNameFormat) const;
+
+    template <typename RecordIndex>
+    bool matchUnordered(qsizetype messageSize, RecordIndex recordIndexAt) const;
+    template <typename RecordMatches>
+    bool matchOrdered(qsizetype messageSize, RecordMatches recordMatches) const;
+
+    bool orderMatching;
+    QList<QNdefFilter::Record> filterRecords;
+
+    // Without ordering all equal records are joined, with ordering only
+    // consecutive equal records are.
+    QList<QNdefFilter::Record> joinedRecords;
+    // Joined records with a non-empty type, only used without ordering
+    QHash<QPair<quint8, QByteArray>, qsizetype> recordIndex;
+    // Joined records with an empty type, by type name format
+    std::array<qsizetype, 8> wildcardIndex;
+};
+
+inline qsizetype QNdefFilterPrivate::wildcardIndexOf(QNdefRecord::TypeNameFormat typeNameFormat) const
+{
+    const auto tnf = quint8(typeNameFormat);
+    return tnf < wildcardIndex.size() ? wildcardIndex[tnf] : -1;
+}
+
+inline qsizetype QNdefFilterPrivate::indexOf(QNdefRecord::TypeNameFormat typeNameFormat,
+                                             const QByteArray &type) const
+{
+    if (!type.isEmpty() && !recordIndex.isEmpty()) {
+        const auto it = recordIndex.constFind(qMakePair(quint8(typeNameFormat), type));
+        if (it != recordIndex.cend())
+            return it.value();
+    }
+    // An empty type in the filter matches any type
+    return wildcardIndexOf(typeNameFormat);
+}
+
+template <typename RecordIndex>
+bool QNdefFilterPrivate::matchUnordered(qsizetype messageSize, RecordIndex recordIndexAt) const
+{
+    QVarLengthArray<unsigned int, 16> counts(joinedRecords.size());
+    std::fill(counts.begin(), counts.end(), 0u);
+
+    for (qsizetype i = 0; i < messageSize; ++i) {
+        const qsizetype idx = recordIndexAt(i);
+        // The message has a record that is not covered by the filter
+        if (idx < 0)
+            return false;
+        ++counts[idx];
+    }
+
+    for (qsizetype i = 0; i < joinedRecords.size(); ++i) {
+        const auto &rec = joinedRecords.at(i);
+        if (counts[i] < rec.minimum || counts[i] > rec.maximum)
+            return false;
+    }
+
+    return true;
+}
+
+template <typename RecordMatches>
+bool QNdefFilterPrivate::matchOrdered(qsizetype messageSize, RecordMatches recordMatches) const
+{
+    QVarLengthArray<unsigned int, 16> counts(joinedRecords.size());
+    std::fill(counts.begin(), counts.end(), 0u);
+
+    qsizetype filterIndex = 0;
+    for (qsizetype messageIndex = 0; messageIndex < messageSize; ++messageIndex) {
+        // Start from the last matched filter record, because the order matters
+        qsizetype idx = filterIndex;
+        for (; idx < joinedRecords.size(); ++idx) {
+            if (recordMatches(messageIndex, idx)) {
+                ++counts[idx];
+                break;
+            }
+
+            // The message record does not match the current filter record,
+            // and the current filter record is not fulfilled yet.
+            const auto &rec = joinedRecords.at(idx);
+            if (counts[idx] < rec.minimum || counts[idx] > rec.maximum)
+                return false;
+        }
+
+        // The message has a record that is not covered by the filter
+        if (idx == joinedRecords.size())
+            return false;
+
+        filterIndex = idx;
+    }
+
+    for (qsizetype i = 0; i < joinedRecords.size(); ++i) {
+        const auto &rec = joinedRecords.at(i);
+        if (counts[i] < rec.minimum || counts[i] > rec.maximum)
+            return false;
+    }
+
+    return true;
+}
+
+// Matches a message against many filters at once. Every distinct record type
+// is looked up once per message, no matter how many filters use it.
+class Q_NFC_EXPORT QNdefFilterMatcher
+{
+public:
+    QNdefFilterMatcher() = default;
+    explicit QNdefFilterMatcher(const QList<QNdefFilter> &filters);
+
+    qsizetype addFilter(const QNdefFilter &filter);
+    qsizetype filterCount() const { return m_filters.size(); }
+    QNdefFilter filterAt(qsizetype i) const { return m_filters.at(i).filter; }
+
+    // Indexes of all the filters that match the message, in ascending order
+    QList<qsizetype> match(const QNdefMessage &message) const;
+
+private:
+    struct CompiledFilter
+    {
+        QNdefFilter filter;
+        // Type id of each joined record, -1 for an empty type
+        QList<int> recordTypes;
+        // Joined record for each type id, -1 if the filter does not use it
+        QList<qsizetype> typeRecords;
+    };
+
+    QList<CompiledFilter> m_filters;
+    QHash<QPair<quint8, QByteArray>, int> m_typeIds;
+};
+
+QT_END_NAMESPACE
+
+#endif // QNDEFFILTER_P_H
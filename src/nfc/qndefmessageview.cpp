@@ -0,0 +1,344 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qndefmessageview_p.h"
+
+#include <QtCore/QtEndian>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+enum class RecordStatus {
+    Valid,
+    Incomplete,
+    Invalid
+};
+
+/*
+    Validates the record starting at \a offset in \a data against the message
+    \a state. \a state is only updated, and \a recordSize only set, when the
+    record is complete and valid. Incomplete records do not produce warnings
+    because more data may follow.
+*/
+RecordStatus checkRecord(QByteArrayView data, qsizetype offset, QNdefMessageParser::State &state,
+                         qsizetype &recordSize)
+{
+    const qsizetype available = data.size() - offset;
+    if (available <= 0)
+        return RecordStatus::Incomplete;
+
+    const quint8 flags = data.at(offset);
+
+    const bool messageBegin = flags & 0x80;
+    const bool messageEnd = flags & 0x40;
+
+    const bool cf = flags & 0x20;
+    const bool sr = flags & 0x10;
+    const bool il = flags & 0x08;
+    const quint8 typeNameFormat = flags & 0x07;
+
+    if (messageBegin && state.seenMessageBegin) {
+        qWarning("Got message begin but already parsed some records");
+        return RecordStatus::Invalid;
+    } else if (!messageBegin && !state.seenMessageBegin) {
+        qWarning("Haven't got message begin yet");
+        return RecordStatus::Invalid;
+    }
+    if (messageEnd && state.seenMessageEnd) {
+        qWarning("Got message end but already parsed final record");
+        return RecordStatus::Invalid;
+    }
+    // TNF must be 0x06 even for the last chunk, when cf == 0.
+    if ((typeNameFormat != 0x06) && state.inChunkedRecord) {
+        qWarning("Partial chunk not empty, but TNF not 0x06 as expected");
+        return RecordStatus::Invalid;
+    }
+    if ((typeNameFormat == 0x06) && !state.inChunkedRecord) {
+        qWarning("Invalid chunked data, TNF 0x06 without initial chunk");
+        return RecordStatus::Invalid;
+    }
+
+    qsizetype headerLength = 1;
+    headerLength += (sr) ? 1 : 4;
+    headerLength += (il) ? 1 : 0;
+
+    if (available <= headerLength)
+        return RecordStatus::Incomplete;
+
+    const quint8 typeLength = data.at(offset + 1);
+
+    if ((typeNameFormat == 0x06) && (typeLength != 0)) {
+        qWarning("Invalid chunked data, TYPE_LENGTH != 0");
+        return RecordStatus::Invalid;
+    }
+
+    const quint32 payloadLength = sr ? quint8(data.at(offset + 2))
+                                     : qFromBigEndian<quint32>(data.data() + offset + 2);
+    const quint8 idLength = il ? quint8(data.at(offset + headerLength)) : 0;
+
+    const quint64 contentLength = quint64(payloadLength) + typeLength + idLength;
+
+    // On a 32 bit platform the payload can theoretically exceed the max.
+    // size of a QByteArray. This will never happen in practice with correct
+    // data because there are no NFC tags that can store such data sizes,
+    // but still can be possible if the data is corrupted.
+    const qsizetype headerEnd = offset + 1 + headerLength;
+    if (contentLength > quint64(std::numeric_limits<qsizetype>::max() - headerEnd)) {
+        qWarning("Payload can't fit into QByteArray");
+        return RecordStatus::Invalid;
+    }
+
+    if (quint64(data.size() - headerEnd) < contentLength)
+        return RecordStatus::Incomplete;
+
+    if ((typeNameFormat == 0x06) && il) {
+        qWarning("Invalid chunked data, IL != 0");
+        return RecordStatus::Invalid;
+    }
+
+    state.seenMessageBegin = true;
+    state.seenMessageEnd = state.seenMessageEnd || messageEnd;
+    state.inChunkedRecord = cf;
+    recordSize = 1 + headerLength + qsizetype(contentLength);
+    return RecordStatus::Valid;
+}
+
+} // namespace
+
+/*
+    QNdefMessageView gives access to the records of an encoded NDEF message
+    without copying them. The message is validated once, in the constructor,
+    with the same rules as QNdefMessage::fromByteArray(). The records returned
+    by the iterators are the records on the wire, so a chunked record is
+    visited once for every chunk. Continuation chunks report the type name
+    format of the initial chunk.
+
+    The view does not own the data, which must outlive it.
+*/
+QNdefMessageView::QNdefMessageView(QByteArrayView data)
+{
+    QNdefMessageParser::State state;
+    qsizetype offset = 0;
+    qsizetype recordCount = 0;
+
+    for (;;) {
+        qsizetype recordSize = 0;
+        switch (checkRecord(data, offset, state, recordSize)) {
+        case RecordStatus::Invalid:
+            return;
+        case RecordStatus::Incomplete:
+            if (offset == data.size() && (!state.seenMessageBegin || !state.seenMessageEnd))
+                qWarning("Malformed NDEF Message, missing begin or end");
+            else
+                qWarning("Unexpected end of message");
+            return;
+        case RecordStatus::Valid:
+            offset += recordSize;
+            if (state.inChunkedRecord)
+                break;
+
+            ++recordCount;
+            if (state.seenMessageEnd) {
+                // Anything after the final record is not part of the message
+                m_data = data.first(offset);
+                m_recordCount = recordCount;
+                m_valid = true;
+                return;
+            }
+            break;
+        }
+    }
+}
+
+/*
+    Converts the view into a QNdefMessage. The payload of a chunked record is
+    assembled into a single allocation. Returns an empty message if the view
+    is not valid.
+*/
+QNdefMessage QNdefMessageView::toMessage() const
+{
+    QNdefMessage result;
+    if (!m_valid)
+        return result;
+
+    result.reserve(m_recordCount);
+
+    for (auto it = begin(); it != end(); ++it) {
+        QNdefRecord record;
+        record.setTypeNameFormat(it->typeNameFormat());
+        if (!it->type().isEmpty())
+            record.setType(it->type().toByteArray());
+        if (!it->id().isEmpty())
+            record.setId(it->id().toByteArray());
+
+        if (it->hasMoreChunks()) {
+            qsizetype payloadSize = 0;
+            for (auto chunk = it;; ++chunk) {
+                payloadSize += chunk->payload().size();
+                if (!chunk->hasMoreChunks())
+                    break;
+            }
+
+            QByteArray payload;
+            payload.reserve(payloadSize);
+            for (;; ++it) {
+                payload.append(it->payload());
+                if (!it->hasMoreChunks())
+                    break;
+            }
+            if (!payload.isEmpty())
+                record.setPayload(payload);
+        } else if (!it->payload().isEmpty()) {
+            record.setPayload(it->payload().toByteArray());
+        }
+
+        result.append(std::move(record));
+    }
+
+    return result;
+}
+
+QNdefMessageView::const_iterator::const_iterator(QByteArrayView data, qsizetype offset)
+    : m_data(data), m_offset(offset)
+{
+    decode();
+}
+
+QNdefMessageView::const_iterator &QNdefMessageView::const_iterator::operator++()
+{
+    m_offset += m_record.m_size;
+    decode();
+    return *this;
+}
+
+// The data has already been validated, so no bounds checks are needed here.
+void QNdefMessageView::const_iterator::decode()
+{
+    if (m_offset >= m_data.size())
+        return;
+
+    const char *record = m_data.data() + m_offset;
+    const quint8 flags = record[0];
+    const bool sr = flags & 0x10;
+    const bool il = flags & 0x08;
+
+    qsizetype pos = 1;
+    const quint8 typeLength = record[pos++];
+
+    quint32 payloadLength;
+    if (sr) {
+        payloadLength = quint8(record[pos++]);
+    } else {
+        payloadLength = qFromBigEndian<quint32>(record + pos);
+        pos += 4;
+    }
+
+    const quint8 idLength = il ? quint8(record[pos++]) : 0;
+
+    if ((flags & 0x07) != 0x06)
+        m_chunkTypeNameFormat = QNdefRecord::TypeNameFormat(flags & 0x07);
+
+    m_record.m_flags = flags;
+    m_record.m_typeNameFormat = m_chunkTypeNameFormat;
+    m_record.m_type = QByteArrayView(record + pos, typeLength);
+    pos += typeLength;
+    m_record.m_id = QByteArrayView(record + pos, idLength);
+    pos += idLength;
+    m_record.m_payload = QByteArrayView(record + pos, qsizetype(payloadLength));
+    pos += payloadLength;
+    m_record.m_size = pos;
+}
+
+/*
+    Appends \a data to the message being parsed and validates the records that
+    became complete. Once the final record has been validated the status is
+    Complete and further data is ignored, as is all data after an error.
+*/
+QNdefMessageParser::Status QNdefMessageParser::append(QByteArrayView data)
+{
+    if (m_status != Status::NeedMoreData)
+        return m_status;
+
+    m_buffer.append(data);
+
+    for (;;) {
+        qsizetype recordSize = 0;
+        switch (checkRecord(m_buffer, m_parsedSize, m_state, recordSize)) {
+        case RecordStatus::Incomplete:
+            return m_status;
+        case RecordStatus::Invalid:
+            m_status = Status::Invalid;
+            return m_status;
+        case RecordStatus::Valid:
+            m_parsedSize += recordSize;
+            if (m_state.inChunkedRecord)
+                break;
+
+            ++m_recordCount;
+            if (m_state.seenMessageEnd) {
+                m_status = Status::Complete;
+                return m_status;
+            }
+            break;
+        }
+    }
+}
+
+QNdefMessageView QNdefMessageParser::message() const
+{
+    if (m_status != Status::Complete)
+        return QNdefMessageView();
+
+    return QNdefMessageView(QByteArrayView(m_buffer).first(m_parsedSize), m_recordCount);
+}
+
+// Resets the parser. The buffer keeps its capacity for the next message.
+void QNdefMessageParser::clear()
+{
+    m_buffer.resize(0);
+    m_parsedSize = 0;
+    m_recordCount = 0;
+    m_state = State();
+    m_status = Status::NeedMoreData;
+}
+
+QT_END_NAMESPACE
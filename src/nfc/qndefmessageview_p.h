@@ -0,0 +1,207 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QNDEFMESSAGEVIEW_P_H
+#define QNDEFMESSAGEVIEW_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qtnfcglobal.h"
+#include "qndefmessage.h"
+#include "qndefrecord.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QByteArrayView>
+
+#include <iterator>
+
+QT_BEGIN_NAMESPACE
+
+class Q_NFC_EXPORT QNdefRecordView
+{
+public:
+    QNdefRecord::TypeNameFormat typeNameFormat() const { return m_typeNameFormat; }
+    QByteArrayView type() const { return m_type; }
+    QByteArrayView id() const { return m_id; }
+    QByteArrayView payload() const { return m_payload; }
+
+    bool isMessageBegin() const { return m_flags & 0x80; }
+    bool isMessageEnd() const { return m_flags & 0x40; }
+    bool hasMoreChunks() const { return m_flags & 0x20; }
+    bool isChunkContinuation() const { return (m_flags & 0x07) == 0x06; }
+
+    // Size of the encoded record, including the header
+    qsizetype size() const { return m_size; }
+
+private:
+    friend class QNdefMessageView;
+
+    quint8 m_flags = 0;
+    QNdefRecord::TypeNameFormat m_typeNameFormat = QNdefRecord::Empty;
+    QByteArrayView m_type;
+    QByteArrayView m_id;
+    QByteArrayView m_payload;
+    qsizetype m_size = 0;
+};
+
+class Q_NFC_EXPORT QNdefMessageView
+{
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = QNdefRecordView;
+        using difference_type = qsizetype;
+        using pointer = const QNdefRecordView *;
+        using reference = const QNdefRecordView &;
+
+        const_iterator() = default;
+
+        reference operator*() const { return m_record; }
+        pointer operator->() const { return &m_record; }
+
+        const_iterator &operator++();
+        const_iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend bool operator==(const const_iterator &lhs, const const_iterator &rhs)
+        {
+            return lhs.m_offset == rhs.m_offset && lhs.m_data.data() == rhs.m_data.data();
+        }
+        friend bool operator!=(const const_iterator &lhs, const const_iterator &rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class QNdefMessageView;
+        const_iterator(QByteArrayView data, qsizetype offset);
+
+        void decode();
+
+        QByteArrayView m_data;
+        qsizetype m_offset = 0;
+        QNdefRecord::TypeNameFormat m_chunkTypeNameFormat = QNdefRecord::Empty;
+        QNdefRecordView m_record;
+    };
+
+    QNdefMessageView() = default;
+    explicit QNdefMessageView(QByteArrayView data);
+
+    bool isValid() const { return m_valid; }
+
+    // The bytes that make up the message. Trailing data after the final
+    // record is not included.
+    QByteArrayView data() const { return m_data; }
+
+    // Number of logical records, chunked records count once
+    qsizetype recordCount() const { return m_recordCount; }
+
+    const_iterator begin() const { return const_iterator(m_data, 0); }
+    const_iterator end() const { return const_iterator(m_data, m_data.size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    QNdefMessage toMessage() const;
+
+private:
+    friend class QNdefMessageParser;
+
+    QNdefMessageView(QByteArrayView data, qsizetype recordCount)
+        : m_data(data), m_recordCount(recordCount), m_valid(true)
+    {
+    }
+
+    QByteArrayView m_data;
+    qsizetype m_recordCount = 0;
+    bool m_valid = false;
+};
+
+// Validates an NDEF message as it arrives in arbitrary pieces. Every record
+// is checked once, as soon as it is complete.
+class Q_NFC_EXPORT QNdefMessageParser
+{
+public:
+    enum class Status {
+        NeedMoreData,
+        Complete,
+        Invalid
+    };
+
+    struct State
+    {
+        bool seenMessageBegin = false;
+        bool seenMessageEnd = false;
+        bool inChunkedRecord = false;
+    };
+
+    void reserve(qsizetype size) { m_buffer.reserve(size); }
+    Status append(QByteArrayView data);
+    Status status() const { return m_status; }
+
+    // Only valid when status() is Complete and until the parser is modified
+    QNdefMessageView message() const;
+
+    void clear();
+
+private:
+    QByteArray m_buffer;
+    qsizetype m_parsedSize = 0;
+    qsizetype m_recordCount = 0;
+    State m_state;
+    Status m_status = Status::NeedMoreData;
+};
+
+QT_END_NAMESPACE
+
+#endif // QNDEFMESSAGEVIEW_P_H
@@ -0,0 +1,96 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qndefmessagewriter_p.h"
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+QNdefMessageWriter::QNdefMessageWriter(const QNdefMessage &message, qsizetype maxChunkSize)
+    : m_message(message), m_maxChunkSize(maxChunkSize)
+{
+    // An empty message is treated as a message containing a single empty record.
+    if (m_message.isEmpty())
+        m_message.append(QNdefRecord());
+
+    for (const QNdefRecord &record : std::as_const(m_message)) {
+        const qsizetype payloadLength = record.payload().size();
+        const qsizetype idLength = record.id().size();
+        const qsizetype step = chunkSize(payloadLength);
+
+        m_encodedSize += record.type().size() + idLength + payloadLength;
+
+        // Header of the first chunk, which also carries the type and id
+        qsizetype length = qMin(step, payloadLength);
+        m_encodedSize += 3 + (length < 255 ? 0 : 3) + (idLength > 0 ? 1 : 0);
+
+        // Headers of the following chunks
+        for (qsizetype offset = length; offset < payloadLength; offset += length) {
+            length = qMin(step, payloadLength - offset);
+            m_encodedSize += 3 + (length < 255 ? 0 : 3);
+        }
+    }
+}
+
+char *QNdefMessageWriter::writeInto(char *dst) const
+{
+    write([&dst](QByteArrayView data) {
+        memcpy(dst, data.data(), data.size());
+        dst += data.size();
+        return true;
+    });
+    return dst;
+}
+
+void QNdefMessageWriter::appendTo(QByteArray &data) const
+{
+    const qsizetype offset = data.size();
+    data.resize(offset + m_encodedSize);
+    writeInto(data.data() + offset);
+}
+
+QByteArray QNdefMessageWriter::toByteArray() const
+{
+    QByteArray data(m_encodedSize, Qt::Uninitialized);
+    writeInto(data.data());
+    return data;
+}
+
+QT_END_NAMESPACE
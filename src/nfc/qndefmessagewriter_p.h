@@ -0,0 +1,175 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QNDEFMESSAGEWRITER_P_H
+#define QNDEFMESSAGEWRITER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qtnfcglobal.h"
+#include "qndefmessage.h"
+#include "qndefrecord.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QByteArrayView>
+#include <QtCore/QtEndian>
+
+QT_BEGIN_NAMESPACE
+
+// Encodes an NDEF message. The encoded size is known before anything is
+// written, and payloads larger than the chunk size are split into chunked
+// records. A chunk size of 0 disables chunking.
+class Q_NFC_EXPORT QNdefMessageWriter
+{
+public:
+    explicit QNdefMessageWriter(const QNdefMessage &message, qsizetype maxChunkSize = 0);
+
+    qsizetype encodedSize() const { return m_encodedSize; }
+
+    // Passes the encoded message to sink piece by piece, in order. Payloads
+    // are not copied. Stops and returns false as soon as sink returns false.
+    template <typename Sink>
+    bool write(Sink &&sink) const;
+
+    // Writes exactly encodedSize() bytes and returns the end of the output
+    char *writeInto(char *dst) const;
+    void appendTo(QByteArray &data) const;
+    QByteArray toByteArray() const;
+
+private:
+    static constexpr qsizetype MaxHeaderSize = 7;
+
+    static qsizetype encodeHeader(char *header, quint8 flags, qsizetype typeLength,
+                                  qsizetype payloadLength, qsizetype idLength);
+    qsizetype chunkSize(qsizetype payloadLength) const;
+
+    QNdefMessage m_message;
+    qsizetype m_maxChunkSize;
+    qsizetype m_encodedSize = 0;
+};
+
+inline qsizetype QNdefMessageWriter::encodeHeader(char *header, quint8 flags,
+                                                  qsizetype typeLength, qsizetype payloadLength,
+                                                  qsizetype idLength)
+{
+    if (payloadLength < 255)
+        flags |= 0x10;
+    if (idLength > 0)
+        flags |= 0x08;
+
+    qsizetype size = 0;
+    header[size++] = char(flags);
+    header[size++] = char(typeLength);
+    if (flags & 0x10) {
+        header[size++] = char(payloadLength);
+    } else {
+        qToBigEndian<quint32>(quint32(payloadLength), header + size);
+        size += 4;
+    }
+    if (flags & 0x08)
+        header[size++] = char(idLength);
+
+    return size;
+}
+
+inline qsizetype QNdefMessageWriter::chunkSize(qsizetype payloadLength) const
+{
+    if (m_maxChunkSize <= 0 || payloadLength <= m_maxChunkSize)
+        return payloadLength;
+    return m_maxChunkSize;
+}
+
+template <typename Sink>
+bool QNdefMessageWriter::write(Sink &&sink) const
+{
+    char header[MaxHeaderSize];
+
+    for (qsizetype i = 0; i < m_message.size(); ++i) {
+        const QNdefRecord &record = m_message.at(i);
+        const QByteArray type = record.type();
+        const QByteArray id = record.id();
+        const QByteArray payload = record.payload();
+
+        quint8 messageFlags = 0;
+        if (i == 0)
+            messageFlags |= 0x80;
+
+        const qsizetype step = chunkSize(payload.size());
+        qsizetype offset = 0;
+        do {
+            const bool first = offset == 0;
+            const qsizetype length = qMin(step, payload.size() - offset);
+            const bool last = offset + length == payload.size();
+
+            quint8 flags = first ? (messageFlags | record.typeNameFormat()) : 0x06;
+            if (!last)
+                flags |= 0x20;
+            else if (i == m_message.size() - 1)
+                flags |= 0x40;
+
+            const qsizetype headerSize = encodeHeader(header, flags, first ? type.size() : 0,
+                                                      length, first ? id.size() : 0);
+            if (!sink(QByteArrayView(header, headerSize)))
+                return false;
+            if (first && !type.isEmpty() && !sink(QByteArrayView(type)))
+                return false;
+            if (first && !id.isEmpty() && !sink(QByteArrayView(id)))
+                return false;
+            if (length > 0 && !sink(QByteArrayView(payload).sliced(offset, length)))
+                return false;
+
+            offset += length;
+        } while (offset < payload.size());
+    }
+
+    return true;
+}
+
+QT_END_NAMESPACE
+
+#endif // QNDEFMESSAGEWRITER_P_H
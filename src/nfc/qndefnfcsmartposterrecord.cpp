@@ -39,8 +39,10 @@
 
 #include <qndefnfcsmartposterrecord.h>
 #include "qndefnfcsmartposterrecord_p.h"
+#include "qndefrecord_p.h"
 #include <qndefmessage.h>
 
+#include <QtCore/QMutex>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QUrl>
@@ -111,7 +113,8 @@ QNdefNfcSmartPosterRecord::QNdefNfcSmartPosterRecord(const QNdefRecord &other)
     : QNdefRecord(other, QNdefRecord::NfcRtd, "Sp"),
       d(new QNdefNfcSmartPosterRecordPrivate)
 {
-    // Need to set payload again to create internal structure
+    // Need to set payload again to create internal structure. The records
+    // are only decoded on first access.
     setPayload(other.payload());
 }
 
@@ -129,8 +132,10 @@ QNdefNfcSmartPosterRecord::QNdefNfcSmartPosterRecord(const QNdefNfcSmartPosterRe
 */
 QNdefNfcSmartPosterRecord &QNdefNfcSmartPosterRecord::operator=(const QNdefNfcSmartPosterRecord &other)
 {
-    if (this != &other)
+    if (this != &other) {
+        QNdefRecord::operator=(other);
         d = other.d;
+    }
 
     return *this;
 }
@@ -144,15 +149,8 @@ QNdefNfcSmartPosterRecord::~QNdefNfcSmartPosterRecord()
 
 void QNdefNfcSmartPosterRecord::cleanup()
 {
-    if (d) {
-        // Clean-up existing internal structure
-        d->m_titleList.clear();
-        if (d->m_uri) delete d->m_uri;
-        if (d->m_action) delete d->m_action;
-        d->m_iconList.clear();
-        if (d->m_size) delete d->m_size;
-        if (d->m_type) delete d->m_type;
-    }
+    if (d)
+        d->setPayload(QByteArray());
 }
 
 /*!
@@ -162,77 +160,139 @@ void QNdefNfcSmartPosterRecord::cleanup()
 void QNdefNfcSmartPosterRecord::setPayload(const QByteArray &payload)
 {
     QNdefRecord::setPayload(payload);
+    d->setPayload(payload);
+}
+
+void QNdefNfcSmartPosterRecord::convertToPayload()
+{
+    // The payload is encoded when it is read. A series of edits therefore
+    // encodes the poster once, and the encoder keeps a snapshot of the
+    // records that is independent of later edits.
+    QNdefRecordPrivate::setPayloadEncoder(*this, [data = d] { return data->encode(); });
+}
 
-    cleanup();
-
-    if (!payload.isEmpty()) {
-        // Create new structure
-        const QNdefMessage message = QNdefMessage::fromByteArray(payload);
-
-        // Iterate through all the records contained in the payload's message.
-        for (const QNdefRecord& record : message) {
-            // Title
-            if (record.isRecordType<QNdefNfcTextRecord>()) {
-                addTitleInternal(record);
-            }
-
-            // URI
-            else if (record.isRecordType<QNdefNfcUriRecord>()) {
-                d->m_uri = new QNdefNfcUriRecord(record);
-            }
-
-            // Action
-            else if (record.isRecordType<QNdefNfcActRecord>()) {
-                d->m_action = new QNdefNfcActRecord(record);
-            }
-
-            // Icon
-            else if (record.isRecordType<QNdefNfcIconRecord>()) {
-                addIconInternal(record);
-            }
-
-            // Size
-            else if (record.isRecordType<QNdefNfcSizeRecord>()) {
-                d->m_size = new QNdefNfcSizeRecord(record);
-            }
-
-            // Type
-            else if (record.isRecordType<QNdefNfcTypeRecord>()) {
-                d->m_type = new QNdefNfcTypeRecord(record);
-            }
+QNdefNfcSmartPosterRecordPrivate::QNdefNfcSmartPosterRecordPrivate(
+        const QNdefNfcSmartPosterRecordPrivate &other)
+    : QSharedData(other), m_content(other.content())
+{
+}
+
+void QNdefNfcSmartPosterRecordPrivate::setPayload(const QByteArray &payload)
+{
+    m_content = Content();
+    m_pendingPayload = payload;
+    m_decodePending.storeRelease(payload.isEmpty() ? 0 : 1);
+}
+
+// Guards decoding of payloads shared between smart posters
+static QBasicMutex decodeMutex;
+
+void QNdefNfcSmartPosterRecordPrivate::ensureDecoded() const
+{
+    if (!m_decodePending.loadAcquire())
+        return;
+
+    QMutexLocker locker(&decodeMutex);
+    if (!m_decodePending.loadRelaxed())
+        return;
+
+    const QNdefMessage message = QNdefMessage::fromByteArray(m_pendingPayload);
+
+    // Iterate through all the records contained in the payload's message.
+    for (const QNdefRecord& record : message) {
+        // Title
+        if (record.isRecordType<QNdefNfcTextRecord>()) {
+            m_content.addTitle(record);
+        }
+
+        // URI
+        else if (record.isRecordType<QNdefNfcUriRecord>()) {
+            m_content.m_uri = QNdefNfcUriRecord(record);
+        }
+
+        // Action
+        else if (record.isRecordType<QNdefNfcActRecord>()) {
+            m_content.m_action = QNdefNfcActRecord(record);
+        }
+
+        // Icon
+        else if (record.isRecordType<QNdefNfcIconRecord>()) {
+            m_content.addIcon(record);
+        }
+
+        // Size
+        else if (record.isRecordType<QNdefNfcSizeRecord>()) {
+            m_content.m_size = QNdefNfcSizeRecord(record);
+        }
+
+        // Type
+        else if (record.isRecordType<QNdefNfcTypeRecord>()) {
+            m_content.m_type = QNdefNfcTypeRecord(record);
         }
     }
+
+    m_pendingPayload.clear();
+    m_decodePending.storeRelease(0);
 }
 
-void QNdefNfcSmartPosterRecord::convertToPayload()
+QByteArray QNdefNfcSmartPosterRecordPrivate::encode() const
 {
+    const Content &c = content();
+
     QNdefMessage message;
+    message.reserve(c.m_titleList.size() + c.m_iconList.size() + 4);
 
     // Title
-    for (qsizetype t = 0; t < titleCount(); t++)
-        message.append(titleRecord(t));
+    for (const QNdefNfcTextRecord &title : c.m_titleList)
+        message.append(title);
 
     // URI
-    if (d->m_uri)
-        message.append(*(d->m_uri));
+    if (c.m_uri)
+        message.append(*c.m_uri);
 
     // Action
-    if (d->m_action)
-        message.append(*(d->m_action));
+    if (c.m_action)
+        message.append(*c.m_action);
 
-    // Icon
-    for (qsizetype i = 0; i < iconCount(); i++)
-        message.append(iconRecord(i));
+    // Icon, the data is shared with the icon records and copied once, into
+    // the encoded message
+    for (const QNdefNfcIconRecord &icon : c.m_iconList)
+        message.append(icon);
 
     // Size
-    if (d->m_size)
-        message.append(*(d->m_size));
+    if (c.m_size)
+        message.append(*c.m_size);
 
     // Type
-    if (d->m_type)
-        message.append(*(d->m_type));
+    if (c.m_type)
+        message.append(*c.m_type);
+
+    return message.toByteArray();
+}
+
+bool QNdefNfcSmartPosterRecordPrivate::Content::addTitle(const QNdefNfcTextRecord &text)
+{
+    for (qsizetype i = 0; i < m_titleList.length(); ++i) {
+        const QNdefNfcTextRecord &rec = m_titleList[i];
+
+        if (rec.locale() == text.locale())
+            return false;
+    }
+
+    m_titleList.append(text);
+    return true;
+}
+
+void QNdefNfcSmartPosterRecordPrivate::Content::addIcon(const QNdefNfcIconRecord &icon)
+{
+    for (qsizetype i = 0; i < m_iconList.length(); ++i) {
+        const QNdefNfcIconRecord &rec = m_iconList[i];
+
+        if (rec.type() == icon.type())
+            m_iconList.removeAt(i);
+    }
 
-    QNdefRecord::setPayload(message.toByteArray());
+    m_iconList.append(icon);
 }
 
 /*!
@@ -243,8 +303,8 @@ void QNdefNfcSmartPosterRecord::convertToPayload()
  */
 bool QNdefNfcSmartPosterRecord::hasTitle(const QString &locale) const
 {
-    for (qsizetype i = 0; i < d->m_titleList.length(); ++i) {
-        const QNdefNfcTextRecord &text = d->m_titleList[i];
+    for (qsizetype i = 0; i < d->content().m_titleList.length(); ++i) {
+        const QNdefNfcTextRecord &text = d->content().m_titleList[i];
 
         if (locale.isEmpty() || text.locale() == locale)
             return true;
@@ -259,7 +319,7 @@ bool QNdefNfcSmartPosterRecord::hasTitle(const QString &locale) const
  */
 bool QNdefNfcSmartPosterRecord::hasAction() const
 {
-    return d->m_action != nullptr;
+    return d->content().m_action.has_value();
 }
 
 /*!
@@ -270,8 +330,8 @@ bool QNdefNfcSmartPosterRecord::hasAction() const
  */
 bool QNdefNfcSmartPosterRecord::hasIcon(const QByteArray &mimetype) const
 {
-    for (qsizetype i = 0; i < d->m_iconList.length(); ++i) {
-        const QNdefNfcIconRecord &icon = d->m_iconList[i];
+    for (qsizetype i = 0; i < d->content().m_iconList.length(); ++i) {
+        const QNdefNfcIconRecord &icon = d->content().m_iconList[i];
 
         if (mimetype.isEmpty() || icon.type() == mimetype)
             return true;
@@ -286,7 +346,7 @@ bool QNdefNfcSmartPosterRecord::hasIcon(const QByteArray &mimetype) const
  */
 bool QNdefNfcSmartPosterRecord::hasSize() const
 {
-    return d->m_size != nullptr;
+    return d->content().m_size.has_value();
 }
 
 /*!
@@ -295,7 +355,7 @@ bool QNdefNfcSmartPosterRecord::hasSize() const
  */
 bool QNdefNfcSmartPosterRecord::hasTypeInfo() const
 {
-    return d->m_type != nullptr;
+    return d->content().m_type.has_value();
 }
 
 /*!
@@ -303,7 +363,7 @@ bool QNdefNfcSmartPosterRecord::hasTypeInfo() const
  */
 qsizetype QNdefNfcSmartPosterRecord::titleCount() const
 {
-    return d->m_titleList.length();
+    return d->content().m_titleList.length();
 }
 
 /*!
@@ -313,8 +373,8 @@ qsizetype QNdefNfcSmartPosterRecord::titleCount() const
  */
 QNdefNfcTextRecord QNdefNfcSmartPosterRecord::titleRecord(qsizetype index) const
 {
-    if (index >= 0 && index < d->m_titleList.length())
-        return d->m_titleList[index];
+    if (index >= 0 && index < d->content().m_titleList.length())
+        return d->content().m_titleList[index];
 
     return QNdefNfcTextRecord();
 }
@@ -326,8 +386,8 @@ QNdefNfcTextRecord QNdefNfcSmartPosterRecord::titleRecord(qsizetype index) const
  */
 QString QNdefNfcSmartPosterRecord::title(const QString &locale) const
 {
-    for (qsizetype i = 0; i < d->m_titleList.length(); ++i) {
-        const QNdefNfcTextRecord &text = d->m_titleList[i];
+    for (qsizetype i = 0; i < d->content().m_titleList.length(); ++i) {
+        const QNdefNfcTextRecord &text = d->content().m_titleList[i];
 
         if (locale.isEmpty() || text.locale() == locale)
             return text.text();
@@ -341,7 +401,7 @@ QString QNdefNfcSmartPosterRecord::title(const QString &locale) const
  */
 QList<QNdefNfcTextRecord> QNdefNfcSmartPosterRecord::titleRecords() const
 {
-    return d->m_titleList;
+    return d->content().m_titleList;
 }
 
 /*!
@@ -362,15 +422,7 @@ bool QNdefNfcSmartPosterRecord::addTitle(const QNdefNfcTextRecord &text)
 
 bool QNdefNfcSmartPosterRecord::addTitleInternal(const QNdefNfcTextRecord &text)
 {
-    for (qsizetype i = 0; i < d->m_titleList.length(); ++i) {
-        const QNdefNfcTextRecord &rec = d->m_titleList[i];
-
-        if (rec.locale() == text.locale())
-            return false;
-    }
-
-    d->m_titleList.append(text);
-    return true;
+    return d->content().addTitle(text);
 }
 
 /*!
@@ -397,11 +449,11 @@ bool QNdefNfcSmartPosterRecord::removeTitle(const QNdefNfcTextRecord &text)
 {
     bool status = false;
 
-    for (qsizetype i = 0; i < d->m_titleList.length(); ++i) {
-        const QNdefNfcTextRecord &rec = d->m_titleList[i];
+    for (qsizetype i = 0; i < d->content().m_titleList.length(); ++i) {
+        const QNdefNfcTextRecord &rec = d->content().m_titleList[i];
 
         if (rec.text() == text.text() && rec.locale() == text.locale() && rec.encoding() == text.encoding()) {
-            d->m_titleList.removeAt(i);
+            d->content().m_titleList.removeAt(i);
             status = true;
             break;
         }
@@ -423,11 +475,11 @@ bool QNdefNfcSmartPosterRecord::removeTitle(const QString &locale)
 {
     bool status = false;
 
-    for (qsizetype i = 0; i < d->m_titleList.length(); ++i) {
-        const QNdefNfcTextRecord &rec = d->m_titleList[i];
+    for (qsizetype i = 0; i < d->content().m_titleList.length(); ++i) {
+        const QNdefNfcTextRecord &rec = d->content().m_titleList[i];
 
         if (rec.locale() == locale) {
-            d->m_titleList.removeAt(i);
+            d->content().m_titleList.removeAt(i);
             status = true;
             break;
         }
@@ -445,10 +497,10 @@ bool QNdefNfcSmartPosterRecord::removeTitle(const QString &locale)
  */
 void QNdefNfcSmartPosterRecord::setTitles(const QList<QNdefNfcTextRecord> &titles)
 {
-    d->m_titleList.clear();
+    d->content().m_titleList.clear();
 
     for (qsizetype i = 0; i < titles.length(); ++i) {
-        d->m_titleList.append(titles[i]);
+        d->content().m_titleList.append(titles[i]);
     }
 
     // Convert to payload
@@ -460,8 +512,8 @@ void QNdefNfcSmartPosterRecord::setTitles(const QList<QNdefNfcTextRecord> &title
  */
 QUrl QNdefNfcSmartPosterRecord::uri() const
 {
-    if (d->m_uri)
-        return d->m_uri->uri();
+    if (d->content().m_uri)
+        return d->content().m_uri->uri();
 
     return QUrl();
 }
@@ -471,8 +523,8 @@ QUrl QNdefNfcSmartPosterRecord::uri() const
  */
 QNdefNfcUriRecord QNdefNfcSmartPosterRecord::uriRecord() const
 {
-    if (d->m_uri)
-        return *(d->m_uri);
+    if (d->content().m_uri)
+        return *(d->content().m_uri);
 
     return QNdefNfcUriRecord();
 }
@@ -482,10 +534,8 @@ QNdefNfcUriRecord QNdefNfcSmartPosterRecord::uriRecord() const
  */
 void QNdefNfcSmartPosterRecord::setUri(const QNdefNfcUriRecord &url)
 {
-    if (d->m_uri)
-        delete d->m_uri;
 
-    d->m_uri = new QNdefNfcUriRecord(url);
+    d->content().m_uri = url;
 
     // Convert to payload
     convertToPayload();
@@ -507,8 +557,8 @@ void QNdefNfcSmartPosterRecord::setUri(const QUrl &url)
  */
 QNdefNfcSmartPosterRecord::Action QNdefNfcSmartPosterRecord::action() const
 {
-    if (d->m_action)
-        return d->m_action->action();
+    if (d->content().m_action)
+        return d->content().m_action->action();
 
     return UnspecifiedAction;
 }
@@ -518,10 +568,10 @@ QNdefNfcSmartPosterRecord::Action QNdefNfcSmartPosterRecord::action() const
  */
 void QNdefNfcSmartPosterRecord::setAction(Action act)
 {
-    if (!d->m_action)
-        d->m_action = new QNdefNfcActRecord();
+    if (!d->content().m_action)
+        d->content().m_action.emplace();
 
-    d->m_action->setAction(act);
+    d->content().m_action->setAction(act);
 
     // Convert to payload
     convertToPayload();
@@ -532,7 +582,7 @@ void QNdefNfcSmartPosterRecord::setAction(Action act)
  */
 qsizetype QNdefNfcSmartPosterRecord::iconCount() const
 {
-    return d->m_iconList.length();
+    return d->content().m_iconList.length();
 }
 
 /*!
@@ -542,8 +592,8 @@ qsizetype QNdefNfcSmartPosterRecord::iconCount() const
  */
 QNdefNfcIconRecord QNdefNfcSmartPosterRecord::iconRecord(qsizetype index) const
 {
-    if (index >= 0 && index < d->m_iconList.length())
-        return d->m_iconList[index];
+    if (index >= 0 && index < d->content().m_iconList.length())
+        return d->content().m_iconList[index];
 
     return QNdefNfcIconRecord();
 }
@@ -554,8 +604,8 @@ QNdefNfcIconRecord QNdefNfcSmartPosterRecord::iconRecord(qsizetype index) const
  */
 QByteArray QNdefNfcSmartPosterRecord::icon(const QByteArray& mimetype) const
 {
-    for (qsizetype i = 0; i < d->m_iconList.length(); ++i) {
-        const QNdefNfcIconRecord &icon = d->m_iconList[i];
+    for (qsizetype i = 0; i < d->content().m_iconList.length(); ++i) {
+        const QNdefNfcIconRecord &icon = d->content().m_iconList[i];
 
         if (mimetype.isEmpty() || icon.type() == mimetype)
             return icon.data();
@@ -569,7 +619,7 @@ QByteArray QNdefNfcSmartPosterRecord::icon(const QByteArray& mimetype) const
  */
 QList<QNdefNfcIconRecord> QNdefNfcSmartPosterRecord::iconRecords() const
 {
-    return d->m_iconList;
+    return d->content().m_iconList;
 }
 
 /*!
@@ -586,14 +636,7 @@ void QNdefNfcSmartPosterRecord::addIcon(const QNdefNfcIconRecord &icon)
 
 void QNdefNfcSmartPosterRecord::addIconInternal(const QNdefNfcIconRecord &icon)
 {
-    for (qsizetype i = 0; i < d->m_iconList.length(); ++i) {
-        const QNdefNfcIconRecord &rec = d->m_iconList[i];
-
-        if (rec.type() == icon.type())
-            d->m_iconList.removeAt(i);
-    }
-
-    d->m_iconList.append(icon);
+    d->content().addIcon(icon);
 }
 
 /*!
@@ -618,11 +661,11 @@ bool QNdefNfcSmartPosterRecord::removeIcon(const QNdefNfcIconRecord &icon)
 {
     bool status = false;
 
-    for (qsizetype i = 0; i < d->m_iconList.length(); ++i) {
-        const QNdefNfcIconRecord &rec = d->m_iconList[i];
+    for (qsizetype i = 0; i < d->content().m_iconList.length(); ++i) {
+        const QNdefNfcIconRecord &rec = d->content().m_iconList[i];
 
         if (rec.type() == icon.type() && rec.data() == icon.data()) {
-            d->m_iconList.removeAt(i);
+            d->content().m_iconList.removeAt(i);
             status = true;
             break;
         }
@@ -644,11 +687,11 @@ bool QNdefNfcSmartPosterRecord::removeIcon(const QByteArray &type)
 {
     bool status = false;
 
-    for (qsizetype i = 0; i < d->m_iconList.length(); ++i) {
-        const QNdefNfcIconRecord &rec = d->m_iconList[i];
+    for (qsizetype i = 0; i < d->content().m_iconList.length(); ++i) {
+        const QNdefNfcIconRecord &rec = d->content().m_iconList[i];
 
         if (rec.type() == type) {
-            d->m_iconList.removeAt(i);
+            d->content().m_iconList.removeAt(i);
             status = true;
             break;
         }
@@ -669,10 +712,10 @@ bool QNdefNfcSmartPosterRecord::removeIcon(const QByteArray &type)
  */
 void QNdefNfcSmartPosterRecord::setIcons(const QList<QNdefNfcIconRecord> &icons)
 {
-    d->m_iconList.clear();
+    d->content().m_iconList.clear();
 
     for (qsizetype i = 0; i < icons.length(); ++i) {
-        d->m_iconList.append(icons[i]);
+        d->content().m_iconList.append(icons[i]);
     }
 
     // Convert to payload
@@ -690,8 +733,8 @@ void QNdefNfcSmartPosterRecord::setIcons(const QList<QNdefNfcIconRecord> &icons)
  */
 quint32 QNdefNfcSmartPosterRecord::size() const
 {
-    if (d->m_size)
-        return d->m_size->size();
+    if (d->content().m_size)
+        return d->content().m_size->size();
 
     return 0;
 }
@@ -704,10 +747,10 @@ quint32 QNdefNfcSmartPosterRecord::size() const
  */
 void QNdefNfcSmartPosterRecord::setSize(quint32 size)
 {
-    if (!d->m_size)
-        d->m_size = new QNdefNfcSizeRecord();
+    if (!d->content().m_size)
+        d->content().m_size.emplace();
 
-    d->m_size->setSize(size);
+    d->content().m_size->setSize(size);
 
     // Convert to payload
     convertToPayload();
@@ -723,8 +766,8 @@ void QNdefNfcSmartPosterRecord::setSize(quint32 size)
  */
 QString QNdefNfcSmartPosterRecord::typeInfo() const
 {
-    if (d->m_type)
-        return d->m_type->typeInfo();
+    if (d->content().m_type)
+        return d->content().m_type->typeInfo();
 
     return QString();
 }
@@ -737,11 +780,9 @@ QString QNdefNfcSmartPosterRecord::typeInfo() const
  */
 void QNdefNfcSmartPosterRecord::setTypeInfo(const QString &type)
 {
-    if (d->m_type)
-        delete d->m_type;
 
-    d->m_type = new QNdefNfcTypeRecord();
-    d->m_type->setTypeInfo(type);
+    d->content().m_type.emplace();
+    d->content().m_type->setTypeInfo(type);
 
     // Convert to payload
     convertToPayload();
@@ -51,6 +51,10 @@
 // We mean it.
 //
 
+#include <QtCore/QAtomicInt>
+
+#include <optional>
+
 QT_BEGIN_NAMESPACE
 
 class QNdefNfcActRecord : public QNdefRecord
@@ -83,15 +87,43 @@ public:
 class QNdefNfcSmartPosterRecordPrivate : public QSharedData
 {
 public:
+    struct Content
+    {
+        bool addTitle(const QNdefNfcTextRecord &text);
+        void addIcon(const QNdefNfcIconRecord &icon);
+
+        QList<QNdefNfcTextRecord> m_titleList;
+        std::optional<QNdefNfcUriRecord> m_uri;
+        std::optional<QNdefNfcActRecord> m_action;
+        QList<QNdefNfcIconRecord> m_iconList;
+        std::optional<QNdefNfcSizeRecord> m_size;
+        std::optional<QNdefNfcTypeRecord> m_type;
+    };
+
     QNdefNfcSmartPosterRecordPrivate() {}
+    QNdefNfcSmartPosterRecordPrivate(const QNdefNfcSmartPosterRecordPrivate &other);
 
-public:
-    QList<QNdefNfcTextRecord> m_titleList;
-    QNdefNfcUriRecord *m_uri = nullptr;
-    QNdefNfcActRecord *m_action = nullptr;
-    QList<QNdefNfcIconRecord> m_iconList;
-    QNdefNfcSizeRecord *m_size = nullptr;
-    QNdefNfcTypeRecord *m_type = nullptr;
+    // The payload is only decoded when one of the records is accessed
+    void setPayload(const QByteArray &payload);
+    QByteArray encode() const;
+
+    const Content &content() const
+    {
+        ensureDecoded();
+        return m_content;
+    }
+    Content &content()
+    {
+        ensureDecoded();
+        return m_content;
+    }
+
+private:
+    void ensureDecoded() const;
+
+    mutable Content m_content;
+    mutable QByteArray m_pendingPayload;
+    mutable QAtomicInt m_decodePending;
 };
 
 QT_END_NAMESPACE
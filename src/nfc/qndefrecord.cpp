@@ -42,6 +42,7 @@
 #include "qndefrecord_p.h"
 
 #include <QtCore/QHash>
+#include <QtCore/QMutex>
 
 QT_BEGIN_NAMESPACE
 
@@ -150,6 +151,56 @@ QT_BEGIN_NAMESPACE
     \sa Q_DECLARE_NDEF_RECORD()
 */
 
+static QBasicMutex payloadEncoderMutex;
+
+QNdefRecordPrivate::QNdefRecordPrivate(const QNdefRecordPrivate &other)
+    : QSharedData(other),
+      typeNameFormat(other.typeNameFormat),
+      type(other.type),
+      id(other.id),
+      payload(other.encodedPayload())
+{
+}
+
+void QNdefRecordPrivate::setPayloadEncoder(QNdefRecord &record,
+                                           std::function<QByteArray()> encoder)
+{
+    if (!record.d)
+        record.d = new QNdefRecordPrivate;
+
+    // Detaching encodes the pending payload of a shared record, so the new
+    // encoder is only visible to this record.
+    QNdefRecordPrivate *d = record.d.data();
+    d->payloadEncoder = std::move(encoder);
+    d->payload.clear();
+    d->payloadPending.storeRelease(1);
+}
+
+/*
+    Returns the payload, running the pending encoder first if there is one.
+    The private may be shared by records used from different threads, so the
+    encoder runs under a lock.
+*/
+const QByteArray &QNdefRecordPrivate::encodedPayload() const
+{
+    if (payloadPending.loadAcquire()) {
+        QMutexLocker locker(&payloadEncoderMutex);
+        if (payloadPending.loadRelaxed()) {
+            payload = payloadEncoder();
+            payloadEncoder = nullptr;
+            payloadPending.storeRelease(0);
+        }
+    }
+    return payload;
+}
+
+void QNdefRecordPrivate::setPayload(const QByteArray &data)
+{
+    payloadEncoder = nullptr;
+    payloadPending.storeRelease(0);
+    payload = data;
+}
+
 size_t qHash(const QNdefRecord &key)
 {
     return qHash(key.type() + key.id() + key.payload());
@@ -314,7 +365,7 @@ void QNdefRecord::setPayload(const QByteArray &payload)
     if (!d)
         d = new QNdefRecordPrivate;
 
-    d->payload = payload;
+    d->setPayload(payload);
 }
 
 /*!
@@ -325,7 +376,7 @@ QByteArray QNdefRecord::payload() const
     if (!d)
         return QByteArray();
 
-    return d->payload;
+    return d->encodedPayload();
 }
 
 /*!
@@ -339,7 +390,7 @@ bool QNdefRecord::isEmpty() const
     if (!d)
         return true;
 
-    return d->payload.isEmpty();
+    return d->encodedPayload().isEmpty();
 }
 
 /*!
@@ -363,7 +414,7 @@ bool QNdefRecord::operator==(const QNdefRecord &other) const
     if (d->id != other.d->id)
         return false;
 
-    if (d->payload != other.d->payload)
+    if (d->encodedPayload() != other.d->encodedPayload())
         return false;
 
     return true;
@@ -383,7 +434,7 @@ void QNdefRecord::clear()
         d->typeNameFormat = 0;
         d->type.clear();
         d->id.clear();
-        d->payload.clear();
+        d->setPayload(QByteArray());
     }
 }
 
@@ -99,6 +99,7 @@ protected:
 
 private:
     QSharedDataPointer<QNdefRecordPrivate> d;
+    friend class QNdefRecordPrivate;
 };
 
 #define Q_DECLARE_NDEF_RECORD(className, typeNameFormat, type, initialPayload) \
@@ -52,9 +52,13 @@
 //
 
 #include "qtnfcglobal.h"
+#include "qndefrecord.h"
 
 #include <QtCore/QSharedData>
 #include <QtCore/QByteArray>
+#include <QtCore/QAtomicInt>
+
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 
@@ -65,12 +69,25 @@ public:
     {
         typeNameFormat = 0; //TypeNameFormat::Empty
     }
+    QNdefRecordPrivate(const QNdefRecordPrivate &other);
+
+    // Defers encoding the payload of record until it is first read. Record
+    // types with structured payloads use this to encode once after a series
+    // of edits instead of after every edit.
+    static void setPayloadEncoder(QNdefRecord &record, std::function<QByteArray()> encoder);
+
+    const QByteArray &encodedPayload() const;
+    void setPayload(const QByteArray &data);
 
     unsigned int typeNameFormat : 3;
 
     QByteArray type;
     QByteArray id;
-    QByteArray payload;
+
+private:
+    mutable QByteArray payload;
+    mutable std::function<QByteArray()> payloadEncoder;
+    mutable QAtomicInt payloadPending;
 };
 
 QT_END_NAMESPACE
@@ -39,6 +39,7 @@
 
 #include "qnearfieldmanager.h"
 #include "qnearfieldmanager_p.h"
+#include "qndefencodingstation_p.h"
 
 #if defined(QT_SIMULATOR)
 #include "qnearfieldmanager_simulator_p.h"
@@ -81,6 +82,20 @@ QT_BEGIN_NAMESPACE
     must be started with the startTargetDetection() function. Target detection can be stopped with
     the stopTargetDetection() function. When the target is no longer required the target should be
     deleted as other applications may be blocked from accessing the target.
+
+    \section1 Encoding Station
+
+    Applications that write NDEF messages to a large number of tags can use
+    the encoding station instead of handling each target themselves. The
+    messages are queued with enqueueNdefMessages() and serialized at that
+    time. After startNdefEncoding() has been called, the next queued message
+    is written to each detected target that supports NDEF access. The
+    ndefMessageEncoded() signal reports the time needed for each tag, and the
+    ndefEncodingFinished() signal is emitted once the queue is empty.
+
+    The targetDetected() signal is still emitted for the targets used by the
+    encoding station. Applications must not access these targets until the
+    encoding has been reported.
 */
 
 /*!
@@ -149,6 +164,55 @@ QT_BEGIN_NAMESPACE
     \sa QNearFieldTarget::disconnected()
 */
 
+/*!
+    \enum QNearFieldManager::EncodingOption
+    \since 6.4
+
+    This enum describes options of the NDEF encoding station.
+
+    \value NoEncodingOption    The messages are only written.
+    \value VerifyAfterWrite    Each message is read back after it has been
+                               written and compared with the queued message.
+                               The time needed for verification is included
+                               in the time reported by ndefMessageEncoded().
+
+    \sa startNdefEncoding()
+*/
+
+/*!
+    \fn void QNearFieldManager::ndefMessageEncoded(const QByteArray &uid, int elapsedMs)
+    \since 6.4
+
+    This signal is emitted when the encoding station has written a queued
+    message to the tag with the given \a uid. \a elapsedMs is the time in
+    milliseconds between the detection of the tag and the successful
+    completion of the write, including the verification if it was requested.
+
+    \sa ndefEncodingFailed(), startNdefEncoding()
+*/
+
+/*!
+    \fn void QNearFieldManager::ndefEncodingFailed(const QByteArray &uid, QNearFieldTarget::Error error)
+    \since 6.4
+
+    This signal is emitted when the encoding station failed to write a queued
+    message to the tag with the given \a uid. The \a error describes the
+    reason. The message is returned to the front of the queue and is written
+    to the next detected tag.
+
+    \sa ndefMessageEncoded()
+*/
+
+/*!
+    \fn void QNearFieldManager::ndefEncodingFinished()
+    \since 6.4
+
+    This signal is emitted when the encoding station has written all queued
+    messages. The target detection is stopped before this signal is emitted.
+
+    \sa startNdefEncoding()
+*/
+
 /*!
     Constructs a new near field manager with \a parent.
 */
@@ -245,7 +309,10 @@ bool QNearFieldManager::startTargetDetection(QNearFieldTarget::AccessMethod acce
 {
     Q_D(QNearFieldManager);
 
-    return d->startTargetDetection(accessMethod);
+    const bool started = d->startTargetDetection(accessMethod);
+    if (started)
+        d->detectionStartedByApplication = true;
+    return started;
 }
 
 /*!
@@ -267,6 +334,7 @@ void QNearFieldManager::stopTargetDetection(const QString &errorMessage)
 {
     Q_D(QNearFieldManager);
 
+    d->detectionStartedByApplication = false;
     d->stopTargetDetection(errorMessage);
 }
 
@@ -292,4 +360,109 @@ void QNearFieldManager::setUserInformation(const QString &message)
     d->setUserInformation(message);
 }
 
+static QNdefEncodingStation *encodingStation(QNearFieldManager *q, QNearFieldManagerPrivate *d)
+{
+    if (!d->encodingStation) {
+        d->encodingStation = new QNdefEncodingStation(d);
+        QObject::connect(d->encodingStation, &QNdefEncodingStation::messageEncoded, q,
+                         &QNearFieldManager::ndefMessageEncoded);
+        QObject::connect(d->encodingStation, &QNdefEncodingStation::encodingFailed, q,
+                         &QNearFieldManager::ndefEncodingFailed);
+        QObject::connect(d->encodingStation, &QNdefEncodingStation::finished, q,
+                         &QNearFieldManager::ndefEncodingFinished);
+    }
+    return d->encodingStation;
+}
+
+/*!
+    \since 6.4
+
+    Appends \a messages to the queue of the encoding station. Each message is
+    written to a separate tag. The messages are serialized immediately, so
+    that no time is spent on it when a tag is detected.
+
+    Messages can be queued while the encoding station is active.
+
+    \sa startNdefEncoding(), pendingNdefMessageCount()
+*/
+void QNearFieldManager::enqueueNdefMessages(const QList<QNdefMessage> &messages)
+{
+    Q_D(QNearFieldManager);
+
+    encodingStation(this, d)->enqueue(messages);
+}
+
+/*!
+    \since 6.4
+
+    Returns the number of queued messages that have not been written yet,
+    including the messages that are currently being written.
+
+    \sa enqueueNdefMessages()
+*/
+qsizetype QNearFieldManager::pendingNdefMessageCount() const
+{
+    Q_D(const QNearFieldManager);
+
+    return d->encodingStation ? d->encodingStation->pendingCount() : 0;
+}
+
+/*!
+    \since 6.4
+
+    Starts the encoding station with the given \a options and returns \c true
+    on success. The target detection is started for targets with NDEF access,
+    and the next queued message is written to each detected target. If the
+    target detection was already started with startTargetDetection(), the
+    running detection is used instead.
+
+    Returns \c false if the encoding station is already active, if no
+    messages are queued, or if the target detection could not be started.
+
+    On platforms where the tag is probed before it is reported, the result of
+    the probing is remembered for tags with a permanent UID. Such tags are not
+    probed again when they are presented again, for example to retry a
+    failed write.
+
+    \sa stopNdefEncoding(), enqueueNdefMessages(), ndefMessageEncoded()
+*/
+bool QNearFieldManager::startNdefEncoding(EncodingOptions options)
+{
+    Q_D(QNearFieldManager);
+
+    return encodingStation(this, d)->start(options);
+}
+
+/*!
+    \since 6.4
+
+    Stops the encoding station. The target detection is stopped as well,
+    unless it has been started with startTargetDetection(). Writes that are
+    already in progress are completed and reported. The remaining messages
+    stay in the queue.
+
+    \sa startNdefEncoding()
+*/
+void QNearFieldManager::stopNdefEncoding()
+{
+    Q_D(QNearFieldManager);
+
+    if (d->encodingStation)
+        d->encodingStation->stop();
+}
+
+/*!
+    \since 6.4
+
+    Returns \c true if the encoding station is active.
+
+    \sa startNdefEncoding()
+*/
+bool QNearFieldManager::isNdefEncodingActive() const
+{
+    Q_D(const QNearFieldManager);
+
+    return d->encodingStation && d->encodingStation->isActive();
+}
+
 QT_END_NAMESPACE
@@ -64,6 +64,13 @@ public:
     };
     Q_ENUM(AdapterState)
 
+    enum class EncodingOption {
+        NoEncodingOption = 0x0,
+        VerifyAfterWrite = 0x1
+    };
+    Q_DECLARE_FLAGS(EncodingOptions, EncodingOption)
+    Q_FLAG(EncodingOptions)
+
     explicit QNearFieldManager(QObject *parent = nullptr);
     explicit QNearFieldManager(QNearFieldManagerPrivate *backend, QObject *parent = nullptr);
     ~QNearFieldManager();
@@ -77,16 +84,27 @@ public:
 
     void setUserInformation(const QString &message);
 
+    void enqueueNdefMessages(const QList<QNdefMessage> &messages);
+    qsizetype pendingNdefMessageCount() const;
+    bool startNdefEncoding(EncodingOptions options = EncodingOption::NoEncodingOption);
+    void stopNdefEncoding();
+    bool isNdefEncodingActive() const;
+
 Q_SIGNALS:
     void adapterStateChanged(QNearFieldManager::AdapterState state);
     void targetDetectionStopped();
     void targetDetected(QNearFieldTarget *target);
     void targetLost(QNearFieldTarget *target);
+    void ndefMessageEncoded(const QByteArray &uid, int elapsedMs);
+    void ndefEncodingFailed(const QByteArray &uid, QNearFieldTarget::Error error);
+    void ndefEncodingFinished();
 
 private:
     QNearFieldManagerPrivate *d_ptr;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QNearFieldManager::EncodingOptions)
+
 QT_END_NAMESPACE
 
 #endif // QNEARFIELDMANAGER_H
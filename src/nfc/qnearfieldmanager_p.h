@@ -62,6 +62,7 @@
 QT_BEGIN_NAMESPACE
 
 class QNdefFilter;
+class QNdefEncodingStation;
 
 class Q_AUTOTEST_EXPORT QNearFieldManagerPrivate : public QObject
 {
@@ -100,6 +101,13 @@ public:
     {
     }
 
+    // Set while the application has started the target detection through
+    // QNearFieldManager, so that the encoding station leaves it running
+    bool detectionStartedByApplication = false;
+
+    // Created by QNearFieldManager when the encoding station is first used
+    QNdefEncodingStation *encodingStation = nullptr;
+
 signals:
     void adapterStateChanged(QNearFieldManager::AdapterState state);
     void targetDetectionStopped();
@@ -53,7 +53,8 @@ Q_DECLARE_LOGGING_CATEGORY(QT_NFC_PCSC)
 
     This object creates a worker thread with an instance of QPcscManager in
     it. All the communication with QPcscManager is done using signal-slot
-    mechanism.
+    mechanism. The cards can live in further threads of QPcscManager, see
+    QPcscManager::QPcscManager().
 */
 QNearFieldManagerPrivateImpl::QNearFieldManagerPrivateImpl()
 {
@@ -144,6 +145,8 @@ void QNearFieldManagerPrivateImpl::onCardInserted(QPcscCard *card, const QByteAr
             &QPcscCard::onReadNdefMessagesRequest);
     connect(priv, &QNearFieldTargetPrivateImpl::writeNdefMessagesRequest, card,
             &QPcscCard::onWriteNdefMessagesRequest);
+    connect(priv, &QNearFieldTargetPrivateImpl::writeNdefMessageDataRequest, card,
+            &QPcscCard::onWriteNdefMessageDataRequest);
 
     connect(priv, &QNearFieldTargetPrivateImpl::targetLost, this,
             &QNearFieldManagerPrivateImpl::onTargetLost);
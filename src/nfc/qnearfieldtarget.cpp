@@ -395,6 +395,12 @@ QNearFieldTarget::RequestId QNearFieldTarget::sendCommand(const QByteArray &comm
     Waits up to \a msecs milliseconds for the request \a id to complete.
     Returns \c true if the request completes successfully and the
     requestCompeted() signal is emitted; otherwise returns \c false.
+
+    When called from the thread the target lives in, the function blocks in
+    a local event loop that only wakes up for incoming events, the
+    completion of the request or the timeout. From any other thread it
+    sleeps until the request has completed. Returns \c false immediately if
+    \a id is invalid.
 */
 bool QNearFieldTarget::waitForRequestCompleted(const RequestId &id, int msecs)
 {
@@ -406,6 +412,9 @@ bool QNearFieldTarget::waitForRequestCompleted(const RequestId &id, int msecs)
 /*!
     Returns the decoded response for request \a id. If the request is unknown or has not yet been
     completed an invalid QVariant is returned.
+
+    The response is stored with the request id and is released when the
+    last copy of \a id is destroyed.
 */
 QVariant QNearFieldTarget::requestResponse(const RequestId &id) const
 {
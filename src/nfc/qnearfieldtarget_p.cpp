@@ -38,13 +38,68 @@
 ****************************************************************************/
 
 #include "qnearfieldtarget_p.h"
+#include "qndefmessage.h"
 
-#include <QtCore/QCoreApplication>
-#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
 #include <QtCore/QPointer>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
 
 QT_BEGIN_NAMESPACE
 
+QNearFieldTarget::RequestIdPrivate::RequestIdPrivate(const RequestIdPrivate &other)
+    : QSharedData()
+{
+    QMutexLocker locker(&other.mutex);
+    m_response = other.m_response;
+    m_completed = other.m_completed;
+}
+
+bool QNearFieldTarget::RequestIdPrivate::isCompleted() const
+{
+    QMutexLocker locker(&mutex);
+    return m_completed;
+}
+
+QVariant QNearFieldTarget::RequestIdPrivate::response() const
+{
+    QMutexLocker locker(&mutex);
+    return m_response;
+}
+
+void QNearFieldTarget::RequestIdPrivate::complete(const QVariant &response)
+{
+    QMutexLocker locker(&mutex);
+    m_response = response;
+    m_completed = true;
+    completedCondition.wakeAll();
+
+    // Waiting event loops deregister under the lock, so they are alive here.
+    for (QEventLoop *loop : std::as_const(m_waitLoops))
+        QMetaObject::invokeMethod(loop, &QEventLoop::quit, Qt::AutoConnection);
+}
+
+bool QNearFieldTarget::RequestIdPrivate::wait(QDeadlineTimer deadline)
+{
+    QMutexLocker locker(&mutex);
+    while (!m_completed) {
+        if (!completedCondition.wait(&mutex, deadline))
+            break;
+    }
+    return m_completed;
+}
+
+void QNearFieldTarget::RequestIdPrivate::addWaitLoop(QEventLoop *loop)
+{
+    QMutexLocker locker(&mutex);
+    m_waitLoops.append(loop);
+}
+
+void QNearFieldTarget::RequestIdPrivate::removeWaitLoop(QEventLoop *loop)
+{
+    QMutexLocker locker(&mutex);
+    m_waitLoops.removeOne(loop);
+}
 
 QNearFieldTargetPrivate::QNearFieldTargetPrivate(QObject *parent)
 :   QObject(parent)
@@ -94,6 +149,20 @@ NearFieldTarget::RequestId QNearFieldTargetPrivate::writeNdefMessages(const QLis
     return id;
 }
 
+/*
+    Writes a single NDEF message that was serialized with
+    QNdefMessage::toByteArray() in advance.
+
+    The default implementation parses the message again and passes it to
+    writeNdefMessages(). Backends that serialize the messages themselves
+    should write the data directly.
+*/
+QNearFieldTarget::RequestId QNearFieldTargetPrivate::writeNdefMessageData(
+        const QByteArray &messageData)
+{
+    return writeNdefMessages({ QNdefMessage::fromByteArray(messageData) });
+}
+
 // TagTypeSpecificAccess
 int QNearFieldTargetPrivate::maxCommandLength() const
 {
@@ -109,46 +178,71 @@ NearFieldTarget::RequestId QNearFieldTargetPrivate::sendCommand(const QByteArray
     return id;
 }
 
+/*
+    Waits for the request \a id without polling. When called from the
+    thread of the target the responses are delivered through its event
+    loop, so a local event loop runs until the request completes, the
+    timeout expires or the target is destroyed. Any other thread sleeps
+    until the target thread completes the request.
+*/
 bool QNearFieldTargetPrivate::waitForRequestCompleted(const NearFieldTarget::RequestId &id, int msecs)
 {
-    QElapsedTimer timer;
-    timer.start();
+    // keep the completion state alive while waiting
+    const QNearFieldTarget::RequestId request = id;
+    auto *state = QNearFieldTarget::RequestIdPrivate::get(request);
+    if (!state)
+        return false;
+
+    if (state->isCompleted())
+        return true;
+
+    if (thread() != QThread::currentThread()) {
+        if (state->wait(QDeadlineTimer(qMax(msecs, 0))))
+            return true;
+
+        QMetaObject::invokeMethod(this, [this, request]() {
+            if (!QNearFieldTarget::RequestIdPrivate::get(request)->isCompleted())
+                reportError(QNearFieldTarget::TimeoutError, request);
+        }, Qt::QueuedConnection);
+        return false;
+    }
 
     const QPointer<QNearFieldTargetPrivate> weakThis = this;
 
-    do {
-        if (!weakThis)
-            return false;
+    QEventLoop loop;
+    QTimer timer;
+    timer.setSingleShot(true);
+    QObject::connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+    QObject::connect(this, &QObject::destroyed, &loop, &QEventLoop::quit);
 
-        if (m_decodedResponses.contains(id))
-            return true;
-        else
-            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 1);
-    } while (timer.elapsed() <= msecs);
+    state->addWaitLoop(&loop);
+    timer.start(qMax(msecs, 0));
+    loop.exec();
+    state->removeWaitLoop(&loop);
 
-    reportError(QNearFieldTarget::TimeoutError, id);
+    if (!weakThis)
+        return false;
+
+    if (state->isCompleted())
+        return true;
+
+    reportError(QNearFieldTarget::TimeoutError, request);
 
     return false;
 }
 
 QVariant QNearFieldTargetPrivate::requestResponse(const NearFieldTarget::RequestId &id) const
 {
-    return m_decodedResponses.value(id);
+    const auto *state = QNearFieldTarget::RequestIdPrivate::get(id);
+    return state ? state->response() : QVariant();
 }
 
 void QNearFieldTargetPrivate::setResponseForRequest(const NearFieldTarget::RequestId &id,
                                                     const QVariant &response,
                                                     bool emitRequestCompleted)
 {
-    for (auto i = m_decodedResponses.begin(), end = m_decodedResponses.end(); i != end; /* erasing */) {
-        // no more external references
-        if (i.key().refCount() == 1)
-            i = m_decodedResponses.erase(i);
-        else
-            ++i;
-    }
-
-    m_decodedResponses.insert(id, response);
+    if (auto *state = QNearFieldTarget::RequestIdPrivate::get(id))
+        state->complete(response);
 
     if (emitRequestCompleted)
         Q_EMIT requestCompleted(id);
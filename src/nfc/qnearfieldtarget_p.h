@@ -54,15 +54,45 @@
 #include "qnearfieldtarget.h"
 
 #include <QtCore/QByteArray>
+#include <QtCore/QDeadlineTimer>
 #include <QtCore/QList>
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include <QtCore/QSharedData>
 #include <QtCore/QVariant>
+#include <QtCore/QWaitCondition>
 
 QT_BEGIN_NAMESPACE
 
+class QEventLoop;
+
 class QNearFieldTarget::RequestIdPrivate : public QSharedData
 {
+public:
+    RequestIdPrivate() = default;
+    RequestIdPrivate(const RequestIdPrivate &other);
+
+    // The completion state lives with the request id and is released
+    // together with the last copy of it.
+    static RequestIdPrivate *get(const QNearFieldTarget::RequestId &id)
+    {
+        return const_cast<RequestIdPrivate *>(id.d.constData());
+    }
+
+    bool isCompleted() const;
+    QVariant response() const;
+    void complete(const QVariant &response);
+
+    bool wait(QDeadlineTimer deadline);
+    void addWaitLoop(QEventLoop *loop);
+    void removeWaitLoop(QEventLoop *loop);
+
+private:
+    mutable QMutex mutex;
+    QWaitCondition completedCondition;
+    QVariant m_response;
+    QList<QEventLoop *> m_waitLoops;
+    bool m_completed = false;
 };
 
 class Q_AUTOTEST_EXPORT QNearFieldTargetPrivate : public QObject
@@ -75,6 +105,8 @@ public:
     explicit QNearFieldTargetPrivate(QObject *parent = nullptr);
     virtual ~QNearFieldTargetPrivate() = default;
 
+    static QNearFieldTargetPrivate *get(QNearFieldTarget *target) { return target->d_func(); }
+
     virtual QByteArray uid() const;
     virtual QNearFieldTarget::Type type() const;
     virtual QNearFieldTarget::AccessMethods accessMethods() const;
@@ -85,6 +117,7 @@ public:
     virtual bool hasNdefMessage();
     virtual QNearFieldTarget::RequestId readNdefMessages();
     virtual QNearFieldTarget::RequestId writeNdefMessages(const QList<QNdefMessage> &messages);
+    virtual QNearFieldTarget::RequestId writeNdefMessageData(const QByteArray &messageData);
 
     // TagTypeSpecificAccess
     virtual int maxCommandLength() const;
@@ -103,8 +136,6 @@ Q_SIGNALS:
     void error(QNearFieldTarget::Error error, const QNearFieldTarget::RequestId &id);
 
 protected:
-    QMap<QNearFieldTarget::RequestId, QVariant> m_decodedResponses;
-
     virtual void setResponseForRequest(const QNearFieldTarget::RequestId &id,
                                        const QVariant &response,
                                        bool emitRequestCompleted = true);
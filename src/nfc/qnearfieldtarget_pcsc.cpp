@@ -170,6 +170,22 @@ QNearFieldTargetPrivateImpl::writeNdefMessages(const QList<QNdefMessage> &messag
     return reqId;
 }
 
+QNearFieldTarget::RequestId
+QNearFieldTargetPrivateImpl::writeNdefMessageData(const QByteArray &messageData)
+{
+    qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
+
+    if (!m_isValid)
+        return QNearFieldTarget::RequestId(nullptr);
+
+    m_connected = true;
+
+    QNearFieldTarget::RequestId reqId(new QNearFieldTarget::RequestIdPrivate);
+    Q_EMIT writeNdefMessageDataRequest(reqId, messageData);
+
+    return reqId;
+}
+
 void QNearFieldTargetPrivateImpl::onDisconnected()
 {
     qCDebug(QT_NFC_PCSC) << Q_FUNC_INFO;
@@ -74,6 +74,7 @@ public:
     QNearFieldTarget::RequestId sendCommand(const QByteArray &command) override;
     QNearFieldTarget::RequestId readNdefMessages() override;
     QNearFieldTarget::RequestId writeNdefMessages(const QList<QNdefMessage> &messages) override;
+    QNearFieldTarget::RequestId writeNdefMessageData(const QByteArray &messageData) override;
 
 private:
     const QByteArray m_uid;
@@ -95,6 +96,8 @@ Q_SIGNALS:
     void readNdefMessagesRequest(const QNearFieldTarget::RequestId &request);
     void writeNdefMessagesRequest(const QNearFieldTarget::RequestId &request,
                                   const QList<QNdefMessage> &messages);
+    void writeNdefMessageDataRequest(const QNearFieldTarget::RequestId &request,
+                                     const QByteArray &messageData);
     void targetLost(QNearFieldTargetPrivate *target);
 };
 
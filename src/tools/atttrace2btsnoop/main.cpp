@@ -0,0 +1,207 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/qendian.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "qlowenergyatttraceformat_p.h"
+
+QT_USE_NAMESPACE
+
+// Converts ATT traces written by QLowEnergyAttTracer (QT_BLUETOOTH_ATT_TRACE)
+// into btsnoop files. The record layout is documented in
+// src/bluetooth/qlowenergyatttraceformat_p.h.
+
+#define RETURN_SUCCESS      0
+#define RETURN_USAGE        1
+#define RETURN_INVALPARAM   2
+#define RETURN_IO_ERROR     3
+
+using Trace = QLowEnergyAttTraceFormat;
+
+// btsnoop, datalink type 1002 (HCI UART/H4)
+static const char btsnoopMagic[8] = { 'b', 't', 's', 'n', 'o', 'o', 'p', '\0' };
+static const quint32 btsnoopVersion = 1;
+static const quint32 btsnoopDatalinkH4 = 1002;
+// microseconds between 0000-01-01 and 1970-01-01
+static const qint64 btsnoopEpochDelta = Q_INT64_C(0x00dcddb30f2f8000);
+static const quint8 h4AclPacket = 0x02;
+static const quint16 attChannelId = 0x0004;
+
+void usage()
+{
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "\tatttrace2btsnoop [Options] <trace file> <btsnoop file>\n\n");
+    fprintf(stderr, "Converts an ATT trace written via QT_BLUETOOTH_ATT_TRACE into a\n"
+                    "btsnoop file. ATT PDUs are wrapped into synthetic HCI ACL and L2CAP\n"
+                    "headers, each traced bearer is assigned its own ACL handle.\n\n"
+                    "Options:\n"
+                    "   -v                  Print all trace records in human-readable form\n");
+}
+
+static const char *eventName(quint8 event)
+{
+    switch (event) {
+    case Trace::SendPdu: return "send";
+    case Trace::ReceivePdu: return "receive";
+    case Trace::EnqueueRequest: return "enqueue";
+    case Trace::DequeueRequest: return "dequeue";
+    case Trace::RequestTimeout: return "timeout";
+    case Trace::EncryptionChangeRequested: return "encryption-requested";
+    case Trace::EncryptionChanged: return "encryption-changed";
+    case Trace::MtuExchanged: return "mtu";
+    default: return "unknown";
+    }
+}
+
+static void writeBtsnoopRecord(QFile *file, quint16 aclHandle, bool received, qint64 time,
+                               const char *pdu, int pduSize)
+{
+    const int packetSize = 1 + 4 + 4 + pduSize;
+
+    char header[24];
+    qToBigEndian<quint32>(quint32(packetSize), header);      // original length
+    qToBigEndian<quint32>(quint32(packetSize), header + 4);  // included length
+    qToBigEndian<quint32>(received ? 0x01 : 0x00, header + 8);
+    qToBigEndian<quint32>(0, header + 12);                   // cumulative drops
+    qToBigEndian<qint64>(time / 1000 + btsnoopEpochDelta, header + 16);
+    file->write(header, sizeof(header));
+
+    char packetHeader[9];
+    packetHeader[0] = char(h4AclPacket);
+    // packet boundary flag 0x2: first automatically flushable packet
+    qToLittleEndian<quint16>(quint16((aclHandle & 0x0fff) | 0x2000), packetHeader + 1);
+    qToLittleEndian<quint16>(quint16(4 + pduSize), packetHeader + 3);
+    qToLittleEndian<quint16>(quint16(pduSize), packetHeader + 5);
+    qToLittleEndian<quint16>(attChannelId, packetHeader + 7);
+    file->write(packetHeader, sizeof(packetHeader));
+    file->write(pdu, pduSize);
+}
+
+int main(int argc, char **argv)
+{
+    bool verbose = false;
+    int argument = 1;
+    for (; argument < argc && argv[argument][0] == '-'; ++argument) {
+        if (strcmp(argv[argument], "-v") == 0) {
+            verbose = true;
+        } else {
+            usage();
+            return RETURN_USAGE;
+        }
+    }
+
+    if (argc - argument != 2) {
+        usage();
+        return RETURN_USAGE;
+    }
+
+    QFile input(QFile::decodeName(argv[argument]));
+    if (!input.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "Cannot open %s\n", argv[argument]);
+        return RETURN_IO_ERROR;
+    }
+    const QByteArray trace = input.readAll();
+
+    if (trace.size() < Trace::FileHeaderSize
+            || memcmp(trace.constData(), Trace::FileMagic, sizeof(Trace::FileMagic)) != 0
+            || qFromLittleEndian<quint32>(trace.constData() + 8) != Trace::FileVersion) {
+        fprintf(stderr, "%s is not an ATT trace file\n", argv[argument]);
+        return RETURN_INVALPARAM;
+    }
+
+    QFile output(QFile::decodeName(argv[argument + 1]));
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        fprintf(stderr, "Cannot open %s\n", argv[argument + 1]);
+        return RETURN_IO_ERROR;
+    }
+
+    char header[16];
+    memcpy(header, btsnoopMagic, 8);
+    qToBigEndian<quint32>(btsnoopVersion, header + 8);
+    qToBigEndian<quint32>(btsnoopDatalinkH4, header + 12);
+    output.write(header, sizeof(header));
+
+    QHash<quint32, quint16> aclHandles;
+    int pduCount = 0;
+    qsizetype position = Trace::FileHeaderSize;
+    while (position < trace.size()) {
+        const char *record = trace.constData() + position;
+        const qsizetype remaining = trace.size() - position;
+        const quint16 size = remaining >= 2 ? qFromLittleEndian<quint16>(record) : 0;
+        if (size < Trace::RecordHeaderSize || size > remaining) {
+            fprintf(stderr, "Truncated record at offset %lld\n", qlonglong(position));
+            break;
+        }
+
+        const quint8 event = quint8(record[2]);
+        const quint32 bearer = qFromLittleEndian<quint32>(record + 4);
+        const qint64 time = qFromLittleEndian<qint64>(record + 8);
+        const quint32 arg0 = qFromLittleEndian<quint32>(record + 16);
+        const quint32 arg1 = qFromLittleEndian<quint32>(record + 20);
+        const char *pdu = record + Trace::RecordHeaderSize;
+        const int pduSize = size - Trace::RecordHeaderSize;
+
+        auto handle = aclHandles.constFind(bearer);
+        if (handle == aclHandles.constEnd())
+            handle = aclHandles.insert(bearer, quint16(aclHandles.size() + 1));
+
+        if (verbose) {
+            printf("%lld.%09lld bearer %u %s 0x%x 0x%x", qlonglong(time / 1000000000),
+                   qlonglong(time % 1000000000), bearer, eventName(event), arg0, arg1);
+            for (int i = 0; i < pduSize; ++i)
+                printf("%s%02x", i ? "" : " ", quint8(pdu[i]));
+            printf("\n");
+        }
+
+        if ((event == Trace::SendPdu || event == Trace::ReceivePdu) && pduSize > 0) {
+            writeBtsnoopRecord(&output, handle.value(), event == Trace::ReceivePdu, time,
+                               pdu, pduSize);
+            ++pduCount;
+        }
+        position += size;
+    }
+
+    fprintf(stderr, "Wrote %d PDUs of %lld bearers\n", pduCount, qlonglong(aclHandles.size()));
+    return output.error() == QFileDevice::NoError ? RETURN_SUCCESS : RETURN_IO_ERROR;
+}
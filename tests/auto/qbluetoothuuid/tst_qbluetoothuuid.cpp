@@ -32,6 +32,7 @@
 #include <QDebug>
 
 #include <qbluetoothuuid.h>
+#include <private/qbluetoothuuid_p.h>
 
 #if defined(Q_OS_UNIX)
 #    include <arpa/inet.h>
@@ -60,6 +61,11 @@ private slots:
     void tst_comparison_data();
     void tst_comparison();
     void tst_quint128ToUuid();
+    void tst_stringParsing_data();
+    void tst_stringParsing();
+    void tst_wireFormat_data();
+    void tst_wireFormat();
+    void tst_assignedNames();
 };
 
 tst_QBluetoothUuid::tst_QBluetoothUuid()
@@ -383,6 +389,183 @@ void tst_QBluetoothUuid::tst_quint128ToUuid()
         QBluetoothUuid u(array);
     }
 }
+
+void tst_QBluetoothUuid::tst_stringParsing_data()
+{
+    QTest::addColumn<QString>("string");
+    QTest::addColumn<bool>("valid");
+
+    QTest::newRow("braces") << QString("{67C8770B-44F1-410A-AB9A-F9B5446F13EE}") << true;
+    QTest::newRow("no braces") << QString("67C8770B-44F1-410A-AB9A-F9B5446F13EE") << true;
+    QTest::newRow("lower case") << QString("{67c8770b-44f1-410a-ab9a-f9b5446f13ee}") << true;
+    QTest::newRow("mixed case") << QString("67c8770B-44F1-410a-Ab9A-f9b5446F13eE") << true;
+    QTest::newRow("base uuid") << QString("00000000-0000-1000-8000-00805F9B34FB") << true;
+    QTest::newRow("16 bit") << QString("0000180D-0000-1000-8000-00805F9B34FB") << true;
+    QTest::newRow("32 bit") << QString("{12345678-0000-1000-8000-00805F9B34FB}") << true;
+    QTest::newRow("null") << QString("{00000000-0000-0000-0000-000000000000}") << false;
+    QTest::newRow("empty") << QString() << false;
+    QTest::newRow("invalid digit") << QString("{67C8770G-44F1-410A-AB9A-F9B5446F13EE}") << false;
+    QTest::newRow("non-latin digit")
+            << QString::fromUtf8("67C8770B-44F1-410A-AB9A-F9B5446F13Ã" "E") << false;
+    QTest::newRow("misplaced dash") << QString("67C8770B4-4F1-410A-AB9A-F9B5446F13EE") << false;
+    QTest::newRow("missing brace") << QString("{67C8770B-44F1-410A-AB9A-F9B5446F13EE") << false;
+    QTest::newRow("too short") << QString("67C8770B-44F1-410A-AB9A-F9B5446F13E") << false;
+}
+
+void tst_QBluetoothUuid::tst_stringParsing()
+{
+    QFETCH(QString, string);
+    QFETCH(bool, valid);
+
+    // The result must be identical to what QUuid produces for the same string
+    const QBluetoothUuid uuid(string);
+    QCOMPARE(uuid, QBluetoothUuid(QUuid(string)));
+    QCOMPARE(!uuid.isNull(), valid);
+    if (valid)
+        QCOMPARE(QBluetoothUuid(uuid.toString()), uuid);
+}
+
+void tst_QBluetoothUuid::tst_wireFormat_data()
+{
+    QTest::addColumn<QBluetoothUuid>("uuid");
+    QTest::addColumn<int>("attSize");
+    QTest::addColumn<QByteArray>("wire");
+
+    QTest::newRow("16 bit") << QBluetoothUuid(quint16(0x180d)) << 2
+                            << QByteArray::fromHex("0d18");
+    QTest::newRow("16 bit as 32 bit") << QBluetoothUuid(quint32(0x2a37)) << 2
+                                      << QByteArray::fromHex("372a");
+    QTest::newRow("base uuid") << QBluetoothUuid(QString("00000000-0000-1000-8000-00805F9B34FB"))
+                               << 2 << QByteArray::fromHex("0000");
+    QTest::newRow("32 bit") << QBluetoothUuid(quint32(0x12345678)) << 16
+                            << QByteArray::fromHex("fb349b5f800000800010000078563412");
+    QTest::newRow("128 bit") << QBluetoothUuid(QString("{67C8770B-44F1-410A-AB9A-F9B5446F13EE}"))
+                             << 16 << QByteArray::fromHex("ee136f44b5f99aab0a41f1440b77c867");
+    QTest::newRow("almost base uuid")
+            << QBluetoothUuid(QString("0000180D-0000-1000-8000-00805F9B34FC")) << 16
+            << QByteArray::fromHex("fc349b5f80000080001000000d180000");
+}
+
+void tst_QBluetoothUuid::tst_wireFormat()
+{
+    using namespace QtBluetoothPrivate;
+
+    QFETCH(QBluetoothUuid, uuid);
+    QFETCH(int, attSize);
+    QFETCH(QByteArray, wire);
+
+    QCOMPARE(hasBluetoothBaseUuid(uuid), uuid.minimumSize() < 16);
+    QCOMPARE(attUuidSize(uuid), attSize);
+
+    char buffer[16];
+    QVERIFY(putUuidLittleEndian(uuid, attSize, buffer) == buffer + attSize);
+    QCOMPARE(QByteArray(buffer, attSize), wire);
+
+    // appending keeps what is already there
+    QByteArray appended("prefix");
+    appendUuidLittleEndian(appended, uuid, attSize);
+    QCOMPARE(appended, QByteArray("prefix") + wire);
+    QCOMPARE(uuidFromLittleEndian(wire.constData(), wire.size()), uuid);
+
+    // the 128 bit form is the reversed big-endian quint128
+    const quint128 bigEndian = uuid.toUInt128();
+    QByteArray reversed(reinterpret_cast<const char *>(bigEndian.data), sizeof bigEndian.data);
+    std::reverse(reversed.begin(), reversed.end());
+    QByteArray full;
+    appendUuidLittleEndian(full, uuid, 16);
+    QCOMPARE(full, reversed);
+    QCOMPARE(uuidFromLittleEndian(full.constData(), 16), uuid);
+
+    if (uuid.minimumSize() <= 4) {
+        bool ok = false;
+        const quint32 value = uuid.toUInt32(&ok);
+        QVERIFY(ok);
+        QByteArray expected(4, Qt::Uninitialized);
+        qToLittleEndian<quint32>(value, expected.data());
+        QByteArray fourBytes;
+        appendUuidLittleEndian(fourBytes, uuid, 4);
+        QCOMPARE(fourBytes, expected);
+        QCOMPARE(uuidFromLittleEndian(fourBytes.constData(), 4), uuid);
+    }
+}
+
+void tst_QBluetoothUuid::tst_assignedNames()
+{
+    using QtBluetoothPrivate::AssignedNumberCategory;
+    using QtBluetoothPrivate::uuidFromAssignedName;
+
+    QCOMPARE(QBluetoothUuid::characteristicToString(
+                     QBluetoothUuid::CharacteristicType::HeartRateMeasurement),
+             QString("Heart Rate Measurement"));
+    QCOMPARE(QBluetoothUuid::descriptorToString(
+                     QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration),
+             QString("Client Characteristic Configuration"));
+    QCOMPARE(QBluetoothUuid::protocolToString(QBluetoothUuid::ProtocolUuid::Sdp),
+             QString("Service Discovery Protocol"));
+    QVERIFY(QBluetoothUuid::descriptorToString(QBluetoothUuid::DescriptorType::UnknownDescriptorType)
+                    .isNull());
+    QVERIFY(QBluetoothUuid::characteristicToString(
+                    static_cast<QBluetoothUuid::CharacteristicType>(0x12a37)).isNull());
+
+    // Repeated lookups share the cached string
+    const QString first = QBluetoothUuid::serviceClassToString(
+            QBluetoothUuid::ServiceClassUuid::GenericAccess);
+    const QString second = QBluetoothUuid::serviceClassToString(
+            QBluetoothUuid::ServiceClassUuid::GenericAccess);
+    QCOMPARE(first, QString("Generic Access"));
+    QCOMPARE(first.constData(), second.constData());
+
+    // Translators installed after the first lookup are picked up
+    class Translator : public QTranslator
+    {
+    public:
+        QString translate(const char *context, const char *sourceText, const char *,
+                          int) const override
+        {
+            if (qstrcmp(context, "QBluetoothServiceDiscoveryAgent") == 0
+                    && qstrcmp(sourceText, "Generic Access") == 0) {
+                return QStringLiteral("Generischer Zugriff");
+            }
+            return QString();
+        }
+        bool isEmpty() const override { return false; }
+    } translator;
+    QVERIFY(QCoreApplication::installTranslator(&translator));
+    const QString translated = QBluetoothUuid::serviceClassToString(
+            QBluetoothUuid::ServiceClassUuid::GenericAccess);
+    QCOMPARE(translated, QString("Generischer Zugriff"));
+    // the translation is cached as well
+    QCOMPARE(QBluetoothUuid::serviceClassToString(
+                     QBluetoothUuid::ServiceClassUuid::GenericAccess).constData(),
+             translated.constData());
+    QVERIFY(QCoreApplication::removeTranslator(&translator));
+    const QString untranslated = QBluetoothUuid::serviceClassToString(
+            QBluetoothUuid::ServiceClassUuid::GenericAccess);
+    QCOMPARE(untranslated, QString("Generic Access"));
+    QCOMPARE(untranslated.constData(), first.constData());
+
+    QCOMPARE(uuidFromAssignedName(AssignedNumberCategory::Characteristic,
+                                  u"heart rate measurement"),
+             QBluetoothUuid(QBluetoothUuid::CharacteristicType::HeartRateMeasurement));
+    QCOMPARE(uuidFromAssignedName(AssignedNumberCategory::Protocol, u"Service Discovery Protocol"),
+             QBluetoothUuid(QBluetoothUuid::ProtocolUuid::Sdp));
+    // Used twice, the lower number wins
+    QCOMPARE(uuidFromAssignedName(AssignedNumberCategory::ServiceClass, u"Human Interface Device"),
+             QBluetoothUuid(QBluetoothUuid::ServiceClassUuid::HumanInterfaceDeviceService));
+    QVERIFY(uuidFromAssignedName(AssignedNumberCategory::Descriptor,
+                                 u"Heart Rate Measurement").isNull());
+    QVERIFY(uuidFromAssignedName(AssignedNumberCategory::Characteristic, u"").isNull());
+
+    for (quint16 value = 0x2a00; value < 0x2b00; ++value) {
+        const auto type = static_cast<QBluetoothUuid::CharacteristicType>(value);
+        const QString name = QBluetoothUuid::characteristicToString(type);
+        if (name.isEmpty())
+            continue;
+        QCOMPARE(uuidFromAssignedName(AssignedNumberCategory::Characteristic, name),
+                 QBluetoothUuid(type));
+    }
+}
+
 QTEST_MAIN(tst_QBluetoothUuid)
 
 #include "tst_qbluetoothuuid.moc"
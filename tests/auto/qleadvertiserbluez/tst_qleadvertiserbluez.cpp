@@ -0,0 +1,465 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtBluetooth/qlowenergyadvertisingdata.h>
+#include <QtBluetooth/qlowenergyadvertisingparameters.h>
+#include <QtBluetooth/private/bluez_data_p.h>
+#include <QtBluetooth/private/hcimanager_p.h>
+#include <QtBluetooth/private/qleadvertiser_p.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qsocketnotifier.h>
+
+#include <algorithm>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Answers the HCI commands of the advertiser like a Bluetooth 5 controller would.
+class SimulatedController : public QObject
+{
+public:
+    struct Command
+    {
+        QBluezConst::OpCodeCommandField ocf;
+        QByteArray parameters;
+    };
+
+    explicit SimulatedController(int socketDescriptor)
+        : socket(socketDescriptor), notifier(socketDescriptor, QSocketNotifier::Read)
+    {
+        connect(&notifier, &QSocketNotifier::activated, this, &SimulatedController::readCommand);
+    }
+    ~SimulatedController() { ::close(socket); }
+
+    QList<Command> commands(QBluezConst::OpCodeCommandField ocf, qsizetype from = 0) const
+    {
+        QList<Command> result;
+        for (qsizetype i = from; i < received.size(); ++i) {
+            if (received.at(i).ocf == ocf)
+                result << received.at(i);
+        }
+        return result;
+    }
+
+    // returns whether the set with the given handle, or the legacy advertiser, got enabled
+    bool isEnabled(int handle = -1, qsizetype from = 0) const
+    {
+        if (handle == -1) {
+            const QList<Command> enables = commands(QBluezConst::OcfLeSetAdvEnable, from);
+            return !enables.isEmpty() && enables.last().parameters.at(0) == 1;
+        }
+        const QList<Command> enables = commands(QBluezConst::OcfLeSetExtAdvEnable, from);
+        return std::any_of(enables.cbegin(), enables.cend(), [handle](const Command &c) {
+            return c.parameters.at(0) == 1 && quint8(c.parameters.at(2)) == handle;
+        });
+    }
+
+    qsizetype commandCount() const { return received.size(); }
+
+    bool extendedAdvertising = true;
+    // sets of another process that are currently enabled
+    QSet<quint8> foreignHandles;
+    // number of upcoming requests to disable a set that fail and leave it enabled
+    int refusedDisables = 0;
+
+private:
+    void readCommand()
+    {
+        char buffer[HCI_MAX_EVENT_SIZE];
+        const ssize_t size = ::read(socket, buffer, sizeof buffer);
+        QVERIFY(size >= 4);
+        QCOMPARE(buffer[0], char(HCI_COMMAND_PKT));
+        const quint16 opCode = qFromLittleEndian<quint16>(buffer + 1);
+        const Command command{ QBluezConst::OpCodeCommandField(ocfFromOpCode(opCode)),
+                               QByteArray(buffer + 4, size - 4) };
+        QCOMPARE(command.parameters.size(), quint8(buffer[3]));
+        received << command;
+
+        quint8 status = 0;
+        QByteArray returnParameters;
+        const bool isExtendedCommand = command.ocf >= QBluezConst::OcfLeSetAdvSetRandomAddress
+                && command.ocf <= QBluezConst::OcfLeSetPeriodicAdvEnable;
+        if (isExtendedCommand && !extendedAdvertising) {
+            status = 0x01; // Unknown HCI Command
+        } else if (command.ocf == QBluezConst::OcfLeSetExtAdvParams
+                   && (foreignHandles.contains(command.parameters.at(0))
+                       || enabledHandles.contains(command.parameters.at(0)))) {
+            status = 0x0c; // Command Disallowed
+        } else if (command.ocf == QBluezConst::OcfLeSetExtAdvEnable) {
+            const quint8 handle = command.parameters.at(2);
+            if (command.parameters.at(0) == 1) {
+                enabledHandles.insert(handle);
+            } else if (refusedDisables > 0) {
+                --refusedDisables;
+                status = 0x0c; // Command Disallowed
+            } else {
+                enabledHandles.remove(handle);
+            }
+        } else if (command.ocf == QBluezConst::OcfLeRemoveAdvSet) {
+            enabledHandles.remove(command.parameters.at(0));
+        } else if (command.ocf == QBluezConst::OcfLeReadNumberOfSupportedAdvSets) {
+            returnParameters = QByteArray(1, 16);
+        } else if (command.ocf == QBluezConst::OcfLeSetExtAdvParams
+                   || command.ocf == QBluezConst::OcfLeReadTxPowerLevel) {
+            returnParameters = QByteArray(1, 4); // TX power
+        }
+
+        // Command Complete event
+        QByteArray event;
+        event.append(char(HCI_EVENT_PKT));
+        event.append(char(0x0e));
+        event.append(char(4 + returnParameters.size()));
+        event.append(char(1));
+        event.append(char(opCode & 0xff));
+        event.append(char(opCode >> 8));
+        event.append(char(status));
+        event.append(returnParameters);
+        QCOMPARE(::write(socket, event.constData(), event.size()), ssize_t(event.size()));
+    }
+
+    int socket;
+    QSocketNotifier notifier;
+    QList<Command> received;
+    QSet<quint8> enabledHandles;
+};
+
+class tst_QLeAdvertiserBluez : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void legacyFallback();
+    void pduType_data();
+    void pduType();
+    void dataFragmentation_data();
+    void dataFragmentation();
+    void handleAllocation();
+    void handleCollision();
+    void ownSetStillEnabled_data();
+    void ownSetStillEnabled();
+
+private:
+    QLeAdvertiserBluez *createAdvertiser(QLowEnergyAdvertisingParameters::Mode mode,
+                                         const QByteArray &advertisingData,
+                                         const QByteArray &scanResponseData = QByteArray());
+
+    HciManager *hciManager = nullptr;
+    SimulatedController *controller = nullptr;
+    QList<QLeAdvertiserBluez *> advertisers;
+};
+
+Q_DECLARE_METATYPE(QLowEnergyAdvertisingParameters::Mode)
+
+// offsets into the LE Set Extended Advertising Parameters command
+static const int PropertiesOffset = 1;
+static const int SidOffset = 22;
+
+void tst_QLeAdvertiserBluez::init()
+{
+#ifdef QT_BUILD_INTERNAL
+    // The handle registry is per adapter and process wide, so every test gets its own adapter.
+    static int deviceId = 1000;
+    int sockets[2];
+    QCOMPARE(::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sockets), 0);
+    hciManager = new HciManager(sockets[0], ++deviceId);
+    controller = new SimulatedController(sockets[1]);
+#else
+    QSKIP("The simulated controller requires a developer build");
+#endif
+}
+
+void tst_QLeAdvertiserBluez::cleanup()
+{
+    qDeleteAll(advertisers);
+    advertisers.clear();
+    delete hciManager;
+    delete controller;
+}
+
+QLeAdvertiserBluez *tst_QLeAdvertiserBluez::createAdvertiser(
+        QLowEnergyAdvertisingParameters::Mode mode, const QByteArray &advertisingData,
+        const QByteArray &scanResponseData)
+{
+    QLowEnergyAdvertisingParameters parameters;
+    parameters.setMode(mode);
+    QLowEnergyAdvertisingData data;
+    data.setRawData(advertisingData);
+    QLowEnergyAdvertisingData responseData;
+    responseData.setRawData(scanResponseData);
+    auto *advertiser = new QLeAdvertiserBluez(parameters, data, responseData, *hciManager);
+    advertisers << advertiser;
+    return advertiser;
+}
+
+void tst_QLeAdvertiserBluez::legacyFallback()
+{
+    controller->extendedAdvertising = false;
+    QLeAdvertiserBluez *advertiser =
+            createAdvertiser(QLowEnergyAdvertisingParameters::AdvInd, QByteArray(5, 'a'));
+    QSignalSpy errorSpy(advertiser, &QLeAdvertiser::errorOccurred);
+    advertiser->startAdvertising();
+
+    QTRY_VERIFY(controller->isEnabled());
+    QVERIFY(errorSpy.isEmpty());
+    QCOMPARE(controller->commands(QBluezConst::OcfLeSetAdvParams).size(), 1);
+    const QList<SimulatedController::Command> data =
+            controller->commands(QBluezConst::OcfLeSetAdvData);
+    QCOMPARE(data.size(), 1);
+    QCOMPARE(data.first().parameters.size(), 32);
+    QCOMPARE(data.first().parameters.at(0), char(5));
+    QCOMPARE(controller->commands(QBluezConst::OcfLeSetExtAdvParams).size(), 0);
+}
+
+void tst_QLeAdvertiserBluez::pduType_data()
+{
+    QTest::addColumn<QLowEnergyAdvertisingParameters::Mode>("mode");
+    QTest::addColumn<int>("advertisingDataLength");
+    QTest::addColumn<int>("scanResponseDataLength");
+    QTest::addColumn<int>("properties");
+
+    // legacy PDUs whenever the payload fits, since every scanner understands them
+    QTest::newRow("connectable, 31 bytes")
+            << QLowEnergyAdvertisingParameters::AdvInd << 31 << 31 << 0x13;
+    QTest::newRow("connectable, 32 bytes")
+            << QLowEnergyAdvertisingParameters::AdvInd << 32 << 0 << 0x01;
+    QTest::newRow("connectable, 32 bytes scan response")
+            << QLowEnergyAdvertisingParameters::AdvInd << 10 << 32 << 0x01;
+    QTest::newRow("scannable, 31 bytes")
+            << QLowEnergyAdvertisingParameters::AdvScanInd << 0 << 31 << 0x12;
+    QTest::newRow("scannable, 100 bytes")
+            << QLowEnergyAdvertisingParameters::AdvScanInd << 0 << 100 << 0x02;
+    QTest::newRow("non-connectable, 31 bytes")
+            << QLowEnergyAdvertisingParameters::AdvNonConnInd << 31 << 0 << 0x10;
+    QTest::newRow("non-connectable, 200 bytes")
+            << QLowEnergyAdvertisingParameters::AdvNonConnInd << 200 << 0 << 0x00;
+}
+
+void tst_QLeAdvertiserBluez::pduType()
+{
+    QFETCH(QLowEnergyAdvertisingParameters::Mode, mode);
+    QFETCH(int, advertisingDataLength);
+    QFETCH(int, scanResponseDataLength);
+    QFETCH(int, properties);
+
+    QLeAdvertiserBluez *advertiser = createAdvertiser(mode, QByteArray(advertisingDataLength, 'a'),
+                                                      QByteArray(scanResponseDataLength, 's'));
+    QSignalSpy errorSpy(advertiser, &QLeAdvertiser::errorOccurred);
+    advertiser->startAdvertising();
+    QTRY_VERIFY(controller->isEnabled(0xef));
+    QVERIFY(errorSpy.isEmpty());
+
+    const QList<SimulatedController::Command> params =
+            controller->commands(QBluezConst::OcfLeSetExtAdvParams);
+    QCOMPARE(params.size(), 1);
+    QCOMPARE(qFromLittleEndian<quint16>(params.first().parameters.constData() + PropertiesOffset),
+             properties);
+}
+
+void tst_QLeAdvertiserBluez::dataFragmentation_data()
+{
+    QTest::addColumn<int>("dataLength");
+    QTest::addColumn<QList<int>>("fragmentLengths");
+    QTest::addColumn<QList<int>>("operations");
+
+    // operations: 0 intermediate, 1 first, 2 last, 3 complete
+    QTest::newRow("legacy") << 31 << QList<int>{ 31 } << QList<int>{ 3 };
+    QTest::newRow("single fragment") << 251 << QList<int>{ 251 } << QList<int>{ 3 };
+    QTest::newRow("two fragments") << 252 << QList<int>{ 251, 1 } << QList<int>{ 1, 2 };
+    QTest::newRow("maximum")
+            << 1650 << QList<int>{ 251, 251, 251, 251, 251, 251, 144 }
+            << QList<int>{ 1, 0, 0, 0, 0, 0, 2 };
+    QTest::newRow("truncated")
+            << 2000 << QList<int>{ 251, 251, 251, 251, 251, 251, 144 }
+            << QList<int>{ 1, 0, 0, 0, 0, 0, 2 };
+}
+
+void tst_QLeAdvertiserBluez::dataFragmentation()
+{
+    QFETCH(int, dataLength);
+    QFETCH(QList<int>, fragmentLengths);
+    QFETCH(QList<int>, operations);
+
+    QByteArray data(dataLength, Qt::Uninitialized);
+    for (int i = 0; i < dataLength; ++i)
+        data[i] = char(i);
+    QLeAdvertiserBluez *advertiser =
+            createAdvertiser(QLowEnergyAdvertisingParameters::AdvNonConnInd, data);
+    advertiser->startAdvertising();
+    QTRY_VERIFY(controller->isEnabled(0xef));
+
+    const QList<SimulatedController::Command> fragments =
+            controller->commands(QBluezConst::OcfLeSetExtAdvData);
+    QCOMPARE(fragments.size(), fragmentLengths.size());
+    QByteArray reassembled;
+    for (qsizetype i = 0; i < fragments.size(); ++i) {
+        const QByteArray &fragment = fragments.at(i).parameters;
+        QCOMPARE(quint8(fragment.at(0)), 0xef); // advertising handle
+        QCOMPARE(int(fragment.at(1)), operations.at(i));
+        QCOMPARE(int(fragment.at(2)), 0x01); // no fragmentation by the controller
+        QCOMPARE(int(quint8(fragment.at(3))), fragmentLengths.at(i));
+        QCOMPARE(fragment.size(), 4 + fragmentLengths.at(i));
+        reassembled += fragment.mid(4);
+    }
+    QCOMPARE(reassembled, data.left(1650));
+}
+
+void tst_QLeAdvertiserBluez::handleAllocation()
+{
+    const QByteArray data(5, 'a');
+    QLeAdvertiserBluez *first = createAdvertiser(QLowEnergyAdvertisingParameters::AdvInd, data);
+    first->startAdvertising();
+    QTRY_VERIFY(controller->isEnabled(0xef));
+
+    qsizetype mark = controller->commandCount();
+    QLeAdvertiserBluez *second = createAdvertiser(QLowEnergyAdvertisingParameters::AdvInd, data);
+    second->startAdvertising();
+    QTRY_VERIFY(controller->isEnabled(0xee, mark));
+    QList<SimulatedController::Command> params = controller->commands(
+            QBluezConst::OcfLeSetExtAdvParams);
+    QCOMPARE(params.size(), 2);
+    QCOMPARE(int(params.at(0).parameters.at(SidOffset)), 0);
+    QCOMPARE(int(params.at(1).parameters.at(SidOffset)), 1);
+
+    // destruction removes the set and releases handle and SID
+    mark = controller->commandCount();
+    advertisers.removeOne(first);
+    delete first;
+    QTRY_COMPARE(controller->commands(QBluezConst::OcfLeRemoveAdvSet, mark).size(), 1);
+    QCOMPARE(quint8(controller->commands(QBluezConst::OcfLeRemoveAdvSet, mark)
+                            .first().parameters.at(0)), 0xef);
+
+    mark = controller->commandCount();
+    QLeAdvertiserBluez *third = createAdvertiser(QLowEnergyAdvertisingParameters::AdvInd, data);
+    third->startAdvertising();
+    QTRY_VERIFY(controller->isEnabled(0xef, mark));
+    params = controller->commands(QBluezConst::OcfLeSetExtAdvParams, mark);
+    QCOMPARE(params.size(), 1);
+    QCOMPARE(int(params.at(0).parameters.at(SidOffset)), 0);
+}
+
+void tst_QLeAdvertiserBluez::handleCollision()
+{
+    controller->foreignHandles = { 0xef };
+    const QByteArray data(5, 'a');
+    QLeAdvertiserBluez *first = createAdvertiser(QLowEnergyAdvertisingParameters::AdvInd, data);
+    QSignalSpy errorSpy(first, &QLeAdvertiser::errorOccurred);
+    first->startAdvertising();
+    QTRY_COMPARE(errorSpy.count(), 1);
+
+    // no other handle is tried, it could belong to a disabled set of the other process
+    QList<SimulatedController::Command> params =
+            controller->commands(QBluezConst::OcfLeSetExtAdvParams);
+    QCOMPARE(params.size(), 1);
+    QCOMPARE(quint8(params.at(0).parameters.at(0)), 0xef);
+    QVERIFY(controller->commands(QBluezConst::OcfLeSetExtAdvEnable).isEmpty());
+
+    // a restart uses another handle
+    qsizetype mark = controller->commandCount();
+    first->startAdvertising();
+    QTRY_VERIFY(controller->isEnabled(0xee, mark));
+    QCOMPARE(errorSpy.count(), 1);
+
+    // the rejected handle is not offered to other advertisers of this process either
+    mark = controller->commandCount();
+    QLeAdvertiserBluez *second = createAdvertiser(QLowEnergyAdvertisingParameters::AdvInd, data);
+    second->startAdvertising();
+    QTRY_VERIFY(controller->isEnabled(0xed, mark));
+
+    advertisers.clear();
+    delete first;
+    delete second;
+
+    // the set of the other process was never disabled, changed or removed
+    const QBluezConst::OpCodeCommandField setCommands[] = {
+        QBluezConst::OcfLeSetExtAdvData, QBluezConst::OcfLeSetExtAdvEnable,
+        QBluezConst::OcfLeRemoveAdvSet
+    };
+    for (QBluezConst::OpCodeCommandField ocf : setCommands) {
+        const QList<SimulatedController::Command> commands = controller->commands(ocf);
+        for (const SimulatedController::Command &command : commands) {
+            const int handleOffset = ocf == QBluezConst::OcfLeSetExtAdvEnable ? 2 : 0;
+            QVERIFY(quint8(command.parameters.at(handleOffset)) != 0xef);
+        }
+    }
+    params = controller->commands(QBluezConst::OcfLeSetExtAdvParams);
+    QCOMPARE(std::count_if(params.cbegin(), params.cend(),
+                           [](const SimulatedController::Command &command) {
+                               return quint8(command.parameters.at(0)) == 0xef;
+                           }), 1);
+}
+
+void tst_QLeAdvertiserBluez::ownSetStillEnabled_data()
+{
+    QTest::addColumn<int>("refusedDisables");
+    QTest::addColumn<bool>("error");
+
+    QTest::newRow("refused once") << 1 << false;
+    QTest::newRow("refused twice") << 2 << true;
+}
+
+void tst_QLeAdvertiserBluez::ownSetStillEnabled()
+{
+    QFETCH(int, refusedDisables);
+    QFETCH(bool, error);
+
+    QLeAdvertiserBluez *advertiser =
+            createAdvertiser(QLowEnergyAdvertisingParameters::AdvNonConnInd, QByteArray(5, 'a'));
+    QSignalSpy errorSpy(advertiser, &QLeAdvertiser::errorOccurred);
+    advertiser->startAdvertising();
+    QTRY_VERIFY(controller->isEnabled(0xef));
+
+    // Extended PDUs need new parameters, which the controller refuses while the set
+    // it did not disable is still enabled. The advertiser retries once for its own set.
+    controller->refusedDisables = refusedDisables;
+    const qsizetype mark = controller->commandCount();
+    QLowEnergyAdvertisingData data;
+    data.setRawData(QByteArray(100, 'b'));
+    advertiser->updateAdvertisingData(data, QLowEnergyAdvertisingData());
+
+    if (error) {
+        QTRY_COMPARE(errorSpy.count(), 1);
+        QVERIFY(!controller->isEnabled(0xef, mark));
+    } else {
+        QTRY_VERIFY(controller->isEnabled(0xef, mark));
+        QVERIFY(errorSpy.isEmpty());
+    }
+    const QList<SimulatedController::Command> params =
+            controller->commands(QBluezConst::OcfLeSetExtAdvParams, mark);
+    QCOMPARE(params.size(), 2);
+    for (const SimulatedController::Command &command : params)
+        QCOMPARE(quint8(command.parameters.at(0)), 0xef);
+}
+
+QTEST_MAIN(tst_QLeAdvertiserBluez)
+
+#include "tst_qleadvertiserbluez.moc"
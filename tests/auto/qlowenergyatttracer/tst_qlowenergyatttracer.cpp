@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtBluetooth/private/qlowenergyatttracer_p.h>
+
+class tst_QLowEnergyAttTracer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void disabled();
+    void records();
+    void ringOverflow();
+    void traceFile();
+};
+
+struct Record
+{
+    quint8 event;
+    quint32 bearer;
+    qint64 time;
+    quint32 arg0;
+    quint32 arg1;
+    QByteArray data;
+};
+
+static QList<Record> parseRecords(const QByteArray &records)
+{
+    QList<Record> result;
+    qsizetype position = 0;
+    while (position < records.size()) {
+        const char *data = records.constData() + position;
+        const quint16 size = qFromLittleEndian<quint16>(data);
+        if (size < QLowEnergyAttTracer::RecordHeaderSize || position + size > records.size())
+            return {};
+
+        Record record;
+        record.event = quint8(data[2]);
+        record.bearer = qFromLittleEndian<quint32>(data + 4);
+        record.time = qFromLittleEndian<qint64>(data + 8);
+        record.arg0 = qFromLittleEndian<quint32>(data + 16);
+        record.arg1 = qFromLittleEndian<quint32>(data + 20);
+        record.data = QByteArray(data + QLowEnergyAttTracer::RecordHeaderSize,
+                                 size - QLowEnergyAttTracer::RecordHeaderSize);
+        result.append(record);
+        position += size;
+    }
+    return result;
+}
+
+void tst_QLowEnergyAttTracer::disabled()
+{
+    QLowEnergyAttTracer tracer;
+    QVERIFY(!tracer.isEnabled());
+    tracer.trace(QLowEnergyAttTracer::SendPdu, 0, 0, QByteArray::fromHex("0a0300"));
+    QCOMPARE(tracer.size(), qsizetype(0));
+    QVERIFY(tracer.records().isEmpty());
+
+    QLowEnergyAttTracer other;
+    QVERIFY(other.bearerId() != tracer.bearerId());
+}
+
+void tst_QLowEnergyAttTracer::records()
+{
+    QLowEnergyAttTracer tracer;
+    tracer.setEnabled(true);
+
+    const qint64 before = QDateTime::currentMSecsSinceEpoch() * 1000000;
+    tracer.trace(QLowEnergyAttTracer::EnqueueRequest, 0x0a, 1);
+    tracer.trace(QLowEnergyAttTracer::SendPdu, 0, 0, QByteArray::fromHex("0a0300"));
+    tracer.trace(QLowEnergyAttTracer::ReceivePdu, 0, 0, QByteArray::fromHex("0b4142"));
+    tracer.trace(QLowEnergyAttTracer::MtuExchanged, 247);
+
+    const QList<Record> records = parseRecords(tracer.records());
+    QCOMPARE(records.size(), qsizetype(4));
+    QCOMPARE(records.at(0).event, quint8(QLowEnergyAttTracer::EnqueueRequest));
+    QCOMPARE(records.at(0).arg0, quint32(0x0a));
+    QCOMPARE(records.at(0).arg1, quint32(1));
+    QVERIFY(records.at(0).data.isEmpty());
+    QCOMPARE(records.at(1).event, quint8(QLowEnergyAttTracer::SendPdu));
+    QCOMPARE(records.at(1).data, QByteArray::fromHex("0a0300"));
+    QCOMPARE(records.at(2).data, QByteArray::fromHex("0b4142"));
+    QCOMPARE(records.at(3).arg0, quint32(247));
+    for (const Record &record : records) {
+        QCOMPARE(record.bearer, tracer.bearerId());
+        QVERIFY(record.time >= before - 1000000);
+    }
+
+    tracer.clear();
+    QVERIFY(tracer.records().isEmpty());
+}
+
+void tst_QLowEnergyAttTracer::ringOverflow()
+{
+    // room for three records with a 3 byte payload
+    const qsizetype recordSize = QLowEnergyAttTracer::RecordHeaderSize + 3;
+    QLowEnergyAttTracer tracer;
+    tracer.setEnabled(true, 3 * recordSize + 5);
+
+    for (quint32 i = 0; i < 10; ++i)
+        tracer.trace(QLowEnergyAttTracer::SendPdu, i, 0, QByteArray(3, char('a' + i)));
+
+    QCOMPARE(tracer.droppedCount(), quint64(7));
+    const QList<Record> records = parseRecords(tracer.records());
+    QCOMPARE(records.size(), qsizetype(3));
+    for (qsizetype i = 0; i < records.size(); ++i) {
+        QCOMPARE(records.at(i).arg0, quint32(7 + i));
+        QCOMPARE(records.at(i).data, QByteArray(3, char('h' + i)));
+    }
+
+    // records larger than the ring are dropped
+    tracer.trace(QLowEnergyAttTracer::SendPdu, 0, 0, QByteArray(4 * recordSize, 'x'));
+    QCOMPARE(tracer.droppedCount(), quint64(8));
+    QCOMPARE(parseRecords(tracer.records()).size(), qsizetype(3));
+}
+
+void tst_QLowEnergyAttTracer::traceFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("att.trace"));
+
+    QLowEnergyAttTracer tracer;
+    tracer.setEnabled(true);
+    tracer.trace(QLowEnergyAttTracer::SendPdu, 0, 0, QByteArray::fromHex("0203"));
+    QVERIFY(tracer.appendToFile(fileName));
+    tracer.clear();
+    tracer.trace(QLowEnergyAttTracer::ReceivePdu, 0, 0, QByteArray::fromHex("030302"));
+    QVERIFY(tracer.appendToFile(fileName));
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray content = file.readAll();
+    QVERIFY(content.startsWith(QByteArray(QLowEnergyAttTracer::FileMagic,
+                                          sizeof(QLowEnergyAttTracer::FileMagic))));
+    QCOMPARE(qFromLittleEndian<quint32>(content.constData() + 8),
+             QLowEnergyAttTracer::FileVersion);
+
+    // the header is only written once
+    const QList<Record> records =
+            parseRecords(content.mid(QLowEnergyAttTracer::FileHeaderSize));
+    QCOMPARE(records.size(), qsizetype(2));
+    QCOMPARE(records.at(0).data, QByteArray::fromHex("0203"));
+    QCOMPARE(records.at(1).data, QByteArray::fromHex("030302"));
+}
+
+QTEST_MAIN(tst_QLowEnergyAttTracer)
+
+#include "tst_qlowenergyatttracer.moc"
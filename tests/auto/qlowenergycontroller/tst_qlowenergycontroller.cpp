@@ -37,6 +37,7 @@
 #include <QBluetoothDeviceDiscoveryAgent>
 #include <QBluetoothUuid>
 #include <QLowEnergyController>
+#include <QLowEnergyAdvertisingData>
 #include <QLowEnergyCharacteristic>
 
 #include <QDebug>
@@ -74,6 +75,7 @@ private slots:
     void tst_readWriteDescriptor();
     void tst_customProgrammableDevice();
     void tst_errorCases();
+    void tst_updateAdvertisingData();
 private:
     void verifyServiceProperties(const QLowEnergyService *info);
     bool verifyClientCharacteristicValue(const QByteArray& value);
@@ -2472,6 +2474,44 @@ void tst_QLowEnergyController::tst_errorCases()
     QCOMPARE(control->error(), QLowEnergyController::NoError);
 }
 
+void tst_QLowEnergyController::tst_updateAdvertisingData()
+{
+    QLowEnergyAdvertisingData data;
+    data.setLocalName(QStringLiteral("tst_updateAdvertisingData"));
+
+    // central role
+    {
+        QScopedPointer<QLowEnergyController> control(
+                    QLowEnergyController::createCentral(QBluetoothDeviceInfo()));
+        QSignalSpy stateSpy(control.data(), SIGNAL(stateChanged(QLowEnergyController::ControllerState)));
+        QSignalSpy errorSpy(control.data(), SIGNAL(errorOccurred(QLowEnergyController::Error)));
+        QTest::ignoreMessage(QtWarningMsg,
+                             QRegularExpression("Cannot update advertising data in central role"));
+        control->updateAdvertisingData(data);
+
+        QCOMPARE(control->state(), QLowEnergyController::UnconnectedState);
+        QCOMPARE(control->error(), QLowEnergyController::NoError);
+        QVERIFY(stateSpy.isEmpty());
+        QVERIFY(errorSpy.isEmpty());
+    }
+
+    // peripheral role, but not advertising
+    {
+        QScopedPointer<QLowEnergyController> control(QLowEnergyController::createPeripheral());
+        QSignalSpy stateSpy(control.data(), SIGNAL(stateChanged(QLowEnergyController::ControllerState)));
+        QSignalSpy errorSpy(control.data(), SIGNAL(errorOccurred(QLowEnergyController::Error)));
+        QCOMPARE(control->state(), QLowEnergyController::UnconnectedState);
+        QTest::ignoreMessage(QtWarningMsg,
+                             QRegularExpression("Cannot update advertising data in state"));
+        control->updateAdvertisingData(data, data);
+
+        QCOMPARE(control->state(), QLowEnergyController::UnconnectedState);
+        QCOMPARE(control->error(), QLowEnergyController::NoError);
+        QVERIFY(stateSpy.isEmpty());
+        QVERIFY(errorSpy.isEmpty());
+    }
+}
+
 /*
     Tests write without responses. We utilize the Over-The-Air image update
     service of the SensorTag.
@@ -0,0 +1,162 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtBluetooth/private/qlowenergycontrollerinstrumentation_p.h>
+
+class tst_QLowEnergyControllerInstrumentation : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void bucketLayout();
+    void percentiles();
+    void merge();
+    void snapshot();
+};
+
+void tst_QLowEnergyControllerInstrumentation::bucketLayout()
+{
+    using Histogram = QLowEnergyLatencyHistogram;
+
+    // small values are exact
+    for (qint64 value = 0; value < Histogram::SubBucketCount; ++value) {
+        const Histogram::Bucket bucket = Histogram::bucketRange(Histogram::bucketIndex(value));
+        QCOMPARE(bucket.lowerBound, value);
+        QCOMPARE(bucket.upperBound, value);
+    }
+
+    // buckets are contiguous and each value lies within its own bucket
+    qint64 expectedLower = 0;
+    for (qsizetype i = 0; i < Histogram::bucketCount(); ++i) {
+        const Histogram::Bucket bucket = Histogram::bucketRange(i);
+        QCOMPARE(bucket.lowerBound, expectedLower);
+        QCOMPARE(Histogram::bucketIndex(bucket.lowerBound), i);
+        QCOMPARE(Histogram::bucketIndex(bucket.upperBound), i);
+        // relative bucket width stays below 2 / SubBucketCount
+        QVERIFY((bucket.upperBound - bucket.lowerBound) * Histogram::SubBucketCount
+                <= 2 * qMax(bucket.lowerBound, qint64(1)));
+        expectedLower = bucket.upperBound + 1;
+    }
+    QCOMPARE(expectedLower - 1, Histogram::MaximumValue);
+
+    // out of range values are clamped
+    QCOMPARE(Histogram::bucketIndex(-5), qsizetype(0));
+    QCOMPARE(Histogram::bucketIndex(std::numeric_limits<qint64>::max()),
+             Histogram::bucketCount() - 1);
+}
+
+void tst_QLowEnergyControllerInstrumentation::percentiles()
+{
+    QLowEnergyLatencyHistogram histogram;
+    QVERIFY(histogram.isEmpty());
+    QCOMPARE(histogram.valueAtPercentile(50.0), qint64(0));
+
+    for (qint64 value = 1; value <= 1000; ++value)
+        histogram.record(value * 1000);
+
+    QCOMPARE(histogram.totalCount(), quint64(1000));
+    QCOMPARE(histogram.minimum(), qint64(1000));
+    QCOMPARE(histogram.maximum(), qint64(1000000));
+    QCOMPARE(histogram.mean(), 500500.0);
+
+    const qint64 p50 = histogram.valueAtPercentile(50.0);
+    QVERIFY(p50 >= 500000 && p50 <= 500000 + 500000 / 16);
+    const qint64 p99 = histogram.valueAtPercentile(99.0);
+    QVERIFY(p99 >= 990000 && p99 <= 1000000);
+    QCOMPARE(histogram.valueAtPercentile(100.0), qint64(1000000));
+    const qint64 p0 = histogram.valueAtPercentile(0.0);
+    QVERIFY(p0 >= 1000 && p0 <= 1000 + 1000 / 16);
+
+    quint64 total = 0;
+    const QList<QLowEnergyLatencyHistogram::Bucket> buckets = histogram.buckets();
+    for (const QLowEnergyLatencyHistogram::Bucket &bucket : buckets) {
+        QVERIFY(bucket.count > 0);
+        total += bucket.count;
+    }
+    QCOMPARE(total, histogram.totalCount());
+
+    histogram.reset();
+    QVERIFY(histogram.isEmpty());
+    QVERIFY(histogram.buckets().isEmpty());
+}
+
+void tst_QLowEnergyControllerInstrumentation::merge()
+{
+    QLowEnergyLatencyHistogram first;
+    QLowEnergyLatencyHistogram second;
+    first.record(10);
+    first.record(20);
+    second.record(5);
+    second.record(4000);
+
+    first.add(second);
+    first.add(QLowEnergyLatencyHistogram());
+    QCOMPARE(first.totalCount(), quint64(4));
+    QCOMPARE(first.minimum(), qint64(5));
+    QCOMPARE(first.maximum(), qint64(4000));
+
+    QLowEnergyLatencyHistogram empty;
+    empty.add(second);
+    QCOMPARE(empty.totalCount(), quint64(2));
+    QCOMPARE(empty.minimum(), qint64(5));
+}
+
+void tst_QLowEnergyControllerInstrumentation::snapshot()
+{
+    QLowEnergyControllerInstrumentation instrumentation;
+    instrumentation.recordQueueLatency(0x0a, 1500);
+    instrumentation.recordQueueLatency(0x0a, 2500);
+    instrumentation.recordResponseLatency(0x0a, 30000000);
+    instrumentation.recordReceiveDelay(0x1b, 42000);
+    instrumentation.recordNotificationLatency(90000);
+    instrumentation.recordQueueDepth(3);
+
+    QCOMPARE(instrumentation.queueLatencies().value(0x0a).totalCount(), quint64(2));
+    QCOMPARE(instrumentation.queueDepths().maximum(), qint64(3));
+
+    const QJsonObject json = instrumentation.toJson();
+    const QJsonObject queueLatency = json.value(QStringLiteral("queueLatency")).toObject()
+                                             .value(QStringLiteral("0x0a")).toObject();
+    QCOMPARE(queueLatency.value(QStringLiteral("count")).toInteger(), qint64(2));
+    QCOMPARE(queueLatency.value(QStringLiteral("min")).toInteger(), qint64(1500));
+    QCOMPARE(queueLatency.value(QStringLiteral("buckets")).toArray().size(), qsizetype(2));
+    QVERIFY(json.value(QStringLiteral("receiveDelay")).toObject()
+                    .contains(QStringLiteral("0x1b")));
+    QCOMPARE(json.value(QStringLiteral("notificationLatency")).toObject()
+                     .value(QStringLiteral("max")).toInteger(), qint64(90000));
+
+    instrumentation.reset();
+    QVERIFY(instrumentation.queueLatencies().isEmpty());
+    QVERIFY(instrumentation.queueDepths().isEmpty());
+}
+
+QTEST_MAIN(tst_QLowEnergyControllerInstrumentation)
+
+#include "tst_qlowenergycontrollerinstrumentation.moc"
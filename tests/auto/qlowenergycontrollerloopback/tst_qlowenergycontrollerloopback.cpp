@@ -0,0 +1,934 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtBluetooth/qlowenergycharacteristicdata.h>
+#include <QtBluetooth/qlowenergycontroller.h>
+#include <QtBluetooth/qlowenergydescriptordata.h>
+#include <QtBluetooth/qlowenergynotificationqueue.h>
+#include <QtBluetooth/qlowenergyservicedata.h>
+#include <QtBluetooth/private/qlowenergycontroller_bluez_p.h>
+#include <QtCore/qsettings.h>
+#include <QtCore/qtemporarydir.h>
+
+#include <algorithm>
+#include <utility>
+
+static const QBluetoothUuid serviceUuid(QStringLiteral("{a1b2c3d4-0000-1000-8000-00805f9b34fb}"));
+static const QBluetoothUuid characteristicUuid(
+        QStringLiteral("{a1b2c3d5-0000-1000-8000-00805f9b34fb}"));
+
+class tst_QLowEnergyControllerLoopback : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void unsupportedOperations();
+    void gattCommunication();
+    void discoveryAtDefaultMtu();
+    void truncatedListValues_data();
+    void truncatedListValues();
+    void signCounterPersistence();
+    void reliableWrite();
+    void discoverAllServiceDetails();
+    void subscriptions();
+    void notificationQueue();
+};
+
+static QLowEnergyServiceData createServiceData()
+{
+    QLowEnergyCharacteristicData characteristic;
+    characteristic.setUuid(characteristicUuid);
+    characteristic.setProperties(QLowEnergyCharacteristic::Read | QLowEnergyCharacteristic::Write
+                                 | QLowEnergyCharacteristic::WriteNoResponse
+                                 | QLowEnergyCharacteristic::Notify);
+    characteristic.setValue(QByteArray("initial"));
+    characteristic.setValueLength(0, 512);
+    characteristic.addDescriptor(QLowEnergyDescriptorData(
+            QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration,
+            QByteArray(2, 0)));
+
+    QLowEnergyServiceData service;
+    service.setType(QLowEnergyServiceData::ServiceTypePrimary);
+    service.setUuid(serviceUuid);
+    service.addCharacteristic(characteristic);
+    return service;
+}
+
+void tst_QLowEnergyControllerLoopback::unsupportedOperations()
+{
+    QScopedPointer<QLowEnergyController> central(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::CentralRole));
+    QScopedPointer<QLowEnergyController> peripheral(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::PeripheralRole));
+
+    central->connectToDevice();
+    QCOMPARE(central->error(), QLowEnergyController::InvalidBluetoothAdapterError);
+    QCOMPARE(central->state(), QLowEnergyController::UnconnectedState);
+
+    // roles must match
+    QVERIFY(!QLowEnergyControllerPrivateBluez::connectLoopback(peripheral.data(), central.data(),
+                                                               23));
+}
+
+void tst_QLowEnergyControllerLoopback::gattCommunication()
+{
+    QScopedPointer<QLowEnergyController> peripheral(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::PeripheralRole));
+    QScopedPointer<QLowEnergyService> localService(peripheral->addService(createServiceData()));
+    QVERIFY(localService);
+
+    QScopedPointer<QLowEnergyController> central(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::CentralRole));
+    QSignalSpy connectedSpy(central.data(), &QLowEnergyController::connected);
+    QSignalSpy peripheralConnectedSpy(peripheral.data(), &QLowEnergyController::connected);
+
+    QVERIFY(QLowEnergyControllerPrivateBluez::connectLoopback(central.data(), peripheral.data(),
+                                                              100));
+    QCOMPARE(connectedSpy.count(), 1);
+    QCOMPARE(peripheralConnectedSpy.count(), 1);
+    QCOMPARE(central->state(), QLowEnergyController::ConnectedState);
+    QTRY_COMPARE(central->mtu(), 100);
+    QCOMPARE(peripheral->mtu(), 100);
+
+    central->discoverServices();
+    QTRY_COMPARE(central->state(), QLowEnergyController::DiscoveredState);
+    QVERIFY(central->services().contains(serviceUuid));
+
+    QScopedPointer<QLowEnergyService> service(central->createServiceObject(serviceUuid));
+    QVERIFY(service);
+    service->discoverDetails();
+    QTRY_COMPARE(service->state(), QLowEnergyService::RemoteServiceDiscovered);
+
+    const QLowEnergyCharacteristic characteristic = service->characteristic(characteristicUuid);
+    QVERIFY(characteristic.isValid());
+    QCOMPARE(characteristic.value(), QByteArray("initial"));
+
+    // write request, longer than the MTU
+    const QByteArray longValue(300, 'w');
+    QSignalSpy writtenSpy(service.data(), &QLowEnergyService::characteristicWritten);
+    service->writeCharacteristic(characteristic, longValue);
+    QTRY_COMPARE(writtenSpy.count(), 1);
+    QCOMPARE(localService->characteristic(characteristicUuid).value(), longValue);
+
+    // read request
+    localService->writeCharacteristic(localService->characteristic(characteristicUuid),
+                                      QByteArray("read me"));
+    QSignalSpy readSpy(service.data(), &QLowEnergyService::characteristicRead);
+    service->readCharacteristic(characteristic);
+    QTRY_COMPARE(readSpy.count(), 1);
+    QCOMPARE(service->characteristic(characteristicUuid).value(), QByteArray("read me"));
+
+    // notification
+    QSignalSpy changedSpy(service.data(), &QLowEnergyService::characteristicChanged);
+    service->subscribe({ characteristic });
+    const QLowEnergyDescriptor localConfiguration =
+            localService->characteristic(characteristicUuid)
+                    .clientCharacteristicConfiguration();
+    QTRY_COMPARE(localConfiguration.value(), QByteArray::fromHex("0100"));
+    localService->writeCharacteristic(localService->characteristic(characteristicUuid),
+                                      QByteArray("notified"));
+    QTRY_COMPARE(changedSpy.count(), 1);
+    QCOMPARE(changedSpy.at(0).at(1).toByteArray(), QByteArray("notified"));
+
+    QSignalSpy disconnectedSpy(peripheral.data(), &QLowEnergyController::disconnected);
+    central->disconnectFromDevice();
+    QTRY_COMPARE(disconnectedSpy.count(), 1);
+    QCOMPARE(peripheral->state(), QLowEnergyController::UnconnectedState);
+}
+
+void tst_QLowEnergyControllerLoopback::discoveryAtDefaultMtu()
+{
+    // Mixed UUID and value sizes split the list responses of the server into
+    // many PDUs, and the unreadable characteristic ends a Read By Type list.
+    QLowEnergyServiceData serviceData;
+    serviceData.setType(QLowEnergyServiceData::ServiceTypePrimary);
+    serviceData.setUuid(serviceUuid);
+    for (int i = 0; i < 12; ++i) {
+        QLowEnergyCharacteristicData characteristic;
+        characteristic.setUuid(i % 3 == 0 ? QBluetoothUuid(quint16(0x2a00 + i))
+                                          : QBluetoothUuid(quint32(0xa1b20000 + i)));
+        characteristic.setProperties(i == 7 ? QLowEnergyCharacteristic::Write
+                                            : QLowEnergyCharacteristic::Read);
+        characteristic.setValue(QByteArray(1 + i % 2, char('a' + i)));
+        serviceData.addCharacteristic(characteristic);
+    }
+    QLowEnergyServiceData batteryData;
+    batteryData.setType(QLowEnergyServiceData::ServiceTypePrimary);
+    batteryData.setUuid(QBluetoothUuid(quint16(0x180f)));
+
+    QScopedPointer<QLowEnergyController> peripheral(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::PeripheralRole));
+    QScopedPointer<QLowEnergyService> localService(peripheral->addService(serviceData));
+    QScopedPointer<QLowEnergyService> localBattery(peripheral->addService(batteryData));
+    QVERIFY(localService && localBattery);
+
+    QScopedPointer<QLowEnergyController> central(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::CentralRole));
+    QVERIFY(QLowEnergyControllerPrivateBluez::connectLoopback(central.data(), peripheral.data(),
+                                                              23));
+    central->discoverServices();
+    QTRY_COMPARE(central->state(), QLowEnergyController::DiscoveredState);
+    QVERIFY(central->services().contains(serviceUuid));
+    QVERIFY(central->services().contains(QBluetoothUuid(quint16(0x180f))));
+
+    QScopedPointer<QLowEnergyService> service(central->createServiceObject(serviceUuid));
+    QVERIFY(service);
+    service->discoverDetails();
+    QTRY_COMPARE(service->state(), QLowEnergyService::RemoteServiceDiscovered);
+
+    const QList<QLowEnergyCharacteristic> characteristics = service->characteristics();
+    QCOMPARE(characteristics.count(), 12);
+    for (int i = 0; i < characteristics.count(); ++i) {
+        const QLowEnergyCharacteristic &characteristic = characteristics.at(i);
+        QCOMPARE(characteristic.uuid(), serviceData.characteristics().at(i).uuid());
+        if (i == 7)
+            QVERIFY(characteristic.value().isEmpty());
+        else
+            QCOMPARE(characteristic.value(), serviceData.characteristics().at(i).value());
+    }
+}
+
+#ifdef QT_BUILD_INTERNAL
+void tst_QLowEnergyControllerLoopback::truncatedListValues_data()
+{
+    QTest::addColumn<int>("mtu");
+    QTest::addColumn<int>("valueLength");
+
+    // Read By Type elements carry up to MTU - 4 value bytes, but no more than
+    // the length field allows
+    QTest::newRow("default mtu") << 23 << 19;
+    QTest::newRow("maximum mtu") << 512 << 253;
+}
+
+void tst_QLowEnergyControllerLoopback::truncatedListValues()
+{
+#ifdef QT_BUILD_INTERNAL
+    QFETCH(int, mtu);
+    QFETCH(int, valueLength);
+
+    // Two characteristics sharing a uuid are read with one Read By Type request.
+    const QByteArray values[] = { QByteArray(300, 'x'), QByteArray(300, 'y') };
+    QLowEnergyServiceData serviceData;
+    serviceData.setType(QLowEnergyServiceData::ServiceTypePrimary);
+    serviceData.setUuid(serviceUuid);
+    for (const QByteArray &value : values) {
+        QLowEnergyCharacteristicData characteristic;
+        characteristic.setUuid(characteristicUuid);
+        characteristic.setProperties(QLowEnergyCharacteristic::Read);
+        characteristic.setValue(value);
+        characteristic.setValueLength(0, 512);
+        serviceData.addCharacteristic(characteristic);
+    }
+
+    QScopedPointer<QLowEnergyController> peripheral(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::PeripheralRole));
+    QScopedPointer<QLowEnergyService> localService(peripheral->addService(serviceData));
+    QVERIFY(localService);
+    QScopedPointer<QLowEnergyController> central(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::CentralRole));
+
+    // length fields and values of the list elements the peripheral sends
+    QList<QPair<int, QByteArray>> valueElements;
+    QList<QPair<int, QByteArray>> serviceElements;
+    QLowEnergyControllerPrivateBluez::setLoopbackPacketFilter(
+            peripheral.data(), [&](QByteArray &pdu) {
+                const auto opCode = static_cast<QBluezConst::AttCommand>(pdu.at(0));
+                const bool byType = opCode == QBluezConst::AttCommand::ATT_OP_READ_BY_TYPE_RESPONSE;
+                if (!byType && opCode != QBluezConst::AttCommand::ATT_OP_READ_BY_GROUP_RESPONSE)
+                    return;
+                const int elementLength = quint8(pdu.at(1));
+                const int headerLength = byType ? 2 : 4;
+                for (int offset = 2; offset + elementLength <= pdu.size();
+                     offset += elementLength) {
+                    const QByteArray value = pdu.mid(offset + headerLength,
+                                                     elementLength - headerLength);
+                    if (!byType)
+                        serviceElements.append({ elementLength, value });
+                    // characteristic declarations start with their properties instead
+                    else if (value.startsWith('x') || value.startsWith('y'))
+                        valueElements.append({ elementLength, value });
+                }
+            });
+
+    QVERIFY(QLowEnergyControllerPrivateBluez::connectLoopback(central.data(), peripheral.data(),
+                                                              mtu));
+    QTRY_COMPARE(central->mtu(), mtu);
+    central->discoverServices();
+    QTRY_COMPARE(central->state(), QLowEnergyController::DiscoveredState);
+    QScopedPointer<QLowEnergyService> service(central->createServiceObject(serviceUuid));
+    QVERIFY(service);
+    service->discoverDetails();
+    QTRY_COMPARE(service->state(), QLowEnergyService::RemoteServiceDiscovered);
+
+    QCOMPARE(valueElements.size(), 2);
+    for (int i = 0; i < valueElements.size(); ++i) {
+        QCOMPARE(valueElements.at(i).first, 2 + valueLength);
+        QCOMPARE(valueElements.at(i).second, values[i].left(valueLength));
+    }
+
+    // 128 bit service uuids fit into Read By Group Type elements at any mtu
+    const auto serviceElement = std::find_if(
+            serviceElements.cbegin(), serviceElements.cend(),
+            [](const QPair<int, QByteArray> &element) { return element.first == 4 + 16; });
+    QVERIFY(serviceElement != serviceElements.cend());
+    QByteArray serviceUuidBytes = serviceElement->second;
+    std::reverse(serviceUuidBytes.begin(), serviceUuidBytes.end());
+    QCOMPARE(QBluetoothUuid(QUuid::fromRfc4122(serviceUuidBytes)), serviceUuid);
+
+    // the rest of the values is read with Read Blob requests
+    const QList<QLowEnergyCharacteristic> characteristics = service->characteristics();
+    QCOMPARE(characteristics.size(), 2);
+    QCOMPARE(characteristics.at(0).value(), values[0]);
+    QCOMPARE(characteristics.at(1).value(), values[1]);
+#else
+    QSKIP("Packet filters require a developer build");
+#endif
+}
+
+// key settings file of a loopback controller, see connectLoopback() for the addresses
+static QString keySettingsFile(const QString &directory, QLowEnergyController::Role role)
+{
+    const QBluetoothAddress peer(role == QLowEnergyController::CentralRole
+                                 ? Q_UINT64_C(0x00005154c000) : Q_UINT64_C(0x00005154c001));
+    return QString::fromLatin1("%1/%2/%3/info")
+            .arg(directory, QBluetoothAddress().toString(), peer.toString());
+}
+
+static bool createKeySettings(const QString &filePath, const QString &group, quint32 counter)
+{
+    if (!QDir().mkpath(QFileInfo(filePath).path()))
+        return false;
+    QSettings settings(filePath, QSettings::IniFormat);
+    settings.beginGroup(group);
+    settings.setValue(QLatin1String("Key"), QByteArray("000102030405060708090a0b0c0d0e0f"));
+    settings.setValue(QLatin1String("Counter"), counter);
+    settings.endGroup();
+    settings.sync();
+    return settings.status() == QSettings::NoError;
+}
+
+static quint32 storedSignCounter(const QString &filePath, const QString &group)
+{
+    QSettings settings(filePath, QSettings::IniFormat);
+    return settings.value(group + QLatin1String("/Counter")).toUInt();
+}
+#endif
+
+void tst_QLowEnergyControllerLoopback::signCounterPersistence()
+{
+#ifdef QT_BUILD_INTERNAL
+    QTemporaryDir centralKeys;
+    QTemporaryDir peripheralKeys;
+    QVERIFY(centralKeys.isValid() && peripheralKeys.isValid());
+    const QString centralFile =
+            keySettingsFile(centralKeys.path(), QLowEnergyController::CentralRole);
+    const QString peripheralFile =
+            keySettingsFile(peripheralKeys.path(), QLowEnergyController::PeripheralRole);
+    const QString localGroup = QStringLiteral("LocalSignatureKey");
+    const QString remoteGroup = QStringLiteral("RemoteSignatureKey");
+    const quint32 initialCounter = 10;
+    QVERIFY(createKeySettings(centralFile, localGroup, initialCounter));
+    QVERIFY(createKeySettings(peripheralFile, remoteGroup, initialCounter));
+
+    QLowEnergyCharacteristicData characteristicData;
+    characteristicData.setUuid(characteristicUuid);
+    characteristicData.setProperties(QLowEnergyCharacteristic::Read
+                                     | QLowEnergyCharacteristic::WriteSigned);
+    characteristicData.setValue(QByteArray("initial"));
+    characteristicData.setValueLength(0, 20);
+    QLowEnergyServiceData serviceData;
+    serviceData.setType(QLowEnergyServiceData::ServiceTypePrimary);
+    serviceData.setUuid(serviceUuid);
+    serviceData.addCharacteristic(characteristicData);
+
+    QScopedPointer<QLowEnergyController> peripheral(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::PeripheralRole));
+    QLowEnergyControllerPrivateBluez::setLoopbackKeySettingsDirectory(peripheral.data(),
+                                                                      peripheralKeys.path());
+    QScopedPointer<QLowEnergyService> localService(peripheral->addService(serviceData));
+    QVERIFY(localService);
+
+    quint32 lastUsedCounter = initialCounter - 1;
+    QScopedPointer<QLowEnergyController> central;
+    QScopedPointer<QLowEnergyService> service;
+    const auto connectCentral = [&](const QString &keyDirectory) {
+        central.reset(QLowEnergyControllerPrivateBluez::createLoopbackController(
+                QLowEnergyController::CentralRole));
+        QLowEnergyControllerPrivateBluez::setLoopbackKeySettingsDirectory(central.data(),
+                                                                          keyDirectory);
+        QVERIFY(QLowEnergyControllerPrivateBluez::connectLoopback(central.data(),
+                                                                  peripheral.data(), 23));
+        central->discoverServices();
+        QTRY_COMPARE(central->state(), QLowEnergyController::DiscoveredState);
+        service.reset(central->createServiceObject(serviceUuid));
+        QVERIFY(service);
+        service->discoverDetails();
+        QTRY_COMPARE(service->state(), QLowEnergyService::RemoteServiceDiscovered);
+    };
+    const auto writeSigned = [&](int count) {
+        const QLowEnergyCharacteristic characteristic = service->characteristic(characteristicUuid);
+        for (int i = 0; i < count; ++i) {
+            const QByteArray value = QByteArray::number(lastUsedCounter + 1);
+            service->writeCharacteristic(characteristic, value, QLowEnergyService::WriteSigned);
+            // the peripheral ignores signed writes with a counter it has already seen
+            QTRY_COMPARE(localService->characteristic(characteristicUuid).value(), value);
+            ++lastUsedCounter;
+        }
+    };
+
+    // more writes than one reservation covers
+    connectCentral(centralKeys.path());
+    if (QTest::currentTestFailed())
+        return;
+    for (int i = 0; i < 70; ++i) {
+        writeSigned(1);
+        if (QTest::currentTestFailed())
+            return;
+        // what a crash would leave behind never allows a counter to be used twice
+        QVERIFY(storedSignCounter(centralFile, localGroup) > lastUsedCounter);
+    }
+
+    // Simulate a crash: the central restarts from what is on disk now, without the
+    // unused part of its reservation being released.
+    const QString crashedKeys = centralKeys.path() + QLatin1String("/crashed");
+    QVERIFY(createKeySettings(keySettingsFile(crashedKeys, QLowEnergyController::CentralRole),
+                              localGroup, storedSignCounter(centralFile, localGroup)));
+
+    // the final flush releases the unused part of the reservation
+    service.reset();
+    central.reset();
+    QCOMPARE(storedSignCounter(centralFile, localGroup), lastUsedCounter + 1);
+    QTRY_COMPARE(peripheral->state(), QLowEnergyController::UnconnectedState);
+    QCOMPARE(storedSignCounter(peripheralFile, remoteGroup), lastUsedCounter + 1);
+
+    connectCentral(crashedKeys);
+    if (QTest::currentTestFailed())
+        return;
+    lastUsedCounter = storedSignCounter(
+            keySettingsFile(crashedKeys, QLowEnergyController::CentralRole), localGroup) - 1;
+    writeSigned(3);
+    if (QTest::currentTestFailed())
+        return;
+
+    // the peripheral writes the remote counter back when it goes away, without waiting
+    // for the flush interval
+    localService.reset();
+    peripheral.reset();
+    QCOMPARE(storedSignCounter(peripheralFile, remoteGroup), lastUsedCounter + 1);
+#else
+    QSKIP("Loopback key settings require a developer build");
+#endif
+}
+
+void tst_QLowEnergyControllerLoopback::reliableWrite()
+{
+#ifdef QT_BUILD_INTERNAL
+    QLowEnergyServiceData serviceData;
+    serviceData.setType(QLowEnergyServiceData::ServiceTypePrimary);
+    serviceData.setUuid(serviceUuid);
+    QList<QBluetoothUuid> uuids;
+    for (int i = 0; i < 3; ++i) {
+        QLowEnergyCharacteristicData characteristic;
+        characteristic.setUuid(QBluetoothUuid(quint32(0xa1b30000 + i)));
+        characteristic.setProperties(QLowEnergyCharacteristic::Read
+                                     | QLowEnergyCharacteristic::Write);
+        characteristic.setValue(QByteArray("initial"));
+        characteristic.setValueLength(0, 512);
+        serviceData.addCharacteristic(characteristic);
+        uuids << characteristic.uuid();
+    }
+
+    QScopedPointer<QLowEnergyController> peripheral(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::PeripheralRole));
+    QScopedPointer<QLowEnergyService> localService(peripheral->addService(serviceData));
+    QVERIFY(localService);
+    QScopedPointer<QLowEnergyController> central(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::CentralRole));
+
+    QList<QByteArray> sentPdus;
+    QLowEnergyControllerPrivateBluez::setLoopbackPacketFilter(
+            central.data(), [&sentPdus](QByteArray &pdu) { sentPdus << pdu; });
+    int prepareResponses = 0;
+    int corruptedResponse = -1;
+    QLowEnergyControllerPrivateBluez::setLoopbackPacketFilter(
+            peripheral.data(), [&](QByteArray &pdu) {
+                if (quint8(pdu.at(0))
+                        != quint8(QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_RESPONSE)) {
+                    return;
+                }
+                if (prepareResponses++ == corruptedResponse)
+                    pdu[pdu.size() - 1] = char(pdu.at(pdu.size() - 1) ^ 0xff);
+            });
+
+    QVERIFY(QLowEnergyControllerPrivateBluez::connectLoopback(central.data(), peripheral.data(),
+                                                              23));
+    central->discoverServices();
+    QTRY_COMPARE(central->state(), QLowEnergyController::DiscoveredState);
+    QScopedPointer<QLowEnergyService> service(central->createServiceObject(serviceUuid));
+    QVERIFY(service);
+    service->discoverDetails();
+    QTRY_COMPARE(service->state(), QLowEnergyService::RemoteServiceDiscovered);
+
+    // Returns the Prepare Write Requests and the flags of the Execute Write Requests
+    // in sentPdus.
+    const auto preparedWrites = [&sentPdus](QList<int> *executeFlags) {
+        QList<QByteArray> prepares;
+        for (const QByteArray &pdu : qAsConst(sentPdus)) {
+            const auto opCode = static_cast<QBluezConst::AttCommand>(pdu.at(0));
+            if (opCode == QBluezConst::AttCommand::ATT_OP_PREPARE_WRITE_REQUEST) {
+                // nothing else is sent while the values are queued on the peripheral
+                if (!executeFlags->isEmpty())
+                    return QList<QByteArray>();
+                prepares << pdu;
+            } else if (opCode == QBluezConst::AttCommand::ATT_OP_EXECUTE_WRITE_REQUEST) {
+                *executeFlags << pdu.at(1);
+            }
+        }
+        return prepares;
+    };
+
+    // several characteristics, fragmented across the MTU, in a single execute
+    const QList<QByteArray> values = { QByteArray(40, 'a'), QByteArray(5, 'b'),
+                                       QByteArray(30, 'c') };
+    QList<QPair<QLowEnergyCharacteristic, QByteArray>> writes;
+    for (int i = 0; i < uuids.size(); ++i)
+        writes.append({ service->characteristic(uuids.at(i)), values.at(i) });
+    QSignalSpy writtenSpy(service.data(), &QLowEnergyService::characteristicWritten);
+    QSignalSpy errorSpy(service.data(), &QLowEnergyService::errorOccurred);
+    sentPdus.clear();
+    service->writeCharacteristicsReliably(writes);
+    QTRY_COMPARE(writtenSpy.count(), 3);
+    QVERIFY(errorSpy.isEmpty());
+    for (int i = 0; i < uuids.size(); ++i) {
+        QCOMPARE(writtenSpy.at(i).at(1).toByteArray(), values.at(i));
+        QCOMPARE(localService->characteristic(uuids.at(i)).value(), values.at(i));
+    }
+
+    QList<int> executeFlags;
+    QList<QByteArray> prepares = preparedWrites(&executeFlags);
+    QCOMPARE(executeFlags, QList<int>({ 1 }));
+    // 23 byte MTU: 18 bytes per fragment
+    QCOMPARE(prepares.size(), 3 + 1 + 2);
+    QHash<QLowEnergyHandle, QByteArray> reassembled;
+    for (const QByteArray &prepare : qAsConst(prepares)) {
+        QVERIFY(prepare.size() <= 23);
+        QByteArray &value = reassembled[bt_get_le16(prepare.constData() + 1)];
+        QCOMPARE(int(bt_get_le16(prepare.constData() + 3)), value.size()); // offset
+        value += prepare.mid(5);
+    }
+    for (int i = 0; i < uuids.size(); ++i)
+        QCOMPARE(reassembled.value(service->characteristic(uuids.at(i)).handle()), values.at(i));
+
+    // a fragment echoed with a different value cancels the whole transaction
+    writes.clear();
+    for (int i = 0; i < uuids.size(); ++i)
+        writes.append({ service->characteristic(uuids.at(i)), QByteArray(20 + i, 'x') });
+    writtenSpy.clear();
+    sentPdus.clear();
+    prepareResponses = 0;
+    corruptedResponse = 1;
+    service->writeCharacteristicsReliably(writes);
+    QTRY_COMPARE(errorSpy.count(), 1);
+    QCOMPARE(errorSpy.at(0).at(0).value<QLowEnergyService::ServiceError>(),
+             QLowEnergyService::CharacteristicWriteError);
+    QVERIFY(writtenSpy.isEmpty());
+    executeFlags.clear();
+    preparedWrites(&executeFlags);
+    QCOMPARE(executeFlags, QList<int>({ 0 }));
+    for (int i = 0; i < uuids.size(); ++i)
+        QCOMPARE(localService->characteristic(uuids.at(i)).value(), values.at(i));
+#else
+    QSKIP("Packet filters require a developer build");
+#endif
+}
+
+void tst_QLowEnergyControllerLoopback::discoverAllServiceDetails()
+{
+    QScopedPointer<QLowEnergyController> peripheral(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::PeripheralRole));
+    QList<QLowEnergyServiceData> serviceData;
+    QList<QSharedPointer<QLowEnergyService>> localServices;
+    for (int i = 0; i < 4; ++i) {
+        QLowEnergyServiceData data;
+        data.setType(QLowEnergyServiceData::ServiceTypePrimary);
+        data.setUuid(QBluetoothUuid(quint32(0xa1b40000 + i)));
+        for (int j = 0; j <= i; ++j) {
+            QLowEnergyCharacteristicData characteristic;
+            characteristic.setUuid(QBluetoothUuid(quint32(0xa1b50000 + 16 * i + j)));
+            characteristic.setProperties(QLowEnergyCharacteristic::Read
+                                         | QLowEnergyCharacteristic::Notify);
+            characteristic.setValue(QByteArray::number(16 * i + j));
+            characteristic.addDescriptor(QLowEnergyDescriptorData(
+                    QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration,
+                    QByteArray(2, 0)));
+            data.addCharacteristic(characteristic);
+        }
+        serviceData << data;
+        localServices << QSharedPointer<QLowEnergyService>(peripheral->addService(data));
+        QVERIFY(localServices.last());
+    }
+
+    QScopedPointer<QLowEnergyController> central(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::CentralRole));
+    QVERIFY(QLowEnergyControllerPrivateBluez::connectLoopback(central.data(), peripheral.data(),
+                                                              23));
+    central->discoverServices();
+    QTRY_COMPARE(central->state(), QLowEnergyController::DiscoveredState);
+
+    QHash<QBluetoothUuid, QSharedPointer<QLowEnergyService>> services;
+    QHash<QBluetoothUuid, QList<QLowEnergyService::ServiceState>> states;
+    const QList<QBluetoothUuid> serviceUuids = central->services();
+    for (const QBluetoothUuid &uuid : serviceUuids) {
+        QSharedPointer<QLowEnergyService> service(central->createServiceObject(uuid));
+        QVERIFY(service);
+        QCOMPARE(service->state(), QLowEnergyService::RemoteService);
+        connect(service.data(), &QLowEnergyService::stateChanged, this,
+                [&states, uuid](QLowEnergyService::ServiceState state) {
+                    states[uuid] << state;
+                });
+        services.insert(uuid, service);
+    }
+
+    // the signals in the order of their emission, with the state of the service
+    QList<QPair<QBluetoothUuid, QLowEnergyService::ServiceState>> signalOrder;
+    connect(central.data(), &QLowEnergyController::serviceDetailsDiscovered, this,
+            [&](const QBluetoothUuid &uuid) {
+                signalOrder.append({ uuid, services.value(uuid)->state() });
+            });
+    connect(central.data(), &QLowEnergyController::allServiceDetailsDiscovered, this,
+            [&signalOrder]() {
+                signalOrder.append({ QBluetoothUuid(), QLowEnergyService::InvalidService });
+            });
+
+    // calling it again while the run is ongoing neither restarts nor ends it
+    bool reentered = false;
+    const auto reentry = connect(central.data(), &QLowEnergyController::serviceDetailsDiscovered,
+                                 this, [&]() {
+                                     if (!std::exchange(reentered, true))
+                                         central->discoverAllServiceDetails();
+                                 });
+
+    central->discoverAllServiceDetails();
+    QTRY_VERIFY(!signalOrder.isEmpty() && signalOrder.last().first.isNull());
+    QTest::qWait(50); // nothing else follows
+    QVERIFY(reentered);
+    disconnect(reentry);
+    QCOMPARE(signalOrder.size(), serviceUuids.size() + 1);
+
+    QSet<QBluetoothUuid> reported;
+    for (int i = 0; i < serviceUuids.size(); ++i) {
+        const QBluetoothUuid &uuid = signalOrder.at(i).first;
+        QVERIFY(services.contains(uuid));
+        QVERIFY2(!reported.contains(uuid), qPrintable(uuid.toString()));
+        reported.insert(uuid);
+        // the service is complete when its signal arrives
+        QCOMPARE(signalOrder.at(i).second, QLowEnergyService::RemoteServiceDiscovered);
+    }
+    for (const QBluetoothUuid &uuid : serviceUuids) {
+        QCOMPARE(states.value(uuid),
+                 QList<QLowEnergyService::ServiceState>(
+                         { QLowEnergyService::RemoteServiceDiscovering,
+                           QLowEnergyService::RemoteServiceDiscovered }));
+    }
+
+    for (const QLowEnergyServiceData &data : qAsConst(serviceData)) {
+        const QSharedPointer<QLowEnergyService> service = services.value(data.uuid());
+        QVERIFY(service);
+        QCOMPARE(service->state(), QLowEnergyService::RemoteServiceDiscovered);
+        const QList<QLowEnergyCharacteristic> characteristics = service->characteristics();
+        QCOMPARE(characteristics.size(), data.characteristics().size());
+        for (int i = 0; i < characteristics.size(); ++i) {
+            QCOMPARE(characteristics.at(i).uuid(), data.characteristics().at(i).uuid());
+            QCOMPARE(characteristics.at(i).value(), data.characteristics().at(i).value());
+            QVERIFY(characteristics.at(i).clientCharacteristicConfiguration().isValid());
+        }
+    }
+
+    // with every service discovered, only the final signal is emitted
+    signalOrder.clear();
+    central->discoverAllServiceDetails();
+    QTRY_COMPARE(signalOrder.size(), 1);
+    QVERIFY(signalOrder.first().first.isNull());
+}
+
+void tst_QLowEnergyControllerLoopback::subscriptions()
+{
+#ifdef QT_BUILD_INTERNAL
+    const QBluetoothUuid bothUuid(quint32(0xa1b60000));
+    const QBluetoothUuid notifyUuid(quint32(0xa1b60001));
+    QLowEnergyServiceData serviceData;
+    serviceData.setType(QLowEnergyServiceData::ServiceTypePrimary);
+    serviceData.setUuid(serviceUuid);
+    for (const QBluetoothUuid &uuid : { bothUuid, notifyUuid }) {
+        QLowEnergyCharacteristicData characteristic;
+        characteristic.setUuid(uuid);
+        characteristic.setProperties(uuid == bothUuid
+                ? QLowEnergyCharacteristic::Read | QLowEnergyCharacteristic::Notify
+                        | QLowEnergyCharacteristic::Indicate
+                : QLowEnergyCharacteristic::Read | QLowEnergyCharacteristic::Notify);
+        characteristic.setValue(QByteArray("initial"));
+        characteristic.addDescriptor(QLowEnergyDescriptorData(
+                QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration,
+                QByteArray(2, 0)));
+        serviceData.addCharacteristic(characteristic);
+    }
+
+    QScopedPointer<QLowEnergyController> peripheral(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::PeripheralRole));
+    QScopedPointer<QLowEnergyService> localService(peripheral->addService(serviceData));
+    QVERIFY(localService);
+    const auto localConfiguration = [&localService](const QBluetoothUuid &uuid) {
+        return localService->characteristic(uuid).clientCharacteristicConfiguration().value();
+    };
+
+    QScopedPointer<QLowEnergyController> central(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::CentralRole));
+    QList<QByteArray> sentPdus;
+    QLowEnergyControllerPrivateBluez::setLoopbackPacketFilter(
+            central.data(), [&sentPdus](QByteArray &pdu) { sentPdus << pdu; });
+    QList<quint8> updateOpCodes;
+    QLowEnergyControllerPrivateBluez::setLoopbackPacketFilter(
+            peripheral.data(), [&updateOpCodes](QByteArray &pdu) {
+                const auto opCode = static_cast<QBluezConst::AttCommand>(pdu.at(0));
+                if (opCode == QBluezConst::AttCommand::ATT_OP_HANDLE_VAL_NOTIFICATION
+                        || opCode == QBluezConst::AttCommand::ATT_OP_HANDLE_VAL_INDICATION) {
+                    updateOpCodes << quint8(opCode);
+                }
+            });
+    const auto writeRequests = [&sentPdus]() {
+        return int(std::count_if(sentPdus.cbegin(), sentPdus.cend(), [](const QByteArray &pdu) {
+            return static_cast<QBluezConst::AttCommand>(pdu.at(0))
+                    == QBluezConst::AttCommand::ATT_OP_WRITE_REQUEST;
+        }));
+    };
+
+    QScopedPointer<QLowEnergyService> service;
+    const auto connectAndDiscover = [&]() {
+        QVERIFY(QLowEnergyControllerPrivateBluez::connectLoopback(central.data(),
+                                                                  peripheral.data(), 23));
+        central->discoverServices();
+        QTRY_COMPARE(central->state(), QLowEnergyController::DiscoveredState);
+        service.reset(central->createServiceObject(serviceUuid));
+        QVERIFY(service);
+        service->discoverDetails();
+        QTRY_COMPARE(service->state(), QLowEnergyService::RemoteServiceDiscovered);
+    };
+    const auto reconnect = [&]() {
+        central->disconnectFromDevice();
+        QTRY_COMPARE(peripheral->state(), QLowEnergyController::UnconnectedState);
+        QTRY_COMPARE(central->state(), QLowEnergyController::UnconnectedState);
+        sentPdus.clear();
+        connectAndDiscover();
+    };
+
+    connectAndDiscover();
+    if (QTest::currentTestFailed())
+        return;
+
+    // the mode selects the CCCD value
+    QSignalSpy writtenSpy(service.data(), &QLowEnergyService::descriptorWritten);
+    service->subscribe({ service->characteristic(bothUuid) },
+                       QLowEnergyService::IndicationSubscription);
+    service->subscribe({ service->characteristic(notifyUuid) });
+    QTRY_COMPARE(writtenSpy.count(), 2);
+    QCOMPARE(writtenSpy.at(0).at(1).toByteArray(), QByteArray::fromHex("0200"));
+    QCOMPARE(writtenSpy.at(1).at(1).toByteArray(), QByteArray::fromHex("0100"));
+    QCOMPARE(localConfiguration(bothUuid), QByteArray::fromHex("0200"));
+    QCOMPARE(localConfiguration(notifyUuid), QByteArray::fromHex("0100"));
+
+    // value changes are sent as indication and notification respectively
+    QSignalSpy changedSpy(service.data(), &QLowEnergyService::characteristicChanged);
+    localService->writeCharacteristic(localService->characteristic(bothUuid),
+                                      QByteArray("indicated"));
+    localService->writeCharacteristic(localService->characteristic(notifyUuid),
+                                      QByteArray("notified"));
+    QTRY_COMPARE(changedSpy.count(), 2);
+    QCOMPARE(updateOpCodes,
+             QList<quint8>({ quint8(QBluezConst::AttCommand::ATT_OP_HANDLE_VAL_INDICATION),
+                             quint8(QBluezConst::AttCommand::ATT_OP_HANDLE_VAL_NOTIFICATION) }));
+
+    // descriptors holding the requested value already are not written again,
+    // unsupported modes are refused
+    QSignalSpy errorSpy(service.data(), &QLowEnergyService::errorOccurred);
+    sentPdus.clear();
+    service->subscribe({ service->characteristic(bothUuid), service->characteristic(bothUuid) },
+                       QLowEnergyService::IndicationSubscription);
+    service->subscribe({ service->characteristic(notifyUuid) },
+                       QLowEnergyService::IndicationSubscription);
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(service->error(), QLowEnergyService::OperationError);
+    QTest::qWait(50);
+    QCOMPARE(writeRequests(), 0);
+    QCOMPARE(localConfiguration(notifyUuid), QByteArray::fromHex("0100"));
+
+    // The peripheral drops the configuration of unbonded clients, so both
+    // subscriptions are written again once the service is rediscovered.
+    reconnect();
+    if (QTest::currentTestFailed())
+        return;
+    QTRY_COMPARE(localConfiguration(bothUuid), QByteArray::fromHex("0200"));
+    QTRY_COMPARE(localConfiguration(notifyUuid), QByteArray::fromHex("0100"));
+    QCOMPARE(writeRequests(), 2);
+
+    // unsubscribed characteristics are not restored
+    service->subscribe({ service->characteristic(notifyUuid) }, QLowEnergyService::NoSubscription);
+    QTRY_COMPARE(localConfiguration(notifyUuid), QByteArray(2, 0));
+    reconnect();
+    if (QTest::currentTestFailed())
+        return;
+    QTRY_COMPARE(localConfiguration(bothUuid), QByteArray::fromHex("0200"));
+    QTest::qWait(50);
+    QCOMPARE(writeRequests(), 1);
+    QCOMPARE(localConfiguration(notifyUuid), QByteArray(2, 0));
+
+    // the restored subscription delivers indications again
+    updateOpCodes.clear();
+    QSignalSpy restoredSpy(service.data(), &QLowEnergyService::characteristicChanged);
+    localService->writeCharacteristic(localService->characteristic(bothUuid),
+                                      QByteArray("again"));
+    QTRY_COMPARE(restoredSpy.count(), 1);
+    QCOMPARE(updateOpCodes,
+             QList<quint8>({ quint8(QBluezConst::AttCommand::ATT_OP_HANDLE_VAL_INDICATION) }));
+
+    // a bonded peripheral keeps the configuration, which the central does not rewrite
+    QTemporaryDir keys;
+    QVERIFY(keys.isValid());
+    QLowEnergyControllerPrivateBluez::setLoopbackKeySettingsDirectory(peripheral.data(),
+                                                                      keys.path());
+    reconnect();
+    if (QTest::currentTestFailed())
+        return;
+    QCOMPARE(service->characteristic(bothUuid).clientCharacteristicConfiguration().value(),
+             QByteArray::fromHex("0200"));
+    QTest::qWait(50);
+    QCOMPARE(writeRequests(), 0);
+    QCOMPARE(localConfiguration(bothUuid), QByteArray::fromHex("0200"));
+#else
+    QSKIP("Packet filters and loopback key settings require a developer build");
+#endif
+}
+
+void tst_QLowEnergyControllerLoopback::notificationQueue()
+{
+    QScopedPointer<QLowEnergyController> peripheral(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::PeripheralRole));
+    QScopedPointer<QLowEnergyService> localService(peripheral->addService(createServiceData()));
+    QVERIFY(localService);
+    const auto notify = [&localService](const QByteArray &value) {
+        localService->writeCharacteristic(localService->characteristic(characteristicUuid), value);
+    };
+
+    QScopedPointer<QLowEnergyController> central(
+            QLowEnergyControllerPrivateBluez::createLoopbackController(
+                    QLowEnergyController::CentralRole));
+    QVERIFY(QLowEnergyControllerPrivateBluez::connectLoopback(central.data(), peripheral.data(),
+                                                              23));
+    central->discoverServices();
+    QTRY_COMPARE(central->state(), QLowEnergyController::DiscoveredState);
+
+    QScopedPointer<QLowEnergyService> service(central->createServiceObject(serviceUuid));
+    QVERIFY(service);
+    service->discoverDetails();
+    QTRY_COMPARE(service->state(), QLowEnergyService::RemoteServiceDiscovered);
+    const QLowEnergyCharacteristic characteristic = service->characteristic(characteristicUuid);
+    service->subscribe({ characteristic });
+    QTRY_COMPARE(localService->characteristic(characteristicUuid)
+                         .clientCharacteristicConfiguration().value(),
+                 QByteArray::fromHex("0100"));
+
+    QLowEnergyNotificationQueue queue(8);
+    service->setNotificationQueue(&queue);
+    QCOMPARE(service->notificationQueue(), &queue);
+
+    // notifications arrive in the queue and through the signal
+    QSignalSpy changedSpy(service.data(), &QLowEnergyService::characteristicChanged);
+    const qint64 before = QDeadlineTimer::current().deadlineNSecs();
+    notify(QByteArray("first"));
+    notify(QByteArray("second"));
+    QTRY_COMPARE(changedSpy.count(), 2);
+    const auto notifications = queue.dequeueAll();
+    QCOMPARE(notifications.size(), qsizetype(2));
+    for (const auto &notification : notifications) {
+        QCOMPARE(notification.handle, characteristic.handle());
+        QVERIFY(notification.timestamp >= before);
+    }
+    QCOMPARE(notifications.at(0).value, QByteArray("first"));
+    QCOMPARE(notifications.at(1).value, QByteArray("second"));
+
+    // another service object shares the queue, destroying it keeps the queue attached
+    QScopedPointer<QLowEnergyService> second(central->createServiceObject(serviceUuid));
+    QVERIFY(second);
+    QCOMPARE(second->notificationQueue(), &queue);
+    second.reset();
+    notify(QByteArray("third"));
+    QTRY_COMPARE(changedSpy.count(), 3);
+    QCOMPARE(queue.size(), qsizetype(1));
+
+    // detaching stops the queue from receiving anything
+    service->setNotificationQueue(nullptr);
+    QCOMPARE(service->notificationQueue(), nullptr);
+    notify(QByteArray("fourth"));
+    QTRY_COMPARE(changedSpy.count(), 4);
+    QCOMPARE(queue.enqueuedCount(), quint64(3));
+
+    // as does destroying the service object which attached it, even though
+    // the controller keeps the service
+    QScopedPointer<QLowEnergyNotificationQueue> shortLived(new QLowEnergyNotificationQueue(8));
+    service->setNotificationQueue(shortLived.data());
+    service.reset();
+    shortLived.reset();
+    QScopedPointer<QLowEnergyService> third(central->createServiceObject(serviceUuid));
+    QVERIFY(third);
+    QCOMPARE(third->notificationQueue(), nullptr);
+    QSignalSpy thirdChangedSpy(third.data(), &QLowEnergyService::characteristicChanged);
+    notify(QByteArray("fifth"));
+    QTRY_COMPARE(thirdChangedSpy.count(), 1);
+    QCOMPARE(queue.enqueuedCount(), quint64(3));
+}
+
+QTEST_MAIN(tst_QLowEnergyControllerLoopback)
+
+#include "tst_qlowenergycontrollerloopback.moc"
@@ -0,0 +1,164 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtBluetooth/qlowenergynotificationqueue.h>
+#include <QtCore/QThread>
+
+class tst_QLowEnergyNotificationQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void capacity();
+    void fifo();
+    void dropNewest();
+    void dropOldest();
+    void crossThread();
+};
+
+void tst_QLowEnergyNotificationQueue::capacity()
+{
+    QCOMPARE(QLowEnergyNotificationQueue(1).capacity(), qsizetype(2));
+    QCOMPARE(QLowEnergyNotificationQueue(8).capacity(), qsizetype(8));
+    QCOMPARE(QLowEnergyNotificationQueue(9).capacity(), qsizetype(16));
+    QCOMPARE(QLowEnergyNotificationQueue(4).overflowPolicy(),
+             QLowEnergyNotificationQueue::DropNewest);
+    QCOMPARE(QLowEnergyNotificationQueue(4, QLowEnergyNotificationQueue::DropOldest)
+                     .overflowPolicy(),
+             QLowEnergyNotificationQueue::DropOldest);
+}
+
+void tst_QLowEnergyNotificationQueue::fifo()
+{
+    QLowEnergyNotificationQueue queue(8);
+    QVERIFY(queue.isEmpty());
+    QVERIFY(queue.dequeueAll().isEmpty());
+
+    const qint64 before = QDeadlineTimer::current().deadlineNSecs();
+    QVERIFY(queue.enqueue(0x10, QByteArray("a")));
+    QVERIFY(queue.enqueue(0x20, QByteArray("b")));
+    QVERIFY(queue.enqueue(0x10, QByteArray("c")));
+    QCOMPARE(queue.size(), qsizetype(3));
+
+    QLowEnergyNotificationQueue::Notification notifications[2];
+    QCOMPARE(queue.dequeue(notifications, 2), qsizetype(2));
+    QCOMPARE(notifications[0].handle, QLowEnergyHandle(0x10));
+    QCOMPARE(notifications[0].value, QByteArray("a"));
+    QVERIFY(notifications[0].timestamp >= before);
+    QCOMPARE(notifications[1].handle, QLowEnergyHandle(0x20));
+    QCOMPARE(notifications[1].value, QByteArray("b"));
+    QVERIFY(notifications[1].timestamp >= notifications[0].timestamp);
+
+    const auto rest = queue.dequeueAll();
+    QCOMPARE(rest.size(), qsizetype(1));
+    QCOMPARE(rest.first().value, QByteArray("c"));
+    QVERIFY(queue.isEmpty());
+
+    QCOMPARE(queue.enqueuedCount(), quint64(3));
+    QCOMPARE(queue.dequeuedCount(), quint64(3));
+    QCOMPARE(queue.droppedCount(), quint64(0));
+}
+
+void tst_QLowEnergyNotificationQueue::dropNewest()
+{
+    QLowEnergyNotificationQueue queue(4, QLowEnergyNotificationQueue::DropNewest);
+    for (int i = 0; i < 6; ++i)
+        QCOMPARE(queue.enqueue(QLowEnergyHandle(i), QByteArray::number(i)), i < 4);
+
+    const auto notifications = queue.dequeueAll();
+    QCOMPARE(notifications.size(), qsizetype(4));
+    for (int i = 0; i < 4; ++i)
+        QCOMPARE(notifications.at(i).handle, QLowEnergyHandle(i));
+    QCOMPARE(queue.enqueuedCount(), quint64(6));
+    QCOMPARE(queue.droppedCount(), quint64(2));
+    QCOMPARE(queue.dequeuedCount(), quint64(4));
+
+    // there is room again
+    QVERIFY(queue.enqueue(0x42, QByteArray()));
+    QCOMPARE(queue.size(), qsizetype(1));
+}
+
+void tst_QLowEnergyNotificationQueue::dropOldest()
+{
+    QLowEnergyNotificationQueue queue(4, QLowEnergyNotificationQueue::DropOldest);
+    for (int i = 0; i < 6; ++i)
+        QVERIFY(queue.enqueue(QLowEnergyHandle(i), QByteArray::number(i)));
+
+    const auto notifications = queue.dequeueAll();
+    QCOMPARE(notifications.size(), qsizetype(4));
+    for (int i = 0; i < 4; ++i)
+        QCOMPARE(notifications.at(i).value, QByteArray::number(i + 2));
+    QCOMPARE(queue.enqueuedCount(), quint64(6));
+    QCOMPARE(queue.droppedCount(), quint64(2));
+    QCOMPARE(queue.dequeuedCount(), quint64(4));
+}
+
+void tst_QLowEnergyNotificationQueue::crossThread()
+{
+    const int count = 100000;
+    QLowEnergyNotificationQueue queue(64, QLowEnergyNotificationQueue::DropOldest);
+
+    QScopedPointer<QThread> producer(QThread::create([&queue]() {
+        for (int i = 0; i < count; ++i)
+            queue.enqueue(QLowEnergyHandle(i), QByteArray::number(i));
+    }));
+    producer->start();
+
+    // whatever survives arrives in order and intact
+    QList<QLowEnergyNotificationQueue::Notification> batch(16);
+    int received = 0;
+    int last = -1;
+    bool ordered = true;
+    const auto drain = [&]() {
+        const qsizetype n = queue.dequeue(batch.data(), batch.size());
+        for (qsizetype i = 0; i < n; ++i) {
+            const int value = batch.at(i).value.toInt();
+            ordered = ordered && value > last && batch.at(i).handle == QLowEnergyHandle(value);
+            last = value;
+        }
+        received += int(n);
+    };
+    while (!producer->isFinished())
+        drain();
+    QVERIFY(producer->wait());
+    while (!queue.isEmpty())
+        drain();
+
+    QVERIFY(ordered);
+    QVERIFY(queue.isEmpty());
+    QVERIFY(last < count);
+    QCOMPARE(queue.dequeuedCount(), quint64(received));
+    QCOMPARE(queue.droppedCount() + queue.dequeuedCount(), quint64(count));
+    QCOMPARE(queue.enqueuedCount(), quint64(count));
+}
+
+QTEST_MAIN(tst_QLowEnergyNotificationQueue)
+
+#include "tst_qlowenergynotificationqueue.moc"
@@ -29,6 +29,7 @@
 #include <QtTest/QtTest>
 
 #include <QtBluetooth/qlowenergyservice.h>
+#include <QtBluetooth/private/qlowenergyhandlemap_p.h>
 
 
 /*
@@ -44,6 +45,7 @@ class tst_QLowEnergyService : public QObject
 
 private slots:
     void tst_flags();
+    void tst_handleMap();
 };
 
 void tst_QLowEnergyService::tst_flags()
@@ -68,6 +70,70 @@ void tst_QLowEnergyService::tst_flags()
     QVERIFY(result.testFlag(QLowEnergyService::IncludedService));
 }
 
+void tst_QLowEnergyService::tst_handleMap()
+{
+    struct Attribute {
+        QBluetoothUuid uuid;
+        QByteArray value;
+    };
+    const QBluetoothUuid cccd(QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration);
+    const QBluetoothUuid format(QBluetoothUuid::DescriptorType::CharacteristicPresentationFormat);
+
+    QLowEnergyHandleMap<Attribute> map;
+    QVERIFY(map.isEmpty());
+    QCOMPARE(map.findByUuid(cccd), map.constEnd());
+
+    // out of order insertion still iterates in handle order
+    map.insert(0x20, { format, QByteArray("b") });
+    map.insert(0x10, { cccd, QByteArray("a") });
+    map[0x18] = { cccd, QByteArray("c") };
+    QCOMPARE(map.keys(), QList<QLowEnergyHandle>({ 0x10, 0x18, 0x20 }));
+    QCOMPARE(map.indexOf(0x18), qsizetype(1));
+    QCOMPARE(map.indexOf(0x19), qsizetype(-1));
+    QCOMPARE(map.keyAt(2), QLowEnergyHandle(0x20));
+
+    QList<QByteArray> values;
+    for (const Attribute &attribute : qAsConst(map))
+        values.append(attribute.value);
+    QCOMPARE(values, QList<QByteArray>({ "a", "c", "b" }));
+
+    // uuid lookup returns the lowest handle
+    QCOMPARE(map.findByUuid(cccd).key(), QLowEnergyHandle(0x10));
+    QCOMPARE(map.findByUuid(format).key(), QLowEnergyHandle(0x20));
+    map.remove(0x10);
+    QCOMPARE(map.findByUuid(cccd).key(), QLowEnergyHandle(0x18));
+
+    // replacing an entry updates the uuid lookup
+    map.insert(0x18, { format, QByteArray("c") });
+    QCOMPARE(map.findByUuid(format).key(), QLowEnergyHandle(0x18));
+    QCOMPARE(map.findByUuid(cccd), map.constEnd());
+
+    // uuids assigned through the reference returned by operator[]()
+    map[0x08].uuid = cccd;
+    QCOMPARE(map.findByUuid(cccd).key(), QLowEnergyHandle(0x08));
+    map[0x18].uuid = cccd;
+    QCOMPARE(map.findByUuid(cccd).key(), QLowEnergyHandle(0x08));
+    QCOMPARE(map.findByUuid(format).key(), QLowEnergyHandle(0x20));
+    map.remove(0x08);
+    QCOMPARE(map.findByUuid(cccd).key(), QLowEnergyHandle(0x18));
+    QCOMPARE(map.findByUuid(format).key(), QLowEnergyHandle(0x20));
+    map.insert(0x18, { format, QByteArray("c") });
+    QCOMPARE(map.findByUuid(format).key(), QLowEnergyHandle(0x18));
+
+    // closest preceding attribute
+    QCOMPARE(map.upperBound(0x17), map.constBegin());
+    QCOMPARE(map.upperBound(0x18).key(), QLowEnergyHandle(0x20));
+    QCOMPARE(map.upperBound(0xffff), map.constEnd());
+
+    QVERIFY(map.contains(0x20));
+    QCOMPARE(map.value(0x20).value, QByteArray("b"));
+    QVERIFY(map.value(0x21).value.isEmpty());
+
+    map.clear();
+    QVERIFY(map.isEmpty());
+    QCOMPARE(map.findByUuid(format), map.constEnd());
+}
+
 QTEST_MAIN(tst_QLowEnergyService)
 
 #include "tst_qlowenergyservice.moc"
@@ -34,6 +34,8 @@
 #include <QNdefNfcUriRecord>
 #include <QNdefMessage>
 
+#include <private/qndeffilter_p.h>
+
 QT_USE_NAMESPACE
 
 class tst_QNdefFilter : public QObject
@@ -59,6 +61,9 @@ private slots:
 
     void match();
     void match_data();
+
+    void matchMultipleFilters();
+    void matchMultipleFilters_data();
 };
 
 void tst_QNdefFilter::construct()
@@ -503,6 +508,38 @@ void tst_QNdefFilter::match_data()
     }
 }
 
+void tst_QNdefFilter::matchMultipleFilters()
+{
+    QFETCH(QNdefFilter, filter);
+    QFETCH(QNdefMessage, message);
+    QFETCH(bool, result);
+
+    QNdefFilter unordered = filter;
+    unordered.setOrderMatch(false);
+    QNdefFilter ordered = filter;
+    ordered.setOrderMatch(true);
+
+    const QNdefFilterMatcher matcher({ filter, QNdefFilter(), unordered, ordered });
+    QCOMPARE(matcher.filterCount(), qsizetype(4));
+
+    QList<qsizetype> expected;
+    if (result)
+        expected.append(0);
+    if (message.isEmpty())
+        expected.append(1);
+    if (unordered.match(message))
+        expected.append(2);
+    if (ordered.match(message))
+        expected.append(3);
+
+    QCOMPARE(matcher.match(message), expected);
+}
+
+void tst_QNdefFilter::matchMultipleFilters_data()
+{
+    match_data();
+}
+
 QTEST_MAIN(tst_QNdefFilter)
 
 #include "tst_qndeffilter.moc"
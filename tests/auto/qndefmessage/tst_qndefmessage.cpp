@@ -32,6 +32,8 @@
 #include <qndefmessage.h>
 #include <qndefnfctextrecord.h>
 #include <qndefnfcurirecord.h>
+#include <private/qndefmessageview_p.h>
+#include <private/qndefmessagewriter_p.h>
 
 QT_USE_NAMESPACE
 
@@ -53,6 +55,10 @@ private slots:
     void parseCorruptedMessage();
     void parseCorruptedMessage_data();
     void parseComplexMessage();
+    void messageView_data();
+    void messageView();
+    void writeChunked_data();
+    void writeChunked();
 };
 
 tst_QNdefMessage::tst_QNdefMessage()
@@ -758,6 +764,139 @@ void tst_QNdefMessage::parseComplexMessage()
 
 }
 
+void tst_QNdefMessage::messageView_data()
+{
+    parseSingleRecordMessage_data();
+}
+
+void tst_QNdefMessage::messageView()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QNdefMessage, message);
+
+    const bool truncated = QByteArray(QTest::currentDataTag()).startsWith("truncated ");
+    if (truncated)
+        QTest::ignoreMessage(QtWarningMsg, "Unexpected end of message");
+
+    QNdefMessageView view(data);
+    QCOMPARE(view.isValid(), !truncated);
+    QVERIFY(view.toMessage() == message);
+
+    if (view.isValid()) {
+        QCOMPARE(view.data().toByteArray(), data);
+
+        qsizetype size = 0;
+        for (const QNdefRecordView &record : view) {
+            QCOMPARE(record.isMessageBegin(), size == 0);
+            size += record.size();
+            QCOMPARE(record.isMessageEnd(), size == data.size());
+            if (record.isChunkContinuation())
+                QVERIFY(record.type().isEmpty());
+        }
+        QCOMPARE(size, data.size());
+
+        if (!message.isEmpty()) {
+            const QNdefRecord &record = message.first();
+            const QNdefRecordView &recordView = *view.begin();
+            QCOMPARE(recordView.typeNameFormat(), record.typeNameFormat());
+            QCOMPARE(recordView.type().toByteArray(), record.type());
+            QCOMPARE(recordView.id().toByteArray(), record.id());
+        }
+    }
+
+    // Feed the data as it would arrive from a tag, one byte at a time
+    QNdefMessageParser parser;
+    for (char byte : std::as_const(data)) {
+        QCOMPARE(parser.status(), QNdefMessageParser::Status::NeedMoreData);
+        parser.append(QByteArrayView(&byte, 1));
+    }
+
+    if (truncated) {
+        QCOMPARE(parser.status(), QNdefMessageParser::Status::NeedMoreData);
+        QVERIFY(!parser.message().isValid());
+    } else {
+        QCOMPARE(parser.status(), QNdefMessageParser::Status::Complete);
+        QCOMPARE(parser.message().recordCount(), view.recordCount());
+        QVERIFY(parser.message().toMessage() == message);
+    }
+}
+
+void tst_QNdefMessage::writeChunked_data()
+{
+    QTest::addColumn<int>("payloadSize");
+    QTest::addColumn<int>("chunkSize");
+    QTest::addColumn<int>("expectedChunks");
+
+    QTest::newRow("no chunking") << 1000 << 0 << 1;
+    QTest::newRow("payload fits") << 1000 << 1000 << 1;
+    QTest::newRow("even chunks") << 1000 << 100 << 10;
+    QTest::newRow("short last chunk") << 1000 << 300 << 4;
+    QTest::newRow("long chunks") << 70000 << 4096 << 18;
+    QTest::newRow("empty payload") << 0 << 16 << 1;
+}
+
+void tst_QNdefMessage::writeChunked()
+{
+    QFETCH(int, payloadSize);
+    QFETCH(int, chunkSize);
+    QFETCH(int, expectedChunks);
+
+    QByteArray payload(payloadSize, Qt::Uninitialized);
+    for (int i = 0; i < payloadSize; ++i)
+        payload[i] = char(i);
+
+    QNdefRecord first;
+    first.setTypeNameFormat(QNdefRecord::Mime);
+    first.setType("application/octet-stream");
+    first.setId("id");
+    first.setPayload(payload);
+
+    QNdefNfcTextRecord second;
+    second.setText(QStringLiteral("after the chunked record"));
+
+    QNdefMessage message;
+    message.append(first);
+    message.append(second);
+
+    QNdefMessageWriter writer(message, chunkSize);
+    const QByteArray encoded = writer.toByteArray();
+    QCOMPARE(encoded.size(), writer.encodedSize());
+    if (chunkSize == 0)
+        QCOMPARE(encoded, message.toByteArray());
+
+    QByteArray appended("prefix");
+    writer.appendTo(appended);
+    QCOMPARE(appended, "prefix" + encoded);
+
+    QByteArray streamed;
+    QVERIFY(writer.write([&streamed](QByteArrayView data) {
+        streamed.append(data);
+        return true;
+    }));
+    QCOMPARE(streamed, encoded);
+
+    const QNdefMessageView view(encoded);
+    QVERIFY(view.isValid());
+    QCOMPARE(view.recordCount(), qsizetype(2));
+    int chunks = 0;
+    for (const QNdefRecordView &record : view) {
+        if (record.typeNameFormat() == QNdefRecord::Mime) {
+            ++chunks;
+            if (chunkSize > 0)
+                QVERIFY(record.payload().size() <= chunkSize);
+        }
+    }
+    QCOMPARE(chunks, expectedChunks);
+
+    const QNdefMessage parsed = QNdefMessage::fromByteArray(encoded);
+    QCOMPARE(parsed.size(), 2);
+    QCOMPARE(parsed.at(0).typeNameFormat(), QNdefRecord::Mime);
+    QCOMPARE(parsed.at(0).type(), first.type());
+    QCOMPARE(parsed.at(0).id(), first.id());
+    QCOMPARE(parsed.at(0).payload(), payload);
+    QVERIFY(parsed.at(1) == second);
+}
+
 QTEST_MAIN(tst_QNdefMessage)
 
 #include "tst_qndefmessage.moc"
@@ -104,6 +104,7 @@ private slots:
     void tst_typeInfo();
     void tst_construct();
     void tst_downcast();
+    void tst_deferredEncoding();
 };
 
 tst_QNdefNfcSmartPosterRecord::tst_QNdefNfcSmartPosterRecord()
@@ -567,6 +568,62 @@ void tst_QNdefNfcSmartPosterRecord::tst_downcast()
     QCOMPARE(basePayload, spPayload);
 }
 
+void tst_QNdefNfcSmartPosterRecord::tst_deferredEncoding()
+{
+    const QByteArray pngData(64 * 1024, 'p');
+    const QByteArray jpegData(32 * 1024, 'j');
+
+    QNdefNfcSmartPosterRecord record;
+    record.setUri(QUrl("http://qt.io"));
+    record.addIcon("image/png", pngData);
+    record.addIcon("image/jpeg", jpegData);
+    for (const QString &locale : _textRecords.keys())
+        QVERIFY(record.addTitle(getTextRecord(locale)));
+    record.setAction(QNdefNfcSmartPosterRecord::DoAction);
+
+    // Icon data is shared, not copied
+    QCOMPARE(record.icon("image/png").constData(), pngData.constData());
+    QCOMPARE(record.iconRecord(1).data().constData(), jpegData.constData());
+
+    // A copy keeps its own records when the original is edited
+    const QNdefNfcSmartPosterRecord copy = record;
+    record.removeIcon("image/png");
+    record.setSize(1024);
+    QCOMPARE(copy.iconCount(), 2);
+    QVERIFY(!copy.hasSize());
+    QCOMPARE(record.iconCount(), 1);
+    QVERIFY(record.hasSize());
+
+    // The payload is encoded when read, also through the base class
+    const QNdefRecord base = record;
+    QNdefMessage message;
+    message.append(record);
+    const QNdefNfcSmartPosterRecord decoded(QNdefMessage::fromByteArray(
+                                                   message.toByteArray()).first());
+    QCOMPARE(decoded.payload(), base.payload());
+    QCOMPARE(decoded.titleCount(), _textRecords.size());
+    QCOMPARE(decoded.uri(), QUrl("http://qt.io"));
+    QCOMPARE(decoded.action(), QNdefNfcSmartPosterRecord::DoAction);
+    QCOMPARE(decoded.size(), quint32(1024));
+    QCOMPARE(decoded.iconCount(), 1);
+    QCOMPARE(decoded.icon("image/jpeg"), jpegData);
+    QVERIFY(!decoded.hasIcon("image/png"));
+
+    const QNdefNfcSmartPosterRecord decodedCopy(
+            QNdefMessage::fromByteArray(QNdefMessage(copy).toByteArray()).first());
+    QCOMPARE(decodedCopy.iconCount(), 2);
+    QCOMPARE(decodedCopy.icon("image/png"), pngData);
+    QVERIFY(!decodedCopy.hasSize());
+
+    // Edits after reading the payload are encoded again
+    record.setPayload(QByteArray());
+    QVERIFY(record.payload().isEmpty());
+    QVERIFY(!record.hasTitle());
+    record.setTypeInfo("text/html");
+    QVERIFY(!record.payload().isEmpty());
+    QCOMPARE(QNdefNfcSmartPosterRecord(QNdefRecord(record)).typeInfo(), QString("text/html"));
+}
+
 QTEST_MAIN(tst_QNdefNfcSmartPosterRecord)
 
 #include "tst_qndefnfcsmartposterrecord.moc"
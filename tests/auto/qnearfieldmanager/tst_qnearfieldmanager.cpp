@@ -59,6 +59,10 @@ private slots:
 
     void targetDetected_data();
     void targetDetected();
+
+    void ndefEncoding_data();
+    void ndefEncoding();
+    void ndefEncodingKeepsApplicationDetection();
 };
 
 tst_QNearFieldManager::tst_QNearFieldManager()
@@ -178,6 +182,87 @@ void tst_QNearFieldManager::targetDetected()
     QCOMPARE(detectionStoppedSpy.count(), 1);
 }
 
+void tst_QNearFieldManager::ndefEncoding_data()
+{
+    QTest::addColumn<QNearFieldManager::EncodingOptions>("options");
+
+    QTest::newRow("write only") << QNearFieldManager::EncodingOptions();
+    QTest::newRow("verify")
+            << QNearFieldManager::EncodingOptions(QNearFieldManager::EncodingOption::VerifyAfterWrite);
+}
+
+void tst_QNearFieldManager::ndefEncoding()
+{
+    QFETCH(QNearFieldManager::EncodingOptions, options);
+
+    QNearFieldManagerPrivateImpl *emulatorBackend = new QNearFieldManagerPrivateImpl;
+    QNearFieldManager manager(emulatorBackend, nullptr);
+
+    // Nothing to encode
+    QVERIFY(!manager.startNdefEncoding(options));
+    QVERIFY(!manager.isNdefEncodingActive());
+
+    QList<QNdefMessage> messages;
+    for (const auto &text : { u"first"_qs, u"second"_qs }) {
+        QNdefNfcTextRecord record;
+        record.setLocale(u"en"_qs);
+        record.setText(text);
+        messages.append(QNdefMessage(record));
+    }
+    manager.enqueueNdefMessages(messages);
+    QCOMPARE(manager.pendingNdefMessageCount(), 2);
+
+    QSignalSpy encodedSpy(&manager, &QNearFieldManager::ndefMessageEncoded);
+    QSignalSpy finishedSpy(&manager, &QNearFieldManager::ndefEncodingFinished);
+    QSignalSpy detectionStoppedSpy(&manager, &QNearFieldManager::targetDetectionStopped);
+
+    QVERIFY(manager.startNdefEncoding(options));
+    QVERIFY(manager.isNdefEncodingActive());
+    QVERIFY(!manager.startNdefEncoding(options));
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 15000);
+
+    QCOMPARE(encodedSpy.count(), 2);
+    for (const auto &arguments : std::as_const(encodedSpy)) {
+        QVERIFY(!arguments.at(0).toByteArray().isEmpty());
+        QVERIFY(arguments.at(1).toInt() >= 0);
+    }
+    QCOMPARE(manager.pendingNdefMessageCount(), 0);
+    QVERIFY(!manager.isNdefEncodingActive());
+    QCOMPARE(detectionStoppedSpy.count(), 1);
+}
+
+void tst_QNearFieldManager::ndefEncodingKeepsApplicationDetection()
+{
+    QNearFieldManagerPrivateImpl *emulatorBackend = new QNearFieldManagerPrivateImpl;
+    QNearFieldManager manager(emulatorBackend, nullptr);
+
+    QNdefNfcTextRecord record;
+    record.setLocale(u"en"_qs);
+    record.setText(u"text"_qs);
+    manager.enqueueNdefMessages({ QNdefMessage(record) });
+
+    QSignalSpy finishedSpy(&manager, &QNearFieldManager::ndefEncodingFinished);
+    QSignalSpy detectionStoppedSpy(&manager, &QNearFieldManager::targetDetectionStopped);
+
+    QVERIFY(manager.startTargetDetection(QNearFieldTarget::NdefAccess));
+    QVERIFY(manager.startNdefEncoding());
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 15000);
+
+    // The detection of the application is still running
+    QCOMPARE(detectionStoppedSpy.count(), 0);
+    QSignalSpy targetDetectedSpy(&manager, &QNearFieldManager::targetDetected);
+    QTRY_VERIFY_WITH_TIMEOUT(!targetDetectedSpy.isEmpty(), 15000);
+
+    manager.stopTargetDetection();
+    QCOMPARE(detectionStoppedSpy.count(), 1);
+
+    // Stopping an idle encoding station does not stop anything either
+    manager.stopNdefEncoding();
+    QCOMPARE(detectionStoppedSpy.count(), 1);
+}
+
 QTEST_MAIN(tst_QNearFieldManager)
 
 // Unset the moc namespace which is not required for the following include.
@@ -0,0 +1,187 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtNfc/private/qnearfieldtarget_p.h>
+#include <QtNfc/qnearfieldtarget.h>
+
+QT_USE_NAMESPACE
+
+// Completes requests only when told to
+class TestTargetPrivate : public QNearFieldTargetPrivate
+{
+public:
+    QNearFieldTarget::RequestId sendCommand(const QByteArray &) override
+    {
+        return QNearFieldTarget::RequestId(new QNearFieldTarget::RequestIdPrivate);
+    }
+
+    void completeRequest(const QNearFieldTarget::RequestId &id, const QVariant &response)
+    {
+        setResponseForRequest(id, response);
+    }
+};
+
+class tst_QNearFieldTarget : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void completionInSameThread();
+    void timeoutInSameThread();
+    void targetDestroyedWhileWaiting();
+    void completionInOtherThread();
+    void timeoutInOtherThread();
+};
+
+void tst_QNearFieldTarget::completionInSameThread()
+{
+    auto priv = new TestTargetPrivate;
+    NearFieldTarget target(priv);
+    QSignalSpy completedSpy(&target, &QNearFieldTarget::requestCompleted);
+    QSignalSpy errorSpy(&target, &QNearFieldTarget::error);
+
+    const QNearFieldTarget::RequestId id = target.sendCommand(QByteArray("command"));
+    QVERIFY(id.isValid());
+    QTimer::singleShot(50, priv, [priv, id]() { priv->completeRequest(id, QByteArray("response")); });
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(target.waitForRequestCompleted(id, 5000));
+    QVERIFY(timer.elapsed() < 5000);
+    QCOMPARE(completedSpy.count(), 1);
+    QCOMPARE(target.requestResponse(id).toByteArray(), QByteArray("response"));
+
+    // completed requests return right away
+    timer.restart();
+    QVERIFY(target.waitForRequestCompleted(id, 5000));
+    QVERIFY(timer.elapsed() < 1000);
+
+    QTest::qWait(50);
+    QVERIFY(errorSpy.isEmpty());
+}
+
+void tst_QNearFieldTarget::timeoutInSameThread()
+{
+    auto priv = new TestTargetPrivate;
+    NearFieldTarget target(priv);
+    QSignalSpy completedSpy(&target, &QNearFieldTarget::requestCompleted);
+    QSignalSpy errorSpy(&target, &QNearFieldTarget::error);
+
+    const QNearFieldTarget::RequestId id = target.sendCommand(QByteArray("command"));
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!target.waitForRequestCompleted(id, 100));
+    QVERIFY(timer.elapsed() >= 100);
+
+    // the timeout is reported asynchronously
+    QVERIFY(errorSpy.isEmpty());
+    QTRY_COMPARE(errorSpy.count(), 1);
+    QCOMPARE(errorSpy.first().at(0).value<QNearFieldTarget::Error>(),
+             QNearFieldTarget::TimeoutError);
+    QCOMPARE(errorSpy.first().at(1).value<QNearFieldTarget::RequestId>(), id);
+    QVERIFY(completedSpy.isEmpty());
+}
+
+void tst_QNearFieldTarget::targetDestroyedWhileWaiting()
+{
+    auto priv = new TestTargetPrivate;
+    auto target = new NearFieldTarget(priv);
+
+    const QNearFieldTarget::RequestId id = target->sendCommand(QByteArray("command"));
+    QTimer::singleShot(50, target, &QObject::deleteLater);
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!target->waitForRequestCompleted(id, 5000));
+    QVERIFY(timer.elapsed() < 5000);
+}
+
+void tst_QNearFieldTarget::completionInOtherThread()
+{
+    auto priv = new TestTargetPrivate;
+    NearFieldTarget target(priv);
+    QSignalSpy errorSpy(&target, &QNearFieldTarget::error);
+
+    const QNearFieldTarget::RequestId id = target.sendCommand(QByteArray("command"));
+
+    QAtomicInt waiting = 0;
+    bool completed = false;
+    qint64 elapsed = 0;
+    QScopedPointer<QThread> waiter(QThread::create([&]() {
+        QElapsedTimer timer;
+        timer.start();
+        waiting.storeRelease(1);
+        completed = target.waitForRequestCompleted(id, 5000);
+        elapsed = timer.elapsed();
+    }));
+    waiter->start();
+
+    // the waiter sleeps, the completion in the target thread wakes it up
+    QTRY_COMPARE(waiting.loadAcquire(), 1);
+    QTest::qWait(50);
+    QVERIFY(!waiter->isFinished());
+    priv->completeRequest(id, QByteArray("response"));
+
+    QVERIFY(waiter->wait(5000));
+    QVERIFY(completed);
+    QVERIFY(elapsed < 5000);
+    QCOMPARE(target.requestResponse(id).toByteArray(), QByteArray("response"));
+
+    QTest::qWait(50);
+    QVERIFY(errorSpy.isEmpty());
+}
+
+void tst_QNearFieldTarget::timeoutInOtherThread()
+{
+    auto priv = new TestTargetPrivate;
+    NearFieldTarget target(priv);
+    QSignalSpy errorSpy(&target, &QNearFieldTarget::error);
+
+    const QNearFieldTarget::RequestId id = target.sendCommand(QByteArray("command"));
+
+    bool completed = true;
+    QScopedPointer<QThread> waiter(QThread::create([&]() {
+        completed = target.waitForRequestCompleted(id, 100);
+    }));
+    waiter->start();
+    QVERIFY(waiter->wait(5000));
+    QVERIFY(!completed);
+
+    // the timeout is reported in the thread of the target
+    QVERIFY(errorSpy.isEmpty());
+    QTRY_COMPARE(errorSpy.count(), 1);
+    QCOMPARE(errorSpy.first().at(0).value<QNearFieldTarget::Error>(),
+             QNearFieldTarget::TimeoutError);
+    QCOMPARE(errorSpy.first().at(1).value<QNearFieldTarget::RequestId>(), id);
+}
+
+QTEST_MAIN(tst_QNearFieldTarget)
+
+#include "tst_qnearfieldtarget.moc"
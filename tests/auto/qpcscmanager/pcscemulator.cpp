@@ -0,0 +1,380 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "pcscemulator_p.h"
+
+#include <QtCore/QDeadlineTimer>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <winscard.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char PnpNotificationReader[] = "\\\\?PnP?\\Notification";
+
+struct Reader
+{
+    bool present = false;
+    QByteArray uid;
+    quint64 cardId = 0;
+    quint16 eventCount = 0;
+};
+
+struct Card
+{
+    QByteArray readerName;
+    quint64 cardId;
+};
+
+struct State
+{
+    QMutex mutex;
+    QWaitCondition changed;
+
+    QMap<QByteArray, Reader> readers;
+    quint16 readerListCount = 1;
+    QHash<SCARDCONTEXT, bool> contexts; // context => cancelled
+    QHash<SCARDHANDLE, Card> cards;
+    SCARDCONTEXT nextContext = 1;
+    SCARDHANDLE nextHandle = 1;
+    quint64 nextCardId = 1;
+    int connectDelay = 0;
+    int connectAttempts = 0;
+    int disconnects = 0;
+};
+
+State &state()
+{
+    static State instance;
+    return instance;
+}
+
+// Must be called with the mutex held
+bool isCardPresent(SCARDHANDLE handle)
+{
+    const auto card = state().cards.constFind(handle);
+    if (card == state().cards.cend())
+        return false;
+    const auto reader = state().readers.constFind(card->readerName);
+    return reader != state().readers.cend() && reader->present && reader->cardId == card->cardId;
+}
+
+} // namespace
+
+namespace PcscEmulator {
+
+void reset()
+{
+    QMutexLocker locker(&state().mutex);
+    state().readers.clear();
+    ++state().readerListCount;
+    state().cards.clear();
+    state().connectDelay = 0;
+    state().connectAttempts = 0;
+    state().disconnects = 0;
+    state().changed.wakeAll();
+}
+
+void addReader(const QByteArray &name)
+{
+    QMutexLocker locker(&state().mutex);
+    state().readers.insert(name, Reader());
+    ++state().readerListCount;
+    state().changed.wakeAll();
+}
+
+void removeReader(const QByteArray &name)
+{
+    QMutexLocker locker(&state().mutex);
+    state().readers.remove(name);
+    ++state().readerListCount;
+    state().changed.wakeAll();
+}
+
+void insertCard(const QByteArray &readerName, const QByteArray &uid)
+{
+    QMutexLocker locker(&state().mutex);
+    Reader &reader = state().readers[readerName];
+    reader.present = true;
+    reader.uid = uid;
+    reader.cardId = state().nextCardId++;
+    ++reader.eventCount;
+    state().changed.wakeAll();
+}
+
+void removeCard(const QByteArray &readerName)
+{
+    QMutexLocker locker(&state().mutex);
+    Reader &reader = state().readers[readerName];
+    reader.present = false;
+    ++reader.eventCount;
+    state().changed.wakeAll();
+}
+
+void setConnectDelay(int ms)
+{
+    QMutexLocker locker(&state().mutex);
+    state().connectDelay = ms;
+}
+
+int connectAttempts()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().connectAttempts;
+}
+
+int disconnects()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().disconnects;
+}
+
+int openContexts()
+{
+    QMutexLocker locker(&state().mutex);
+    return int(state().contexts.size());
+}
+
+} // namespace PcscEmulator
+
+LONG SCardEstablishContext(DWORD, LPCVOID, LPCVOID, LPSCARDCONTEXT phContext)
+{
+    QMutexLocker locker(&state().mutex);
+    *phContext = state().nextContext++;
+    state().contexts.insert(*phContext, false);
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardReleaseContext(SCARDCONTEXT hContext)
+{
+    QMutexLocker locker(&state().mutex);
+    if (!state().contexts.remove(hContext))
+        return SCARD_E_INVALID_HANDLE;
+    state().changed.wakeAll();
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardCancel(SCARDCONTEXT hContext)
+{
+    QMutexLocker locker(&state().mutex);
+    const auto context = state().contexts.find(hContext);
+    if (context == state().contexts.end())
+        return SCARD_E_INVALID_HANDLE;
+    *context = true;
+    state().changed.wakeAll();
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardListReaders(SCARDCONTEXT hContext, LPCSTR, LPSTR mszReaders, LPDWORD pcchReaders)
+{
+    QMutexLocker locker(&state().mutex);
+    if (!state().contexts.contains(hContext))
+        return SCARD_E_INVALID_HANDLE;
+    if (state().readers.isEmpty())
+        return SCARD_E_NO_READERS_AVAILABLE;
+    if (*pcchReaders != SCARD_AUTOALLOCATE)
+        return SCARD_E_INVALID_PARAMETER;
+
+    QByteArray list;
+    for (auto it = state().readers.cbegin(); it != state().readers.cend(); ++it)
+        list.append(it.key()).append('\0');
+    list.append('\0');
+
+    auto buffer = static_cast<char *>(malloc(list.size()));
+    memcpy(buffer, list.constData(), list.size());
+    *reinterpret_cast<LPSTR *>(mszReaders) = buffer;
+    *pcchReaders = DWORD(list.size());
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardFreeMemory(SCARDCONTEXT, LPCVOID pvMem)
+{
+    free(const_cast<void *>(pvMem));
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardGetStatusChange(SCARDCONTEXT hContext, DWORD dwTimeout,
+                          SCARD_READERSTATE *rgReaderStates, DWORD cReaders)
+{
+    QMutexLocker locker(&state().mutex);
+    QDeadlineTimer deadline(dwTimeout == INFINITE ? QDeadlineTimer(QDeadlineTimer::Forever)
+                                                  : QDeadlineTimer(dwTimeout));
+
+    for (;;) {
+        const auto context = state().contexts.find(hContext);
+        if (context == state().contexts.end())
+            return SCARD_E_INVALID_HANDLE;
+        if (*context) {
+            *context = false;
+            return SCARD_E_CANCELLED;
+        }
+
+        bool changed = false;
+        bool unknownReader = false;
+        for (DWORD i = 0; i < cReaders; ++i) {
+            SCARD_READERSTATE &readerState = rgReaderStates[i];
+            DWORD eventState;
+            if (strcmp(readerState.szReader, PnpNotificationReader) == 0) {
+                eventState = DWORD(state().readerListCount) << 16;
+            } else {
+                const auto reader = state().readers.constFind(readerState.szReader);
+                if (reader == state().readers.cend()) {
+                    eventState = SCARD_STATE_UNKNOWN;
+                    unknownReader = true;
+                } else {
+                    eventState = (reader->present ? SCARD_STATE_PRESENT : SCARD_STATE_EMPTY)
+                            | (DWORD(reader->eventCount) << 16);
+                }
+            }
+            if (eventState != (readerState.dwCurrentState & ~DWORD(SCARD_STATE_CHANGED))) {
+                eventState |= SCARD_STATE_CHANGED;
+                changed = true;
+            }
+            readerState.dwEventState = eventState;
+        }
+
+        if (unknownReader)
+            return SCARD_E_UNKNOWN_READER;
+        if (changed)
+            return SCARD_S_SUCCESS;
+        if (deadline.hasExpired())
+            return SCARD_E_TIMEOUT;
+        state().changed.wait(&state().mutex, deadline);
+    }
+}
+
+LONG SCardConnect(SCARDCONTEXT hContext, LPCSTR szReader, DWORD, DWORD, LPSCARDHANDLE phCard,
+                  LPDWORD pdwActiveProtocol)
+{
+    QMutexLocker locker(&state().mutex);
+    if (!state().contexts.contains(hContext))
+        return SCARD_E_INVALID_HANDLE;
+    ++state().connectAttempts;
+
+    // Slow cards only block the calling thread
+    const int delay = state().connectDelay;
+    if (delay > 0) {
+        locker.unlock();
+        QThread::msleep(delay);
+        locker.relock();
+    }
+
+    const auto reader = state().readers.constFind(szReader);
+    if (reader == state().readers.cend())
+        return SCARD_E_UNKNOWN_READER;
+    if (!reader->present)
+        return SCARD_E_NO_SMARTCARD;
+
+    *phCard = state().nextHandle++;
+    state().cards.insert(*phCard, { szReader, reader->cardId });
+    *pdwActiveProtocol = SCARD_PROTOCOL_T1;
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardReconnect(SCARDHANDLE hCard, DWORD, DWORD, DWORD, LPDWORD pdwActiveProtocol)
+{
+    QMutexLocker locker(&state().mutex);
+    if (!isCardPresent(hCard))
+        return SCARD_W_REMOVED_CARD;
+    *pdwActiveProtocol = SCARD_PROTOCOL_T1;
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardDisconnect(SCARDHANDLE hCard, DWORD)
+{
+    QMutexLocker locker(&state().mutex);
+    if (!state().cards.remove(hCard))
+        return SCARD_E_INVALID_HANDLE;
+    ++state().disconnects;
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardBeginTransaction(SCARDHANDLE hCard)
+{
+    QMutexLocker locker(&state().mutex);
+    return isCardPresent(hCard) ? SCARD_S_SUCCESS : SCARD_W_REMOVED_CARD;
+}
+
+LONG SCardEndTransaction(SCARDHANDLE hCard, DWORD)
+{
+    QMutexLocker locker(&state().mutex);
+    return isCardPresent(hCard) ? SCARD_S_SUCCESS : SCARD_W_REMOVED_CARD;
+}
+
+LONG SCardStatus(SCARDHANDLE hCard, LPSTR, LPDWORD, LPDWORD pdwState, LPDWORD, LPBYTE, LPDWORD)
+{
+    QMutexLocker locker(&state().mutex);
+    if (!isCardPresent(hCard))
+        return SCARD_W_REMOVED_CARD;
+    if (pdwState)
+        *pdwState = SCARD_PRESENT | SCARD_POWERED | SCARD_SPECIFIC;
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardTransmit(SCARDHANDLE hCard, const SCARD_IO_REQUEST *, LPCBYTE pbSendBuffer,
+                   DWORD cbSendLength, SCARD_IO_REQUEST *, LPBYTE pbRecvBuffer,
+                   LPDWORD pcbRecvLength)
+{
+    QMutexLocker locker(&state().mutex);
+    if (!isCardPresent(hCard))
+        return SCARD_W_REMOVED_CARD;
+
+    QByteArray response;
+    if (cbSendLength >= 2 && pbSendBuffer[0] == 0xFF && pbSendBuffer[1] == 0xCA) {
+        // GET DATA, UID
+        const Card &card = state().cards[hCard];
+        response = state().readers.value(card.readerName).uid + QByteArray::fromHex("9000");
+    } else {
+        // File or application not found
+        response = QByteArray::fromHex("6a82");
+    }
+
+    if (*pcbRecvLength < DWORD(response.size()))
+        return SCARD_E_INSUFFICIENT_BUFFER;
+    memcpy(pbRecvBuffer, response.constData(), response.size());
+    *pcbRecvLength = DWORD(response.size());
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardGetAttrib(SCARDHANDLE, DWORD, LPBYTE, LPDWORD)
+{
+    return SCARD_E_UNSUPPORTED_FEATURE;
+}
+
+const char *pcsc_stringify_error(const LONG)
+{
+    return "PC/SC emulator error";
+}
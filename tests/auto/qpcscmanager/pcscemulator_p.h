@@ -0,0 +1,56 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef PCSCEMULATOR_P_H
+#define PCSCEMULATOR_P_H
+
+#include <QtCore/QByteArray>
+
+// In-process replacement for the PC/SC service, providing the SCard*
+// functions used by the PC/SC backend of QtNfc. Cards answer GET DATA
+// with their UID and reject every other command.
+namespace PcscEmulator {
+
+void reset();
+
+void addReader(const QByteArray &name);
+void removeReader(const QByteArray &name);
+void insertCard(const QByteArray &readerName, const QByteArray &uid);
+void removeCard(const QByteArray &readerName);
+
+// SCardConnect() sleeps for this long before looking at the reader
+void setConnectDelay(int ms);
+
+int connectAttempts();
+int disconnects();
+int openContexts();
+
+} // namespace PcscEmulator
+
+#endif // PCSCEMULATOR_P_H
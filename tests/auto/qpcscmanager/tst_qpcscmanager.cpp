@@ -0,0 +1,222 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include "pcscemulator_p.h"
+#include "qpcscmanager_p.h"
+#include "qpcsccard_p.h"
+
+Q_LOGGING_CATEGORY(QT_NFC_PCSC, "qt.nfc.pcsc")
+
+class tst_QPcscManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void cardDetection_data();
+    void cardDetection();
+    void cardInsertedWhileStopping_data();
+    void cardInsertedWhileStopping();
+
+private:
+    struct InsertedCard
+    {
+        QByteArray uid;
+        QThread *thread;
+    };
+
+    void createManager(bool readerThreads);
+    void destroyManager();
+    void startTargetDetection();
+    void stopTargetDetection();
+    QList<InsertedCard> insertedCards();
+
+    QThread *m_managerThread = nullptr;
+    QPcscManager *m_manager = nullptr;
+    QMutex m_mutex;
+    QList<InsertedCard> m_insertedCards;
+};
+
+void tst_QPcscManager::init()
+{
+    PcscEmulator::reset();
+    m_insertedCards.clear();
+}
+
+void tst_QPcscManager::cleanup()
+{
+    destroyManager();
+    qunsetenv("QT_NFC_PCSC_READER_THREADS");
+}
+
+/*
+    Runs the manager in a thread of its own, as QNearFieldManager does.
+*/
+void tst_QPcscManager::createManager(bool readerThreads)
+{
+    if (readerThreads)
+        qputenv("QT_NFC_PCSC_READER_THREADS", "1");
+    else
+        qunsetenv("QT_NFC_PCSC_READER_THREADS");
+
+    m_managerThread = new QThread;
+    m_manager = new QPcscManager;
+    m_manager->moveToThread(m_managerThread);
+
+    // Emitted from the thread of the slot worker
+    connect(m_manager, &QPcscManager::cardInserted, m_manager,
+            [this](QPcscCard *card, const QByteArray &uid) {
+                QMutexLocker locker(&m_mutex);
+                m_insertedCards.append({ uid, QThread::currentThread() });
+                QMetaObject::invokeMethod(card, &QPcscCard::enableAutodelete,
+                                          Qt::QueuedConnection);
+            },
+            Qt::DirectConnection);
+
+    m_managerThread->start();
+}
+
+void tst_QPcscManager::destroyManager()
+{
+    if (!m_manager)
+        return;
+
+    // The manager quits its thread when it is destroyed
+    QMetaObject::invokeMethod(m_manager, &QObject::deleteLater, Qt::QueuedConnection);
+    m_managerThread->wait();
+    delete m_managerThread;
+    m_manager = nullptr;
+    m_managerThread = nullptr;
+}
+
+void tst_QPcscManager::startTargetDetection()
+{
+    QMetaObject::invokeMethod(m_manager, [manager = m_manager] {
+        manager->onStartTargetDetectionRequest(QNearFieldTarget::AnyAccess);
+    });
+}
+
+void tst_QPcscManager::stopTargetDetection()
+{
+    QMetaObject::invokeMethod(m_manager, &QPcscManager::onStopTargetDetectionRequest);
+}
+
+QList<tst_QPcscManager::InsertedCard> tst_QPcscManager::insertedCards()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_insertedCards;
+}
+
+void tst_QPcscManager::cardDetection_data()
+{
+    QTest::addColumn<bool>("readerThreads");
+
+    QTest::newRow("manager thread") << false;
+    QTest::newRow("reader threads") << true;
+}
+
+void tst_QPcscManager::cardDetection()
+{
+    QFETCH(bool, readerThreads);
+
+    const QByteArray uidA = QByteArray::fromHex("04112233445566");
+    const QByteArray uidB = QByteArray::fromHex("04aabbccddeeff");
+    PcscEmulator::addReader("Reader A");
+    PcscEmulator::addReader("Reader B");
+
+    createManager(readerThreads);
+    startTargetDetection();
+    PcscEmulator::insertCard("Reader A", uidA);
+    PcscEmulator::insertCard("Reader B", uidB);
+
+    QTRY_COMPARE(insertedCards().size(), 2);
+    const auto cards = insertedCards();
+    QCOMPARE(QSet<QByteArray>({ cards.at(0).uid, cards.at(1).uid }),
+             QSet<QByteArray>({ uidA, uidB }));
+
+    if (readerThreads) {
+        QVERIFY(cards.at(0).thread != m_managerThread);
+        QVERIFY(cards.at(1).thread != m_managerThread);
+        QVERIFY(cards.at(0).thread != cards.at(1).thread);
+    } else {
+        QCOMPARE(cards.at(0).thread, m_managerThread);
+        QCOMPARE(cards.at(1).thread, m_managerThread);
+    }
+
+    // The slots with cards are kept until the cards are removed, after that
+    // no PC/SC context is left open
+    stopTargetDetection();
+    QTest::qWait(100);
+    QCOMPARE(PcscEmulator::disconnects(), 0);
+    PcscEmulator::removeCard("Reader A");
+    PcscEmulator::removeCard("Reader B");
+    QTRY_COMPARE(PcscEmulator::disconnects(), 2);
+    QTRY_COMPARE(PcscEmulator::openContexts(), 0);
+    QCOMPARE(insertedCards().size(), 2);
+}
+
+void tst_QPcscManager::cardInsertedWhileStopping_data()
+{
+    cardDetection_data();
+}
+
+void tst_QPcscManager::cardInsertedWhileStopping()
+{
+    QFETCH(bool, readerThreads);
+
+    PcscEmulator::addReader("Reader");
+    PcscEmulator::setConnectDelay(300);
+
+    createManager(readerThreads);
+    startTargetDetection();
+    PcscEmulator::insertCard("Reader", QByteArray::fromHex("04010203040506"));
+
+    // Stop while the slot worker is still connecting to the new card
+    QTRY_COMPARE(PcscEmulator::connectAttempts(), 1);
+    stopTargetDetection();
+
+    // The card is reported and stays connected, because it is still present
+    QTRY_COMPARE(insertedCards().size(), 1);
+    QTest::qWait(100);
+    QCOMPARE(PcscEmulator::disconnects(), 0);
+
+    // Once it is gone, the slot does not linger
+    PcscEmulator::removeCard("Reader");
+    QTRY_COMPARE(PcscEmulator::disconnects(), 1);
+    QTRY_COMPARE(PcscEmulator::openContexts(), 0);
+    QCOMPARE(PcscEmulator::connectAttempts(), 1);
+}
+
+QTEST_MAIN(tst_QPcscManager)
+
+#include "tst_qpcscmanager.moc"
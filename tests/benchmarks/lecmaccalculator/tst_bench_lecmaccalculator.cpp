@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtBluetooth/qbluetoothuuid.h>
+#include <QtBluetooth/private/lecmaccalculator_p.h>
+#include <QtTest/QtTest>
+
+using Implementation = LeCmacCalculator::Implementation;
+
+Q_DECLARE_METATYPE(LeCmacCalculator::Implementation)
+
+class tst_bench_LeCmacCalculator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void calculateMac_data();
+    void calculateMac();
+    void calculateMacUncachedKey_data();
+    void calculateMacUncachedKey();
+    void expandKey();
+};
+
+// Spec v4.2, Vol 3, Part H, Appendix D.1
+static const quint128 csrk = {
+    { 0x3c, 0x4f, 0xcf, 0x09, 0x88, 0x15, 0xf7, 0xab,
+      0xa6, 0xd2, 0xae, 0x28, 0x16, 0x15, 0x7e, 0x2b }
+};
+
+static void addRows()
+{
+    QTest::addColumn<Implementation>("implementation");
+    QTest::addColumn<int>("messageSize");
+
+    // A signed write carries opcode, handle, value and sign counter,
+    // so these are typical sizes for small and MTU-sized values.
+    const int sizes[] = { 7, 27, 251, 512 };
+    for (int size : sizes) {
+        QTest::addRow("in-process, %d bytes", size) << Implementation::InProcess << size;
+#ifdef CONFIG_LINUX_CRYPTO_API
+        QTest::addRow("AF_ALG, %d bytes", size) << Implementation::LinuxCryptoApi << size;
+#endif
+    }
+}
+
+void tst_bench_LeCmacCalculator::calculateMac_data()
+{
+    addRows();
+}
+
+void tst_bench_LeCmacCalculator::calculateMac()
+{
+    QFETCH(Implementation, implementation);
+    QFETCH(int, messageSize);
+
+    const LeCmacCalculator calculator(implementation);
+    if (calculator.implementation() != implementation)
+        QSKIP("Linux crypto API not usable");
+    const LeCmacCalculator::KeySchedule key = LeCmacCalculator::expandKey(csrk);
+    const QByteArray message(messageSize, 'x');
+    quint64 mac = 0;
+    QBENCHMARK {
+        mac ^= calculator.calculateMac(message, key);
+    }
+    Q_UNUSED(mac);
+}
+
+void tst_bench_LeCmacCalculator::calculateMacUncachedKey_data()
+{
+    addRows();
+}
+
+void tst_bench_LeCmacCalculator::calculateMacUncachedKey()
+{
+    QFETCH(Implementation, implementation);
+    QFETCH(int, messageSize);
+
+    // This is what a signed write cost before the key schedule was cached per peer.
+    const QByteArray message(messageSize, 'x');
+    quint64 mac = 0;
+    QBENCHMARK {
+        const LeCmacCalculator calculator(implementation);
+        mac ^= calculator.calculateMac(message, csrk);
+    }
+    Q_UNUSED(mac);
+}
+
+void tst_bench_LeCmacCalculator::expandKey()
+{
+    QBENCHMARK {
+        const LeCmacCalculator::KeySchedule key = LeCmacCalculator::expandKey(csrk);
+        Q_UNUSED(key);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_bench_LeCmacCalculator)
+
+#include "tst_bench_lecmaccalculator.moc"
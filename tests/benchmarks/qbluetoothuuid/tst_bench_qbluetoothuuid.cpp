@@ -0,0 +1,250 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtBluetooth/qbluetoothuuid.h>
+#include <QtBluetooth/private/qbluetoothuuid_p.h>
+#include <QtCore/qset.h>
+#include <QtTest/QtTest>
+
+using namespace QtBluetoothPrivate;
+
+class tst_bench_QBluetoothUuid : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fromString_data();
+    void fromString();
+    void fromString16Bit();
+    void fromUInt16();
+    void minimumSize_data();
+    void minimumSize();
+    void toUInt16();
+    void toWire_data();
+    void toWire();
+    void toWireViaUInt128();
+    void fromWire_data();
+    void fromWire();
+    void hash();
+    void characteristicToString();
+    void uuidFromAssignedName();
+};
+
+static const QBluetoothUuid uuid16(QBluetoothUuid::CharacteristicType::HeartRateMeasurement);
+static const QBluetoothUuid uuid32(quint32(0x12345678));
+static const QBluetoothUuid uuid128(QStringLiteral("{67c8770b-44f1-410a-ab9a-f9b5446f13ee}"));
+
+void tst_bench_QBluetoothUuid::fromString_data()
+{
+    QTest::addColumn<QString>("string");
+    QTest::addColumn<bool>("viaQUuid");
+
+    const QString braces = QStringLiteral("{67C8770B-44F1-410A-AB9A-F9B5446F13EE}");
+    const QString plain = QStringLiteral("67c8770b-44f1-410a-ab9a-f9b5446f13ee");
+    const QString invalid = QStringLiteral("{67C8770B-44F1-410A-AB9A-F9B5446F13EX}");
+    QTest::newRow("braces") << braces << false;
+    QTest::newRow("braces, QUuid") << braces << true;
+    QTest::newRow("no braces") << plain << false;
+    QTest::newRow("no braces, QUuid") << plain << true;
+    QTest::newRow("invalid") << invalid << false;
+    QTest::newRow("invalid, QUuid") << invalid << true;
+}
+
+void tst_bench_QBluetoothUuid::fromString()
+{
+    QFETCH(QString, string);
+    QFETCH(bool, viaQUuid);
+
+    if (viaQUuid) {
+        QBENCHMARK {
+            const QUuid uuid(string);
+            Q_UNUSED(uuid);
+        }
+    } else {
+        QBENCHMARK {
+            const QBluetoothUuid uuid(string);
+            Q_UNUSED(uuid);
+        }
+    }
+}
+
+void tst_bench_QBluetoothUuid::fromString16Bit()
+{
+    // Typical for UUIDs reported by BlueZ over D-Bus
+    const QString string = QStringLiteral("0000180d-0000-1000-8000-00805f9b34fb");
+    quint16 result = 0;
+    QBENCHMARK {
+        result += QBluetoothUuid(string).toUInt16();
+    }
+    QCOMPARE(QBluetoothUuid(string), QBluetoothUuid(quint16(0x180d)));
+    Q_UNUSED(result);
+}
+
+void tst_bench_QBluetoothUuid::fromUInt16()
+{
+    quint16 value = 0x2a00;
+    QBENCHMARK {
+        const QBluetoothUuid uuid(value++);
+        Q_UNUSED(uuid);
+    }
+}
+
+void tst_bench_QBluetoothUuid::minimumSize_data()
+{
+    QTest::addColumn<QBluetoothUuid>("uuid");
+
+    QTest::newRow("16 bit") << uuid16;
+    QTest::newRow("32 bit") << uuid32;
+    QTest::newRow("128 bit") << uuid128;
+}
+
+void tst_bench_QBluetoothUuid::minimumSize()
+{
+    QFETCH(QBluetoothUuid, uuid);
+
+    int size = 0;
+    QBENCHMARK {
+        size += uuid.minimumSize();
+    }
+    Q_UNUSED(size);
+}
+
+void tst_bench_QBluetoothUuid::toUInt16()
+{
+    bool ok = false;
+    quint16 value = 0;
+    QBENCHMARK {
+        value += uuid16.toUInt16(&ok);
+    }
+    QVERIFY(ok);
+}
+
+void tst_bench_QBluetoothUuid::toWire_data()
+{
+    QTest::addColumn<QBluetoothUuid>("uuid");
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("2 bytes") << uuid16 << 2;
+    QTest::newRow("4 bytes") << uuid32 << 4;
+    QTest::newRow("16 bytes") << uuid128 << 16;
+}
+
+void tst_bench_QBluetoothUuid::toWire()
+{
+    QFETCH(QBluetoothUuid, uuid);
+    QFETCH(int, size);
+
+    // Appending to a preallocated PDU, as the ATT response builders do
+    QByteArray pdu;
+    pdu.reserve(512);
+    QBENCHMARK {
+        pdu.resize(0);
+        for (int i = 0; i < 16; ++i)
+            appendUuidLittleEndian(pdu, uuid, size);
+    }
+    QCOMPARE(uuidFromLittleEndian(pdu.constData(), size), uuid);
+}
+
+void tst_bench_QBluetoothUuid::toWireViaUInt128()
+{
+    // The conversion previously done by the ATT code, for comparison with toWire()
+    QByteArray pdu;
+    pdu.reserve(512);
+    QBENCHMARK {
+        pdu.resize(0);
+        for (int i = 0; i < 16; ++i) {
+            const quint128 bigEndian = uuid128.toUInt128();
+            char littleEndian[16];
+            for (int j = 0; j < 16; ++j)
+                littleEndian[j] = char(bigEndian.data[15 - j]);
+            pdu.append(littleEndian, sizeof(littleEndian));
+        }
+    }
+    QCOMPARE(uuidFromLittleEndian(pdu.constData(), 16), uuid128);
+}
+
+void tst_bench_QBluetoothUuid::fromWire_data()
+{
+    toWire_data();
+}
+
+void tst_bench_QBluetoothUuid::fromWire()
+{
+    QFETCH(QBluetoothUuid, uuid);
+    QFETCH(int, size);
+
+    char buffer[16];
+    putUuidLittleEndian(uuid, size, buffer);
+    QBluetoothUuid result;
+    QBENCHMARK {
+        result = uuidFromLittleEndian(buffer, size);
+    }
+    QCOMPARE(result, uuid);
+}
+
+void tst_bench_QBluetoothUuid::hash()
+{
+    QList<QBluetoothUuid> uuids;
+    for (quint16 i = 0; i < 256; ++i)
+        uuids.append(QBluetoothUuid(quint16(0x2a00 + i)));
+
+    QBENCHMARK {
+        QSet<QBluetoothUuid> set;
+        set.reserve(uuids.size());
+        for (const QBluetoothUuid &uuid : std::as_const(uuids))
+            set.insert(uuid);
+    }
+}
+
+void tst_bench_QBluetoothUuid::characteristicToString()
+{
+    // What building the inventory of a device's services and characteristics costs
+    int length = 0;
+    QBENCHMARK {
+        for (quint16 value = 0x2a00; value < 0x2b00; ++value) {
+            length += QBluetoothUuid::characteristicToString(
+                              static_cast<QBluetoothUuid::CharacteristicType>(value)).size();
+        }
+    }
+    Q_UNUSED(length);
+}
+
+void tst_bench_QBluetoothUuid::uuidFromAssignedName()
+{
+    const QString name = QStringLiteral("Heart Rate Measurement");
+    QBluetoothUuid result;
+    QBENCHMARK {
+        result = QtBluetoothPrivate::uuidFromAssignedName(AssignedNumberCategory::Characteristic,
+                                                          name);
+    }
+    QCOMPARE(result, uuid16);
+}
+
+QTEST_MAIN(tst_bench_QBluetoothUuid)
+
+#include "tst_bench_qbluetoothuuid.moc"
@@ -0,0 +1,340 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtBluetooth module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtBluetooth/qlowenergycharacteristicdata.h>
+#include <QtBluetooth/qlowenergycontroller.h>
+#include <QtBluetooth/qlowenergydescriptordata.h>
+#include <QtBluetooth/qlowenergyservicedata.h>
+#include <QtBluetooth/private/qlowenergycontroller_bluez_p.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtTest/QtTest>
+
+// All benchmarks run a central and a peripheral controller in this process,
+// connected by the loopback ATT bearer. Both ends share the thread, so the
+// numbers are the combined CPU cost of the two protocol engines per operation.
+
+static const QBluetoothUuid serviceUuid(QStringLiteral("{a1b2c3d4-0000-1000-8000-00805f9b34fb}"));
+
+static QBluetoothUuid characteristicUuid(int index)
+{
+    return QBluetoothUuid(quint32(0xa1b20000 + index));
+}
+
+template <typename Predicate>
+static bool waitFor(Predicate predicate, int timeout = 10000)
+{
+    // QTest::qWaitFor() sleeps between polls, which would dominate the
+    // measurements, so block in the event loop instead.
+    QTimer wakeUp;
+    wakeUp.setSingleShot(true);
+    wakeUp.start(timeout);
+    while (!predicate() && wakeUp.isActive())
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    return predicate();
+}
+
+class LoopbackLink
+{
+public:
+    bool setUp(int characteristicCount, quint16 mtu);
+    bool discover();
+
+    QScopedPointer<QLowEnergyController> peripheral;
+    QScopedPointer<QLowEnergyService> localService;
+    QScopedPointer<QLowEnergyController> central;
+    QScopedPointer<QLowEnergyService> remoteService;
+};
+
+bool LoopbackLink::setUp(int characteristicCount, quint16 mtu)
+{
+    QLowEnergyServiceData serviceData;
+    serviceData.setType(QLowEnergyServiceData::ServiceTypePrimary);
+    serviceData.setUuid(serviceUuid);
+    for (int i = 0; i < characteristicCount; ++i) {
+        QLowEnergyCharacteristicData characteristic;
+        characteristic.setUuid(characteristicUuid(i));
+        characteristic.setProperties(QLowEnergyCharacteristic::Read
+                                     | QLowEnergyCharacteristic::Write
+                                     | QLowEnergyCharacteristic::WriteNoResponse
+                                     | QLowEnergyCharacteristic::Notify);
+        characteristic.setValue(QByteArray(4, 'v'));
+        characteristic.setValueLength(0, 512);
+        characteristic.addDescriptor(QLowEnergyDescriptorData(
+                QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration,
+                QByteArray(2, 0)));
+        serviceData.addCharacteristic(characteristic);
+    }
+
+    peripheral.reset(QLowEnergyControllerPrivateBluez::createLoopbackController(
+            QLowEnergyController::PeripheralRole));
+    localService.reset(peripheral->addService(serviceData));
+    central.reset(QLowEnergyControllerPrivateBluez::createLoopbackController(
+            QLowEnergyController::CentralRole));
+    if (!localService
+            || !QLowEnergyControllerPrivateBluez::connectLoopback(central.data(),
+                                                                  peripheral.data(), mtu)) {
+        return false;
+    }
+    return waitFor([this, mtu]() { return central->mtu() == mtu; });
+}
+
+bool LoopbackLink::discover()
+{
+    central->discoverServices();
+    if (!waitFor([this]() {
+            return central->state() == QLowEnergyController::DiscoveredState; })) {
+        return false;
+    }
+    remoteService.reset(central->createServiceObject(serviceUuid));
+    if (!remoteService)
+        return false;
+    remoteService->discoverDetails();
+    return waitFor([this]() {
+        return remoteService->state() == QLowEnergyService::RemoteServiceDiscovered;
+    });
+}
+
+class tst_bench_QLowEnergyController : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void discovery_data();
+    void discovery();
+    void read_data();
+    void read();
+    void write_data();
+    void write();
+    void notify_data();
+    void notify();
+    void throughput_data();
+    void throughput();
+};
+
+static void addMtuRows()
+{
+    QTest::addColumn<int>("mtu");
+
+    // default LE MTU, a full LE data length PDU and the largest attribute value
+    const int mtus[] = { 23, 247, 517 };
+    for (int mtu : mtus)
+        QTest::addRow("MTU %d", mtu) << mtu;
+}
+
+void tst_bench_QLowEnergyController::discovery_data()
+{
+    QTest::addColumn<int>("characteristicCount");
+    QTest::addColumn<int>("mtu");
+
+    const int counts[] = { 1, 16, 64 };
+    const int mtus[] = { 23, 247, 517 };
+    for (int count : counts) {
+        for (int mtu : mtus)
+            QTest::addRow("%d characteristics, MTU %d", count, mtu) << count << mtu;
+    }
+}
+
+void tst_bench_QLowEnergyController::discovery()
+{
+    QFETCH(int, characteristicCount);
+    QFETCH(int, mtu);
+
+    // includes the connection setup and the MTU exchange
+    QBENCHMARK {
+        LoopbackLink link;
+        QVERIFY(link.setUp(characteristicCount, mtu));
+        QVERIFY(link.discover());
+    }
+}
+
+void tst_bench_QLowEnergyController::read_data()
+{
+    addMtuRows();
+}
+
+void tst_bench_QLowEnergyController::read()
+{
+    QFETCH(int, mtu);
+
+    LoopbackLink link;
+    QVERIFY(link.setUp(1, mtu));
+    QVERIFY(link.discover());
+
+    // a value filling the whole Read Response
+    link.localService->writeCharacteristic(
+            link.localService->characteristic(characteristicUuid(0)), QByteArray(mtu - 1, 'r'));
+    const QLowEnergyCharacteristic characteristic =
+            link.remoteService->characteristic(characteristicUuid(0));
+    int reads = 0;
+    QObject::connect(link.remoteService.data(), &QLowEnergyService::characteristicRead,
+                     [&reads]() { ++reads; });
+
+    QBENCHMARK {
+        const int expected = reads + 1;
+        link.remoteService->readCharacteristic(characteristic);
+        QVERIFY(waitFor([&]() { return reads == expected; }));
+    }
+}
+
+void tst_bench_QLowEnergyController::write_data()
+{
+    QTest::addColumn<int>("mtu");
+    QTest::addColumn<QLowEnergyService::WriteMode>("mode");
+
+    const int mtus[] = { 23, 247, 517 };
+    for (int mtu : mtus) {
+        QTest::addRow("request, MTU %d", mtu) << mtu << QLowEnergyService::WriteWithResponse;
+        QTest::addRow("command, MTU %d", mtu) << mtu << QLowEnergyService::WriteWithoutResponse;
+    }
+}
+
+void tst_bench_QLowEnergyController::write()
+{
+    QFETCH(int, mtu);
+    QFETCH(QLowEnergyService::WriteMode, mode);
+
+    LoopbackLink link;
+    QVERIFY(link.setUp(1, mtu));
+    QVERIFY(link.discover());
+
+    const QLowEnergyCharacteristic characteristic =
+            link.remoteService->characteristic(characteristicUuid(0));
+    const QByteArray value(mtu - 3, 'w');
+    // The peripheral reports every write by the client, which also covers
+    // write commands that are never acknowledged on the bearer.
+    int writes = 0;
+    QObject::connect(link.localService.data(), &QLowEnergyService::characteristicChanged,
+                     [&writes]() { ++writes; });
+
+    QBENCHMARK {
+        const int expected = writes + 1;
+        link.remoteService->writeCharacteristic(characteristic, value, mode);
+        QVERIFY(waitFor([&]() { return writes == expected; }));
+    }
+}
+
+void tst_bench_QLowEnergyController::notify_data()
+{
+    addMtuRows();
+}
+
+void tst_bench_QLowEnergyController::notify()
+{
+    QFETCH(int, mtu);
+
+    LoopbackLink link;
+    QVERIFY(link.setUp(1, mtu));
+    QVERIFY(link.discover());
+
+    const QLowEnergyCharacteristic localCharacteristic =
+            link.localService->characteristic(characteristicUuid(0));
+    link.remoteService->subscribe({ link.remoteService->characteristic(characteristicUuid(0)) });
+    QVERIFY(waitFor([&]() {
+        return localCharacteristic.clientCharacteristicConfiguration().value()
+                == QByteArray::fromHex("0100");
+    }));
+
+    const QByteArray value(mtu - 3, 'n');
+    int notifications = 0;
+    QObject::connect(link.remoteService.data(), &QLowEnergyService::characteristicChanged,
+                     [&notifications]() { ++notifications; });
+
+    QBENCHMARK {
+        const int expected = notifications + 1;
+        link.localService->writeCharacteristic(localCharacteristic, value);
+        QVERIFY(waitFor([&]() { return notifications == expected; }));
+    }
+}
+
+void tst_bench_QLowEnergyController::throughput_data()
+{
+    QTest::addColumn<int>("mtu");
+    QTest::addColumn<bool>("notifications");
+
+    const int mtus[] = { 23, 247, 517 };
+    for (int mtu : mtus) {
+        QTest::addRow("notifications, MTU %d", mtu) << mtu << true;
+        QTest::addRow("write commands, MTU %d", mtu) << mtu << false;
+    }
+}
+
+void tst_bench_QLowEnergyController::throughput()
+{
+    QFETCH(int, mtu);
+    QFETCH(bool, notifications);
+
+    LoopbackLink link;
+    QVERIFY(link.setUp(1, mtu));
+    QVERIFY(link.discover());
+
+    const QLowEnergyCharacteristic localCharacteristic =
+            link.localService->characteristic(characteristicUuid(0));
+    const QLowEnergyCharacteristic remoteCharacteristic =
+            link.remoteService->characteristic(characteristicUuid(0));
+    if (notifications) {
+        link.remoteService->subscribe({ remoteCharacteristic });
+        QVERIFY(waitFor([&]() {
+            return localCharacteristic.clientCharacteristicConfiguration().value()
+                    == QByteArray::fromHex("0100");
+        }));
+    }
+
+    const QByteArray value(mtu - 3, 't');
+    int received = 0;
+    QLowEnergyService *receiver =
+            notifications ? link.remoteService.data() : link.localService.data();
+    QObject::connect(receiver, &QLowEnergyService::characteristicChanged,
+                     [&received]() { ++received; });
+
+    // Unacknowledged PDUs are written straight to the socket and dropped when
+    // its send buffer is full, so keep a bounded number of them in flight.
+    constexpr int packetCount = 4096;
+    constexpr int window = 32;
+    QElapsedTimer timer;
+    timer.start();
+    for (int sent = 0; sent < packetCount; ++sent) {
+        if (sent - received >= window)
+            QVERIFY(waitFor([&]() { return sent - received < window; }));
+        if (notifications)
+            link.localService->writeCharacteristic(localCharacteristic, value);
+        else
+            link.remoteService->writeCharacteristic(remoteCharacteristic, value,
+                                                    QLowEnergyService::WriteWithoutResponse);
+    }
+    QVERIFY(waitFor([&]() { return received == packetCount; }));
+    const qint64 elapsed = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    QTest::setBenchmarkResult(qreal(packetCount) * value.size() * 1e9 / elapsed,
+                              QTest::BytesPerSecond);
+}
+
+QTEST_MAIN(tst_bench_QLowEnergyController)
+
+#include "tst_bench_qlowenergycontroller.moc"
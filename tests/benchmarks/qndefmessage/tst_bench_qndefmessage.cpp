@@ -0,0 +1,288 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNfc module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QDir>
+#include <QtCore/QSettings>
+
+#include <QtNfc/qndefmessage.h>
+#include <QtNfc/qndefnfctextrecord.h>
+#include <QtNfc/private/qndefmessageview_p.h>
+#include <QtNfc/private/qndefmessagewriter_p.h>
+
+QT_USE_NAMESPACE
+
+class tst_bench_QNdefMessage : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void fromByteArray_data();
+    void fromByteArray();
+    void iterateView_data();
+    void iterateView();
+    void viewToMessage_data();
+    void viewToMessage();
+    void incrementalParser_data();
+    void incrementalParser();
+    void toByteArray_data();
+    void toByteArray();
+    void writeChunked_data();
+    void writeChunked();
+
+private:
+    void addCorpus();
+
+    QList<QPair<QByteArray, QByteArray>> corpus;
+};
+
+// Extracts the NDEF message TLV from the data area of a Type 1 tag dump
+static QByteArray ndefMessageFromType1Dump(const QByteArray &data)
+{
+    // UID and reserved byte, followed by the capability container
+    qsizetype idx = 12;
+    while (idx < data.size()) {
+        const quint8 tag = data.at(idx++);
+        if (tag == 0x00)
+            continue;
+        if (tag == 0xfe || idx >= data.size())
+            break;
+
+        qsizetype length = quint8(data.at(idx++));
+        if (length == 0xff) {
+            if (idx + 2 > data.size())
+                break;
+            length = qFromBigEndian<quint16>(data.constData() + idx);
+            idx += 2;
+        }
+
+        if (tag == 0x03)
+            return data.mid(idx, length);
+
+        idx += length;
+    }
+
+    return QByteArray();
+}
+
+void tst_bench_QNdefMessage::initTestCase()
+{
+    // Real tag dumps
+    QDirIterator dumps(QStringLiteral(SRCDIR), QStringList(QStringLiteral("*.nfc")), QDir::Files);
+    while (dumps.hasNext()) {
+        QSettings settings(dumps.next(), QSettings::IniFormat);
+        const QByteArray message =
+                ndefMessageFromType1Dump(settings.value(QStringLiteral("TagType1/Data")).toByteArray());
+        if (!message.isEmpty())
+            corpus.append({ dumps.fileInfo().baseName().toLatin1(), message });
+    }
+    QVERIFY(!corpus.isEmpty());
+
+    // A message with many small records, as written by contact sharing apps
+    QNdefMessage manyRecords;
+    for (int i = 0; i < 64; ++i) {
+        QNdefNfcTextRecord text;
+        text.setText(QStringLiteral("Record text %1").arg(i));
+        manyRecords.append(text);
+    }
+    corpus.append({ "many records", manyRecords.toByteArray() });
+
+    // One record split into 64 byte chunks
+    const QByteArray payload(4096, 'x');
+    QByteArray chunked;
+    for (qsizetype offset = 0; offset < payload.size(); offset += 64) {
+        quint8 flags = 0x10; // SR
+        if (offset == 0)
+            flags |= 0x80 | 0x02; // MB, TNF = Mime
+        else
+            flags |= 0x06; // TNF = Unchanged
+        if (offset + 64 < payload.size())
+            flags |= 0x20; // CF
+        else
+            flags |= 0x40; // ME
+
+        const QByteArray type = offset == 0 ? QByteArray("application/octet-stream")
+                                            : QByteArray();
+        chunked.append(char(flags));
+        chunked.append(char(type.size()));
+        chunked.append(char(64));
+        chunked.append(type);
+        chunked.append(payload.mid(offset, 64));
+    }
+    corpus.append({ "chunked", chunked });
+}
+
+void tst_bench_QNdefMessage::addCorpus()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    for (const auto &entry : std::as_const(corpus))
+        QTest::newRow(entry.first.constData()) << entry.second;
+}
+
+void tst_bench_QNdefMessage::fromByteArray_data()
+{
+    addCorpus();
+}
+
+void tst_bench_QNdefMessage::fromByteArray()
+{
+    QFETCH(QByteArray, data);
+
+    QNdefMessage message;
+    QBENCHMARK {
+        message = QNdefMessage::fromByteArray(data);
+    }
+    QVERIFY(!message.isEmpty());
+}
+
+void tst_bench_QNdefMessage::iterateView_data()
+{
+    addCorpus();
+}
+
+void tst_bench_QNdefMessage::iterateView()
+{
+    // What looking at the records costs without converting them
+    QFETCH(QByteArray, data);
+
+    qsizetype payloadSize = 0;
+    QBENCHMARK {
+        payloadSize = 0;
+        const QNdefMessageView view(data);
+        for (const auto &record : view)
+            payloadSize += record.payload().size();
+    }
+    QVERIFY(payloadSize > 0);
+}
+
+void tst_bench_QNdefMessage::viewToMessage_data()
+{
+    addCorpus();
+}
+
+void tst_bench_QNdefMessage::viewToMessage()
+{
+    QFETCH(QByteArray, data);
+
+    const QNdefMessageView view(data);
+    QVERIFY(view.isValid());
+
+    QNdefMessage message;
+    QBENCHMARK {
+        message = view.toMessage();
+    }
+    QCOMPARE(message.size(), view.recordCount());
+}
+
+void tst_bench_QNdefMessage::incrementalParser_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("chunkSize");
+
+    // Typical ReadBinary response sizes for short and extended APDUs
+    for (const auto &entry : std::as_const(corpus)) {
+        for (int chunkSize : { 59, 255 }) {
+            QTest::addRow("%s, %d byte chunks", entry.first.constData(), chunkSize)
+                    << entry.second << chunkSize;
+        }
+    }
+}
+
+void tst_bench_QNdefMessage::incrementalParser()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, chunkSize);
+
+    QNdefMessageParser parser;
+    QNdefMessage message;
+    QBENCHMARK {
+        parser.clear();
+        parser.reserve(data.size());
+        for (qsizetype offset = 0; offset < data.size(); offset += chunkSize)
+            parser.append(QByteArrayView(data).sliced(offset, qMin<qsizetype>(chunkSize, data.size() - offset)));
+        message = parser.message().toMessage();
+    }
+    QCOMPARE(parser.status(), QNdefMessageParser::Status::Complete);
+    QVERIFY(!message.isEmpty());
+}
+
+void tst_bench_QNdefMessage::toByteArray_data()
+{
+    addCorpus();
+}
+
+void tst_bench_QNdefMessage::toByteArray()
+{
+    QFETCH(QByteArray, data);
+
+    const QNdefMessage message = QNdefMessage::fromByteArray(data);
+    QByteArray encoded;
+    QBENCHMARK {
+        encoded = message.toByteArray();
+    }
+    QCOMPARE(QNdefMessage::fromByteArray(encoded), message);
+}
+
+void tst_bench_QNdefMessage::writeChunked_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("chunkSize");
+
+    for (const auto &entry : std::as_const(corpus)) {
+        for (int chunkSize : { 64, 1024 }) {
+            QTest::addRow("%s, %d byte chunks", entry.first.constData(), chunkSize)
+                    << entry.second << chunkSize;
+        }
+    }
+}
+
+void tst_bench_QNdefMessage::writeChunked()
+{
+    // Streams the message out without building it in one buffer first
+    QFETCH(QByteArray, data);
+    QFETCH(int, chunkSize);
+
+    const QNdefMessage message = QNdefMessage::fromByteArray(data);
+    qsizetype written = 0;
+    QBENCHMARK {
+        written = 0;
+        QNdefMessageWriter writer(message, chunkSize);
+        writer.write([&written](QByteArrayView piece) {
+            written += piece.size();
+            return true;
+        });
+    }
+    QCOMPARE(written, QNdefMessageWriter(message, chunkSize).encodedSize());
+}
+
+QTEST_MAIN(tst_bench_QNdefMessage)
+
+#include "tst_bench_qndefmessage.moc"